@@ -0,0 +1,25 @@
+#pragma once
+
+#include <windows.h>
+
+/**
+ * @brief Lowers the CPU and I/O priority of the current thread while it exists.
+ *
+ * Background tasks run on workers shared with urgent work, so they lower the worker for
+ * their own duration only rather than for the life of the thread.
+ */
+class BackgroundModeScope
+{
+public:
+    BackgroundModeScope() : m_entered(SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN) != FALSE) {}
+    ~BackgroundModeScope()
+    {
+        if (m_entered) SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+    }
+
+    BackgroundModeScope(const BackgroundModeScope&) = delete;
+    BackgroundModeScope& operator=(const BackgroundModeScope&) = delete;
+
+private:
+    bool m_entered;
+};
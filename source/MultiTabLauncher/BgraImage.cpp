@@ -0,0 +1,240 @@
+#include "BgraImage.h"
+
+#include <algorithm>
+#include <cmath>
+#include "SimdLevel.h"
+
+#if MTL_ENABLE_SIMD
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // The source pixels that contribute to one destination pixel along one axis
+    struct Taps
+    {
+        int first{ 0 };
+        int count{ 0 };
+        size_t weightOffset{ 0 };
+    };
+
+    struct Kernel
+    {
+        std::vector<Taps> taps;
+        std::vector<float> weights;
+    };
+
+    /**
+     * @brief Computes the filter weights for resampling one axis.
+     *
+     * A tent filter stretched over the scale factor: when shrinking, each destination
+     * pixel averages all the source pixels it covers, weighted towards its center, so
+     * that no source pixel is skipped. When enlarging it is bilinear interpolation.
+     */
+    Kernel ComputeKernel(int sourceSize, int destinationSize)
+    {
+        Kernel kernel;
+        kernel.taps.resize(destinationSize);
+
+        const double scale = static_cast<double>(sourceSize) / destinationSize;
+        const double support = (std::max)(scale, 1.0);
+        for (int i = 0; i < destinationSize; ++i)
+        {
+            double center = (i + 0.5) * scale;
+            int first = (std::max)(0, static_cast<int>(std::floor(center - support)));
+            int last = (std::min)(sourceSize, static_cast<int>(std::ceil(center + support)));
+
+            Taps& taps = kernel.taps[i];
+            taps.first = first;
+            taps.count = last - first;
+            taps.weightOffset = kernel.weights.size();
+
+            double total = 0.0;
+            for (int j = first; j < last; ++j)
+            {
+                double weight = (std::max)(0.0, 1.0 - std::abs(j + 0.5 - center) / support);
+                kernel.weights.push_back(static_cast<float>(weight));
+                total += weight;
+            }
+            for (int j = 0; j < taps.count; ++j)
+            {
+                kernel.weights[taps.weightOffset + j] = static_cast<float>(kernel.weights[taps.weightOffset + j] / total);
+            }
+        }
+        return kernel;
+    }
+
+    /**
+     * @brief Premultiplies colors by alpha into four floats per pixel: B, G, R, A.
+     */
+    void Premultiply(const std::vector<uint32_t>& pixels, float* destination, bool vectorized)
+    {
+        size_t i = 0;
+#if MTL_ENABLE_SIMD
+        if (vectorized)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128 alphaLane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+            for (; i < pixels.size(); ++i)
+            {
+                __m128i bytes = _mm_cvtsi32_si128(static_cast<int>(pixels[i]));
+                __m128 channels = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+                __m128 alpha = _mm_shuffle_ps(channels, channels, _MM_SHUFFLE(3, 3, 3, 3));
+                __m128 scaled = _mm_mul_ps(channels, _mm_div_ps(alpha, _mm_set1_ps(255.0f)));
+                // Alpha itself is kept as it is
+                _mm_storeu_ps(destination + i * 4, _mm_or_ps(_mm_and_ps(alphaLane, channels), _mm_andnot_ps(alphaLane, scaled)));
+            }
+        }
+#else
+        (void)vectorized;
+#endif
+        for (; i < pixels.size(); ++i)
+        {
+            uint32_t pixel = pixels[i];
+            float alpha = static_cast<float>(pixel >> 24);
+            float factor = alpha / 255.0f;
+            destination[i * 4 + 0] = static_cast<float>(pixel & 0xFF) * factor;
+            destination[i * 4 + 1] = static_cast<float>((pixel >> 8) & 0xFF) * factor;
+            destination[i * 4 + 2] = static_cast<float>((pixel >> 16) & 0xFF) * factor;
+            destination[i * 4 + 3] = alpha;
+        }
+    }
+
+    /**
+     * @brief Filters rows of four-channel pixels along one axis.
+     * @param source, destination Pixels as four floats each.
+     * @param stride The distance in floats between neighbouring pixels along the filtered axis.
+     * @param lineStride The distance in floats between neighbouring lines in the source.
+     * @param destinationStride, destinationLineStride The same for the destination.
+     * @param vectorized Whether to sum the four channels of a pixel in one SSE2 register.
+     */
+    void Convolve(const float* source, float* destination, const Kernel& kernel, int lineCount,
+        size_t stride, size_t lineStride, size_t destinationStride, size_t destinationLineStride, bool vectorized)
+    {
+        for (int line = 0; line < lineCount; ++line)
+        {
+            const float* sourceLine = source + line * lineStride;
+            float* destinationLine = destination + line * destinationLineStride;
+            for (size_t i = 0; i < kernel.taps.size(); ++i)
+            {
+                const Taps& taps = kernel.taps[i];
+                const float* weights = kernel.weights.data() + taps.weightOffset;
+                const float* pixel = sourceLine + taps.first * stride;
+                float* out = destinationLine + i * destinationStride;
+#if MTL_ENABLE_SIMD
+                if (vectorized)
+                {
+                    __m128 sum = _mm_setzero_ps();
+                    for (int j = 0; j < taps.count; ++j, pixel += stride)
+                    {
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(pixel), _mm_set1_ps(weights[j])));
+                    }
+                    _mm_storeu_ps(out, sum);
+                    continue;
+                }
+#else
+                (void)vectorized;
+#endif
+                float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                for (int j = 0; j < taps.count; ++j, pixel += stride)
+                {
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        sum[c] += pixel[c] * weights[j];
+                    }
+                }
+                for (int c = 0; c < 4; ++c)
+                {
+                    out[c] = sum[c];
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Converts filtered pixels back to straight alpha, rounded and clamped to bytes.
+     */
+    void Unpremultiply(const float* source, std::vector<uint32_t>& pixels, bool vectorized)
+    {
+        size_t i = 0;
+#if MTL_ENABLE_SIMD
+        if (vectorized)
+        {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 maximum = _mm_set1_ps(255.0f);
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 alphaLane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+            for (; i < pixels.size(); ++i)
+            {
+                __m128 channels = _mm_loadu_ps(source + i * 4);
+                __m128 alpha = _mm_shuffle_ps(channels, channels, _MM_SHUFFLE(3, 3, 3, 3));
+                alpha = _mm_min_ps(_mm_max_ps(alpha, zero), maximum);
+                // Where alpha is 0 the division gives infinities, which the mask then clears
+                __m128 visible = _mm_cmpgt_ps(alpha, zero);
+                __m128 colors = _mm_mul_ps(channels, _mm_div_ps(maximum, alpha));
+                colors = _mm_and_ps(visible, _mm_min_ps(_mm_max_ps(colors, zero), maximum));
+                __m128 rounded = _mm_add_ps(_mm_or_ps(_mm_and_ps(alphaLane, alpha), _mm_andnot_ps(alphaLane, colors)), half);
+                __m128i words = _mm_cvttps_epi32(rounded);
+                words = _mm_packs_epi32(words, words);
+                pixels[i] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(words, words)));
+            }
+        }
+#else
+        (void)vectorized;
+#endif
+        for (; i < pixels.size(); ++i)
+        {
+            const float* pixel = source + i * 4;
+            float alpha = (std::min)((std::max)(pixel[3], 0.0f), 255.0f);
+            uint32_t value = static_cast<uint32_t>(alpha + 0.5f) << 24;
+            if (alpha > 0.0f)
+            {
+                float factor = 255.0f / alpha;
+                for (int c = 0; c < 3; ++c)
+                {
+                    float channel = (std::min)((std::max)(pixel[c] * factor, 0.0f), 255.0f);
+                    value |= static_cast<uint32_t>(channel + 0.5f) << (c * 8);
+                }
+            }
+            pixels[i] = value;
+        }
+    }
+}
+
+/**
+ * @brief Resamples an image to another size with a tent filter.
+ *
+ * Colors are premultiplied by alpha while filtering, so that fully transparent pixels,
+ * whose color is arbitrary, do not bleed into the edges of the result.
+ * @param source The image to resample.
+ * @param width, height The size of the result.
+ * @return The resampled image, or an empty image if either size is empty.
+ */
+BgraImage ResizeBgra(const BgraImage& source, int width, int height)
+{
+    BgraImage result;
+    if (source.IsEmpty() || width <= 0 || height <= 0)
+    {
+        return result;
+    }
+
+    // SSE2 handles the four channels of a pixel at once and gives the same result
+    const bool vectorized = GetSimdLevel() >= SimdLevel::Sse2;
+    std::vector<float> premultiplied(source.pixels.size() * 4);
+    Premultiply(source.pixels, premultiplied.data(), vectorized);
+
+    // Horizontal pass into a buffer of width x source.height, then the vertical pass
+    std::vector<float> horizontal(static_cast<size_t>(width) * source.height * 4);
+    Convolve(premultiplied.data(), horizontal.data(), ComputeKernel(source.width, width), source.height,
+        4, static_cast<size_t>(source.width) * 4, 4, static_cast<size_t>(width) * 4, vectorized);
+
+    std::vector<float> filtered(static_cast<size_t>(width) * height * 4);
+    Convolve(horizontal.data(), filtered.data(), ComputeKernel(source.height, height), width,
+        static_cast<size_t>(width) * 4, 4, static_cast<size_t>(width) * 4, 4, vectorized);
+
+    result.width = width;
+    result.height = height;
+    result.pixels.resize(static_cast<size_t>(width) * height);
+    Unpremultiply(filtered.data(), result.pixels, vectorized);
+    return result;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A 32-bit image with straight (not premultiplied) alpha, stored top-down.
+ *        Each pixel is 0xAARRGGBB, which is the BGRA byte order of a 32-bit DIB.
+ */
+struct BgraImage
+{
+    int width{ 0 };
+    int height{ 0 };
+    std::vector<uint32_t> pixels;
+
+    bool IsEmpty() const { return width <= 0 || height <= 0; }
+};
+
+BgraImage ResizeBgra(const BgraImage& source, int width, int height);
@@ -0,0 +1,452 @@
+#include "BrokerClient.h"
+#include "BrokerHost.h"
+#include "Trace.h"
+
+#include <bcrypt.h>
+#include <objbase.h>
+#include <shellapi.h>
+#include <vector>
+
+#pragma comment(lib, "bcrypt.lib")
+
+BrokerClient::~BrokerClient()
+{
+    Stop();
+}
+
+/**
+ * @brief Starts the client thread, which starts the broker.
+ * @return True on success, false if the thread could not be started.
+ */
+bool BrokerClient::Start()
+{
+    if (m_hClientThread) return true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isFailed = false;
+    }
+
+    m_hStopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    m_hQueueEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+    m_hRestartEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+    if (m_hStopEvent && m_hQueueEvent && m_hRestartEvent)
+    {
+        m_hClientThread = CreateThread(NULL, 0, ClientThreadProcedure, this, 0, NULL);
+    }
+    if (!m_hClientThread)
+    {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Closes the connection, which ends the broker, and waits for the client thread.
+ *        Requests still waiting get their reply first.
+ */
+void BrokerClient::Stop()
+{
+    if (m_hClientThread)
+    {
+        SetEvent(m_hStopEvent);
+        WaitForSingleObject(m_hClientThread, INFINITE);
+        CloseHandle(m_hClientThread);
+        m_hClientThread = NULL;
+    }
+    if (m_hStopEvent)
+    {
+        CloseHandle(m_hStopEvent);
+        m_hStopEvent = NULL;
+    }
+    if (m_hQueueEvent)
+    {
+        CloseHandle(m_hQueueEvent);
+        m_hQueueEvent = NULL;
+    }
+    if (m_hRestartEvent)
+    {
+        CloseHandle(m_hRestartEvent);
+        m_hRestartEvent = NULL;
+    }
+    FailRequests(BrokerStatus::Unavailable, 0);
+}
+
+/**
+ * @brief Ends the current broker and starts a new one with the next request. Returns at
+ *        once; requests sent to the old broker and not answered yet fail. Call from the
+ *        thread that calls Start() and Stop().
+ */
+void BrokerClient::Restart()
+{
+    if (m_hRestartEvent)
+    {
+        SetEvent(m_hRestartEvent);
+    }
+}
+
+/**
+ * @brief Returns true while the broker is being started or is connected.
+ */
+bool BrokerClient::IsRunning() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hClientThread && !m_isFailed;
+}
+
+/**
+ * @brief Queues a launch request; its id is assigned here.
+ * @param onReply Called once with the reply, on the client thread, or right away with
+ *                Unavailable if the broker is not running.
+ */
+void BrokerClient::Submit(BrokerLaunchRequest request, ReplyHandler onReply)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        request.requestId = m_nextRequestId++;
+        if (m_hClientThread && !m_isFailed)
+        {
+            m_queue.push_back({ std::move(request), std::move(onReply) });
+            SetEvent(m_hQueueEvent);
+            return;
+        }
+    }
+    BrokerReply reply;
+    reply.requestId = request.requestId;
+    reply.status = BrokerStatus::Unavailable;
+    onReply(reply);
+}
+
+DWORD WINAPI BrokerClient::ClientThreadProcedure(LPVOID param)
+{
+    Trace::SetThreadName("BrokerClient");
+    static_cast<BrokerClient*>(param)->RunClientLoop();
+    return 0;
+}
+
+void BrokerClient::RunClientLoop()
+{
+    // The shell shows the consent prompt for the broker from this thread
+    CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+    m_hWriteEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+    DWORD errorCode = 0;
+    bool isStarted = false;
+    while (m_hWriteEvent)
+    {
+        errorCode = 0;
+        isStarted = StartBroker(errorCode);
+        bool isRestarting = isStarted && Connect() && RunRequestLoop();
+        Disconnect(isRestarting);
+        if (!isRestarting)
+        {
+            break;
+        }
+
+        // The old broker will not answer any more; the new one is started for the next launch
+        FailSentRequests();
+        if (!WaitForNextRequest())
+        {
+            break;
+        }
+        ResetEvent(m_hRestartEvent);
+    }
+
+    if (m_hWriteEvent)
+    {
+        CloseHandle(m_hWriteEvent);
+        m_hWriteEvent = NULL;
+    }
+
+    // Declining the prompt cancels the waiting launches, as it does for a single launch
+    bool isDeclined = !isStarted && errorCode == ERROR_CANCELLED;
+    FailRequests(isDeclined ? BrokerStatus::Failed : BrokerStatus::Unavailable, errorCode);
+    CoUninitialize();
+}
+
+/**
+ * @brief Starts this executable elevated as the broker of this process, which shows the
+ *        consent prompt.
+ * @param errorCode Receives the error on failure; ERROR_CANCELLED if the user declined.
+ */
+bool BrokerClient::StartBroker(DWORD& errorCode)
+{
+    TRACE_SCOPE("StartLaunchBroker");
+
+    std::string token(BROKER_TOKEN_SIZE, '\0');
+    if (!BCRYPT_SUCCESS(BCryptGenRandom(NULL, reinterpret_cast<PUCHAR>(token.data()), static_cast<ULONG>(token.size()),
+        BCRYPT_USE_SYSTEM_PREFERRED_RNG)))
+    {
+        errorCode = ERROR_GEN_FAILURE;
+        return false;
+    }
+    m_token = token;
+
+    std::vector<wchar_t> executablePath(32768);
+    if (GetModuleFileNameW(NULL, executablePath.data(), static_cast<DWORD>(executablePath.size())) == 0)
+    {
+        errorCode = GetLastError();
+        return false;
+    }
+    std::wstring parameters = L"/broker " + std::to_wstring(GetCurrentProcessId()) + L" " + FormatBrokerToken(m_token);
+
+    SHELLEXECUTEINFOW sei = { sizeof(sei) };
+    sei.fMask = SEE_MASK_NOCLOSEPROCESS | SEE_MASK_NOASYNC;
+    // No owner window: the prompt would send to it while Stop() may be waiting on the UI thread
+    sei.hwnd = NULL;
+    sei.lpVerb = L"runas";
+    sei.lpFile = executablePath.data();
+    sei.lpParameters = parameters.c_str();
+    sei.nShow = SW_HIDE;
+    if (!ShellExecuteExW(&sei) || !sei.hProcess)
+    {
+        errorCode = GetLastError();
+        return false;
+    }
+    m_hBrokerProcess = sei.hProcess;
+    return true;
+}
+
+/**
+ * @brief Connects to the broker's pipe once it exists and introduces the launcher. The
+ *        pipe must belong to the broker this client started; a pipe created by anyone
+ *        else under the name is not used.
+ */
+bool BrokerClient::Connect()
+{
+    std::wstring pipeName = GetBrokerPipeName(GetCurrentProcessId());
+    ULONGLONG deadline = GetTickCount64() + CONNECT_TIMEOUT_MS;
+    while (true)
+    {
+        // Identification only: the broker has no use for acting as the launcher
+        m_hPipe = CreateFileW(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING,
+            FILE_FLAG_OVERLAPPED | SECURITY_SQOS_PRESENT | SECURITY_IDENTIFICATION, NULL);
+        if (m_hPipe != INVALID_HANDLE_VALUE)
+        {
+            break;
+        }
+        DWORD error = GetLastError();
+        if ((error != ERROR_FILE_NOT_FOUND && error != ERROR_PIPE_BUSY) || GetTickCount64() >= deadline)
+        {
+            return false;
+        }
+        HANDLE waitHandles[] = { m_hStopEvent, m_hBrokerProcess };
+        if (WaitForMultipleObjects(2, waitHandles, FALSE, 50) != WAIT_TIMEOUT)
+        {
+            return false; // Stopped, or the broker exited without creating its pipe
+        }
+    }
+
+    ULONG serverProcessId = 0;
+    if (!GetNamedPipeServerProcessId(m_hPipe, &serverProcessId) || serverProcessId != GetProcessId(m_hBrokerProcess))
+    {
+        return false;
+    }
+    BrokerHello hello;
+    hello.token = m_token;
+    return Write(EncodeBrokerHello(hello));
+}
+
+/**
+ * @brief Sends queued requests and hands out replies until stopped, restarted or the broker
+ *        is gone.
+ * @return True if Restart() was called, false otherwise.
+ */
+bool BrokerClient::RunRequestLoop()
+{
+    HANDLE hReadEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!hReadEvent)
+    {
+        return false;
+    }
+    OVERLAPPED readOverlapped = {};
+    readOverlapped.hEvent = hReadEvent;
+    std::vector<char> buffer(4096);
+    BrokerFrameReader reader;
+    bool isReading = false;
+    bool isRestarting = false;
+    while (true)
+    {
+        if (!isReading)
+        {
+            if (!ReadFile(m_hPipe, buffer.data(), static_cast<DWORD>(buffer.size()), NULL, &readOverlapped) &&
+                GetLastError() != ERROR_IO_PENDING)
+            {
+                break;
+            }
+            isReading = true;
+        }
+
+        HANDLE waitHandles[] = { m_hStopEvent, m_hQueueEvent, hReadEvent, m_hBrokerProcess, m_hRestartEvent };
+        DWORD result = WaitForMultipleObjects(5, waitHandles, FALSE, INFINITE);
+        if (result == WAIT_OBJECT_0 + 4)
+        {
+            isRestarting = true;
+            break;
+        }
+        if (result == WAIT_OBJECT_0 + 1)
+        {
+            std::deque<QueuedRequest> requests;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                requests.swap(m_queue);
+            }
+            bool isWritten = true;
+            while (isWritten && !requests.empty())
+            {
+                QueuedRequest& queued = requests.front();
+                m_sent[queued.request.requestId] = std::move(queued.onReply);
+                isWritten = Write(EncodeBrokerLaunchRequest(queued.request));
+                requests.pop_front();
+            }
+            if (!isWritten)
+            {
+                // Put back what was not sent, so it is answered as unavailable
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queue.insert(m_queue.begin(), std::make_move_iterator(requests.begin()), std::make_move_iterator(requests.end()));
+                break;
+            }
+            continue;
+        }
+        if (result != WAIT_OBJECT_0 + 2)
+        {
+            break; // Stopped, the broker exited, or the wait failed
+        }
+
+        DWORD transferred = 0;
+        isReading = false;
+        if (!GetOverlappedResult(m_hPipe, &readOverlapped, &transferred, FALSE))
+        {
+            break;
+        }
+        reader.Append(buffer.data(), transferred);
+        std::string payload;
+        BrokerReply reply;
+        bool isValid = true;
+        while (isValid && reader.Next(payload))
+        {
+            auto sent = DecodeBrokerReply(payload, reply) ? m_sent.find(reply.requestId) : m_sent.end();
+            isValid = sent != m_sent.end();
+            if (isValid)
+            {
+                ReplyHandler onReply = std::move(sent->second);
+                m_sent.erase(sent);
+                onReply(reply);
+            }
+        }
+        if (!isValid || reader.HasError())
+        {
+            break;
+        }
+    }
+
+    if (isReading)
+    {
+        DWORD transferred = 0;
+        CancelIoEx(m_hPipe, &readOverlapped);
+        GetOverlappedResult(m_hPipe, &readOverlapped, &transferred, TRUE);
+    }
+    CloseHandle(hReadEvent);
+    return isRestarting;
+}
+
+/**
+ * @brief Closes the pipe, which ends the broker.
+ * @param waitForExit Whether to wait for the broker to exit, so that the next one can
+ *                    create its pipe under the same name.
+ */
+void BrokerClient::Disconnect(bool waitForExit)
+{
+    if (m_hPipe != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_hPipe);
+        m_hPipe = INVALID_HANDLE_VALUE;
+    }
+    if (m_hBrokerProcess)
+    {
+        if (waitForExit)
+        {
+            HANDLE waitHandles[] = { m_hBrokerProcess, m_hStopEvent };
+            WaitForMultipleObjects(2, waitHandles, FALSE, CONNECT_TIMEOUT_MS);
+        }
+        CloseHandle(m_hBrokerProcess);
+        m_hBrokerProcess = NULL;
+    }
+}
+
+/**
+ * @brief Waits until a request is queued, so that the consent prompt for a new broker
+ *        comes with a launch rather than right after the old broker ended.
+ * @return True once a request is queued, false if stopped.
+ */
+bool BrokerClient::WaitForNextRequest()
+{
+    HANDLE waitHandles[] = { m_hStopEvent, m_hQueueEvent };
+    if (WaitForMultipleObjects(2, waitHandles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+    {
+        return false;
+    }
+    // Set again, for the request loop of the new broker to send what is queued
+    SetEvent(m_hQueueEvent);
+    return true;
+}
+
+bool BrokerClient::Write(const std::string& frame)
+{
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = m_hWriteEvent;
+    DWORD transferred = 0;
+    if (!WriteFile(m_hPipe, frame.data(), static_cast<DWORD>(frame.size()), NULL, &overlapped) && GetLastError() != ERROR_IO_PENDING)
+    {
+        return false;
+    }
+    HANDLE waitHandles[] = { m_hWriteEvent, m_hBrokerProcess };
+    if (WaitForMultipleObjects(2, waitHandles, FALSE, INFINITE) != WAIT_OBJECT_0)
+    {
+        CancelIoEx(m_hPipe, &overlapped);
+        GetOverlappedResult(m_hPipe, &overlapped, &transferred, TRUE);
+        return false;
+    }
+    return GetOverlappedResult(m_hPipe, &overlapped, &transferred, FALSE) && transferred == frame.size();
+}
+
+/**
+ * @brief Answers every request still waiting: those never sent with the given status,
+ *        and those sent without a reply as failed, since the broker may have started them.
+ */
+void BrokerClient::FailRequests(BrokerStatus status, DWORD errorCode)
+{
+    std::deque<QueuedRequest> requests;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isFailed = true;
+        requests.swap(m_queue);
+    }
+    for (QueuedRequest& queued : requests)
+    {
+        BrokerReply reply;
+        reply.requestId = queued.request.requestId;
+        reply.status = status;
+        reply.errorCode = errorCode;
+        queued.onReply(reply);
+    }
+    FailSentRequests();
+}
+
+/**
+ * @brief Fails the requests sent without a reply, since the broker may have started them.
+ *        Client thread only, or once it ended.
+ */
+void BrokerClient::FailSentRequests()
+{
+    for (auto& [requestId, onReply] : m_sent)
+    {
+        BrokerReply reply;
+        reply.requestId = requestId;
+        reply.status = BrokerStatus::Failed;
+        reply.errorCode = ERROR_BROKEN_PIPE;
+        onReply(reply);
+    }
+    m_sent.clear();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <windows.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include "BrokerProtocol.h"
+
+/**
+ * @brief Starts the elevated launch broker and passes launch requests to it, on a
+ *        background thread.
+ *
+ * Start() returns at once; the thread shows the consent prompt for the broker, connects to
+ * its pipe and checks that the pipe belongs to the broker it started. Requests submitted
+ * meanwhile are sent once connected. Every request gets exactly one reply, on the client
+ * thread: from the broker, or Unavailable if it never reached the broker. A request the
+ * broker received but did not answer before the connection was lost fails, since it may
+ * have been started. If the user declines the prompt, the waiting requests fail with
+ * ERROR_CANCELLED.
+ *
+ * Restart() replaces the broker without blocking the caller: the client thread ends the
+ * connection and starts a new broker, with a new prompt, once the next request arrives.
+ */
+class BrokerClient
+{
+public:
+    using ReplyHandler = std::function<void(const BrokerReply& reply)>;
+
+    static constexpr DWORD CONNECT_TIMEOUT_MS = 10 * 1000;
+
+    BrokerClient() = default;
+    ~BrokerClient();
+
+    BrokerClient(const BrokerClient&) = delete;
+    BrokerClient& operator=(const BrokerClient&) = delete;
+
+    bool Start();
+    void Stop();
+    void Restart();
+    bool IsRunning() const;
+
+    void Submit(BrokerLaunchRequest request, ReplyHandler onReply);
+
+private:
+    struct QueuedRequest
+    {
+        BrokerLaunchRequest request;
+        ReplyHandler onReply;
+    };
+
+    static DWORD WINAPI ClientThreadProcedure(LPVOID param);
+    void RunClientLoop();
+    bool StartBroker(DWORD& errorCode);
+    bool Connect();
+    bool RunRequestLoop();
+    void Disconnect(bool waitForExit);
+    bool WaitForNextRequest();
+    bool Write(const std::string& frame);
+    void FailRequests(BrokerStatus status, DWORD errorCode);
+    void FailSentRequests();
+
+    std::string m_token;
+
+    mutable std::mutex m_mutex;
+    std::deque<QueuedRequest> m_queue;      // Not sent yet
+    uint32_t m_nextRequestId{ 1 };
+    bool m_isFailed{ false };               // The broker is gone; requests fail at once
+
+    std::map<uint32_t, ReplyHandler> m_sent; // Client thread only
+
+    HANDLE m_hClientThread{ NULL };
+    HANDLE m_hStopEvent{ NULL };
+    HANDLE m_hQueueEvent{ NULL };
+    HANDLE m_hRestartEvent{ NULL };
+    HANDLE m_hBrokerProcess{ NULL };
+    HANDLE m_hPipe{ INVALID_HANDLE_VALUE };
+    HANDLE m_hWriteEvent{ NULL };
+};
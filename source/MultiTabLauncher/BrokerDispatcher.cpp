@@ -0,0 +1,94 @@
+#include "BrokerDispatcher.h"
+
+namespace
+{
+    // Takes as long wherever the first difference is
+    bool IsSameToken(const std::string& a, const std::string& b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        unsigned char difference = 0;
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            difference |= static_cast<unsigned char>(a[i] ^ b[i]);
+        }
+        return difference == 0;
+    }
+}
+
+BrokerDispatcher::BrokerDispatcher(LauncherConfig config, std::string token, BrokerLaunchFunction launch)
+    : m_config(std::move(config)), m_token(std::move(token)), m_launch(std::move(launch))
+{
+}
+
+/**
+ * @brief Handles bytes read from the connection.
+ * @param data The bytes, which may end in the middle of a frame.
+ * @param size The number of bytes.
+ * @param output Receives the replies to write back, appended.
+ * @return False if the connection must be closed.
+ */
+bool BrokerDispatcher::OnBytes(const char* data, size_t size, std::string& output)
+{
+    m_reader.Append(data, size);
+    std::string payload;
+    while (m_reader.Next(payload))
+    {
+        if (!OnFrame(payload, output))
+        {
+            return false;
+        }
+    }
+    return !m_reader.HasError();
+}
+
+bool BrokerDispatcher::OnFrame(const std::string& payload, std::string& output)
+{
+    if (!m_isAuthenticated)
+    {
+        BrokerHello hello;
+        m_isAuthenticated = DecodeBrokerHello(payload, hello) && hello.version == BROKER_PROTOCOL_VERSION &&
+            !m_token.empty() && IsSameToken(hello.token, m_token);
+        return m_isAuthenticated;
+    }
+
+    BrokerLaunchRequest request;
+    if (!DecodeBrokerLaunchRequest(payload, request))
+    {
+        return false;
+    }
+
+    BrokerReply reply;
+    const ButtonConfig* button = FindAdministratorButton(request);
+    if (button)
+    {
+        reply = m_launch(*button);
+        m_launchCount++;
+    }
+    else
+    {
+        reply.status = BrokerStatus::Rejected;
+        m_rejectedCount++;
+    }
+    reply.requestId = request.requestId;
+    output += EncodeBrokerReply(reply);
+    return true;
+}
+
+const ButtonConfig* BrokerDispatcher::FindAdministratorButton(const BrokerLaunchRequest& request) const
+{
+    if (request.tab < 0 || request.tab >= m_config.GetTabCount())
+    {
+        return nullptr;
+    }
+    const std::vector<ButtonConfig>& buttons = m_config.tabs[request.tab].buttons;
+    if (request.button < 0 || request.button >= static_cast<int>(buttons.size()))
+    {
+        return nullptr;
+    }
+    const ButtonConfig& button = buttons[request.button];
+    bool isSame = button.adminMode && !button.path.empty() && button.path == request.path && button.parameters == request.parameters;
+    return isSame ? &button : nullptr;
+}
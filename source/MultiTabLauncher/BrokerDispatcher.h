@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "BrokerProtocol.h"
+#include "ConfigModel.h"
+
+// Starts a button's program in the broker. Fills in the status, error code and process of
+// the reply; the request id is set by the dispatcher.
+using BrokerLaunchFunction = std::function<BrokerReply(const ButtonConfig& button)>;
+
+/**
+ * @brief The broker's side of a connection, independent of how bytes are carried.
+ *
+ * The first frame must be a hello with the protocol version and the session token the
+ * broker was started with; anything else closes the connection without a reply. After it,
+ * every launch request is checked against the configuration the broker read when it was
+ * started, that is, when the user consented to the elevation: only a button marked to run
+ * as administrator, with the same path and parameters, is started. A request for anything
+ * else is rejected, so editing the configuration later cannot elevate a new target without
+ * a new consent. Malformed frames close the connection.
+ */
+class BrokerDispatcher
+{
+public:
+    BrokerDispatcher(LauncherConfig config, std::string token, BrokerLaunchFunction launch);
+
+    bool OnBytes(const char* data, size_t size, std::string& output);
+
+    bool IsAuthenticated() const { return m_isAuthenticated; }
+    uint32_t GetLaunchCount() const { return m_launchCount; }
+    uint32_t GetRejectedCount() const { return m_rejectedCount; }
+
+private:
+    bool OnFrame(const std::string& payload, std::string& output);
+    const ButtonConfig* FindAdministratorButton(const BrokerLaunchRequest& request) const;
+
+    LauncherConfig m_config;
+    std::string m_token;
+    BrokerLaunchFunction m_launch;
+    BrokerFrameReader m_reader;
+    bool m_isAuthenticated{ false };
+    uint32_t m_launchCount{ 0 };
+    uint32_t m_rejectedCount{ 0 };
+};
@@ -0,0 +1,204 @@
+#include "BrokerHost.h"
+#include "Trace.h"
+
+#include <sddl.h>
+#include <vector>
+
+/**
+ * @brief Returns the name of the pipe of the broker serving a launcher.
+ */
+std::wstring GetBrokerPipeName(DWORD launcherProcessId)
+{
+    return L"\\\\.\\pipe\\MultiTabLauncher.Broker." + std::to_wstring(launcherProcessId);
+}
+
+BrokerHost::~BrokerHost()
+{
+    Close();
+}
+
+/**
+ * @brief Checks the launcher that asked for the broker and creates the pipe for it.
+ * @param launcherProcessId The process id from the broker's command line.
+ * @return False if the process is not this executable in this session, or the pipe
+ *         cannot be created.
+ */
+bool BrokerHost::Open(DWORD launcherProcessId)
+{
+    m_launcherProcessId = launcherProcessId;
+
+    // The handle also keeps the id from being reused while the broker runs
+    m_hLauncherProcess = OpenProcess(SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_DUP_HANDLE, FALSE, launcherProcessId);
+    DWORD launcherSession = 0;
+    DWORD brokerSession = 0;
+    if (!m_hLauncherProcess || !ProcessIdToSessionId(launcherProcessId, &launcherSession) ||
+        !ProcessIdToSessionId(GetCurrentProcessId(), &brokerSession) || launcherSession != brokerSession ||
+        !IsLauncherExecutable() || !CreatePipe())
+    {
+        Close();
+        return false;
+    }
+    m_hIoEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    return m_hIoEvent != NULL;
+}
+
+/**
+ * @brief Waits for the launcher to connect and handles its requests.
+ * @return True if the launcher closed the connection, false if it never connected, was
+ *         not the launcher, broke the protocol or exited.
+ */
+bool BrokerHost::Run(BrokerDispatcher& dispatcher)
+{
+    TRACE_SCOPE("RunLaunchBroker");
+
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = m_hIoEvent;
+    DWORD transferred = 0;
+    if (!ConnectNamedPipe(m_hPipe, &overlapped) && GetLastError() != ERROR_PIPE_CONNECTED &&
+        !CompleteIo(FALSE, overlapped, CONNECT_TIMEOUT_MS, transferred))
+    {
+        return false;
+    }
+
+    ULONG clientProcessId = 0;
+    if (!GetNamedPipeClientProcessId(m_hPipe, &clientProcessId) || clientProcessId != m_launcherProcessId)
+    {
+        return false;
+    }
+
+    std::vector<char> buffer(4096);
+    while (true)
+    {
+        BOOL isStarted = ReadFile(m_hPipe, buffer.data(), static_cast<DWORD>(buffer.size()), NULL, &overlapped);
+        if (!CompleteIo(isStarted, overlapped, INFINITE, transferred))
+        {
+            return GetLastError() == ERROR_BROKEN_PIPE;
+        }
+
+        std::string output;
+        bool keepOpen = dispatcher.OnBytes(buffer.data(), transferred, output);
+        for (size_t offset = 0; offset < output.size(); offset += transferred)
+        {
+            isStarted = WriteFile(m_hPipe, output.data() + offset, static_cast<DWORD>(output.size() - offset), NULL, &overlapped);
+            if (!CompleteIo(isStarted, overlapped, INFINITE, transferred))
+            {
+                return false;
+            }
+        }
+        if (!keepOpen)
+        {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Duplicates a process handle into the launcher, with the access the launcher needs
+ *        to time the launch and track the process.
+ * @return The handle's value in the launcher, or 0 on failure.
+ */
+uint64_t BrokerHost::ShareProcessHandle(HANDLE hProcess) const
+{
+    HANDLE hLauncherCopy = NULL;
+    if (!DuplicateHandle(GetCurrentProcess(), hProcess, m_hLauncherProcess, &hLauncherCopy,
+        SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, 0))
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(hLauncherCopy));
+}
+
+bool BrokerHost::IsLauncherExecutable() const
+{
+    std::vector<wchar_t> launcherPath(32768);
+    std::vector<wchar_t> brokerPath(32768);
+    DWORD launcherLength = static_cast<DWORD>(launcherPath.size());
+    DWORD brokerLength = GetModuleFileNameW(NULL, brokerPath.data(), static_cast<DWORD>(brokerPath.size()));
+    return QueryFullProcessImageNameW(m_hLauncherProcess, 0, launcherPath.data(), &launcherLength) &&
+        brokerLength > 0 && brokerLength < brokerPath.size() && lstrcmpiW(launcherPath.data(), brokerPath.data()) == 0;
+}
+
+/**
+ * @brief Creates the pipe, accessible to the launcher's user only. The broker runs with the
+ *        administrator token, whose user may differ from the launcher's, so the user is
+ *        taken from the launcher's token.
+ */
+bool BrokerHost::CreatePipe()
+{
+    HANDLE hToken = NULL;
+    if (!OpenProcessToken(m_hLauncherProcess, TOKEN_QUERY, &hToken))
+    {
+        return false;
+    }
+    std::vector<BYTE> tokenUser(256);
+    DWORD size = 0;
+    BOOL hasUser = GetTokenInformation(hToken, TokenUser, tokenUser.data(), static_cast<DWORD>(tokenUser.size()), &size);
+    if (!hasUser && GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+    {
+        tokenUser.resize(size);
+        hasUser = GetTokenInformation(hToken, TokenUser, tokenUser.data(), static_cast<DWORD>(tokenUser.size()), &size);
+    }
+    CloseHandle(hToken);
+
+    LPWSTR userSid = NULL;
+    if (!hasUser || !ConvertSidToStringSidW(reinterpret_cast<TOKEN_USER*>(tokenUser.data())->User.Sid, &userSid))
+    {
+        return false;
+    }
+    // Read and write for the user alone; the medium label lets the launcher write to it
+    std::wstring descriptor = std::wstring(L"D:P(A;;GRGW;;;") + userSid + L")S:(ML;;NW;;;ME)";
+    LocalFree(userSid);
+
+    SECURITY_ATTRIBUTES attributes = { sizeof(attributes) };
+    if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(descriptor.c_str(), SDDL_REVISION_1, &attributes.lpSecurityDescriptor, NULL))
+    {
+        return false;
+    }
+    m_hPipe = CreateNamedPipeW(GetBrokerPipeName(m_launcherProcessId).c_str(),
+        PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE | FILE_FLAG_OVERLAPPED,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+        1, static_cast<DWORD>(BROKER_MAX_FRAME_SIZE), static_cast<DWORD>(BROKER_MAX_FRAME_SIZE), 0, &attributes);
+    LocalFree(attributes.lpSecurityDescriptor);
+    return m_hPipe != INVALID_HANDLE_VALUE;
+}
+
+/**
+ * @brief Waits for an overlapped operation on the pipe, giving up when the launcher exits.
+ * @param isStarted What the call that started the operation returned.
+ * @return True if the operation succeeded; otherwise the last error tells why.
+ */
+bool BrokerHost::CompleteIo(BOOL isStarted, OVERLAPPED& overlapped, DWORD timeoutMs, DWORD& transferred)
+{
+    if (!isStarted && GetLastError() != ERROR_IO_PENDING)
+    {
+        return false;
+    }
+    HANDLE waitHandles[] = { m_hIoEvent, m_hLauncherProcess };
+    if (WaitForMultipleObjects(2, waitHandles, FALSE, timeoutMs) != WAIT_OBJECT_0)
+    {
+        CancelIoEx(m_hPipe, &overlapped);
+        GetOverlappedResult(m_hPipe, &overlapped, &transferred, TRUE);
+        SetLastError(ERROR_OPERATION_ABORTED);
+        return false;
+    }
+    return GetOverlappedResult(m_hPipe, &overlapped, &transferred, FALSE) != FALSE;
+}
+
+void BrokerHost::Close()
+{
+    if (m_hPipe != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_hPipe);
+        m_hPipe = INVALID_HANDLE_VALUE;
+    }
+    if (m_hIoEvent)
+    {
+        CloseHandle(m_hIoEvent);
+        m_hIoEvent = NULL;
+    }
+    if (m_hLauncherProcess)
+    {
+        CloseHandle(m_hLauncherProcess);
+        m_hLauncherProcess = NULL;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <windows.h>
+#include <cstdint>
+#include <string>
+#include "BrokerDispatcher.h"
+
+std::wstring GetBrokerPipeName(DWORD launcherProcessId);
+
+/**
+ * @brief The elevated end of the launch broker: serves the launcher that started it over
+ *        a named pipe, until the launcher closes the pipe or exits.
+ *
+ * The pipe is created once, fails if the name is already taken, refuses remote clients
+ * and only grants access to the launcher's user at medium integrity. The one connection it
+ * accepts must come from the launcher's process; requests on it are checked by the
+ * BrokerDispatcher. Processes the broker starts are handed to the launcher as handles that
+ * can only wait for and query them.
+ */
+class BrokerHost
+{
+public:
+    static constexpr DWORD CONNECT_TIMEOUT_MS = 30 * 1000;
+
+    BrokerHost() = default;
+    ~BrokerHost();
+
+    BrokerHost(const BrokerHost&) = delete;
+    BrokerHost& operator=(const BrokerHost&) = delete;
+
+    bool Open(DWORD launcherProcessId);
+    bool Run(BrokerDispatcher& dispatcher);
+    uint64_t ShareProcessHandle(HANDLE hProcess) const;
+
+private:
+    bool IsLauncherExecutable() const;
+    bool CreatePipe();
+    bool CompleteIo(BOOL isStarted, OVERLAPPED& overlapped, DWORD timeoutMs, DWORD& transferred);
+    void Close();
+
+    DWORD m_launcherProcessId{ 0 };
+    HANDLE m_hLauncherProcess{ NULL };
+    HANDLE m_hPipe{ INVALID_HANDLE_VALUE };
+    HANDLE m_hIoEvent{ NULL };
+};
@@ -0,0 +1,261 @@
+#include "BrokerProtocol.h"
+#include "TextKernels.h"
+
+namespace
+{
+    void AppendVarint(std::string& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    bool ReadVarint(std::string_view data, size_t& offset, uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && offset < data.size(); shift += 7)
+        {
+            uint8_t byte = static_cast<uint8_t>(data[offset++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ReadUint32(std::string_view data, size_t& offset, uint32_t& value)
+    {
+        uint64_t wide = 0;
+        if (!ReadVarint(data, offset, wide) || wide > UINT32_MAX) return false;
+        value = static_cast<uint32_t>(wide);
+        return true;
+    }
+
+    bool ReadInt32(std::string_view data, size_t& offset, int32_t& value)
+    {
+        uint32_t bits = 0;
+        if (!ReadUint32(data, offset, bits)) return false;
+        value = static_cast<int32_t>(bits);
+        return true;
+    }
+
+    void AppendBytes(std::string& out, std::string_view bytes)
+    {
+        AppendVarint(out, bytes.size());
+        out += bytes;
+    }
+
+    bool ReadBytes(std::string_view data, size_t& offset, std::string_view& bytes)
+    {
+        uint64_t length = 0;
+        if (!ReadVarint(data, offset, length) || length > data.size() - offset) return false;
+        bytes = data.substr(offset, static_cast<size_t>(length));
+        offset += static_cast<size_t>(length);
+        return true;
+    }
+
+    void AppendText(std::string& out, std::wstring_view text)
+    {
+        std::string bytes;
+        AppendUtf8(text, bytes);
+        AppendBytes(out, bytes);
+    }
+
+    bool ReadText(std::string_view data, size_t& offset, std::wstring& text)
+    {
+        std::string_view bytes;
+        if (!ReadBytes(data, offset, bytes)) return false;
+        text = DecodeUtf8(bytes);
+        return true;
+    }
+
+    // Puts the length in front of a payload
+    std::string MakeFrame(const std::string& payload)
+    {
+        std::string frame;
+        uint32_t length = static_cast<uint32_t>(payload.size());
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            frame += static_cast<char>((length >> shift) & 0xFF);
+        }
+        return frame + payload;
+    }
+}
+
+std::string EncodeBrokerHello(const BrokerHello& hello)
+{
+    std::string payload(1, static_cast<char>(BrokerMessageKind::Hello));
+    payload += static_cast<char>(hello.version);
+    AppendBytes(payload, hello.token);
+    return MakeFrame(payload);
+}
+
+std::string EncodeBrokerLaunchRequest(const BrokerLaunchRequest& request)
+{
+    std::string payload(1, static_cast<char>(BrokerMessageKind::Launch));
+    AppendVarint(payload, request.requestId);
+    AppendVarint(payload, static_cast<uint32_t>(request.tab));
+    AppendVarint(payload, static_cast<uint32_t>(request.button));
+    AppendText(payload, request.path);
+    AppendText(payload, request.parameters);
+    return MakeFrame(payload);
+}
+
+std::string EncodeBrokerReply(const BrokerReply& reply)
+{
+    std::string payload(1, static_cast<char>(BrokerMessageKind::Reply));
+    AppendVarint(payload, reply.requestId);
+    payload += static_cast<char>(reply.status);
+    AppendVarint(payload, reply.errorCode);
+    AppendVarint(payload, reply.processId);
+    AppendVarint(payload, reply.processHandle);
+    return MakeFrame(payload);
+}
+
+/**
+ * @brief Returns the kind of a frame payload; the decoders check it again.
+ */
+BrokerMessageKind GetBrokerMessageKind(std::string_view payload)
+{
+    return payload.empty() ? BrokerMessageKind{} : static_cast<BrokerMessageKind>(payload[0]);
+}
+
+/**
+ * @brief Decodes a hello. Like the other decoders, it fails on a payload of another kind,
+ *        a truncated one or one with bytes left over.
+ */
+bool DecodeBrokerHello(std::string_view payload, BrokerHello& hello)
+{
+    size_t offset = 2;
+    std::string_view token;
+    if (payload.size() < offset || GetBrokerMessageKind(payload) != BrokerMessageKind::Hello || !ReadBytes(payload, offset, token))
+    {
+        return false;
+    }
+    hello.version = static_cast<uint8_t>(payload[1]);
+    hello.token.assign(token);
+    return offset == payload.size();
+}
+
+bool DecodeBrokerLaunchRequest(std::string_view payload, BrokerLaunchRequest& request)
+{
+    size_t offset = 1;
+    return GetBrokerMessageKind(payload) == BrokerMessageKind::Launch &&
+        ReadUint32(payload, offset, request.requestId) &&
+        ReadInt32(payload, offset, request.tab) &&
+        ReadInt32(payload, offset, request.button) &&
+        ReadText(payload, offset, request.path) &&
+        ReadText(payload, offset, request.parameters) &&
+        offset == payload.size();
+}
+
+bool DecodeBrokerReply(std::string_view payload, BrokerReply& reply)
+{
+    size_t offset = 1;
+    uint64_t processHandle = 0;
+    if (GetBrokerMessageKind(payload) != BrokerMessageKind::Reply || !ReadUint32(payload, offset, reply.requestId) ||
+        offset >= payload.size())
+    {
+        return false;
+    }
+    uint8_t status = static_cast<uint8_t>(payload[offset++]);
+    if (status > static_cast<uint8_t>(BrokerStatus::Rejected) ||
+        !ReadUint32(payload, offset, reply.errorCode) ||
+        !ReadUint32(payload, offset, reply.processId) ||
+        !ReadVarint(payload, offset, processHandle))
+    {
+        return false;
+    }
+    reply.status = static_cast<BrokerStatus>(status);
+    reply.processHandle = processHandle;
+    return offset == payload.size();
+}
+
+/**
+ * @brief Formats a session token as hexadecimal, for the broker's command line.
+ */
+std::wstring FormatBrokerToken(std::string_view token)
+{
+    static const wchar_t DIGITS[] = L"0123456789abcdef";
+    std::wstring text;
+    for (char c : token)
+    {
+        text += DIGITS[static_cast<uint8_t>(c) >> 4];
+        text += DIGITS[static_cast<uint8_t>(c) & 0x0F];
+    }
+    return text;
+}
+
+/**
+ * @brief Parses a session token formatted by FormatBrokerToken().
+ * @return False unless the text holds exactly BROKER_TOKEN_SIZE bytes.
+ */
+bool ParseBrokerToken(std::wstring_view text, std::string& token)
+{
+    auto digit = [](wchar_t c) -> int
+    {
+        if (c >= L'0' && c <= L'9') return c - L'0';
+        if (c >= L'a' && c <= L'f') return c - L'a' + 10;
+        if (c >= L'A' && c <= L'F') return c - L'A' + 10;
+        return -1;
+    };
+    if (text.size() != BROKER_TOKEN_SIZE * 2)
+    {
+        return false;
+    }
+    token.clear();
+    for (size_t i = 0; i < text.size(); i += 2)
+    {
+        int high = digit(text[i]);
+        int low = digit(text[i + 1]);
+        if (high < 0 || low < 0) return false;
+        token += static_cast<char>(high * 16 + low);
+    }
+    return true;
+}
+
+void BrokerFrameReader::Append(const char* data, size_t size)
+{
+    // Consumed frames are dropped before the buffer grows
+    if (m_offset > 0)
+    {
+        m_buffer.erase(0, m_offset);
+        m_offset = 0;
+    }
+    m_buffer.append(data, size);
+}
+
+/**
+ * @brief Takes the next complete frame.
+ * @param payload Receives the frame without its length.
+ * @return False if no complete frame is buffered or the stream is in error.
+ */
+bool BrokerFrameReader::Next(std::string& payload)
+{
+    if (m_hasError || m_buffer.size() - m_offset < 4)
+    {
+        return false;
+    }
+    uint32_t length = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        length |= static_cast<uint32_t>(static_cast<uint8_t>(m_buffer[m_offset + i])) << (8 * i);
+    }
+    if (length == 0 || length > BROKER_MAX_FRAME_SIZE)
+    {
+        m_hasError = true;
+        return false;
+    }
+    if (m_buffer.size() - m_offset - 4 < length)
+    {
+        return false;
+    }
+    payload.assign(m_buffer, m_offset + 4, length);
+    m_offset += 4 + length;
+    return true;
+}
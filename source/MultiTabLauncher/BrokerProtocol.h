@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Messages between the launcher and its elevated launch broker. Each frame is a 32-bit
+// little-endian payload length followed by the payload, whose first byte is the kind.
+const uint8_t BROKER_PROTOCOL_VERSION = 1;
+const size_t BROKER_MAX_FRAME_SIZE = 64 * 1024;
+const size_t BROKER_TOKEN_SIZE = 32;
+
+enum class BrokerMessageKind : uint8_t
+{
+    Hello = 1,      // Launcher to broker, first and once: protocol version and session token
+    Launch = 2,     // Launcher to broker: start an administrator button
+    Reply = 3,      // Broker to launcher: the outcome of a launch
+};
+
+enum class BrokerStatus : uint8_t
+{
+    Launched,       // Started; the reply carries the process if one was created
+    Failed,         // Starting failed; the reply carries the error code
+    Rejected,       // Not an administrator button of the configuration the broker was started with
+    Unavailable,    // Never reached the broker; set by the client, not sent
+};
+
+struct BrokerHello
+{
+    uint8_t version{ BROKER_PROTOCOL_VERSION };
+    std::string token;          // BROKER_TOKEN_SIZE random bytes, passed to the broker at start
+};
+
+struct BrokerLaunchRequest
+{
+    uint32_t requestId{ 0 };
+    int32_t tab{ 0 };
+    int32_t button{ 0 };
+    std::wstring path;          // As configured, to detect a configuration that changed since
+    std::wstring parameters;
+};
+
+struct BrokerReply
+{
+    uint32_t requestId{ 0 };
+    BrokerStatus status{ BrokerStatus::Failed };
+    uint32_t errorCode{ 0 };
+    uint32_t processId{ 0 };
+    uint64_t processHandle{ 0 };    // Duplicated into the launcher, or 0
+};
+
+std::string EncodeBrokerHello(const BrokerHello& hello);
+std::string EncodeBrokerLaunchRequest(const BrokerLaunchRequest& request);
+std::string EncodeBrokerReply(const BrokerReply& reply);
+
+BrokerMessageKind GetBrokerMessageKind(std::string_view payload);
+bool DecodeBrokerHello(std::string_view payload, BrokerHello& hello);
+bool DecodeBrokerLaunchRequest(std::string_view payload, BrokerLaunchRequest& request);
+bool DecodeBrokerReply(std::string_view payload, BrokerReply& reply);
+
+std::wstring FormatBrokerToken(std::string_view token);
+bool ParseBrokerToken(std::wstring_view text, std::string& token);
+
+/**
+ * @brief Cuts a byte stream into frame payloads, however the reads split it.
+ *
+ * A frame longer than BROKER_MAX_FRAME_SIZE puts the reader in the error state, and the
+ * connection should be closed.
+ */
+class BrokerFrameReader
+{
+public:
+    void Append(const char* data, size_t size);
+    bool Next(std::string& payload);
+    bool HasError() const { return m_hasError; }
+
+private:
+    std::string m_buffer;
+    size_t m_offset{ 0 };
+    bool m_hasError{ false };
+};
@@ -0,0 +1,515 @@
+#include "CatalogSync.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+const char* const CatalogSync::MANIFEST_NAME = "manifest";
+
+namespace
+{
+    const char* const MANIFEST_HEADER = "MultiTabLauncherCatalogPack 1";
+    const char* const CACHED_TEXT_PREFIX = "catalog-";         // Then the catalog hash and ".utf8"
+    const char* const CACHED_TEXT_EXTENSION = ".utf8";
+    const char* const LEGACY_CACHED_TEXT_NAME = "catalog.utf8"; // Before the text was named by its hash
+    const char* const CACHED_MANIFEST_NAME = "catalog.manifest";
+
+    // A section starts a chunk when this many top bits of the hash of its name are zero,
+    // so a chunk holds about 2^CHUNK_BOUNDARY_BITS sections beyond MIN_CHUNK_SIZE
+    const int CHUNK_BOUNDARY_BITS = 4;
+
+    const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+
+    template <typename T>
+    bool ParseNumber(std::string_view text, T& value, int base = 10)
+    {
+        if (text.empty()) return false;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value, base);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    bool ParseChunkName(std::string_view name, uint64_t& hash)
+    {
+        if (name.size() != 16) return false;
+        for (char ch : name)
+        {
+            if (!((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f'))) return false;
+        }
+        return ParseNumber(name, hash, 16);
+    }
+
+    // Splits "a b c" at single spaces into exactly count fields
+    bool SplitFields(std::string_view line, std::string_view* fields, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t space = (i + 1 < count) ? line.find(' ') : std::string_view::npos;
+            if (i + 1 < count && space == std::string_view::npos) return false;
+            fields[i] = line.substr(0, space);
+            line = (space == std::string_view::npos) ? std::string_view() : line.substr(space + 1);
+        }
+        return true;
+    }
+
+    // Whether a line of INI text is a section header that begins a new chunk
+    bool IsChunkBoundary(std::string_view line)
+    {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string_view::npos || line[start] != '[') return false;
+        size_t end = line.find(']', start);
+        std::string_view header = line.substr(start, end == std::string_view::npos ? line.size() - start : end - start + 1);
+        return (HashCatalogBytes(header) >> (64 - CHUNK_BOUNDARY_BITS)) == 0;
+    }
+
+    bool ReadWholeFile(const std::filesystem::path& path, std::string& contents)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+
+        contents.clear();
+        char block[16 * 1024];
+        while (file.read(block, sizeof(block)) || file.gcount() > 0)
+        {
+            contents.append(block, static_cast<size_t>(file.gcount()));
+        }
+        return !file.bad();
+    }
+
+    std::string GetCachedTextName(uint64_t hash)
+    {
+        return CACHED_TEXT_PREFIX + FormatChunkName(hash) + CACHED_TEXT_EXTENSION;
+    }
+
+    // Writes a file next to its final name and moves it into place, so readers never see
+    // a partial file
+    bool WriteFileReplacing(const std::filesystem::path& path, std::string_view contents)
+    {
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+            file.close();
+            if (file.fail())
+            {
+                std::error_code error;
+                std::filesystem::remove(tempPath, error);
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        if (error)
+        {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Hashes bytes with 64-bit FNV-1a. Not cryptographic; it only tells chunks apart.
+ */
+uint64_t HashCatalogBytes(std::string_view bytes)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (char ch : bytes)
+    {
+        hash = (hash ^ static_cast<unsigned char>(ch)) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Returns the file name of a chunk: its hash as 16 lower-case hex digits.
+ */
+std::string FormatChunkName(uint64_t hash)
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+    return name;
+}
+
+/**
+ * @brief Cuts INI text into chunks that begin at section headers.
+ *
+ * A chunk ends before a section whose name satisfies IsChunkBoundary() once it holds
+ * at least MIN_CHUNK_SIZE bytes, or at the next line once it holds MAX_CHUNK_SIZE.
+ * Because the cut points depend on the nearby section names and not on offsets, text
+ * inserted or removed in one section leaves the other chunks unchanged.
+ * @return Views of the chunks, covering the text in order.
+ */
+std::vector<std::string_view> SplitCatalogChunks(std::string_view text)
+{
+    std::vector<std::string_view> chunks;
+    size_t chunkStart = 0;
+    size_t lineStart = 0;
+    while (lineStart < text.size())
+    {
+        size_t lineEnd = text.find('\n', lineStart);
+        lineEnd = (lineEnd == std::string_view::npos) ? text.size() : lineEnd + 1;
+
+        size_t chunkSize = lineStart - chunkStart;
+        if (chunkSize >= CatalogSync::MAX_CHUNK_SIZE ||
+            (chunkSize >= CatalogSync::MIN_CHUNK_SIZE && IsChunkBoundary(text.substr(lineStart, lineEnd - lineStart))))
+        {
+            chunks.push_back(text.substr(chunkStart, chunkSize));
+            chunkStart = lineStart;
+        }
+        lineStart = lineEnd;
+    }
+    if (chunkStart < text.size())
+    {
+        chunks.push_back(text.substr(chunkStart));
+    }
+    return chunks;
+}
+
+std::string CatalogManifest::Serialize() const
+{
+    std::string text = MANIFEST_HEADER;
+    text += "\ncatalog " + FormatChunkName(hash) + ' ' + std::to_string(size) + '\n';
+    if (!(sourceStamp == CatalogStamp()))
+    {
+        text += "stamp " + std::to_string(sourceStamp.size) + ' ' + std::to_string(sourceStamp.lastWriteTime) + '\n';
+    }
+    for (const Chunk& chunk : chunks)
+    {
+        text += FormatChunkName(chunk.hash) + ' ' + std::to_string(chunk.size) + '\n';
+    }
+    return text;
+}
+
+/**
+ * @brief Replaces the manifest with one read from text written by Serialize().
+ * @return True if the text is a complete manifest whose chunks add up to the catalog size.
+ */
+bool CatalogManifest::Parse(std::string_view text)
+{
+    *this = CatalogManifest();
+
+    bool hasCatalog = false;
+    bool hasHeader = false;
+    uint64_t totalSize = 0;
+    while (!text.empty())
+    {
+        size_t lineEnd = text.find('\n');
+        if (lineEnd == std::string_view::npos) return false;  // Truncated
+        std::string_view line = text.substr(0, lineEnd);
+        text.remove_prefix(lineEnd + 1);
+
+        std::string_view fields[3];
+        if (!hasHeader)
+        {
+            if (line != MANIFEST_HEADER) return false;
+            hasHeader = true;
+        }
+        else if (!hasCatalog)
+        {
+            if (!SplitFields(line, fields, 3) || fields[0] != "catalog" ||
+                !ParseChunkName(fields[1], hash) || !ParseNumber(fields[2], size))
+            {
+                return false;
+            }
+            hasCatalog = true;
+        }
+        else if (line.rfind("stamp ", 0) == 0)
+        {
+            if (!SplitFields(line, fields, 3) || !ParseNumber(fields[1], sourceStamp.size) ||
+                !ParseNumber(fields[2], sourceStamp.lastWriteTime))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            Chunk chunk;
+            if (!SplitFields(line, fields, 2) || !ParseChunkName(fields[0], chunk.hash) ||
+                !ParseNumber(fields[1], chunk.size) || chunk.size == 0)
+            {
+                return false;
+            }
+            chunks.push_back(chunk);
+            totalSize += chunk.size;
+        }
+    }
+    return hasCatalog && totalSize == size;
+}
+
+CatalogStoreStatus DirectoryCatalogStore::GetStamp(const std::string& name, CatalogStamp& stamp)
+{
+    std::filesystem::path path = m_directory / name;
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(path, error);
+    if (error) return GetMissingStatus();
+    std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(path, error);
+    if (error) return GetMissingStatus();
+
+    stamp.size = size;
+    stamp.lastWriteTime = static_cast<int64_t>(lastWriteTime.time_since_epoch().count());
+    return CatalogStoreStatus::Ok;
+}
+
+CatalogStoreStatus DirectoryCatalogStore::Read(const std::string& name, std::string& contents)
+{
+    std::filesystem::path path = m_directory / name;
+    if (ReadWholeFile(path, contents))
+    {
+        return CatalogStoreStatus::Ok;
+    }
+    std::error_code error;
+    return std::filesystem::exists(path, error) ? CatalogStoreStatus::Unreachable : GetMissingStatus();
+}
+
+/**
+ * @brief Tells a file that does not exist from a directory that cannot be reached.
+ */
+CatalogStoreStatus DirectoryCatalogStore::GetMissingStatus() const
+{
+    std::error_code error;
+    return std::filesystem::is_directory(m_directory, error) ? CatalogStoreStatus::Missing : CatalogStoreStatus::Unreachable;
+}
+
+/**
+ * @param remote The published pack. It must outlive the sync.
+ * @param cacheDirectory The local directory for the cached catalog; created when needed.
+ */
+CatalogSync::CatalogSync(CatalogStore& remote, std::filesystem::path cacheDirectory)
+    : m_remote(remote), m_cacheDirectory(std::move(cacheDirectory))
+{
+}
+
+/**
+ * @brief Brings the cached catalog up to date with the published one.
+ * @param text Receives the new catalog as UTF-8 text if the result is Updated.
+ * @return The outcome; anything but Updated leaves the cache as it was.
+ */
+CatalogSyncResult CatalogSync::Sync(std::string& text)
+{
+    m_statistics = CatalogSyncStatistics();
+    bool hasCache = LoadCachedManifest();
+
+    // The stamp alone answers the common case without reading anything from the remote
+    CatalogStamp stamp;
+    CatalogStoreStatus status = m_remote.GetStamp(MANIFEST_NAME, stamp);
+    if (status != CatalogStoreStatus::Ok)
+    {
+        return status == CatalogStoreStatus::Missing ? CatalogSyncResult::Unavailable : CatalogSyncResult::Unreachable;
+    }
+    if (hasCache && stamp == m_cachedManifest.sourceStamp)
+    {
+        return CatalogSyncResult::Unchanged;
+    }
+
+    std::string manifestText;
+    status = m_remote.Read(MANIFEST_NAME, manifestText);
+    if (status != CatalogStoreStatus::Ok)
+    {
+        return status == CatalogStoreStatus::Missing ? CatalogSyncResult::Unavailable : CatalogSyncResult::Unreachable;
+    }
+    CatalogManifest manifest;
+    if (!manifest.Parse(manifestText))
+    {
+        return CatalogSyncResult::Failed;
+    }
+    manifest.sourceStamp = stamp;
+
+    // Published again with the same contents, or touched
+    if (hasCache && manifest.hash == m_cachedManifest.hash && manifest.size == m_cachedManifest.size)
+    {
+        m_cachedManifest.sourceStamp = stamp;
+        WriteFileReplacing(m_cacheDirectory / CACHED_MANIFEST_NAME, m_cachedManifest.Serialize());
+        return CatalogSyncResult::Unchanged;
+    }
+
+    // Chunks of the cached catalog, by hash
+    std::string cachedText;
+    std::unordered_map<uint64_t, std::string_view> cachedChunks;
+    if (hasCache && ReadCache(cachedText))
+    {
+        size_t offset = 0;
+        for (const CatalogManifest::Chunk& chunk : m_cachedManifest.chunks)
+        {
+            cachedChunks.emplace(chunk.hash, std::string_view(cachedText).substr(offset, static_cast<size_t>(chunk.size)));
+            offset += static_cast<size_t>(chunk.size);
+        }
+    }
+
+    text.clear();
+    text.reserve(static_cast<size_t>(manifest.size));
+    std::unordered_map<uint64_t, std::string> fetchedChunks;    // For chunks that occur more than once
+    std::string chunkData;
+    for (const CatalogManifest::Chunk& chunk : manifest.chunks)
+    {
+        auto cached = cachedChunks.find(chunk.hash);
+        if (cached != cachedChunks.end() && cached->second.size() == chunk.size)
+        {
+            text += cached->second;
+            m_statistics.chunksReused++;
+            continue;
+        }
+        auto fetched = fetchedChunks.find(chunk.hash);
+        if (fetched != fetchedChunks.end())
+        {
+            text += fetched->second;
+            continue;
+        }
+
+        status = m_remote.Read(FormatChunkName(chunk.hash), chunkData);
+        if (status == CatalogStoreStatus::Unreachable)
+        {
+            return CatalogSyncResult::Unreachable;
+        }
+        // A missing chunk means a publish is under way; the next sync sees its manifest
+        if (status != CatalogStoreStatus::Ok || chunkData.size() != chunk.size || HashCatalogBytes(chunkData) != chunk.hash)
+        {
+            return CatalogSyncResult::Failed;
+        }
+        text += chunkData;
+        m_statistics.chunksFetched++;
+        m_statistics.bytesFetched += chunkData.size();
+        fetchedChunks.emplace(chunk.hash, chunkData);
+    }
+
+    if (text.size() != manifest.size || HashCatalogBytes(text) != manifest.hash || !WriteCache(text, manifest))
+    {
+        return CatalogSyncResult::Failed;
+    }
+    m_cachedManifest = manifest;
+    return CatalogSyncResult::Updated;
+}
+
+/**
+ * @brief Reads the cached catalog without contacting the remote.
+ * @param text Receives the catalog as UTF-8 text.
+ * @return True if a complete catalog is cached, false if there is none or it is damaged.
+ */
+bool CatalogSync::ReadCache(std::string& text)
+{
+    if (!LoadCachedManifest())
+    {
+        return false;
+    }
+    bool isRead = ReadWholeFile(m_cacheDirectory / GetCachedTextName(m_cachedManifest.hash), text) ||
+        ReadWholeFile(m_cacheDirectory / LEGACY_CACHED_TEXT_NAME, text);
+    return isRead && text.size() == m_cachedManifest.size && HashCatalogBytes(text) == m_cachedManifest.hash;
+}
+
+/**
+ * @brief Reads the manifest of the cached catalog once.
+ * @return True if there is a cached catalog.
+ */
+bool CatalogSync::LoadCachedManifest()
+{
+    if (!m_isManifestLoaded)
+    {
+        std::string manifestText;
+        if (!ReadWholeFile(m_cacheDirectory / CACHED_MANIFEST_NAME, manifestText) || !m_cachedManifest.Parse(manifestText))
+        {
+            m_cachedManifest = CatalogManifest();
+        }
+        m_isManifestLoaded = true;
+    }
+    return m_cachedManifest.hash != 0;
+}
+
+/**
+ * @brief Replaces the cached catalog. The text is stored under a name derived from its
+ *        hash, and the manifest that names it is replaced last: until then the previous
+ *        manifest still finds its own text, so a write that fails half way leaves the
+ *        previous catalog readable.
+ */
+bool CatalogSync::WriteCache(const std::string& text, const CatalogManifest& manifest)
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_cacheDirectory, error);
+    std::string textName = GetCachedTextName(manifest.hash);
+    if (!WriteFileReplacing(m_cacheDirectory / textName, text) ||
+        !WriteFileReplacing(m_cacheDirectory / CACHED_MANIFEST_NAME, manifest.Serialize()))
+    {
+        return false;
+    }
+
+    // Texts of earlier catalogs, which no manifest names any more
+    for (std::filesystem::directory_iterator entry(m_cacheDirectory, error), end; !error && entry != end; entry.increment(error))
+    {
+        std::string name = entry->path().filename().string();
+        bool isCachedText = name.rfind(CACHED_TEXT_PREFIX, 0) == 0 &&
+            name.compare(name.size() - std::strlen(CACHED_TEXT_EXTENSION), std::string::npos, CACHED_TEXT_EXTENSION) == 0;
+        if ((isCachedText && name != textName) || name == LEGACY_CACHED_TEXT_NAME)
+        {
+            std::error_code removeError;
+            std::filesystem::remove(entry->path(), removeError);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Publishes a catalog as a pack of chunks and a manifest that CatalogSync reads.
+ *
+ * Chunks that are already there are not written again, and the manifest is replaced
+ * last, so a sync never sees a manifest whose chunks are not there yet. Chunks used by
+ * neither the new nor the previous manifest are removed; a sync that read the previous
+ * manifest just before can still complete.
+ * @param text The catalog as UTF-8 INI text.
+ * @param packDirectory The directory to publish to; created if needed.
+ * @return True on success, false on failure.
+ */
+bool CatalogSync::PublishPack(std::string_view text, const std::filesystem::path& packDirectory)
+{
+    std::error_code error;
+    std::filesystem::create_directories(packDirectory, error);
+    if (error) return false;
+
+    CatalogManifest previous;
+    std::string previousText;
+    if (ReadWholeFile(packDirectory / MANIFEST_NAME, previousText))
+    {
+        previous.Parse(previousText);
+    }
+
+    CatalogManifest manifest;
+    manifest.hash = HashCatalogBytes(text);
+    manifest.size = text.size();
+    for (std::string_view chunkText : SplitCatalogChunks(text))
+    {
+        CatalogManifest::Chunk chunk{ HashCatalogBytes(chunkText), chunkText.size() };
+        manifest.chunks.push_back(chunk);
+
+        std::filesystem::path chunkPath = packDirectory / FormatChunkName(chunk.hash);
+        if (!std::filesystem::exists(chunkPath, error) && !WriteFileReplacing(chunkPath, chunkText))
+        {
+            return false;
+        }
+    }
+    if (!WriteFileReplacing(packDirectory / MANIFEST_NAME, manifest.Serialize()))
+    {
+        return false;
+    }
+
+    std::unordered_set<uint64_t> usedChunks;
+    for (const CatalogManifest* used : { &manifest, &previous })
+    {
+        for (const CatalogManifest::Chunk& chunk : used->chunks)
+        {
+            usedChunks.insert(chunk.hash);
+        }
+    }
+    for (std::filesystem::directory_iterator entry(packDirectory, error), end; !error && entry != end; entry.increment(error))
+    {
+        uint64_t hash = 0;
+        if (ParseChunkName(entry->path().filename().string(), hash) && usedChunks.count(hash) == 0)
+        {
+            std::error_code removeError;
+            std::filesystem::remove(entry->path(), removeError);
+        }
+    }
+    return true;
+}
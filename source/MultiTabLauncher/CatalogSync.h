@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The size and last write time of a file, compared to skip reading files that did not change.
+struct CatalogStamp
+{
+    uint64_t size{ 0 };
+    int64_t lastWriteTime{ 0 };   // In the units of std::filesystem::file_time_type
+
+    bool operator==(const CatalogStamp&) const = default;
+};
+
+/**
+ * @brief The list of chunks a catalog is cut into, published next to them as "manifest".
+ *
+ * Chunks are stored under the hex form of their hash, so a chunk that did not change
+ * between two publishes has the same name and is not transferred again. The manifest
+ * is plain text:
+ *
+ *     MultiTabLauncherCatalogPack 1
+ *     catalog <hash> <size>
+ *     <hash> <size>            (one line per chunk, in catalog order)
+ *
+ * A cached copy also records the stamp of the manifest it was fetched from.
+ */
+struct CatalogManifest
+{
+    struct Chunk
+    {
+        uint64_t hash{ 0 };
+        uint64_t size{ 0 };
+    };
+
+    uint64_t hash{ 0 };             // Of the whole catalog
+    uint64_t size{ 0 };
+    std::vector<Chunk> chunks;
+    CatalogStamp sourceStamp;       // Cached copies only
+
+    std::string Serialize() const;
+    bool Parse(std::string_view text);
+};
+
+uint64_t HashCatalogBytes(std::string_view bytes);
+std::string FormatChunkName(uint64_t hash);
+std::vector<std::string_view> SplitCatalogChunks(std::string_view text);
+
+enum class CatalogStoreStatus
+{
+    Ok,
+    Missing,        // The location is reachable but the file does not exist
+    Unreachable     // The location itself cannot be reached
+};
+
+/**
+ * @brief Read access to the location a catalog pack is published to.
+ *
+ * The sync only reads through this interface, so a share can be replaced by anything
+ * that serves the same files, e.g. a directory with simulated latency and outages.
+ */
+class CatalogStore
+{
+public:
+    virtual ~CatalogStore() = default;
+
+    virtual CatalogStoreStatus GetStamp(const std::string& name, CatalogStamp& stamp) = 0;
+    virtual CatalogStoreStatus Read(const std::string& name, std::string& contents) = 0;
+};
+
+/**
+ * @brief A catalog pack in a directory, local or on a share.
+ */
+class DirectoryCatalogStore : public CatalogStore
+{
+public:
+    explicit DirectoryCatalogStore(std::filesystem::path directory) : m_directory(std::move(directory)) {}
+
+    CatalogStoreStatus GetStamp(const std::string& name, CatalogStamp& stamp) override;
+    CatalogStoreStatus Read(const std::string& name, std::string& contents) override;
+
+private:
+    CatalogStoreStatus GetMissingStatus() const;
+
+    std::filesystem::path m_directory;
+};
+
+enum class CatalogSyncResult
+{
+    Unchanged,
+    Updated,
+    Unavailable,    // Nothing is published at the location
+    Unreachable,    // The location did not respond; the cache is kept
+    Failed          // The pack is damaged or the cache cannot be written
+};
+
+struct CatalogSyncStatistics
+{
+    size_t chunksFetched{ 0 };
+    size_t chunksReused{ 0 };
+    uint64_t bytesFetched{ 0 };
+};
+
+/**
+ * @brief Keeps a local copy of a catalog that is published to a slow or unreliable location.
+ *
+ * The publisher cuts the catalog into chunks at section boundaries (see PublishPack());
+ * where to cut depends only on the section names nearby, so editing one tab changes one
+ * chunk and leaves the others as they were. Sync() first compares the stamp of the
+ * remote manifest with the cached one, then the catalog hash, and only then fetches the
+ * chunks the cache does not have. The cached catalog is replaced only once the complete
+ * new one has been assembled and verified, so an outage in the middle of a sync leaves
+ * the previous catalog in place.
+ *
+ * The cache directory holds the catalog as UTF-8 text, named by its hash, and the
+ * manifest that names it, which is replaced last. Sync() is blocking and meant for a
+ * background thread; the cache can be read without the remote.
+ */
+class CatalogSync
+{
+public:
+    static const char* const MANIFEST_NAME;
+    static const size_t MIN_CHUNK_SIZE = 16 * 1024;
+    static const size_t MAX_CHUNK_SIZE = 256 * 1024;
+
+    CatalogSync(CatalogStore& remote, std::filesystem::path cacheDirectory);
+
+    CatalogSync(const CatalogSync&) = delete;
+    CatalogSync& operator=(const CatalogSync&) = delete;
+
+    CatalogSyncResult Sync(std::string& text);
+    bool ReadCache(std::string& text);
+    const CatalogSyncStatistics& GetLastStatistics() const { return m_statistics; }
+
+    static bool PublishPack(std::string_view text, const std::filesystem::path& packDirectory);
+
+private:
+    bool LoadCachedManifest();
+    bool WriteCache(const std::string& text, const CatalogManifest& manifest);
+
+    CatalogStore& m_remote;
+    std::filesystem::path m_cacheDirectory;
+    CatalogManifest m_cachedManifest;
+    bool m_isManifestLoaded{ false };
+    CatalogSyncStatistics m_statistics;
+};
@@ -0,0 +1,157 @@
+#include "CatalogUpdater.h"
+#include "BackgroundModeScope.h"
+#include "IniDocument.h"
+#include "SharedCatalog.h"
+#include "TextKernels.h"
+#include "Trace.h"
+
+#include <algorithm>
+
+CatalogUpdater::~CatalogUpdater()
+{
+    Stop();
+}
+
+/**
+ * @brief Starts syncing.
+ * @param executor The executor the syncs run on.
+ * @param packDirectory The published catalog pack, usually on a share.
+ * @param cacheDirectory The local directory the catalog is cached in.
+ * @param snapshotPath The local snapshot that is published whenever the catalog changed.
+ * @param intervalMs Time between two syncs.
+ * @param hNotifyWindow Window notified when the snapshot was updated.
+ * @param notifyMessage Message posted after an update.
+ * @return True on success, false if the executor is not running or the timer could not be created.
+ */
+bool CatalogUpdater::Start(TaskExecutor& executor, const std::wstring& packDirectory, const std::wstring& cacheDirectory, const std::wstring& snapshotPath,
+    DWORD intervalMs, HWND hNotifyWindow, UINT notifyMessage)
+{
+    if (m_tasks.IsRunning()) return true;
+    if (!executor.IsRunning()) return false;
+
+    m_packDirectory = packDirectory;
+    m_cacheDirectory = cacheDirectory;
+    m_snapshotPath = snapshotPath;
+    m_intervalMs = (std::max)(intervalMs, MIN_RETRY_DELAY_MS);
+    m_retryDelayMs = MIN_RETRY_DELAY_MS;
+    m_hNotifyWindow = hNotifyWindow;
+    m_notifyMessage = notifyMessage;
+    m_remote = std::make_unique<DirectoryCatalogStore>(m_packDirectory);
+    m_sync = std::make_unique<CatalogSync>(*m_remote, m_cacheDirectory);
+    m_stopping = false;
+
+    m_syncTimer = CreateThreadpoolTimer(OnSyncDue, this, NULL);
+    if (!m_syncTimer) return false;
+
+    m_tasks.Start(executor);
+    if (!m_tasks.Submit(TaskPriority::Background, [this]() { SyncCatalog(); }))
+    {
+        m_tasks.Stop();
+        CloseThreadpoolTimer(m_syncTimer);
+        m_syncTimer = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stops syncing. A sync in progress finishes its current read first, which may
+ *        take as long as the share takes to time out.
+ */
+void CatalogUpdater::Stop()
+{
+    if (!m_tasks.IsRunning()) return;
+
+    // Once stopping is set, the sync task does not set the timer again
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    SetThreadpoolTimer(m_syncTimer, NULL, 0, 0);
+    WaitForThreadpoolTimerCallbacks(m_syncTimer, TRUE);
+    CloseThreadpoolTimer(m_syncTimer);
+    m_syncTimer = NULL;
+
+    m_tasks.Stop();
+    m_sync.reset();
+    m_remote.reset();
+}
+
+/**
+ * @brief Publishes the snapshot again from the cached catalog, without the share.
+ *
+ * Used when the snapshot is missing or was written by another build, which rejects it.
+ * @return True if a cached catalog was found and published.
+ */
+bool CatalogUpdater::RestoreSnapshot(const std::wstring& cacheDirectory, const std::wstring& snapshotPath)
+{
+    TRACE_SCOPE("RestoreCatalogSnapshot");
+
+    DirectoryCatalogStore unused{ std::filesystem::path() };
+    CatalogSync sync(unused, cacheDirectory);
+    std::string text;
+    return sync.ReadCache(text) && PublishSnapshot(text, snapshotPath);
+}
+
+VOID CALLBACK CatalogUpdater::OnSyncDue(PTP_CALLBACK_INSTANCE, PVOID context, PTP_TIMER)
+{
+    CatalogUpdater* updater = static_cast<CatalogUpdater*>(context);
+    updater->m_tasks.Submit(TaskPriority::Background, [updater]() { updater->SyncCatalog(); });
+}
+
+/**
+ * @brief Syncs the catalog once and sets the timer of the next sync. Runs on the executor.
+ */
+void CatalogUpdater::SyncCatalog()
+{
+    // Lower both CPU and I/O priority; a sync never competes with the user
+    BackgroundModeScope backgroundMode;
+    std::string text;
+    CatalogSyncResult result;
+    {
+        TRACE_SCOPE("SyncCatalog");
+        result = m_sync->Sync(text);
+        TRACE_COUNTER("CatalogBytesFetched", m_sync->GetLastStatistics().bytesFetched);
+    }
+
+    if (result == CatalogSyncResult::Updated && PublishSnapshot(text, m_snapshotPath))
+    {
+        PostMessage(m_hNotifyWindow, m_notifyMessage, 0, 0);
+    }
+
+    // An outage or a publish in progress is retried sooner, backing off while it lasts
+    DWORD delayMs = m_intervalMs;
+    if (result == CatalogSyncResult::Unreachable || result == CatalogSyncResult::Failed)
+    {
+        delayMs = m_retryDelayMs;
+        m_retryDelayMs = (std::min)(m_retryDelayMs * 2, m_intervalMs);
+    }
+    else
+    {
+        m_retryDelayMs = MIN_RETRY_DELAY_MS;
+    }
+    ScheduleSync(delayMs);
+}
+
+void CatalogUpdater::ScheduleSync(DWORD delayMs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping) return;
+
+    ULARGE_INTEGER delay;
+    delay.QuadPart = static_cast<ULONGLONG>(-static_cast<LONGLONG>(delayMs) * 10000); // Relative, in 100 ns
+    FILETIME dueTime;
+    dueTime.dwLowDateTime = delay.LowPart;
+    dueTime.dwHighDateTime = delay.HighPart;
+    SetThreadpoolTimer(m_syncTimer, &dueTime, 0, 0);
+}
+
+/**
+ * @brief Publishes catalog text as the local snapshot the launcher maps.
+ */
+bool CatalogUpdater::PublishSnapshot(const std::string& text, const std::wstring& snapshotPath)
+{
+    IniDocument document;
+    document.Parse(DecodeUtf8(text));
+    return SharedCatalog::Publish(document, snapshotPath);
+}
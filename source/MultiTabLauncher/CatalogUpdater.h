@@ -0,0 +1,58 @@
+#pragma once
+
+#include <windows.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "CatalogSync.h"
+#include "TaskExecutor.h"
+
+/**
+ * @brief Keeps a local copy of a shared catalog published to a network location, in
+ *        Background tasks.
+ *
+ * The launcher maps the snapshot in the cache directory, so startup never waits for the
+ * share. A task syncs the catalog pack (see CatalogSync) right after Start(), and a
+ * thread-pool timer queues the next one an interval after it finished; while the share
+ * cannot be reached it retries sooner, backing off up to the interval. When the catalog
+ * changed, the cached snapshot is published again and the notification message is posted.
+ */
+class CatalogUpdater
+{
+public:
+    static constexpr DWORD MIN_RETRY_DELAY_MS = 30 * 1000;
+
+    CatalogUpdater() = default;
+    ~CatalogUpdater();
+
+    CatalogUpdater(const CatalogUpdater&) = delete;
+    CatalogUpdater& operator=(const CatalogUpdater&) = delete;
+
+    bool Start(TaskExecutor& executor, const std::wstring& packDirectory, const std::wstring& cacheDirectory, const std::wstring& snapshotPath,
+        DWORD intervalMs, HWND hNotifyWindow, UINT notifyMessage);
+    void Stop();
+
+    static bool RestoreSnapshot(const std::wstring& cacheDirectory, const std::wstring& snapshotPath);
+
+private:
+    static VOID CALLBACK OnSyncDue(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer);
+    void SyncCatalog();
+    void ScheduleSync(DWORD delayMs);
+    static bool PublishSnapshot(const std::string& text, const std::wstring& snapshotPath);
+
+    std::wstring m_packDirectory;
+    std::wstring m_cacheDirectory;
+    std::wstring m_snapshotPath;
+    DWORD m_intervalMs{ 0 };
+    DWORD m_retryDelayMs{ MIN_RETRY_DELAY_MS };         // Sync task only
+    std::unique_ptr<DirectoryCatalogStore> m_remote;    // Sync task only
+    std::unique_ptr<CatalogSync> m_sync;                // Sync task only
+
+    std::mutex m_mutex;
+    bool m_stopping{ false };
+
+    PTP_TIMER m_syncTimer{ NULL };
+    TaskGroup m_tasks;
+    HWND m_hNotifyWindow{ NULL };
+    UINT m_notifyMessage{ 0 };
+};
@@ -0,0 +1,120 @@
+#include "CompletionQueue.h"
+
+CompletionQueue::CompletionQueue()
+    : m_head(&m_stub), m_tail(&m_stub)
+{
+}
+
+/**
+ * @brief Drops the completions that were not run. Nothing may push any more.
+ */
+CompletionQueue::~CompletionQueue()
+{
+    while (Node* node = Pop())
+    {
+        delete node;
+    }
+}
+
+/**
+ * @brief Sets the function that wakes the consumer. Call before anything is pushed.
+ */
+void CompletionQueue::SetWakeHandler(std::function<void()> wake)
+{
+    m_wake = std::move(wake);
+}
+
+/**
+ * @brief Queues a completion to run on the consumer thread. Safe to call from any thread,
+ *        including from a completion.
+ */
+void CompletionQueue::Push(Completion completion)
+{
+    Node* node = new Node;
+    node->run = std::move(completion);
+
+    // Counted first, so that the consumer never sees fewer pending than linked
+    bool wasEmpty = m_pending.fetch_add(1, std::memory_order_acq_rel) == 0;
+    Link(node);
+    if (wasEmpty && m_wake)
+    {
+        m_wake();
+    }
+}
+
+/**
+ * @brief Runs queued completions, oldest first, until none is left or the budget is spent.
+ *        At least one completion runs if any is queued. Call from the consumer thread only.
+ * @param budget The time after which no further completion is started.
+ */
+CompletionDrainResult CompletionQueue::Drain(Clock::duration budget)
+{
+    CompletionDrainResult result;
+    if (IsEmpty())
+    {
+        return result;
+    }
+
+    const Clock::time_point deadline = Clock::now() + budget;
+    while (Node* node = Pop())
+    {
+        node->run();
+        delete node;
+        m_pending.fetch_sub(1, std::memory_order_acq_rel);
+        result.completed++;
+        if (Clock::now() >= deadline)
+        {
+            break;
+        }
+    }
+
+    // Also true while a producer is between counting and linking its node
+    result.hasMore = !IsEmpty();
+    return result;
+}
+
+void CompletionQueue::Link(Node* node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+/**
+ * @brief Unlinks the oldest node.
+ * @return The node, or nullptr if the queue is empty or its oldest node is still being linked.
+ */
+CompletionQueue::Node* CompletionQueue::Pop()
+{
+    Node* tail = m_tail;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &m_stub)
+    {
+        if (!next)
+        {
+            return nullptr;
+        }
+        m_tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next)
+    {
+        m_tail = next;
+        return tail;
+    }
+
+    // The tail is the last node; it can only be taken once the stub is linked behind it
+    if (tail != m_head.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    Link(&m_stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next)
+    {
+        m_tail = next;
+        return tail;
+    }
+    return nullptr;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Outcome of one CompletionQueue::Drain() call.
+struct CompletionDrainResult
+{
+    size_t completed{ 0 };      // Completions run
+    bool hasMore{ false };      // Completions were left for the next call
+};
+
+/**
+ * @brief Hands the results of background work to the UI thread.
+ *
+ * Any thread can push a completion; only the UI thread drains them, in the order they were
+ * pushed. Pushing never takes a lock: completions are linked into a single-consumer list
+ * with one atomic exchange, so workers finishing hundreds of icons at once never wait for
+ * each other or for the UI thread.
+ *
+ * The wake handler runs on the pushing thread when the queue goes from empty to not empty,
+ * so the UI thread is woken once per batch rather than once per completion. Drain() runs
+ * completions until the queue is empty or its time budget is spent, so that the message
+ * loop gets back to input in bounded time however many results arrive.
+ */
+class CompletionQueue
+{
+public:
+    using Completion = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    CompletionQueue();
+    ~CompletionQueue();
+
+    CompletionQueue(const CompletionQueue&) = delete;
+    CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+    void SetWakeHandler(std::function<void()> wake);
+    void Push(Completion completion);
+    CompletionDrainResult Drain(Clock::duration budget);
+
+    bool IsEmpty() const { return m_pending.load(std::memory_order_acquire) == 0; }
+    size_t GetPendingCount() const { return static_cast<size_t>(m_pending.load(std::memory_order_acquire)); }
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> next{ nullptr };
+        Completion run;
+    };
+
+    void Link(Node* node);
+    Node* Pop();
+
+    std::atomic<Node*> m_head;      // Newest node; producers exchange it
+    Node* m_tail;                   // Oldest node; consumer only
+    Node m_stub;                    // Keeps the list non-empty, so producers never touch m_tail
+    std::atomic<int64_t> m_pending{ 0 };
+    std::function<void()> m_wake;
+};
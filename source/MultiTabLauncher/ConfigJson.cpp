@@ -0,0 +1,686 @@
+#include "ConfigJson.h"
+#include "JsonStream.h"
+#include "TextKernels.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    const int64_t JSON_FORMAT_VERSION = 1;
+
+    // The objects and arrays of the document that have a meaning
+    enum class Scope
+    {
+        Root,
+        Prefetch,
+        Resident,
+        Resources,
+        Elevation,
+        Diagnostics,
+        ProgramIndex,
+        Tabs,       // Array of tab objects
+        Tab,
+        Buttons,    // Array of button objects and nulls
+        Button,
+        Profile,
+    };
+
+    // What the value of a member is read into
+    struct Slot
+    {
+        enum class Type { Unknown, Version, Integer, Boolean, Text, Priority, Affinity, Object, Array };
+
+        Type type{ Type::Unknown };
+        int* integer{ nullptr };
+        bool* boolean{ nullptr };
+        std::wstring* text{ nullptr };
+        LaunchPriority* priority{ nullptr };
+        uint64_t* affinity{ nullptr };
+        Scope scope{ Scope::Root };     // Entered by Object and Array members
+    };
+
+    Slot IntegerSlot(int& target) { Slot slot; slot.type = Slot::Type::Integer; slot.integer = &target; return slot; }
+    Slot BooleanSlot(bool& target) { Slot slot; slot.type = Slot::Type::Boolean; slot.boolean = &target; return slot; }
+    Slot TextSlot(std::wstring& target) { Slot slot; slot.type = Slot::Type::Text; slot.text = &target; return slot; }
+    Slot ScopeSlot(Slot::Type type, Scope scope) { Slot slot; slot.type = type; slot.scope = scope; return slot; }
+
+    /**
+     * @brief Fills a LauncherConfig from the events of a JsonReader.
+     */
+    class ConfigJsonLoader : public JsonHandler
+    {
+    public:
+        explicit ConfigJsonLoader(LauncherConfig& config) : m_config(config) {}
+
+        bool OnStartObject() override;
+        bool OnKey(std::string_view key) override;
+        bool OnEndObject() override { return OnEndContainer(); }
+        bool OnStartArray() override;
+        bool OnEndArray() override { return OnEndContainer(); }
+        bool OnString(std::string_view value) override;
+        bool OnNumber(std::string_view text) override;
+        bool OnBool(bool value) override;
+        bool OnNull() override;
+
+        void Finish();
+        const std::string& GetError() const { return m_error; }
+
+    private:
+        bool OnEndContainer();
+        bool EnterMember(Slot::Type type);
+        bool BeginScalar(bool isNull, bool& consumed);
+        bool Fail(std::string message);
+        bool TypeError();
+        Slot FindSlot(std::string_view key);
+
+        LauncherConfig& m_config;
+        std::vector<Scope> m_scopes;
+        Slot m_slot;                // Member whose value comes next
+        std::string m_key;          // Its name, for error messages
+        int m_skipDepth{ 0 };       // Nesting within an unknown member
+        std::wstring m_text;        // Decoded priorities and processor lists
+        std::string m_error;
+    };
+
+    bool ConfigJsonLoader::OnStartObject()
+    {
+        if (m_skipDepth > 0)
+        {
+            ++m_skipDepth;
+            return true;
+        }
+        if (m_scopes.empty())
+        {
+            m_scopes.push_back(Scope::Root);
+            return true;
+        }
+        if (m_scopes.back() == Scope::Tabs)
+        {
+            if (m_config.GetTabCount() == MAX_TAB_COUNT)
+            {
+                return Fail("More than " + std::to_string(MAX_TAB_COUNT) + " tabs");
+            }
+            // The grid is resolved in Finish(), when the default grid is known
+            TabConfig& tab = m_config.tabs.emplace_back();
+            tab.buttonRows = 0;
+            tab.buttonCols = 0;
+            m_scopes.push_back(Scope::Tab);
+            return true;
+        }
+        if (m_scopes.back() == Scope::Buttons)
+        {
+            std::vector<ButtonConfig>& buttons = m_config.tabs.back().buttons;
+            if (buttons.size() == static_cast<size_t>(MAX_GRID_DIMENSION * MAX_GRID_DIMENSION))
+            {
+                return Fail("More buttons than the largest grid holds");
+            }
+            buttons.emplace_back();
+            m_scopes.push_back(Scope::Button);
+            return true;
+        }
+        return EnterMember(Slot::Type::Object);
+    }
+
+    bool ConfigJsonLoader::OnStartArray()
+    {
+        if (m_skipDepth > 0)
+        {
+            ++m_skipDepth;
+            return true;
+        }
+        if (m_scopes.empty())
+        {
+            return Fail("The document must be an object");
+        }
+        if (m_scopes.back() == Scope::Tabs)
+        {
+            return Fail("Expected an object for each tab");
+        }
+        if (m_scopes.back() == Scope::Buttons)
+        {
+            return Fail("Expected an object or null for each button");
+        }
+        return EnterMember(Slot::Type::Array);
+    }
+
+    bool ConfigJsonLoader::OnEndContainer()
+    {
+        if (m_skipDepth > 0)
+        {
+            --m_skipDepth;
+        }
+        else
+        {
+            m_scopes.pop_back();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Enters the object or array value of the current member, or skips it if the
+     *        member is unknown.
+     */
+    bool ConfigJsonLoader::EnterMember(Slot::Type type)
+    {
+        Slot slot = m_slot;
+        m_slot = Slot();
+        if (slot.type == Slot::Type::Unknown)
+        {
+            m_skipDepth = 1;
+            return true;
+        }
+        if (slot.type != type)
+        {
+            m_slot = slot;
+            return TypeError();
+        }
+        m_scopes.push_back(slot.scope);
+        return true;
+    }
+
+    bool ConfigJsonLoader::OnKey(std::string_view key)
+    {
+        if (m_skipDepth == 0)
+        {
+            m_key = key;
+            m_slot = FindSlot(key);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Handles what is common to all values that are not containers.
+     * @param isNull True for null, which is allowed for every member and for buttons.
+     * @param consumed Set to true if the value needs no further handling.
+     */
+    bool ConfigJsonLoader::BeginScalar(bool isNull, bool& consumed)
+    {
+        consumed = true;
+        if (m_skipDepth > 0)
+        {
+            return true;
+        }
+        if (m_scopes.empty())
+        {
+            return Fail("The document must be an object");
+        }
+        if (m_scopes.back() == Scope::Tabs)
+        {
+            return Fail("Expected an object for each tab");
+        }
+        if (m_scopes.back() == Scope::Buttons)
+        {
+            if (!isNull)
+            {
+                return Fail("Expected an object or null for each button");
+            }
+            std::vector<ButtonConfig>& buttons = m_config.tabs.back().buttons;
+            if (buttons.size() == static_cast<size_t>(MAX_GRID_DIMENSION * MAX_GRID_DIMENSION))
+            {
+                return Fail("More buttons than the largest grid holds");
+            }
+            buttons.emplace_back();
+            return true;
+        }
+        consumed = isNull || m_slot.type == Slot::Type::Unknown;
+        if (consumed)
+        {
+            m_slot = Slot();
+        }
+        return true;
+    }
+
+    bool ConfigJsonLoader::OnString(std::string_view value)
+    {
+        bool consumed;
+        if (!BeginScalar(false, consumed) || consumed)
+        {
+            return m_error.empty();
+        }
+
+        // Invalid priorities and processor lists fall back to the defaults, as in the INI file
+        switch (m_slot.type)
+        {
+        case Slot::Type::Text:
+            DecodeUtf8(value, *m_slot.text);
+            break;
+        case Slot::Type::Priority:
+            DecodeUtf8(value, m_text);
+            ParseLaunchPriority(m_text, *m_slot.priority);
+            break;
+        case Slot::Type::Affinity:
+            DecodeUtf8(value, m_text);
+            ParseAffinityMask(m_text, *m_slot.affinity);
+            break;
+        default:
+            return TypeError();
+        }
+        m_slot = Slot();
+        return true;
+    }
+
+    bool ConfigJsonLoader::OnNumber(std::string_view text)
+    {
+        bool consumed;
+        if (!BeginScalar(false, consumed) || consumed)
+        {
+            return m_error.empty();
+        }
+
+        int64_t value;
+        bool isInteger = JsonReader::ParseInteger(text, value);
+        switch (m_slot.type)
+        {
+        case Slot::Type::Version:
+            if (!isInteger || value != JSON_FORMAT_VERSION)
+            {
+                return Fail("Unsupported version " + std::string(text));
+            }
+            break;
+        case Slot::Type::Integer:
+            if (text.find_first_of(".eE") != std::string_view::npos)
+            {
+                return TypeError();
+            }
+            // Huge values saturate; Finish() replaces values out of range by defaults
+            if (!isInteger) value = text[0] == '-' ? (std::numeric_limits<int64_t>::min)() : (std::numeric_limits<int64_t>::max)();
+            *m_slot.integer = static_cast<int>((std::clamp)(value,
+                static_cast<int64_t>((std::numeric_limits<int>::min)()), static_cast<int64_t>((std::numeric_limits<int>::max)())));
+            break;
+        case Slot::Type::Boolean:
+            // 0 and 1 as in the INI file
+            if (!isInteger)
+            {
+                return TypeError();
+            }
+            *m_slot.boolean = value != 0;
+            break;
+        default:
+            return TypeError();
+        }
+        m_slot = Slot();
+        return true;
+    }
+
+    bool ConfigJsonLoader::OnBool(bool value)
+    {
+        bool consumed;
+        if (!BeginScalar(false, consumed) || consumed)
+        {
+            return m_error.empty();
+        }
+        if (m_slot.type != Slot::Type::Boolean)
+        {
+            return TypeError();
+        }
+        *m_slot.boolean = value;
+        m_slot = Slot();
+        return true;
+    }
+
+    bool ConfigJsonLoader::OnNull()
+    {
+        bool consumed;
+        BeginScalar(true, consumed);
+        return m_error.empty();
+    }
+
+    bool ConfigJsonLoader::Fail(std::string message)
+    {
+        m_error = std::move(message);
+        return false;
+    }
+
+    /**
+     * @brief Reports a value that does not have the type of the current member.
+     */
+    bool ConfigJsonLoader::TypeError()
+    {
+        const char* expected = "a string";
+        switch (m_slot.type)
+        {
+        case Slot::Type::Version:
+        case Slot::Type::Integer: expected = "an integer"; break;
+        case Slot::Type::Boolean: expected = "true or false"; break;
+        case Slot::Type::Object: expected = "an object"; break;
+        case Slot::Type::Array: expected = "an array"; break;
+        default: break;
+        }
+        return Fail(std::string("Expected ") + expected + " for \"" + m_key + "\"");
+    }
+
+    /**
+     * @brief Looks up a member of the current object.
+     */
+    Slot ConfigJsonLoader::FindSlot(std::string_view key)
+    {
+        switch (m_scopes.back())
+        {
+        case Scope::Root:
+            if (key == "version") return ScopeSlot(Slot::Type::Version, Scope::Root);
+            if (key == "buttonRows") return IntegerSlot(m_config.buttonRows);
+            if (key == "buttonCols") return IntegerSlot(m_config.buttonCols);
+            if (key == "prefetch") return ScopeSlot(Slot::Type::Object, Scope::Prefetch);
+            if (key == "resident") return ScopeSlot(Slot::Type::Object, Scope::Resident);
+            if (key == "resources") return ScopeSlot(Slot::Type::Object, Scope::Resources);
+            if (key == "elevation") return ScopeSlot(Slot::Type::Object, Scope::Elevation);
+            if (key == "diagnostics") return ScopeSlot(Slot::Type::Object, Scope::Diagnostics);
+            if (key == "programIndex") return ScopeSlot(Slot::Type::Object, Scope::ProgramIndex);
+            if (key == "tabs") return ScopeSlot(Slot::Type::Array, Scope::Tabs);
+            break;
+        case Scope::Prefetch:
+            if (key == "enabled") return BooleanSlot(m_config.prefetch.enabled);
+            if (key == "budgetMB") return IntegerSlot(m_config.prefetch.budgetMegabytes);
+            if (key == "topButtons") return IntegerSlot(m_config.prefetch.topButtonCount);
+            if (key == "idleSeconds") return IntegerSlot(m_config.prefetch.idleSeconds);
+            break;
+        case Scope::Resident:
+            if (key == "enabled") return BooleanSlot(m_config.resident.enabled);
+            if (key == "hotkey") return TextSlot(m_config.resident.hotkey);
+            break;
+        case Scope::Resources:
+            if (key == "maxIcons") return IntegerSlot(m_config.resources.maxIcons);
+            if (key == "maxWindows") return IntegerSlot(m_config.resources.maxWindows);
+            if (key == "idleTrimMinutes") return IntegerSlot(m_config.resources.idleTrimMinutes);
+            break;
+        case Scope::Elevation:
+            if (key == "broker") return BooleanSlot(m_config.elevation.broker);
+            break;
+        case Scope::Diagnostics:
+            if (key == "trace") return BooleanSlot(m_config.diagnostics.trace);
+            break;
+        case Scope::ProgramIndex:
+            if (key == "enabled") return BooleanSlot(m_config.programIndex.enabled);
+            if (key == "directories") return TextSlot(m_config.programIndex.directories);
+            break;
+        case Scope::Tab:
+        {
+            TabConfig& tab = m_config.tabs.back();
+            if (key == "name") return TextSlot(tab.name);
+            if (key == "rows") return IntegerSlot(tab.buttonRows);
+            if (key == "cols") return IntegerSlot(tab.buttonCols);
+            if (key == "buttons") return ScopeSlot(Slot::Type::Array, Scope::Buttons);
+            break;
+        }
+        case Scope::Button:
+        {
+            ButtonConfig& button = m_config.tabs.back().buttons.back();
+            if (key == "name") return TextSlot(button.name);
+            if (key == "path") return TextSlot(button.path);
+            if (key == "parameters") return TextSlot(button.parameters);
+            if (key == "admin") return BooleanSlot(button.adminMode);
+            if (key == "singleInstance") return BooleanSlot(button.singleInstance);
+            if (key == "prefetch") return TextSlot(button.prefetchFiles);
+            if (key == "profile") return ScopeSlot(Slot::Type::Object, Scope::Profile);
+            break;
+        }
+        case Scope::Profile:
+        {
+            LaunchProfile& profile = m_config.tabs.back().buttons.back().profile;
+            if (key == "workingDirectory") return TextSlot(profile.workingDirectory);
+            if (key == "environment") return TextSlot(profile.environment);
+            if (key == "lowIo") return BooleanSlot(profile.lowIoPriority);
+            if (key == "priority")
+            {
+                Slot slot;
+                slot.type = Slot::Type::Priority;
+                slot.priority = &profile.priority;
+                return slot;
+            }
+            if (key == "affinity")
+            {
+                Slot slot;
+                slot.type = Slot::Type::Affinity;
+                slot.affinity = &profile.affinityMask;
+                return slot;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        return Slot();
+    }
+
+    /**
+     * @brief Replaces missing and invalid values with the defaults ParseLauncherConfig() uses
+     *        and fits the buttons of each tab to its grid.
+     */
+    void ConfigJsonLoader::Finish()
+    {
+        auto gridDimension = [](int value, int defaultValue)
+            {
+                return (value <= 0 || value > MAX_GRID_DIMENSION) ? defaultValue : value;
+            };
+
+        LauncherConfig& config = m_config;
+        config.buttonRows = gridDimension(config.buttonRows, 3);
+        config.buttonCols = gridDimension(config.buttonCols, 8);
+        if (config.prefetch.idleSeconds <= 0) config.prefetch.idleSeconds = 30;
+        config.resources.maxIcons = (std::max)(config.resources.maxIcons, 0);
+        config.resources.maxWindows = (std::max)(config.resources.maxWindows, 0);
+        config.resources.idleTrimMinutes = (std::max)(config.resources.idleTrimMinutes, 0);
+
+        if (config.tabs.empty())
+        {
+            config.tabs.resize(10);
+            for (TabConfig& tab : config.tabs)
+            {
+                tab.buttonRows = 0;
+                tab.buttonCols = 0;
+            }
+        }
+        for (int tabIndex = 0; tabIndex < config.GetTabCount(); ++tabIndex)
+        {
+            TabConfig& tab = config.tabs[tabIndex];
+            if (tab.name.empty() || tab.name.length() > 30)
+            {
+                tab.name = L"Tab" + std::to_wstring(tabIndex + 1);
+            }
+            tab.buttonRows = gridDimension(tab.buttonRows, config.buttonRows);
+            tab.buttonCols = gridDimension(tab.buttonCols, config.buttonCols);
+            tab.buttons.resize(tab.GetButtonCount());
+        }
+    }
+
+    bool ReadLauncherConfig(JsonReader& reader, LauncherConfig& config, std::string& error)
+    {
+        config = LauncherConfig();
+
+        ConfigJsonLoader loader(config);
+        if (!reader.Parse(loader))
+        {
+            error = (loader.GetError().empty() ? reader.GetError() : loader.GetError()) +
+                " at byte " + std::to_string(reader.GetErrorOffset());
+            return false;
+        }
+        loader.Finish();
+        return true;
+    }
+}
+
+/**
+ * @brief Reads a configuration from a JSON stream.
+ * @param stream The document, opened in binary mode.
+ * @param config Receives the configuration.
+ * @param error Receives the reason and byte offset on failure.
+ * @return True on success, false on failure.
+ */
+bool ReadLauncherConfigJson(std::istream& stream, LauncherConfig& config, std::string& error)
+{
+    JsonReader reader(stream);
+    return ReadLauncherConfig(reader, config, error);
+}
+
+/**
+ * @brief Reads a configuration from a JSON document in memory.
+ */
+bool ReadLauncherConfigJson(std::string_view text, LauncherConfig& config, std::string& error)
+{
+    JsonReader reader(text);
+    return ReadLauncherConfig(reader, config, error);
+}
+
+/**
+ * @brief Writes a configuration as JSON. Settings at their defaults are left out of
+ *        buttons, and each button is written on one line.
+ * @return True on success, false if the stream failed.
+ */
+bool WriteLauncherConfigJson(const LauncherConfig& config, std::ostream& stream)
+{
+    JsonWriter json(stream);
+    json.BeginObject();
+    json.Key("version");
+    json.Integer(JSON_FORMAT_VERSION);
+    json.Key("buttonRows");
+    json.Integer(config.buttonRows);
+    json.Key("buttonCols");
+    json.Integer(config.buttonCols);
+
+    json.Key("prefetch");
+    json.BeginObject(true);
+    json.Key("enabled");
+    json.Bool(config.prefetch.enabled);
+    json.Key("budgetMB");
+    json.Integer(config.prefetch.budgetMegabytes);
+    json.Key("topButtons");
+    json.Integer(config.prefetch.topButtonCount);
+    json.Key("idleSeconds");
+    json.Integer(config.prefetch.idleSeconds);
+    json.EndObject();
+
+    json.Key("resident");
+    json.BeginObject(true);
+    json.Key("enabled");
+    json.Bool(config.resident.enabled);
+    json.Key("hotkey");
+    json.String(config.resident.hotkey);
+    json.EndObject();
+
+    json.Key("resources");
+    json.BeginObject(true);
+    json.Key("maxIcons");
+    json.Integer(config.resources.maxIcons);
+    json.Key("maxWindows");
+    json.Integer(config.resources.maxWindows);
+    json.Key("idleTrimMinutes");
+    json.Integer(config.resources.idleTrimMinutes);
+    json.EndObject();
+
+    json.Key("elevation");
+    json.BeginObject(true);
+    json.Key("broker");
+    json.Bool(config.elevation.broker);
+    json.EndObject();
+
+    json.Key("diagnostics");
+    json.BeginObject(true);
+    json.Key("trace");
+    json.Bool(config.diagnostics.trace);
+    json.EndObject();
+
+    json.Key("programIndex");
+    json.BeginObject(true);
+    json.Key("enabled");
+    json.Bool(config.programIndex.enabled);
+    json.Key("directories");
+    json.String(config.programIndex.directories);
+    json.EndObject();
+
+    const ButtonConfig emptyButton;
+    json.Key("tabs");
+    json.BeginArray();
+    for (const TabConfig& tab : config.tabs)
+    {
+        json.BeginObject();
+        json.Key("name");
+        json.String(tab.name);
+        if (tab.buttonRows != config.buttonRows || tab.buttonCols != config.buttonCols)
+        {
+            json.Key("rows");
+            json.Integer(tab.buttonRows);
+            json.Key("cols");
+            json.Integer(tab.buttonCols);
+        }
+
+        // Empty buttons at the end of the grid are left out
+        size_t buttonCount = tab.buttons.size();
+        while (buttonCount > 0 && tab.buttons[buttonCount - 1] == emptyButton) --buttonCount;
+        json.Key("buttons");
+        json.BeginArray();
+        for (size_t btn = 0; btn < buttonCount; ++btn)
+        {
+            const ButtonConfig& button = tab.buttons[btn];
+            if (button == emptyButton)
+            {
+                json.Null();
+                continue;
+            }
+            json.BeginObject(true);
+            json.Key("name");
+            json.String(button.name);
+            json.Key("path");
+            json.String(button.path);
+            if (!button.parameters.empty())
+            {
+                json.Key("parameters");
+                json.String(button.parameters);
+            }
+            if (button.adminMode)
+            {
+                json.Key("admin");
+                json.Bool(true);
+            }
+            if (button.singleInstance)
+            {
+                json.Key("singleInstance");
+                json.Bool(true);
+            }
+            if (!button.prefetchFiles.empty())
+            {
+                json.Key("prefetch");
+                json.String(button.prefetchFiles);
+            }
+
+            const LaunchProfile& profile = button.profile;
+            if (!profile.IsDefault())
+            {
+                json.Key("profile");
+                json.BeginObject();
+                if (!profile.workingDirectory.empty())
+                {
+                    json.Key("workingDirectory");
+                    json.String(profile.workingDirectory);
+                }
+                if (!profile.environment.empty())
+                {
+                    json.Key("environment");
+                    json.String(profile.environment);
+                }
+                if (profile.priority != LaunchPriority::Normal)
+                {
+                    json.Key("priority");
+                    json.String(std::wstring_view(GetLaunchPriorityName(profile.priority)));
+                }
+                if (profile.affinityMask != 0)
+                {
+                    json.Key("affinity");
+                    json.String(FormatAffinityMask(profile.affinityMask));
+                }
+                if (profile.lowIoPriority)
+                {
+                    json.Key("lowIo");
+                    json.Bool(true);
+                }
+                json.EndObject();
+            }
+            json.EndObject();
+        }
+        json.EndArray();
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+    return json.Flush();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "ConfigModel.h"
+
+/**
+ * @brief The launcher configuration as JSON, for catalogs generated by scripts.
+ *
+ * The document holds the same settings as the INI file, with one object per tab and
+ * per button instead of numbered keys:
+ *
+ *     { "version": 1, "buttonRows": 3, "buttonCols": 8,
+ *       "prefetch": { ... }, "resident": { ... }, "resources": { ... },
+ *       "elevation": { "broker": false }, "diagnostics": { "trace": false },
+ *       "programIndex": { "enabled": true, "directories": "..." },
+ *       "tabs": [ { "name": "Tools", "rows": 2, "cols": 4,
+ *                   "buttons": [ { "name": "Notepad", "path": "notepad.exe" }, null, ... ] } ] }
+ *
+ * Buttons fill the grid row by row; null leaves a button empty. Members that are left
+ * out keep their defaults, and unknown members are skipped. Values out of range are
+ * replaced by defaults as in ParseLauncherConfig(); values of the wrong type are errors.
+ * Reading goes straight from the stream into the LauncherConfig without a document tree.
+ */
+bool ReadLauncherConfigJson(std::istream& stream, LauncherConfig& config, std::string& error);
+bool ReadLauncherConfigJson(std::string_view text, LauncherConfig& config, std::string& error);
+bool WriteLauncherConfigJson(const LauncherConfig& config, std::ostream& stream);
@@ -0,0 +1,277 @@
+#include "ConfigModel.h"
+#include "IniDocument.h"
+#include "TextKernels.h"
+
+#include <algorithm>
+
+namespace
+{
+    int ReadGridDimension(const LayeredIni& ini, const LayeredIni::Section& section, const wchar_t* key, int defaultValue)
+    {
+        int value = ini.GetInt(section, key, defaultValue);
+        return (value <= 0 || value > MAX_GRID_DIMENSION) ? defaultValue : value;
+    }
+
+    /**
+     * @brief Formats a value so that IniDocument reads it back unchanged: line breaks become
+     *        spaces, and values it would trim or unquote are enclosed in quotes.
+     */
+    std::wstring FormatIniValue(std::wstring_view value)
+    {
+        std::wstring text(value);
+        std::replace_if(text.begin(), text.end(), [](wchar_t ch) { return ch == L'\r' || ch == L'\n'; }, L' ');
+        bool isQuoted = text.length() >= 2 && (text.front() == L'"' || text.front() == L'\'') && text.back() == text.front();
+        if (!text.empty() && (IsBlank(text.front()) || IsBlank(text.back()) || isQuoted))
+        {
+            text = L'"' + text + L'"';
+        }
+        return text;
+    }
+}
+
+/**
+ * @brief Builds the configuration from a parsed INI file layered over a base catalog.
+ *
+ * Every key is looked up in the overlay first and then in the base, so a user can
+ * override single keys of the shared catalog. The grid of a tab comes from Rows=/Cols=
+ * in its own section and falls back to ButtonRows/ButtonCols in [Tabs]. Invalid values
+ * are replaced by defaults.
+ * @param base The shared catalog; an empty document if there is none.
+ * @param overlay The parsed INI file of the user.
+ * @return The configuration.
+ */
+LauncherConfig ParseLauncherConfig(const IniDocument& base, const IniDocument& overlay)
+{
+    LauncherConfig config;
+    LayeredIni ini(base, overlay);
+
+    // Read general settings
+    int tabCount = ini.GetInt(L"Tabs", L"Count", 10);
+    if (tabCount <= 0 || tabCount > MAX_TAB_COUNT) tabCount = 10;
+
+    const LayeredIni::Section tabsSection = ini.FindSection(L"Tabs");
+    config.buttonRows = ReadGridDimension(ini, tabsSection, L"ButtonRows", 3);
+    config.buttonCols = ReadGridDimension(ini, tabsSection, L"ButtonCols", 8);
+
+    // Read idle prefetch settings
+    config.prefetch.enabled = ini.GetInt(L"Prefetch", L"Enabled", 1) != 0;
+    config.prefetch.budgetMegabytes = ini.GetInt(L"Prefetch", L"BudgetMB", 64);
+    config.prefetch.topButtonCount = ini.GetInt(L"Prefetch", L"TopButtons", 5);
+    config.prefetch.idleSeconds = ini.GetInt(L"Prefetch", L"IdleSeconds", 30);
+    if (config.prefetch.idleSeconds <= 0) config.prefetch.idleSeconds = 30;
+
+    // Read tray-resident mode settings
+    config.resident.enabled = ini.GetInt(L"Resident", L"Enabled", 0) != 0;
+    config.resident.hotkey = ini.GetString(L"Resident", L"Hotkey", L"Ctrl+Alt+Space");
+
+    // Read resource budget settings
+    config.resources.maxIcons = (std::max)(ini.GetInt(L"Resources", L"MaxIcons", 3000), 0);
+    config.resources.maxWindows = (std::max)(ini.GetInt(L"Resources", L"MaxWindows", 5000), 0);
+    config.resources.idleTrimMinutes = (std::max)(ini.GetInt(L"Resources", L"IdleTrimMinutes", 10), 0);
+
+    // Read elevation and diagnostics settings
+    config.elevation.broker = ini.GetInt(L"Elevation", L"Broker", 0) != 0;
+    config.diagnostics.trace = ini.GetInt(L"Diagnostics", L"Trace", 0) != 0;
+
+    // Read program index settings
+    config.programIndex.enabled = ini.GetInt(L"ProgramIndex", L"Enabled", 1) != 0;
+    config.programIndex.directories = ini.GetString(L"ProgramIndex", L"Directories", config.programIndex.directories);
+
+    config.tabs.resize(tabCount);
+    for (int tabIndex = 0; tabIndex < tabCount; tabIndex++)
+    {
+        TabConfig& tab = config.tabs[tabIndex];
+        std::wstring sectionName = L"Tab" + std::to_wstring(tabIndex);
+        const LayeredIni::Section section = ini.FindSection(sectionName);
+
+        std::wstring defaultName = L"Tab" + std::to_wstring(tabIndex + 1);
+        tab.name = ini.GetString(tabsSection, sectionName, defaultName);
+        if (tab.name.empty() || tab.name.length() > 30)
+        {
+            tab.name = defaultName;
+        }
+
+        tab.buttonRows = ReadGridDimension(ini, section, L"Rows", config.buttonRows);
+        tab.buttonCols = ReadGridDimension(ini, section, L"Cols", config.buttonCols);
+        tab.buttons.resize(tab.GetButtonCount());
+
+        // Tabs without a section keep empty buttons
+        if (!section.Exists()) continue;
+
+        // One key buffer for all lookups of the tab instead of a string per key
+        std::wstring key;
+        for (int btn = 0; btn < tab.GetButtonCount(); btn++)
+        {
+            std::wstring keyBase = L"Button" + std::to_wstring(btn);
+            auto keyFor = [&](const wchar_t* suffix) -> const std::wstring&
+                {
+                    return key.assign(keyBase).append(suffix);
+                };
+            ButtonConfig& info = tab.buttons[btn];
+
+            info.name = ini.GetString(section, keyFor(L"_Name"), L"");
+            info.path = ini.GetString(section, keyFor(L"_Path"), L"");
+            info.parameters = ini.GetString(section, keyFor(L"_Params"), L"");
+            info.adminMode = ini.GetInt(section, keyFor(L"_Admin"), 0) != 0;
+            info.singleInstance = ini.GetInt(section, keyFor(L"_SingleInstance"), 0) != 0;
+            info.prefetchFiles = ini.GetString(section, keyFor(L"_Prefetch"), L"");
+
+            // Invalid priorities and processor lists fall back to the defaults
+            LaunchProfile& profile = info.profile;
+            profile.workingDirectory = ini.GetString(section, keyFor(L"_WorkDir"), L"");
+            profile.environment = ini.GetString(section, keyFor(L"_Env"), L"");
+            ParseLaunchPriority(ini.GetString(section, keyFor(L"_Priority"), L""), profile.priority);
+            ParseAffinityMask(ini.GetString(section, keyFor(L"_Affinity"), L""), profile.affinityMask);
+            profile.lowIoPriority = ini.GetInt(section, keyFor(L"_LowIo"), 0) != 0;
+        }
+    }
+    return config;
+}
+
+/**
+ * @brief Writes a configuration in the INI format ParseLauncherConfig() reads.
+ *
+ * Tabs get Rows=/Cols= only where their grid differs from the default grid. Only buttons
+ * with settings are written, and of those only the keys that differ from the defaults,
+ * except for the name, path, parameters and administrator flag.
+ * @param config The configuration.
+ * @return The text of the INI file.
+ */
+std::wstring FormatLauncherConfig(const LauncherConfig& config)
+{
+    std::wstring text;
+    auto appendLine = [&](std::wstring_view key, std::wstring_view value)
+        {
+            text.append(key).append(L"=").append(FormatIniValue(value)).append(L"\r\n");
+        };
+    auto appendNumber = [&](std::wstring_view key, int64_t value)
+        {
+            text.append(key).append(L"=").append(std::to_wstring(value)).append(L"\r\n");
+        };
+
+    text += L"[Tabs]\r\n";
+    appendNumber(L"Count", config.GetTabCount());
+    appendNumber(L"ButtonRows", config.buttonRows);
+    appendNumber(L"ButtonCols", config.buttonCols);
+    for (int tab = 0; tab < config.GetTabCount(); ++tab)
+    {
+        appendLine(L"Tab" + std::to_wstring(tab), config.tabs[tab].name);
+    }
+
+    text += L"\r\n[Prefetch]\r\n";
+    appendNumber(L"Enabled", config.prefetch.enabled ? 1 : 0);
+    appendNumber(L"BudgetMB", config.prefetch.budgetMegabytes);
+    appendNumber(L"TopButtons", config.prefetch.topButtonCount);
+    appendNumber(L"IdleSeconds", config.prefetch.idleSeconds);
+
+    text += L"\r\n[Resident]\r\n";
+    appendNumber(L"Enabled", config.resident.enabled ? 1 : 0);
+    appendLine(L"Hotkey", config.resident.hotkey);
+
+    text += L"\r\n[Resources]\r\n";
+    appendNumber(L"MaxIcons", config.resources.maxIcons);
+    appendNumber(L"MaxWindows", config.resources.maxWindows);
+    appendNumber(L"IdleTrimMinutes", config.resources.idleTrimMinutes);
+
+    text += L"\r\n[Elevation]\r\n";
+    appendNumber(L"Broker", config.elevation.broker ? 1 : 0);
+
+    text += L"\r\n[Diagnostics]\r\n";
+    appendNumber(L"Trace", config.diagnostics.trace ? 1 : 0);
+
+    text += L"\r\n[ProgramIndex]\r\n";
+    appendNumber(L"Enabled", config.programIndex.enabled ? 1 : 0);
+    appendLine(L"Directories", config.programIndex.directories);
+
+    const ButtonConfig emptyButton;
+    std::wstring key;
+    for (int tabIndex = 0; tabIndex < config.GetTabCount(); ++tabIndex)
+    {
+        const TabConfig& tab = config.tabs[tabIndex];
+        text += L"\r\n[Tab" + std::to_wstring(tabIndex) + L"]\r\n";
+        if (tab.buttonRows != config.buttonRows || tab.buttonCols != config.buttonCols)
+        {
+            appendNumber(L"Rows", tab.buttonRows);
+            appendNumber(L"Cols", tab.buttonCols);
+        }
+
+        for (int btn = 0; btn < static_cast<int>(tab.buttons.size()); ++btn)
+        {
+            const ButtonConfig& info = tab.buttons[btn];
+            if (info == emptyButton) continue;
+
+            std::wstring keyBase = L"Button" + std::to_wstring(btn);
+            auto keyFor = [&](const wchar_t* suffix) -> const std::wstring&
+                {
+                    return key.assign(keyBase).append(suffix);
+                };
+            appendLine(keyFor(L"_Name"), info.name);
+            appendLine(keyFor(L"_Path"), info.path);
+            appendLine(keyFor(L"_Params"), info.parameters);
+            appendNumber(keyFor(L"_Admin"), info.adminMode ? 1 : 0);
+            if (info.singleInstance) appendNumber(keyFor(L"_SingleInstance"), 1);
+            if (!info.prefetchFiles.empty()) appendLine(keyFor(L"_Prefetch"), info.prefetchFiles);
+
+            const LaunchProfile& profile = info.profile;
+            if (!profile.workingDirectory.empty()) appendLine(keyFor(L"_WorkDir"), profile.workingDirectory);
+            if (!profile.environment.empty()) appendLine(keyFor(L"_Env"), profile.environment);
+            if (profile.priority != LaunchPriority::Normal) appendLine(keyFor(L"_Priority"), GetLaunchPriorityName(profile.priority));
+            if (profile.affinityMask != 0) appendLine(keyFor(L"_Affinity"), FormatAffinityMask(profile.affinityMask));
+            if (profile.lowIoPriority) appendNumber(keyFor(L"_LowIo"), 1);
+        }
+    }
+    return text;
+}
+
+/**
+ * @brief Computes the changes needed to turn one configuration into another.
+ *
+ * Only tabs and buttons present in both configurations are compared. Tabs and
+ * buttons that were added are implied by the old and new counts; removed buttons are
+ * listed, so that what is kept per button can be dropped with them.
+ * @param current The configuration currently shown.
+ * @param updated The newly loaded configuration.
+ * @return The differences between the two configurations.
+ */
+ConfigDiff DiffConfigs(const LauncherConfig& current, const LauncherConfig& updated)
+{
+    ConfigDiff diff;
+    diff.oldTabCount = current.GetTabCount();
+    diff.newTabCount = updated.GetTabCount();
+
+    int commonTabs = (std::min)(diff.oldTabCount, diff.newTabCount);
+    for (int tab = 0; tab < commonTabs; ++tab)
+    {
+        const TabConfig& oldTab = current.tabs[tab];
+        const TabConfig& newTab = updated.tabs[tab];
+        if (oldTab.name != newTab.name)
+        {
+            diff.renamedTabs.push_back(tab);
+        }
+        if (oldTab.buttonRows != newTab.buttonRows || oldTab.buttonCols != newTab.buttonCols)
+        {
+            diff.resizedTabs.push_back(tab);
+        }
+
+        size_t commonButtons = (std::min)(oldTab.buttons.size(), newTab.buttons.size());
+        for (size_t btn = 0; btn < commonButtons; ++btn)
+        {
+            if (!(oldTab.buttons[btn] == newTab.buttons[btn]))
+            {
+                diff.changedButtons.push_back({ tab, static_cast<int>(btn), oldTab.buttons[btn].path != newTab.buttons[btn].path });
+            }
+        }
+        for (size_t btn = commonButtons; btn < oldTab.buttons.size(); ++btn)
+        {
+            diff.removedButtons.push_back({ tab, static_cast<int>(btn) });
+        }
+    }
+    for (int tab = commonTabs; tab < diff.oldTabCount; ++tab)
+    {
+        for (size_t btn = 0; btn < current.tabs[tab].buttons.size(); ++btn)
+        {
+            diff.removedButtons.push_back({ tab, static_cast<int>(btn) });
+        }
+    }
+    return diff;
+}
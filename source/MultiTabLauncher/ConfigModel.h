@@ -0,0 +1,142 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "LaunchProfile.h"
+
+class IniDocument;
+
+// Sanity limits against typos in the INI; far beyond any real catalog.
+const int MAX_TAB_COUNT = 100000;
+const int MAX_GRID_DIMENSION = 64;
+
+// Identifies a button by its tab index and its index within the tab.
+struct ButtonKey
+{
+    int tab{ -1 };
+    int button{ -1 };
+
+    bool operator==(const ButtonKey&) const = default;
+};
+
+// Settings of a single button as stored in the INI file.
+struct ButtonConfig
+{
+    std::wstring name{ L"" };
+    std::wstring path{ L"" };
+    std::wstring parameters{ L"" };
+    bool adminMode{ false };
+    bool singleInstance{ false };
+    std::wstring prefetchFiles{ L"" }; // Companion files read ahead with the target, separated by ';'
+    LaunchProfile profile;
+
+    bool operator==(const ButtonConfig&) const = default;
+};
+
+// Settings of the idle-time prefetch of frequently launched programs ([Prefetch] section).
+struct PrefetchSettings
+{
+    bool enabled{ true };
+    int budgetMegabytes{ 64 };  // Maximum bytes read per idle period
+    int topButtonCount{ 5 };    // Number of most launched buttons to prefetch
+    int idleSeconds{ 30 };      // Time without user input before prefetching starts
+};
+
+// Settings of the tray-resident mode ([Resident] section).
+struct ResidentSettings
+{
+    bool enabled{ false };                      // Closing hides the window to the notification area
+    std::wstring hotkey{ L"Ctrl+Alt+Space" };   // Shows or hides the window from anywhere
+
+    bool operator==(const ResidentSettings&) const = default;
+};
+
+// Budget for the windows and icons of tab pages ([Resources] section); 0 turns a limit off.
+struct ResourceSettings
+{
+    int maxIcons{ 3000 };       // Least recently visited pages are released above this
+    int maxWindows{ 5000 };
+    int idleTrimMinutes{ 10 };  // Unvisited pages and the working set are released after this
+};
+
+// Settings of the elevation broker ([Elevation] section).
+struct ElevationSettings
+{
+    bool broker{ false };   // Administrator buttons are launched by one elevated helper
+
+    bool operator==(const ElevationSettings&) const = default;
+};
+
+// Settings for looking into the launcher itself ([Diagnostics] section).
+struct DiagnosticsSettings
+{
+    bool trace{ false };    // Record where time is spent, as with /trace
+
+    bool operator==(const DiagnosticsSettings&) const = default;
+};
+
+// Settings of the index of launchable programs ([ProgramIndex] section).
+struct ProgramIndexSettings
+{
+    bool enabled{ true };
+    // Application folders searched with their subfolders, separated by ';'
+    std::wstring directories{ L"%ProgramData%\\Microsoft\\Windows\\Start Menu\\Programs;%APPDATA%\\Microsoft\\Windows\\Start Menu\\Programs" };
+
+    bool operator==(const ProgramIndexSettings&) const = default;
+};
+
+// A tab with its own button grid.
+struct TabConfig
+{
+    std::wstring name{ L"" };
+    int buttonRows{ 3 };
+    int buttonCols{ 8 };
+    std::vector<ButtonConfig> buttons; // buttonRows * buttonCols entries, row by row
+
+    int GetButtonCount() const { return buttonRows * buttonCols; }
+};
+
+// The complete launcher configuration, independent of any window state.
+struct LauncherConfig
+{
+    int buttonRows{ 3 };    // Grid of tabs without their own Rows=/Cols=
+    int buttonCols{ 8 };
+    std::vector<TabConfig> tabs;
+    PrefetchSettings prefetch;
+    ResidentSettings resident;
+    ResourceSettings resources;
+    ElevationSettings elevation;
+    DiagnosticsSettings diagnostics;
+    ProgramIndexSettings programIndex;
+
+    int GetTabCount() const { return static_cast<int>(tabs.size()); }
+};
+
+// A button that exists in both configurations but whose settings differ.
+struct ButtonChange
+{
+    int tab{ 0 };
+    int button{ 0 };
+    bool pathChanged{ false }; // The icon has to be extracted again
+};
+
+// The differences between a running configuration and a reloaded one.
+struct ConfigDiff
+{
+    int oldTabCount{ 0 };
+    int newTabCount{ 0 };
+    std::vector<int> renamedTabs;           // Tabs present in both configurations
+    std::vector<int> resizedTabs;           // Tabs present in both whose rows or columns differ
+    std::vector<ButtonChange> changedButtons;
+    std::vector<ButtonKey> removedButtons;  // Buttons of removed tabs and of grids that shrank
+
+    bool IsEmpty() const
+    {
+        return oldTabCount == newTabCount && renamedTabs.empty() && resizedTabs.empty() && changedButtons.empty() &&
+            removedButtons.empty();
+    }
+};
+
+LauncherConfig ParseLauncherConfig(const IniDocument& base, const IniDocument& overlay);
+std::wstring FormatLauncherConfig(const LauncherConfig& config);
+ConfigDiff DiffConfigs(const LauncherConfig& current, const LauncherConfig& updated);
@@ -0,0 +1,116 @@
+#include "ConfigWatcher.h"
+#include "Trace.h"
+
+#include <filesystem>
+
+ConfigWatcher::~ConfigWatcher()
+{
+    Stop();
+}
+
+/**
+ * @brief Starts watching a file.
+ * @param filePath Full path of the file to watch.
+ * @param hNotifyWindow Window that receives change notifications.
+ * @param notifyMessage Message posted when the file has changed.
+ * @return True on success, false on failure.
+ */
+bool ConfigWatcher::Start(const std::wstring& filePath, HWND hNotifyWindow, UINT notifyMessage)
+{
+    if (m_hWatchThread) return true;
+
+    m_filePath = filePath;
+    m_hNotifyWindow = hNotifyWindow;
+    m_notifyMessage = notifyMessage;
+    m_filter = FileChangeFilter(ReadFileStamp());
+
+    std::wstring directory = std::filesystem::path(filePath).parent_path().wstring();
+    m_hChangeNotification = FindFirstChangeNotificationW(
+        directory.c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE
+    );
+    if (m_hChangeNotification == INVALID_HANDLE_VALUE) return false;
+
+    m_hStopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (m_hStopEvent)
+    {
+        m_hWatchThread = CreateThread(NULL, 0, WatchThreadProcedure, this, 0, NULL);
+    }
+    if (!m_hWatchThread)
+    {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stops watching and waits for the watch thread to exit.
+ */
+void ConfigWatcher::Stop()
+{
+    if (m_hWatchThread)
+    {
+        SetEvent(m_hStopEvent);
+        WaitForSingleObject(m_hWatchThread, INFINITE);
+        CloseHandle(m_hWatchThread);
+        m_hWatchThread = NULL;
+    }
+    if (m_hStopEvent)
+    {
+        CloseHandle(m_hStopEvent);
+        m_hStopEvent = NULL;
+    }
+    if (m_hChangeNotification != INVALID_HANDLE_VALUE)
+    {
+        FindCloseChangeNotification(m_hChangeNotification);
+        m_hChangeNotification = INVALID_HANDLE_VALUE;
+    }
+}
+
+DWORD WINAPI ConfigWatcher::WatchThreadProcedure(LPVOID param)
+{
+    Trace::SetThreadName("ConfigWatcher");
+    static_cast<ConfigWatcher*>(param)->RunWatchLoop();
+    return 0;
+}
+
+/**
+ * @brief Waits for directory changes and posts a notification when the watched file changed.
+ */
+void ConfigWatcher::RunWatchLoop()
+{
+    HANDLE waitHandles[] = { m_hStopEvent, m_hChangeNotification };
+    while (true)
+    {
+        DWORD result = WaitForMultipleObjects(2, waitHandles, FALSE, INFINITE);
+        if (result != WAIT_OBJECT_0 + 1)
+        {
+            break; // Stop requested or the wait failed
+        }
+
+        if (m_filter.OnDirectoryChanged(ReadFileStamp()))
+        {
+            TRACE_INSTANT("ConfigFileChanged");
+            PostMessage(m_hNotifyWindow, m_notifyMessage, 0, 0);
+        }
+
+        if (!FindNextChangeNotification(m_hChangeNotification))
+        {
+            break;
+        }
+    }
+}
+
+FileStamp ConfigWatcher::ReadFileStamp() const
+{
+    FileStamp stamp;
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (GetFileAttributesExW(m_filePath.c_str(), GetFileExInfoStandard, &data))
+    {
+        stamp.exists = true;
+        stamp.lastWriteTime = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+        stamp.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    }
+    return stamp;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include "FileChangeFilter.h"
+
+/**
+ * @brief Watches a single file and notifies a window when its contents change.
+ *
+ * The containing directory is watched with a change notification handle on a
+ * background thread. Because directory notifications also fire for unrelated
+ * files, a FileChangeFilter compares the watched file's size and last write time
+ * against the last seen values before the notification message is posted.
+ */
+class ConfigWatcher
+{
+public:
+    ConfigWatcher() = default;
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    bool Start(const std::wstring& filePath, HWND hNotifyWindow, UINT notifyMessage);
+    void Stop();
+
+private:
+    static DWORD WINAPI WatchThreadProcedure(LPVOID param);
+    void RunWatchLoop();
+    FileStamp ReadFileStamp() const;
+
+    std::wstring m_filePath;
+    FileChangeFilter m_filter;
+
+    HANDLE m_hWatchThread{ NULL };
+    HANDLE m_hStopEvent{ NULL };
+    HANDLE m_hChangeNotification{ INVALID_HANDLE_VALUE };
+    HWND m_hNotifyWindow{ NULL };
+    UINT m_notifyMessage{ 0 };
+};
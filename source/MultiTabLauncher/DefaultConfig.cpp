@@ -0,0 +1,351 @@
+#include "DefaultConfig.h"
+
+#include <iterator>
+#include <string_view>
+
+namespace
+{
+    struct DefaultButton
+    {
+        int tab;
+        int button;
+        std::wstring_view name;
+        std::wstring_view path;
+        std::wstring_view parameters;
+        bool adminMode;
+    };
+
+    constexpr int DEFAULT_BUTTON_ROWS = 3;
+    constexpr int DEFAULT_BUTTON_COLS = 8;
+
+    constexpr std::wstring_view DEFAULT_TAB_NAMES[] = {
+        L"Home", L"System", L"Dev", L"Tab4", L"Tab5", L"Tab6", L"Tab7", L"Tab8", L"Tab9", L"Tab10",
+    };
+
+    // Buttons with a target; all others are empty
+    constexpr DefaultButton DEFAULT_BUTTONS[] = {
+        { 0, 0, L"Explorer", L"explorer.exe", L"", false },
+        { 0, 1, L"Notepad", L"notepad.exe", L"", false },
+        { 0, 2, L"Snipping Tool", L"snippingtool.exe", L"", false },
+        { 0, 3, L"Paint", L"mspaint.exe", L"", false },
+        { 0, 4, L"Calculator", L"calc.exe", L"", false },
+        { 0, 5, L"Chrome", L"C:\\Program Files\\Google\\Chrome\\Application\\chrome.exe", L"", false },
+        { 0, 8, L"Task Manager", L"Taskmgr.exe", L"", false },
+        { 0, 9, L"Command Prompt", L"cmd.exe", L"", false },
+        { 0, 10, L"Remote Desktop", L"mstsc.exe", L"", false },
+        { 0, 11, L"Sandbox", L"WindowsSandbox.exe", L"", false },
+        { 0, 13, L"Desktop", L"explorer.exe", L"%USERPROFILE%\\Desktop", false },
+        { 0, 14, L"Downloads", L"explorer.exe", L"%USERPROFILE%\\Downloads", false },
+        { 1, 0, L"Device Manager", L"devmgmt.msc", L"", false },
+        { 1, 1, L"Control Panel", L"control.exe", L"", false },
+        { 1, 2, L"Disk Management", L"diskmgmt.msc", L"", false },
+        { 1, 3, L"Computer Mgmt", L"compmgmt.msc", L"", false },
+        { 1, 4, L"Programs", L"appwiz.cpl", L"", false },
+        { 1, 5, L"System Info", L"msinfo32.exe", L"", false },
+        { 2, 0, L"VS Code", L"code.exe", L"", false },
+        { 2, 1, L"VS 2022", L"devenv.exe", L"", false },
+        { 2, 2, L"VS Installer", L"C:\\Program Files (x86)\\Microsoft Visual Studio\\Installer\\setup.exe", L"", false },
+    };
+
+    // The INI file written for the table, kept as text so that it reads like a hand-written file
+    constexpr std::wstring_view DEFAULT_CONFIG_TEXT = LR"([Tabs]
+Count=10
+ButtonRows=3
+ButtonCols=8
+Tab0=Home
+Tab1=System
+Tab2=Dev
+Tab3=Tab4
+Tab4=Tab5
+Tab5=Tab6
+Tab6=Tab7
+Tab7=Tab8
+Tab8=Tab9
+Tab9=Tab10
+
+[Tab0]
+Button0_Name=Explorer
+Button0_Path=explorer.exe
+Button0_Params=
+Button0_Admin=0
+Button1_Name=Notepad
+Button1_Path=notepad.exe
+Button1_Params=
+Button1_Admin=0
+Button2_Name=Snipping Tool
+Button2_Path=snippingtool.exe
+Button2_Params=
+Button2_Admin=0
+Button3_Name=Paint
+Button3_Path=mspaint.exe
+Button3_Params=
+Button3_Admin=0
+Button4_Name=Calculator
+Button4_Path=calc.exe
+Button4_Params=
+Button4_Admin=0
+Button5_Name=Chrome
+Button5_Path=C:\Program Files\Google\Chrome\Application\chrome.exe
+Button5_Params=
+Button5_Admin=0
+Button6_Name=
+Button6_Path=
+Button6_Params=
+Button6_Admin=0
+Button7_Name=
+Button7_Path=
+Button7_Params=
+Button7_Admin=0
+Button8_Name=Task Manager
+Button8_Path=Taskmgr.exe
+Button8_Params=
+Button8_Admin=0
+Button9_Name=Command Prompt
+Button9_Path=cmd.exe
+Button9_Params=
+Button9_Admin=0
+Button10_Name=Remote Desktop
+Button10_Path=mstsc.exe
+Button10_Params=
+Button10_Admin=0
+Button11_Name=Sandbox
+Button11_Path=WindowsSandbox.exe
+Button11_Params=
+Button11_Admin=0
+Button12_Name=
+Button12_Path=
+Button12_Params=
+Button12_Admin=0
+Button13_Name=Desktop
+Button13_Path=explorer.exe
+Button13_Params=%USERPROFILE%\Desktop
+Button13_Admin=0
+Button14_Name=Downloads
+Button14_Path=explorer.exe
+Button14_Params=%USERPROFILE%\Downloads
+Button14_Admin=0
+Button15_Name=
+Button15_Path=
+Button15_Params=
+Button15_Admin=0
+
+[Tab1]
+Button0_Name=Device Manager
+Button0_Path=devmgmt.msc
+Button0_Params=
+Button0_Admin=0
+Button1_Name=Control Panel
+Button1_Path=control.exe
+Button1_Params=
+Button1_Admin=0
+Button2_Name=Disk Management
+Button2_Path=diskmgmt.msc
+Button2_Params=
+Button2_Admin=0
+Button3_Name=Computer Mgmt
+Button3_Path=compmgmt.msc
+Button3_Params=
+Button3_Admin=0
+Button4_Name=Programs
+Button4_Path=appwiz.cpl
+Button4_Params=
+Button4_Admin=0
+Button5_Name=System Info
+Button5_Path=msinfo32.exe
+Button5_Params=
+Button5_Admin=0
+
+[Tab2]
+Button0_Name=VS Code
+Button0_Path=code.exe
+Button0_Params=
+Button0_Admin=0
+Button1_Name=VS 2022
+Button1_Path=devenv.exe
+Button1_Params=
+Button1_Admin=0
+Button2_Name=VS Installer
+Button2_Path=C:\Program Files (x86)\Microsoft Visual Studio\Installer\setup.exe
+Button2_Params=
+Button2_Admin=0
+)";
+
+    constexpr int TAB_COUNT = static_cast<int>(std::size(DEFAULT_TAB_NAMES));
+
+    // --- Compile-time check of DEFAULT_CONFIG_TEXT against the table ---
+
+    constexpr bool ParseNumber(std::wstring_view text, int& value)
+    {
+        if (text.empty() || text.size() > 9) return false;
+        value = 0;
+        for (wchar_t ch : text)
+        {
+            if (ch < L'0' || ch > L'9') return false;
+            value = value * 10 + (ch - L'0');
+        }
+        return true;
+    }
+
+    constexpr const DefaultButton* FindDefaultButton(int tab, int button)
+    {
+        for (const DefaultButton& entry : DEFAULT_BUTTONS)
+        {
+            if (entry.tab == tab && entry.button == button) return &entry;
+        }
+        return nullptr;
+    }
+
+    constexpr bool IsValidTable()
+    {
+        for (const DefaultButton& entry : DEFAULT_BUTTONS)
+        {
+            if (entry.tab < 0 || entry.tab >= TAB_COUNT) return false;
+            if (entry.button < 0 || entry.button >= DEFAULT_BUTTON_ROWS * DEFAULT_BUTTON_COLS) return false;
+            if (FindDefaultButton(entry.tab, entry.button) != &entry) return false; // Duplicate
+            if (entry.name.empty()) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks that DEFAULT_CONFIG_TEXT describes exactly the table: every key in the
+     *        text holds the table's value, and every tab and button of the table is in the text.
+     */
+    constexpr bool IsDefaultTextEquivalent()
+    {
+        std::wstring_view text = DEFAULT_CONFIG_TEXT;
+        int section = -2;   // -1 for [Tabs], the tab index for [TabN]
+        size_t tabNameCount = 0;
+        size_t buttonCount = 0;
+        while (!text.empty())
+        {
+            size_t lineEnd = text.find(L'\n');
+            std::wstring_view line = text.substr(0, lineEnd);
+            text = lineEnd == std::wstring_view::npos ? std::wstring_view() : text.substr(lineEnd + 1);
+            if (line.empty()) continue;
+
+            if (line.front() == L'[')
+            {
+                if (line.back() != L']') return false;
+                std::wstring_view name = line.substr(1, line.size() - 2);
+                if (name == L"Tabs")
+                {
+                    section = -1;
+                }
+                else if (name.substr(0, 3) != L"Tab" || !ParseNumber(name.substr(3), section) || section >= TAB_COUNT)
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            size_t equals = line.find(L'=');
+            if (equals == std::wstring_view::npos) return false;
+            std::wstring_view key = line.substr(0, equals);
+            std::wstring_view value = line.substr(equals + 1);
+            int number = 0;
+            if (section == -1)
+            {
+                if (key == L"Count")
+                {
+                    if (!ParseNumber(value, number) || number != TAB_COUNT) return false;
+                }
+                else if (key == L"ButtonRows")
+                {
+                    if (!ParseNumber(value, number) || number != DEFAULT_BUTTON_ROWS) return false;
+                }
+                else if (key == L"ButtonCols")
+                {
+                    if (!ParseNumber(value, number) || number != DEFAULT_BUTTON_COLS) return false;
+                }
+                else if (key.substr(0, 3) == L"Tab" && ParseNumber(key.substr(3), number) && number < TAB_COUNT)
+                {
+                    if (value != DEFAULT_TAB_NAMES[number]) return false;
+                    ++tabNameCount;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            else if (section >= 0)
+            {
+                size_t underscore = key.find(L'_');
+                if (key.substr(0, 6) != L"Button" || underscore == std::wstring_view::npos ||
+                    !ParseNumber(key.substr(6, underscore - 6), number))
+                {
+                    return false;
+                }
+                std::wstring_view field = key.substr(underscore + 1);
+                const DefaultButton* entry = FindDefaultButton(section, number);
+                if (field == L"Name")
+                {
+                    if (value != (entry ? entry->name : std::wstring_view())) return false;
+                    if (entry) ++buttonCount;
+                }
+                else if (field == L"Path")
+                {
+                    if (value != (entry ? entry->path : std::wstring_view())) return false;
+                }
+                else if (field == L"Params")
+                {
+                    if (value != (entry ? entry->parameters : std::wstring_view())) return false;
+                }
+                else if (field == L"Admin")
+                {
+                    if (value != ((entry && entry->adminMode) ? L"1" : L"0")) return false;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                return false;   // Key outside of a section
+            }
+        }
+        return tabNameCount == std::size(DEFAULT_TAB_NAMES) && buttonCount == std::size(DEFAULT_BUTTONS);
+    }
+
+    static_assert(IsValidTable(), "DEFAULT_BUTTONS has an entry outside the default grid");
+    static_assert(IsDefaultTextEquivalent(), "DEFAULT_CONFIG_TEXT does not describe DEFAULT_BUTTONS");
+}
+
+/**
+ * @brief Builds the default configuration from the compiled-in table.
+ * @return The configuration that ParseLauncherConfig() returns for GetDefaultConfigString().
+ */
+LauncherConfig GetDefaultLauncherConfig()
+{
+    LauncherConfig config;
+    config.buttonRows = DEFAULT_BUTTON_ROWS;
+    config.buttonCols = DEFAULT_BUTTON_COLS;
+    config.tabs.resize(TAB_COUNT);
+    for (int tab = 0; tab < TAB_COUNT; tab++)
+    {
+        TabConfig& tabConfig = config.tabs[tab];
+        tabConfig.name = DEFAULT_TAB_NAMES[tab];
+        tabConfig.buttonRows = DEFAULT_BUTTON_ROWS;
+        tabConfig.buttonCols = DEFAULT_BUTTON_COLS;
+        tabConfig.buttons.resize(tabConfig.GetButtonCount());
+    }
+    for (const DefaultButton& entry : DEFAULT_BUTTONS)
+    {
+        ButtonConfig& button = config.tabs[entry.tab].buttons[entry.button];
+        button.name = entry.name;
+        button.path = entry.path;
+        button.parameters = entry.parameters;
+        button.adminMode = entry.adminMode;
+    }
+    return config;
+}
+
+/**
+ * @brief Provides the default string content for the INI file.
+ * @return A wstring containing the default configuration.
+ */
+std::wstring GetDefaultConfigString()
+{
+    return std::wstring(DEFAULT_CONFIG_TEXT);
+}
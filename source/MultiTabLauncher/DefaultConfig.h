@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include "ConfigModel.h"
+
+/**
+ * @brief The configuration the launcher starts with when there is no INI file.
+ *
+ * The tabs and buttons are a constant table compiled into the executable, so a first run
+ * builds its configuration without writing or parsing a file. The INI text written on
+ * the first edit describes the same configuration; a static_assert in DefaultConfig.cpp
+ * checks the two against each other whenever the file is compiled.
+ */
+
+LauncherConfig GetDefaultLauncherConfig();
+std::wstring GetDefaultConfigString();
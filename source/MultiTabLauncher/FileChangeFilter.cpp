@@ -0,0 +1,15 @@
+#include "FileChangeFilter.h"
+
+/**
+ * @brief Takes the stamp of the watched file after a directory notification.
+ * @return True if the file exists and changed since the last notification.
+ */
+bool FileChangeFilter::OnDirectoryChanged(const FileStamp& stamp)
+{
+    if (stamp == m_lastStamp)
+    {
+        return false;
+    }
+    m_lastStamp = stamp;
+    return stamp.exists;
+}
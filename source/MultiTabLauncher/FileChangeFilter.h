@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// What a directory listing says about a file; compared to tell real changes from noise.
+struct FileStamp
+{
+    bool exists{ false };
+    uint64_t lastWriteTime{ 0 };    // In the file system's own units
+    uint64_t size{ 0 };
+
+    bool operator==(const FileStamp&) const = default;
+};
+
+/**
+ * @brief Decides which change notifications of a directory are changes of the watched file.
+ *
+ * Directory notifications also fire for other files, and an editor saving a file may
+ * cause several; only a stamp that differs from the last one seen counts. A file that
+ * disappeared is remembered but not reported, since it is usually being replaced; its
+ * reappearance is. The filter does not watch anything itself: ConfigWatcher feeds it on
+ * Windows, and an inotify watcher does in the tests.
+ */
+class FileChangeFilter
+{
+public:
+    explicit FileChangeFilter(const FileStamp& initialStamp = FileStamp()) : m_lastStamp(initialStamp) {}
+
+    bool OnDirectoryChanged(const FileStamp& stamp);
+
+private:
+    FileStamp m_lastStamp;
+};
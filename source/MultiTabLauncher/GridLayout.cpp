@@ -0,0 +1,17 @@
+#include "GridLayout.h"
+
+/**
+ * @brief Computes the position of a cell in a grid.
+ * @param area The area covered by the grid.
+ * @param rows, cols The size of the grid.
+ * @param index The index of the cell, counted row by row.
+ * @return The cell's rectangle. Cells have equal size; leftover pixels stay unused.
+ */
+GridRect GetGridCell(const GridRect& area, int rows, int cols, int index)
+{
+    int cellWidth = (area.right - area.left) / cols;
+    int cellHeight = (area.bottom - area.top) / rows;
+    int left = area.left + (index % cols) * cellWidth;
+    int top = area.top + (index / cols) * cellHeight;
+    return { left, top, left + cellWidth, top + cellHeight };
+}
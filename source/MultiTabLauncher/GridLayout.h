@@ -0,0 +1,14 @@
+#pragma once
+
+// A rectangle in pixels, laid out like a Win32 RECT but usable without windows.h.
+struct GridRect
+{
+    int left{ 0 };
+    int top{ 0 };
+    int right{ 0 };
+    int bottom{ 0 };
+
+    bool operator==(const GridRect&) const = default;
+};
+
+GridRect GetGridCell(const GridRect& area, int rows, int cols, int index);
@@ -0,0 +1,227 @@
+#include "IconCache.h"
+#include "Trace.h"
+
+#include <shellapi.h>
+#include <shlobj.h>
+#include <algorithm>
+
+namespace
+{
+    // Sizes icon files commonly contain; extraction asks for one of them so no scaling happens there
+    const int STANDARD_ICON_SIZES[] = { 16, 20, 24, 32, 40, 48, 64, 96, 128, 256 };
+}
+
+/**
+ * @brief Returns the icon of a file at the given size.
+ * @param filePath The absolute path of the file.
+ * @param size The width and height of the icon in pixels.
+ * @return A new icon owned by the caller, or NULL if the file has no icon.
+ */
+HICON IconCache::GetIcon(const std::wstring& filePath, int size)
+{
+    HICON hIcon = FindIcon(filePath, size);
+    if (!hIcon)
+    {
+        BgraImage image;
+        if (!ExtractImage(filePath, size, image))
+        {
+            return NULL; // Not cached; the target may appear later
+        }
+        AddImage(filePath, size, std::move(image));
+        hIcon = FindIcon(filePath, size);
+    }
+    return hIcon;
+}
+
+/**
+ * @brief Returns the icon of a file at the given size if it is cached, without extracting it.
+ * @return A new icon owned by the caller, or NULL if the icon is not cached.
+ */
+HICON IconCache::FindIcon(const std::wstring& filePath, int size) const
+{
+    auto it = m_images.find(std::make_pair(filePath, size));
+    return it != m_images.end() ? ImageToIcon(it->second) : NULL;
+}
+
+/**
+ * @brief Caches pixels returned by ExtractImage(), replacing those cached for the same path and size.
+ */
+void IconCache::AddImage(const std::wstring& filePath, int size, BgraImage image)
+{
+    m_images[std::make_pair(filePath, size)] = std::move(image);
+}
+
+/**
+ * @brief Extracts the icon of a file and scales it to the given size. Touches no state of
+ *        the cache, so it can run on any thread that has initialized COM.
+ * @return True on success, false if the file has no icon.
+ */
+bool IconCache::ExtractImage(const std::wstring& filePath, int size, BgraImage& image)
+{
+    TRACE_SCOPE("ScaleIcon");
+    if (!ExtractNativeIcon(filePath, size, image))
+    {
+        return false;
+    }
+    if (image.width != size || image.height != size)
+    {
+        image = ResizeBgra(image, size, size);
+    }
+    return true;
+}
+
+/**
+ * @brief Drops all cached icons.
+ */
+void IconCache::Clear()
+{
+    m_images.clear();
+}
+
+/**
+ * @brief Returns the bytes held by the cached pixels and paths.
+ */
+size_t IconCache::GetByteSize() const
+{
+    size_t bytes = 0;
+    for (const auto& [key, image] : m_images)
+    {
+        bytes += key.first.capacity() * sizeof(wchar_t) + image.pixels.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+/**
+ * @brief Extracts the icon of a file at the smallest standard size not below the requested size.
+ *        Falls back to the shell's large icon for files without an icon location of their own.
+ */
+bool IconCache::ExtractNativeIcon(const std::wstring& filePath, int size, BgraImage& image)
+{
+    const int* nativeSize = std::lower_bound(std::begin(STANDARD_ICON_SIZES), std::end(STANDARD_ICON_SIZES), size);
+    int extractSize = nativeSize != std::end(STANDARD_ICON_SIZES) ? *nativeSize : STANDARD_ICON_SIZES[std::size(STANDARD_ICON_SIZES) - 1];
+
+    HICON hIcon = NULL;
+    SHFILEINFOW sfi = {};
+    if (SHGetFileInfoW(filePath.c_str(), 0, &sfi, sizeof(sfi), SHGFI_ICONLOCATION) && sfi.szDisplayName[0] != L'\0')
+    {
+        if (SHDefExtractIconW(sfi.szDisplayName, sfi.iIcon, 0, &hIcon, NULL, MAKELONG(extractSize, 0)) != S_OK)
+        {
+            hIcon = NULL;
+        }
+    }
+    if (!hIcon)
+    {
+        sfi = {};
+        if (SHGetFileInfoW(filePath.c_str(), 0, &sfi, sizeof(sfi), SHGFI_ICON | SHGFI_LARGEICON))
+        {
+            hIcon = sfi.hIcon;
+        }
+    }
+    if (!hIcon)
+    {
+        return false;
+    }
+
+    bool converted = IconToImage(hIcon, image);
+    DestroyIcon(hIcon);
+    return converted;
+}
+
+/**
+ * @brief Reads the pixels of an icon. Icons without an alpha channel take it from their mask.
+ */
+bool IconCache::IconToImage(HICON hIcon, BgraImage& image)
+{
+    ICONINFO iconInfo = {};
+    if (!GetIconInfo(hIcon, &iconInfo))
+    {
+        return false;
+    }
+
+    bool converted = false;
+    BITMAP bm = {};
+    if (iconInfo.hbmColor && GetObject(iconInfo.hbmColor, sizeof(bm), &bm) && bm.bmWidth > 0 && bm.bmHeight > 0)
+    {
+        image.width = bm.bmWidth;
+        image.height = bm.bmHeight;
+        image.pixels.assign(static_cast<size_t>(image.width) * image.height, 0);
+
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = image.width;
+        bmi.bmiHeader.biHeight = -image.height; // Top-down
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        HDC hdc = GetDC(NULL);
+        converted = GetDIBits(hdc, iconInfo.hbmColor, 0, image.height, image.pixels.data(), &bmi, DIB_RGB_COLORS) == image.height;
+
+        bool hasAlpha = std::any_of(image.pixels.begin(), image.pixels.end(), [](uint32_t pixel) { return (pixel >> 24) != 0; });
+        if (converted && !hasAlpha)
+        {
+            // Mask pixels are white where the icon is transparent
+            std::vector<uint32_t> mask(image.pixels.size());
+            if (iconInfo.hbmMask && GetDIBits(hdc, iconInfo.hbmMask, 0, image.height, mask.data(), &bmi, DIB_RGB_COLORS) == image.height)
+            {
+                for (size_t i = 0; i < image.pixels.size(); ++i)
+                {
+                    image.pixels[i] = (image.pixels[i] & 0x00FFFFFF) | ((mask[i] & 0x00FFFFFF) ? 0 : 0xFF000000);
+                }
+            }
+            else
+            {
+                for (uint32_t& pixel : image.pixels)
+                {
+                    pixel |= 0xFF000000;
+                }
+            }
+        }
+        ReleaseDC(NULL, hdc);
+    }
+
+    if (iconInfo.hbmColor) DeleteObject(iconInfo.hbmColor);
+    if (iconInfo.hbmMask) DeleteObject(iconInfo.hbmMask);
+    return converted;
+}
+
+/**
+ * @brief Creates an icon with an alpha channel from an image.
+ */
+HICON IconCache::ImageToIcon(const BgraImage& image)
+{
+    if (image.IsEmpty())
+    {
+        return NULL;
+    }
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = image.width;
+    bmi.bmiHeader.biHeight = -image.height; // Top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    void* bits = NULL;
+    HBITMAP hbmColor = CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    if (!hbmColor)
+    {
+        return NULL;
+    }
+    std::copy(image.pixels.begin(), image.pixels.end(), static_cast<uint32_t*>(bits));
+
+    // The alpha channel decides transparency; the mask only has to exist. Rows are WORD aligned.
+    std::vector<BYTE> maskBits(static_cast<size_t>((image.width + 15) / 16) * 2 * image.height, 0);
+    HBITMAP hbmMask = CreateBitmap(image.width, image.height, 1, 1, maskBits.data());
+
+    ICONINFO iconInfo = {};
+    iconInfo.fIcon = TRUE;
+    iconInfo.hbmColor = hbmColor;
+    iconInfo.hbmMask = hbmMask;
+    HICON hIcon = hbmMask ? CreateIconIndirect(&iconInfo) : NULL;
+
+    DeleteObject(hbmColor);
+    if (hbmMask) DeleteObject(hbmMask);
+    return hIcon;
+}
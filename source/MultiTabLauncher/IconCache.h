@@ -0,0 +1,42 @@
+#pragma once
+
+#include <windows.h>
+#include <map>
+#include <string>
+#include <utility>
+#include "BgraImage.h"
+
+/**
+ * @brief Icons of launch targets at exactly the pixel size they are drawn at.
+ *
+ * An icon is extracted at the smallest standard size that is at least as large as the
+ * requested size, so that it is only ever scaled down, and scaled once with ResizeBgra().
+ * The scaled pixels are kept per path and size: asking again, for another button with
+ * the same target or after moving back to a monitor with the previous DPI, only creates
+ * a new icon handle. The cache is used from the UI thread only; ExtractImage() does the
+ * slow part and can run on any thread, so that icons are extracted in the background
+ * and added with AddImage().
+ */
+class IconCache
+{
+public:
+    IconCache() = default;
+
+    IconCache(const IconCache&) = delete;
+    IconCache& operator=(const IconCache&) = delete;
+
+    HICON GetIcon(const std::wstring& filePath, int size);
+    HICON FindIcon(const std::wstring& filePath, int size) const;
+    void AddImage(const std::wstring& filePath, int size, BgraImage image);
+    void Clear();
+    size_t GetByteSize() const;
+
+    static bool ExtractImage(const std::wstring& filePath, int size, BgraImage& image);
+
+private:
+    static bool ExtractNativeIcon(const std::wstring& filePath, int size, BgraImage& image);
+    static bool IconToImage(HICON hIcon, BgraImage& image);
+    static HICON ImageToIcon(const BgraImage& image);
+
+    std::map<std::pair<std::wstring, int>, BgraImage> m_images;
+};
@@ -0,0 +1,387 @@
+#include "IniDocument.h"
+#include "TextKernels.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <cwctype>
+
+namespace
+{
+    const uint32_t SNAPSHOT_MAGIC = 0x534C544D;  // "MTLS"
+    const uint32_t SNAPSHOT_VERSION = 1;
+
+    // Followed by the sections, the entries and the text, in that order
+    struct SnapshotHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t charSize;      // sizeof(wchar_t) of the writer
+        uint32_t sectionCount;
+        uint32_t entryCount;
+        uint32_t textLength;    // In characters
+    };
+
+    wint_t FoldCase(wchar_t ch)
+    {
+        // Names are almost always ASCII; avoid the locale lookup for them
+        if (ch < 0x80) return (ch >= L'A' && ch <= L'Z') ? ch + (L'a' - L'A') : ch;
+        return std::towlower(ch);
+    }
+
+    int CompareNoCase(std::wstring_view a, std::wstring_view b)
+    {
+        size_t length = (std::min)(a.length(), b.length());
+        for (size_t i = 0; i < length; ++i)
+        {
+            wint_t ca = FoldCase(a[i]);
+            wint_t cb = FoldCase(b[i]);
+            if (ca != cb) return ca < cb ? -1 : 1;
+        }
+        if (a.length() == b.length()) return 0;
+        return a.length() < b.length() ? -1 : 1;
+    }
+
+    bool IsSpanInText(uint32_t offset, uint32_t length, uint32_t textLength)
+    {
+        return static_cast<uint64_t>(offset) + length <= textLength;
+    }
+}
+
+/**
+ * @brief Replaces the document with the contents of an INI file.
+ * @param text The decoded file contents; a leading byte order mark is skipped.
+ *             Offsets are 32-bit, so text beyond 4G characters is ignored.
+ */
+void IniDocument::Parse(std::wstring text)
+{
+    m_text = std::move(text);
+    if (m_text.length() > UINT32_MAX) m_text.resize(UINT32_MAX);
+    m_sections.clear();
+    m_entries.clear();
+    m_snapshotText = nullptr;
+    m_snapshotTextLength = 0;
+    m_snapshotSections = nullptr;
+    m_snapshotSectionCount = 0;
+    m_snapshotEntries = nullptr;
+
+    auto span = [](size_t begin, size_t end) -> TextSpan
+        {
+            return { static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin) };
+        };
+
+    // Offset of the first ch in [from, to), or to if there is none
+    const wchar_t* data = m_text.data();
+    auto find = [data](size_t from, size_t to, wchar_t ch) -> size_t
+        {
+            return FindChar(data + from, data + to, ch) - data;
+        };
+
+    const size_t end = m_text.length();
+    size_t pos = (end > 0 && m_text[0] == L'\xFEFF') ? 1 : 0;
+
+    while (pos < end)
+    {
+        size_t lineEnd = find(pos, end, L'\n');
+
+        // Trim the line; this also drops the '\r' of CRLF line endings
+        size_t first = pos;
+        size_t last = lineEnd;
+        while (first < last && IsBlank(m_text[first])) ++first;
+        while (last > first && IsBlank(m_text[last - 1])) --last;
+        pos = lineEnd + 1;
+
+        if (first == last || m_text[first] == L';')
+        {
+            continue;
+        }
+
+        if (m_text[first] == L'[')
+        {
+            size_t nameEnd = find(first + 1, last, L']');
+            size_t nameStart = first + 1;
+            while (nameStart < nameEnd && IsBlank(m_text[nameStart])) ++nameStart;
+            while (nameEnd > nameStart && IsBlank(m_text[nameEnd - 1])) --nameEnd;
+            m_sections.push_back({ span(nameStart, nameEnd), static_cast<uint32_t>(m_entries.size()), 0 });
+            continue;
+        }
+
+        // Keys before the first section header belong to no section and are ignored
+        size_t equals = find(first, last, L'=');
+        if (m_sections.empty() || equals == last)
+        {
+            continue;
+        }
+
+        size_t keyEnd = equals;
+        while (keyEnd > first && IsBlank(m_text[keyEnd - 1])) --keyEnd;
+        size_t valueStart = equals + 1;
+        while (valueStart < last && IsBlank(m_text[valueStart])) ++valueStart;
+
+        size_t valueEnd = last;
+        if (valueEnd - valueStart >= 2 && (m_text[valueStart] == L'"' || m_text[valueStart] == L'\'') &&
+            m_text[valueEnd - 1] == m_text[valueStart])
+        {
+            ++valueStart;
+            --valueEnd;
+        }
+
+        m_entries.push_back({ span(first, keyEnd), span(valueStart, valueEnd) });
+        ++m_sections.back().entryCount;
+    }
+
+    // Stable sorts keep the first of several equal names in front, where lookups find it
+    auto entryLess = [this](const Entry& a, const Entry& b)
+        {
+            return CompareNoCase(View(a.key), View(b.key)) < 0;
+        };
+    for (const Section& section : m_sections)
+    {
+        auto begin = m_entries.begin() + section.firstEntry;
+        std::stable_sort(begin, begin + section.entryCount, entryLess);
+    }
+    std::stable_sort(m_sections.begin(), m_sections.end(), [this](const Section& a, const Section& b)
+        {
+            return CompareNoCase(View(a.name), View(b.name)) < 0;
+        });
+}
+
+/**
+ * @brief Saves the document as a snapshot that AttachSnapshot() can query in place.
+ *        The layout is that of the running build; other builds reject it.
+ * @return The snapshot bytes.
+ */
+std::vector<char> IniDocument::SaveSnapshot() const
+{
+    std::wstring_view text = Text();
+    const Section* sections = Sections();
+    const size_t sectionCount = SectionCount();
+    size_t entryCount = 0;
+    for (size_t i = 0; i < sectionCount; ++i)
+    {
+        entryCount = (std::max)(entryCount, static_cast<size_t>(sections[i].firstEntry) + sections[i].entryCount);
+    }
+
+    SnapshotHeader header = {};
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.charSize = sizeof(wchar_t);
+    header.sectionCount = static_cast<uint32_t>(sectionCount);
+    header.entryCount = static_cast<uint32_t>(entryCount);
+    header.textLength = static_cast<uint32_t>(text.length());
+
+    std::vector<char> snapshot(sizeof(header) + sectionCount * sizeof(Section) +
+        entryCount * sizeof(Entry) + text.length() * sizeof(wchar_t));
+    char* out = snapshot.data();
+    auto append = [&out](const void* data, size_t size)
+        {
+            if (size > 0) std::memcpy(out, data, size);
+            out += size;
+        };
+    append(&header, sizeof(header));
+    append(sections, sectionCount * sizeof(Section));
+    append(Entries(), entryCount * sizeof(Entry));
+    append(text.data(), text.length() * sizeof(wchar_t));
+    return snapshot;
+}
+
+/**
+ * @brief Replaces the document with a view of a snapshot saved by SaveSnapshot().
+ *
+ * Nothing is copied: the data must stay valid and unchanged for as long as the
+ * document is used. Every offset is checked against the size, so a damaged or
+ * truncated file is rejected instead of read out of bounds.
+ * @param data The snapshot, aligned to at least 4 bytes, e.g. a mapped view of a file.
+ * @param size The size of the snapshot in bytes.
+ * @return True if the snapshot is valid; otherwise the document is left empty.
+ */
+bool IniDocument::AttachSnapshot(const void* data, size_t size)
+{
+    Parse(std::wstring());
+
+    if (!data || size < sizeof(SnapshotHeader) || reinterpret_cast<uintptr_t>(data) % alignof(Section) != 0)
+    {
+        return false;
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || header.charSize != sizeof(wchar_t))
+    {
+        return false;
+    }
+
+    const uint64_t sectionsOffset = sizeof(SnapshotHeader);
+    const uint64_t entriesOffset = sectionsOffset + static_cast<uint64_t>(header.sectionCount) * sizeof(Section);
+    const uint64_t textOffset = entriesOffset + static_cast<uint64_t>(header.entryCount) * sizeof(Entry);
+    const uint64_t totalSize = textOffset + static_cast<uint64_t>(header.textLength) * sizeof(wchar_t);
+    if (totalSize > size)
+    {
+        return false;
+    }
+
+    const char* bytes = static_cast<const char*>(data);
+    const Section* sections = reinterpret_cast<const Section*>(bytes + sectionsOffset);
+    const Entry* entries = reinterpret_cast<const Entry*>(bytes + entriesOffset);
+    for (uint32_t i = 0; i < header.sectionCount; ++i)
+    {
+        const Section& section = sections[i];
+        if (!IsSpanInText(section.name.offset, section.name.length, header.textLength) ||
+            static_cast<uint64_t>(section.firstEntry) + section.entryCount > header.entryCount)
+        {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.entryCount; ++i)
+    {
+        const Entry& entry = entries[i];
+        if (!IsSpanInText(entry.key.offset, entry.key.length, header.textLength) ||
+            !IsSpanInText(entry.value.offset, entry.value.length, header.textLength))
+        {
+            return false;
+        }
+    }
+
+    m_snapshotText = reinterpret_cast<const wchar_t*>(bytes + textOffset);
+    m_snapshotTextLength = header.textLength;
+    m_snapshotSections = sections;
+    m_snapshotSectionCount = header.sectionCount;
+    m_snapshotEntries = entries;
+    return true;
+}
+
+/**
+ * @brief Looks up a value, as GetPrivateProfileString does.
+ * @return The value, or defaultValue if the section or key does not exist.
+ */
+std::wstring IniDocument::GetString(std::wstring_view section, std::wstring_view key, std::wstring_view defaultValue) const
+{
+    return GetString(FindSection(section), key, defaultValue);
+}
+
+std::wstring IniDocument::GetString(const Section* section, std::wstring_view key, std::wstring_view defaultValue) const
+{
+    const Entry* entry = FindEntry(section, key);
+    return std::wstring(entry ? View(entry->value) : defaultValue);
+}
+
+/**
+ * @brief Looks up an integer, as GetPrivateProfileInt does.
+ * @return The value, 0 if it does not start with a number, or defaultValue if the key does not exist.
+ */
+int IniDocument::GetInt(std::wstring_view section, std::wstring_view key, int defaultValue) const
+{
+    return GetInt(FindSection(section), key, defaultValue);
+}
+
+int IniDocument::GetInt(const Section* section, std::wstring_view key, int defaultValue) const
+{
+    const Entry* entry = FindEntry(section, key);
+    return entry ? ParseInt(View(entry->value)) : defaultValue;
+}
+
+/**
+ * @brief Looks up a value without copying it.
+ * @param value Receives the value; valid as long as the document.
+ * @return True if the key exists, false otherwise.
+ */
+bool IniDocument::FindValue(const Section* section, std::wstring_view key, std::wstring_view& value) const
+{
+    const Entry* entry = FindEntry(section, key);
+    if (!entry) return false;
+    value = View(entry->value);
+    return true;
+}
+
+/**
+ * @brief Converts a value as GetPrivateProfileInt does: leading decimal digits are
+ *        converted and the rest of the value is ignored.
+ */
+int IniDocument::ParseInt(std::wstring_view value)
+{
+    size_t i = 0;
+    bool negative = i < value.length() && value[i] == L'-';
+    if (negative) ++i;
+
+    long long number = 0;
+    for (; i < value.length() && value[i] >= L'0' && value[i] <= L'9'; ++i)
+    {
+        number = (std::min)(number * 10 + (value[i] - L'0'), static_cast<long long>(INT_MAX));
+    }
+    return static_cast<int>(negative ? -number : number);
+}
+
+/**
+ * @brief Looks up a section by name.
+ * @return The section, or nullptr if it does not exist. Valid until the next Parse().
+ */
+const IniDocument::Section* IniDocument::FindSection(std::wstring_view section) const
+{
+    const Section* begin = Sections();
+    const Section* end = begin + SectionCount();
+    const Section* it = std::lower_bound(begin, end, section, [this](const Section& s, std::wstring_view name)
+        {
+            return CompareNoCase(View(s.name), name) < 0;
+        });
+    if (it == end || CompareNoCase(View(it->name), section) != 0) return nullptr;
+    return it;
+}
+
+std::wstring_view IniDocument::Text() const
+{
+    return m_snapshotText ? std::wstring_view(m_snapshotText, m_snapshotTextLength) : std::wstring_view(m_text);
+}
+
+const IniDocument::Entry* IniDocument::FindEntry(const Section* section, std::wstring_view key) const
+{
+    if (!section) return nullptr;
+
+    const Entry* begin = Entries() + section->firstEntry;
+    const Entry* end = begin + section->entryCount;
+    const Entry* it = std::lower_bound(begin, end, key, [this](const Entry& e, std::wstring_view name)
+        {
+            return CompareNoCase(View(e.key), name) < 0;
+        });
+    if (it == end || CompareNoCase(View(it->key), key) != 0) return nullptr;
+    return it;
+}
+
+/**
+ * @brief Looks up a section in both layers.
+ */
+LayeredIni::Section LayeredIni::FindSection(std::wstring_view section) const
+{
+    return { m_overlay.FindSection(section), m_base.FindSection(section) };
+}
+
+/**
+ * @brief Looks up a value in the overlay, then in the base.
+ */
+std::wstring LayeredIni::GetString(std::wstring_view section, std::wstring_view key, std::wstring_view defaultValue) const
+{
+    return GetString(FindSection(section), key, defaultValue);
+}
+
+std::wstring LayeredIni::GetString(const Section& section, std::wstring_view key, std::wstring_view defaultValue) const
+{
+    std::wstring_view value;
+    if (m_overlay.FindValue(section.overlay, key, value) || m_base.FindValue(section.base, key, value))
+    {
+        return std::wstring(value);
+    }
+    return std::wstring(defaultValue);
+}
+
+int LayeredIni::GetInt(std::wstring_view section, std::wstring_view key, int defaultValue) const
+{
+    return GetInt(FindSection(section), key, defaultValue);
+}
+
+int LayeredIni::GetInt(const Section& section, std::wstring_view key, int defaultValue) const
+{
+    std::wstring_view value;
+    if (m_overlay.FindValue(section.overlay, key, value) || m_base.FindValue(section.base, key, value))
+    {
+        return IniDocument::ParseInt(value);
+    }
+    return defaultValue;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief An INI file parsed in memory and queried like the profile API.
+ *
+ * GetPrivateProfileString scans the file for every key it is asked for, which makes
+ * reading a catalog of thousands of tabs quadratic. The document is parsed once
+ * instead; sections and keys are kept sorted so that lookups are binary searches.
+ * Matching follows the profile API: section and key names are case-insensitive,
+ * the first of several equal sections or keys wins, values are trimmed and one pair
+ * of enclosing quotes is removed. Lines starting with ';' are comments.
+ * Callers reading many keys of one section can look the section up once with
+ * FindSection() and pass it to the lookup functions instead of its name.
+ *
+ * A parsed document can be saved as a snapshot: its text and sorted index in one
+ * flat block. AttachSnapshot() queries such a block in place, without copying or
+ * parsing, so that processes mapping the same snapshot file share its pages.
+ */
+class IniDocument
+{
+private:
+    // Offsets into the text, so that copies and moves of the document stay valid.
+    // Fixed-size fields, as they are also the snapshot layout.
+    struct TextSpan
+    {
+        uint32_t offset{ 0 };
+        uint32_t length{ 0 };
+    };
+
+public:
+    struct Section
+    {
+        TextSpan name;
+        uint32_t firstEntry{ 0 };
+        uint32_t entryCount{ 0 };
+    };
+
+    void Parse(std::wstring text);
+
+    std::vector<char> SaveSnapshot() const;
+    bool AttachSnapshot(const void* data, size_t size);
+
+    const Section* FindSection(std::wstring_view section) const;
+    bool HasSection(std::wstring_view section) const { return FindSection(section) != nullptr; }
+
+    std::wstring GetString(std::wstring_view section, std::wstring_view key, std::wstring_view defaultValue) const;
+    std::wstring GetString(const Section* section, std::wstring_view key, std::wstring_view defaultValue) const;
+    int GetInt(std::wstring_view section, std::wstring_view key, int defaultValue) const;
+    int GetInt(const Section* section, std::wstring_view key, int defaultValue) const;
+
+    bool FindValue(const Section* section, std::wstring_view key, std::wstring_view& value) const;
+    static int ParseInt(std::wstring_view value);
+
+private:
+    struct Entry
+    {
+        TextSpan key;
+        TextSpan value;
+    };
+
+    std::wstring_view Text() const;
+    const Section* Sections() const { return m_snapshotSections ? m_snapshotSections : m_sections.data(); }
+    const Entry* Entries() const { return m_snapshotEntries ? m_snapshotEntries : m_entries.data(); }
+    size_t SectionCount() const { return m_snapshotSections ? m_snapshotSectionCount : m_sections.size(); }
+
+    std::wstring_view View(TextSpan span) const { return Text().substr(span.offset, span.length); }
+    const Entry* FindEntry(const Section* section, std::wstring_view key) const;
+
+    // Parsed contents; empty while a snapshot is attached
+    std::wstring m_text;
+    std::vector<Section> m_sections;    // Sorted by name
+    std::vector<Entry> m_entries;       // Grouped by section, each group sorted by key
+
+    // Attached snapshot, owned by the caller
+    const wchar_t* m_snapshotText{ nullptr };
+    size_t m_snapshotTextLength{ 0 };
+    const Section* m_snapshotSections{ nullptr };
+    size_t m_snapshotSectionCount{ 0 };
+    const Entry* m_snapshotEntries{ nullptr };
+};
+
+/**
+ * @brief Two INI documents read as one: a key in the overlay replaces the same key in the
+ *        base, and everything else comes from the base.
+ */
+class LayeredIni
+{
+public:
+    struct Section
+    {
+        const IniDocument::Section* overlay{ nullptr };
+        const IniDocument::Section* base{ nullptr };
+
+        bool Exists() const { return overlay || base; }
+    };
+
+    LayeredIni(const IniDocument& base, const IniDocument& overlay) : m_base(base), m_overlay(overlay) {}
+
+    Section FindSection(std::wstring_view section) const;
+
+    std::wstring GetString(std::wstring_view section, std::wstring_view key, std::wstring_view defaultValue) const;
+    std::wstring GetString(const Section& section, std::wstring_view key, std::wstring_view defaultValue) const;
+    int GetInt(std::wstring_view section, std::wstring_view key, int defaultValue) const;
+    int GetInt(const Section& section, std::wstring_view key, int defaultValue) const;
+
+private:
+    const IniDocument& m_base;
+    const IniDocument& m_overlay;
+};
@@ -0,0 +1,265 @@
+#include "InteractionReplay.h"
+#include "IniDocument.h"
+#include "ResourceAccountant.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+HeadlessLauncher::HeadlessLauncher(LauncherConfig config, int tabStripHeight)
+    : m_config(std::move(config)), m_tabStripHeight(tabStripHeight)
+{
+    m_pages.resize(m_config.tabs.size());
+    m_launchCounts.resize(m_config.tabs.size());
+    for (size_t tab = 0; tab < m_config.tabs.size(); ++tab)
+    {
+        m_launchCounts[tab].resize(m_config.tabs[tab].buttons.size());
+    }
+}
+
+/**
+ * @brief Shows a tab, building its page on the first visit and fitting it to the window.
+ * @return False if the tab does not exist.
+ */
+bool HeadlessLauncher::SelectTab(int tab)
+{
+    if (tab < 0 || tab >= m_config.GetTabCount())
+    {
+        return false;
+    }
+    if (tab == m_currentTab)
+    {
+        return true;
+    }
+    if (m_currentTab >= 0)
+    {
+        m_pages[m_currentTab].lastVisit = ++m_visitClock;
+    }
+    EnsurePageLoaded(tab);
+    LayoutPage(tab);
+    m_currentTab = tab;
+    m_pages[tab].lastVisit = ++m_visitClock;
+    return true;
+}
+
+/**
+ * @brief Resizes the window to the given client size. Only the current page is laid out;
+ *        the others are when they are shown.
+ */
+void HeadlessLauncher::Resize(int width, int height)
+{
+    m_width = (std::max)(width, 0);
+    m_height = (std::max)(height, 0);
+    if (m_currentTab >= 0)
+    {
+        LayoutPage(m_currentTab);
+    }
+}
+
+/**
+ * @brief Counts a launch and formats its usage file entry.
+ * @return False if the button does not exist or has no target.
+ */
+bool HeadlessLauncher::Launch(int tab, int button)
+{
+    if (!IsValidButton(tab, button) || m_config.tabs[tab].buttons[button].path.empty())
+    {
+        return false;
+    }
+    unsigned int count = ++m_launchCounts[tab][button];
+    m_lastUsageEntry = L"[Tab" + std::to_wstring(tab) + L"] Button" + std::to_wstring(button) + L"_Launches=" + std::to_wstring(count);
+    return true;
+}
+
+/**
+ * @brief Renames a button, then saves and reloads the configuration as the settings
+ *        dialog and the file watcher do, and applies the differences to the loaded pages.
+ * @return False if the button does not exist.
+ */
+bool HeadlessLauncher::EditButton(int tab, int button)
+{
+    if (!IsValidButton(tab, button))
+    {
+        return false;
+    }
+    LauncherConfig edited = m_config;
+    std::wstring& name = edited.tabs[tab].buttons[button].name;
+    name = (name.size() >= 2 && name.compare(name.size() - 2, 2, L" *") == 0) ? name.substr(0, name.size() - 2) : name + L" *";
+
+    IniDocument base;
+    IniDocument saved;
+    saved.Parse(FormatLauncherConfig(edited));
+    LauncherConfig reloaded = ParseLauncherConfig(base, saved);
+
+    ConfigDiff diff = DiffConfigs(m_config, reloaded);
+    for (const ButtonChange& change : diff.changedButtons)
+    {
+        Page& page = m_pages[change.tab];
+        if (page.isLoaded && change.button < static_cast<int>(page.labels.size()))
+        {
+            page.labels[change.button] = reloaded.tabs[change.tab].buttons[change.button].name;
+        }
+    }
+    m_config.tabs[tab].buttons[button] = reloaded.tabs[tab].buttons[button];
+    return true;
+}
+
+int HeadlessLauncher::GetLoadedPageCount() const
+{
+    return static_cast<int>(std::count_if(m_pages.begin(), m_pages.end(), [](const Page& page) { return page.isLoaded; }));
+}
+
+/**
+ * @brief Returns the button cells of a tab's page, or nullptr if the page is not loaded.
+ */
+const std::vector<GridRect>* HeadlessLauncher::GetPageLayout(int tab) const
+{
+    return (tab >= 0 && tab < static_cast<int>(m_pages.size()) && m_pages[tab].isLoaded) ? &m_pages[tab].cells : nullptr;
+}
+
+bool HeadlessLauncher::IsValidButton(int tab, int button) const
+{
+    return tab >= 0 && tab < m_config.GetTabCount() &&
+        button >= 0 && button < static_cast<int>(m_config.tabs[tab].buttons.size());
+}
+
+void HeadlessLauncher::EnsurePageLoaded(int tab)
+{
+    Page& page = m_pages[tab];
+    if (page.isLoaded)
+    {
+        return;
+    }
+    const TabConfig& config = m_config.tabs[tab];
+    page.isLoaded = true;
+    page.labels.clear();
+    page.labels.reserve(config.buttons.size());
+    for (const ButtonConfig& button : config.buttons)
+    {
+        page.labels.push_back(button.name);
+    }
+    page.cells.assign(config.buttons.size(), GridRect());
+    page.layoutArea = GridRect{ -1, -1, -1, -1 };
+    EnforceResourceLimits(tab);
+}
+
+void HeadlessLauncher::LayoutPage(int tab)
+{
+    Page& page = m_pages[tab];
+    GridRect area = GetButtonArea();
+    if (!page.isLoaded || page.layoutArea == area)
+    {
+        return;
+    }
+    GridRect pageRect = { 0, 0, area.right - area.left, area.bottom - area.top };
+    const TabConfig& config = m_config.tabs[tab];
+    for (int i = 0; i < static_cast<int>(page.cells.size()); ++i)
+    {
+        page.cells[i] = GetGridCell(pageRect, config.buttonRows, config.buttonCols, i);
+    }
+    page.layoutArea = area;
+}
+
+/**
+ * @brief Releases the least recently visited pages over the [Resources] budget, counting
+ *        an icon per button with a target and a window per button and page.
+ */
+void HeadlessLauncher::EnforceResourceLimits(int pinnedTab)
+{
+    std::vector<PageUsage> pages;
+    int64_t liveIcons = 0;
+    int64_t liveWindows = 0;
+    for (int tab = 0; tab < static_cast<int>(m_pages.size()); ++tab)
+    {
+        if (!m_pages[tab].isLoaded) continue;
+
+        PageUsage usage;
+        usage.tab = tab;
+        usage.windows = 1 + static_cast<int64_t>(m_pages[tab].labels.size());
+        usage.icons = std::count_if(m_config.tabs[tab].buttons.begin(), m_config.tabs[tab].buttons.end(),
+            [](const ButtonConfig& button) { return !button.path.empty(); });
+        usage.lastVisit = m_pages[tab].lastVisit;
+        liveIcons += usage.icons;
+        liveWindows += usage.windows;
+        pages.push_back(usage);
+    }
+
+    ResourceLimits limits;
+    limits.maxIcons = m_config.resources.maxIcons;
+    limits.maxWindows = m_config.resources.maxWindows;
+    for (int tab : ResourceAccountant::SelectPagesOverLimits(std::move(pages), limits, liveIcons, liveWindows, pinnedTab))
+    {
+        m_pages[tab] = Page();
+    }
+}
+
+GridRect HeadlessLauncher::GetButtonArea() const
+{
+    return { 0, (std::min)(m_tabStripHeight, m_height), m_width, m_height };
+}
+
+/**
+ * @brief Formats the report as a table with one row per kind of interaction; latencies in
+ *        microseconds.
+ */
+std::string InteractionReplayReport::Format() const
+{
+    std::string report;
+    char line[160];
+    std::snprintf(line, sizeof(line), "Replayed %zu events (%zu skipped) of a %.1f s session\n", replayed, skipped, sessionMs / 1000.0);
+    report += line;
+    std::snprintf(line, sizeof(line), "%-12s %8s %10s %10s %10s %10s\n", "Interaction", "Count", "p50", "p90", "p99", "Max");
+    report += line;
+    for (int kind = 0; kind < INTERACTION_KIND_COUNT; ++kind)
+    {
+        const LatencyHistogram& histogram = latency[kind];
+        std::snprintf(line, sizeof(line), "%-12s %8llu %10.2f %10.2f %10.2f %10.2f\n", GetInteractionKindName(static_cast<InteractionKind>(kind)),
+            static_cast<unsigned long long>(histogram.GetCount()), histogram.GetPercentile(50) / 1000.0, histogram.GetPercentile(90) / 1000.0,
+            histogram.GetPercentile(99) / 1000.0, histogram.GetMax() / 1000.0);
+        report += line;
+    }
+    return report;
+}
+
+/**
+ * @brief Replays a recorded session against a headless launcher, back to back rather than
+ *        at the recorded pace, and times every event.
+ * @param config The configuration to replay against, normally the one it was recorded with.
+ * @param trace The recorded session.
+ * @param repetitions How often to replay the session, each time from a fresh launcher.
+ * @return The latencies of all repetitions together.
+ */
+InteractionReplayReport ReplayInteractions(const LauncherConfig& config, const InteractionTrace& trace, int repetitions)
+{
+    using Clock = std::chrono::steady_clock;
+
+    InteractionReplayReport report;
+    report.sessionMs = trace.events.empty() ? 0 : trace.events.back().timeMs;
+    for (int repetition = 0; repetition < repetitions; ++repetition)
+    {
+        HeadlessLauncher launcher(config, trace.tabStripHeight);
+        for (const InteractionEvent& event : trace.events)
+        {
+            Clock::time_point start = Clock::now();
+            bool handled = true;
+            switch (event.kind)
+            {
+            case InteractionKind::SelectTab: handled = launcher.SelectTab(event.a); break;
+            case InteractionKind::Resize: launcher.Resize(event.a, event.b); break;
+            case InteractionKind::Launch: handled = launcher.Launch(event.a, event.b); break;
+            case InteractionKind::EditButton: handled = launcher.EditButton(event.a, event.b); break;
+            }
+            Clock::time_point end = Clock::now();
+
+            if (!handled)
+            {
+                report.skipped++;
+                continue;
+            }
+            report.replayed++;
+            int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            report.latency[static_cast<int>(event.kind)].Record(static_cast<uint64_t>((std::max)(nanoseconds, int64_t{ 0 })));
+        }
+    }
+    return report;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ConfigModel.h"
+#include "GridLayout.h"
+#include "InteractionTrace.h"
+#include "LatencyHistogram.h"
+
+/**
+ * @brief The launcher's tab, layout and configuration logic without any windows.
+ *
+ * Mirrors what the main window does for each recorded interaction: pages are built on the
+ * first visit and released over the [Resources] budget, the current page is laid out again
+ * when the window is resized and other pages when they are shown, launches are counted
+ * for the usage file, and an edited button is saved and the configuration reloaded and
+ * diffed as the file watcher does. Window and shell calls are left out, so replays run on
+ * any platform and measure the launcher's own code only.
+ */
+class HeadlessLauncher
+{
+public:
+    HeadlessLauncher(LauncherConfig config, int tabStripHeight);
+
+    bool SelectTab(int tab);
+    void Resize(int width, int height);
+    bool Launch(int tab, int button);
+    bool EditButton(int tab, int button);
+
+    int GetCurrentTab() const { return m_currentTab; }
+    int GetLoadedPageCount() const;
+    const std::vector<GridRect>* GetPageLayout(int tab) const;
+
+private:
+    struct Page
+    {
+        bool isLoaded{ false };
+        std::vector<std::wstring> labels;   // Button texts, as set on the button windows
+        std::vector<GridRect> cells;
+        GridRect layoutArea;
+        uint64_t lastVisit{ 0 };
+    };
+
+    bool IsValidButton(int tab, int button) const;
+    void EnsurePageLoaded(int tab);
+    void LayoutPage(int tab);
+    void EnforceResourceLimits(int pinnedTab);
+    GridRect GetButtonArea() const;
+
+    LauncherConfig m_config;
+    std::vector<Page> m_pages;
+    std::vector<std::vector<unsigned int>> m_launchCounts;
+    std::wstring m_lastUsageEntry;      // What the last launch wrote to the usage file
+    int m_tabStripHeight{ 0 };
+    int m_width{ 0 };
+    int m_height{ 0 };
+    int m_currentTab{ -1 };
+    uint64_t m_visitClock{ 0 };
+};
+
+// Latencies of a replay, per kind of interaction.
+struct InteractionReplayReport
+{
+    std::array<LatencyHistogram, INTERACTION_KIND_COUNT> latency;  // In nanoseconds
+    size_t replayed{ 0 };
+    size_t skipped{ 0 };    // Events for tabs or buttons the configuration does not have
+    uint32_t sessionMs{ 0 }; // Length of the recorded session
+
+    std::string Format() const;
+};
+
+InteractionReplayReport ReplayInteractions(const LauncherConfig& config, const InteractionTrace& trace, int repetitions);
@@ -0,0 +1,198 @@
+#include "InteractionTrace.h"
+#include "ConfigModel.h"
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+    const char TRACE_MAGIC[] = { 'M', 'T', 'L', 'I' };
+    const uint8_t TRACE_VERSION = 1;
+
+    const char* const KIND_NAMES[INTERACTION_KIND_COUNT] = { "SelectTab", "Resize", "Launch", "EditButton" };
+
+    void AppendVarint(std::string& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    bool ReadVarint(std::string_view data, size_t& offset, uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && offset < data.size(); shift += 7)
+        {
+            uint8_t byte = static_cast<uint8_t>(data[offset++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Zigzag encoding keeps small negative arguments short
+    uint64_t EncodeSigned(int32_t value)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(value)) << 1) ^ static_cast<uint64_t>(value < 0 ? -1 : 0);
+    }
+
+    int32_t DecodeSigned(uint64_t value)
+    {
+        return static_cast<int32_t>(static_cast<uint32_t>(value >> 1) ^ (0u - static_cast<uint32_t>(value & 1)));
+    }
+}
+
+const char* GetInteractionKindName(InteractionKind kind)
+{
+    int index = static_cast<int>(kind);
+    return index >= 0 && index < INTERACTION_KIND_COUNT ? KIND_NAMES[index] : "Unknown";
+}
+
+/**
+ * @brief Encodes the trace in the binary file format.
+ */
+std::string InteractionTrace::Serialize() const
+{
+    std::string out(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    out += static_cast<char>(TRACE_VERSION);
+    AppendVarint(out, EncodeSigned(tabStripHeight));
+
+    uint32_t previousTime = 0;
+    for (const InteractionEvent& event : events)
+    {
+        out += static_cast<char>(event.kind);
+        AppendVarint(out, event.timeMs >= previousTime ? event.timeMs - previousTime : 0);
+        AppendVarint(out, EncodeSigned(event.a));
+        AppendVarint(out, EncodeSigned(event.b));
+        previousTime = (std::max)(previousTime, event.timeMs);
+    }
+    return out;
+}
+
+/**
+ * @brief Decodes a trace written by Serialize().
+ * @return True on success, false if the data is not a trace or is cut off.
+ */
+bool InteractionTrace::Parse(std::string_view data)
+{
+    events.clear();
+    tabStripHeight = 0;
+    if (data.size() < sizeof(TRACE_MAGIC) + 1 || data.substr(0, sizeof(TRACE_MAGIC)) != std::string_view(TRACE_MAGIC, sizeof(TRACE_MAGIC)) ||
+        static_cast<uint8_t>(data[sizeof(TRACE_MAGIC)]) != TRACE_VERSION)
+    {
+        return false;
+    }
+
+    size_t offset = sizeof(TRACE_MAGIC) + 1;
+    uint64_t value = 0;
+    if (!ReadVarint(data, offset, value))
+    {
+        return false;
+    }
+    tabStripHeight = DecodeSigned(value);
+
+    uint64_t time = 0;
+    while (offset < data.size())
+    {
+        InteractionEvent event;
+        uint8_t kind = static_cast<uint8_t>(data[offset++]);
+        uint64_t delta = 0, a = 0, b = 0;
+        if (kind >= INTERACTION_KIND_COUNT || !ReadVarint(data, offset, delta) || !ReadVarint(data, offset, a) || !ReadVarint(data, offset, b))
+        {
+            events.clear();
+            return false;
+        }
+        time += delta;
+        event.timeMs = static_cast<uint32_t>((std::min)(time, uint64_t{ UINT32_MAX }));
+        event.kind = static_cast<InteractionKind>(kind);
+        event.a = DecodeSigned(a);
+        event.b = DecodeSigned(b);
+        events.push_back(event);
+    }
+    return true;
+}
+
+/**
+ * @brief Builds a session that exercises a configuration the way a user working through
+ *        it would: open the window, visit every tab and launch from it, drag the window
+ *        larger and back, edit a few buttons and jump between tabs.
+ *
+ * The result only depends on the configuration and the seed, so replays of it can be
+ * compared between builds and platforms without a recorded trace.
+ */
+InteractionTrace GenerateSyntheticSession(const LauncherConfig& config, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    InteractionTrace trace;
+    trace.tabStripHeight = 32;
+    uint32_t time = 0;
+    auto add = [&](InteractionKind kind, int a, int b, uint32_t delayMs)
+    {
+        time += delayMs;
+        trace.events.push_back({ time, kind, a, b });
+    };
+    auto launchFrom = [&](int tab)
+    {
+        const std::vector<ButtonConfig>& buttons = config.tabs[tab].buttons;
+        for (int attempt = 0; attempt < 4 && !buttons.empty(); ++attempt)
+        {
+            int button = static_cast<int>(random() % buttons.size());
+            if (!buttons[button].path.empty())
+            {
+                add(InteractionKind::Launch, tab, button, 500 + random() % 1500);
+                return;
+            }
+        }
+    };
+
+    int width = 1280, height = 800;
+    add(InteractionKind::Resize, width, height, 0);
+    if (config.tabs.empty())
+    {
+        return trace;
+    }
+    add(InteractionKind::SelectTab, 0, 0, 0);
+
+    for (int tab = 1; tab < config.GetTabCount(); ++tab)
+    {
+        add(InteractionKind::SelectTab, tab, 0, 200 + random() % 800);
+        launchFrom(tab);
+    }
+
+    // A drag resize sends a WM_SIZE about every frame
+    for (int step = 0; step < 30; ++step)
+    {
+        add(InteractionKind::Resize, width + step * 16, height + step * 9, 16);
+    }
+    for (int step = 30; step >= 0; --step)
+    {
+        add(InteractionKind::Resize, width + step * 16, height + step * 9, 16);
+    }
+
+    for (int edit = 0; edit < 5; ++edit)
+    {
+        int tab = static_cast<int>(random() % config.tabs.size());
+        add(InteractionKind::SelectTab, tab, 0, 1000);
+        if (!config.tabs[tab].buttons.empty())
+        {
+            add(InteractionKind::EditButton, tab, static_cast<int>(random() % config.tabs[tab].buttons.size()), 5000);
+        }
+    }
+
+    for (int jump = 0; jump < 100; ++jump)
+    {
+        int tab = static_cast<int>(random() % config.tabs.size());
+        add(InteractionKind::SelectTab, tab, 0, 300 + random() % 700);
+        if (random() % 3 == 0)
+        {
+            launchFrom(tab);
+        }
+    }
+    return trace;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct LauncherConfig;
+
+// User interactions the main window handles, as recorded for replay.
+enum class InteractionKind : uint8_t
+{
+    SelectTab,      // TCN_SELCHANGE; a = tab
+    Resize,         // WM_SIZE; a = client width, b = client height
+    Launch,         // WM_COMMAND from a button; a = tab, b = button
+    EditButton,     // WM_CONTEXTMENU closed with OK; a = tab, b = button
+};
+const int INTERACTION_KIND_COUNT = 4;
+
+const char* GetInteractionKindName(InteractionKind kind);
+
+struct InteractionEvent
+{
+    uint32_t timeMs{ 0 };   // Since the recording started
+    InteractionKind kind{ InteractionKind::SelectTab };
+    int32_t a{ 0 };
+    int32_t b{ 0 };
+
+    bool operator==(const InteractionEvent&) const = default;
+};
+
+/**
+ * @brief A recorded session of the launcher: what the user did and when.
+ *
+ * Stored in a compact binary file: a header, then per event its kind, the time since the
+ * previous event and its two arguments as variable-length integers, which comes to about
+ * five bytes per event. Window sizes are in pixels of the recording session.
+ */
+struct InteractionTrace
+{
+    int tabStripHeight{ 0 };    // Height of the tab strip above the buttons, in pixels
+    std::vector<InteractionEvent> events;
+
+    std::string Serialize() const;
+    bool Parse(std::string_view data);
+};
+
+InteractionTrace GenerateSyntheticSession(const LauncherConfig& config, uint32_t seed);
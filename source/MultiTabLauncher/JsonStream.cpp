@@ -0,0 +1,699 @@
+#include "JsonStream.h"
+#include "TextKernels.h"
+
+#include <limits>
+
+namespace
+{
+    const uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+    bool IsDigit(char ch)
+    {
+        return ch >= '0' && ch <= '9';
+    }
+
+    bool EndsString(char ch)
+    {
+        return ch == '"' || ch == '\\' || static_cast<unsigned char>(ch) < 0x20;
+    }
+
+    void AppendCodePoint(uint32_t codePoint, std::string& bytes)
+    {
+        if (codePoint < 0x80)
+        {
+            bytes += static_cast<char>(codePoint);
+            return;
+        }
+        if (codePoint < 0x800)
+        {
+            bytes += static_cast<char>(0xC0 | (codePoint >> 6));
+        }
+        else if (codePoint < 0x10000)
+        {
+            bytes += static_cast<char>(0xE0 | (codePoint >> 12));
+            bytes += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        }
+        else
+        {
+            bytes += static_cast<char>(0xF0 | (codePoint >> 18));
+            bytes += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            bytes += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        }
+        bytes += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+
+    /**
+     * @brief Checks a number against the JSON grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+     */
+    bool IsValidNumber(std::string_view text)
+    {
+        size_t i = 0;
+        auto digits = [&]()
+            {
+                size_t start = i;
+                while (i < text.size() && IsDigit(text[i])) ++i;
+                return i > start;
+            };
+
+        if (i < text.size() && text[i] == '-') ++i;
+        if (i < text.size() && text[i] == '0')
+        {
+            ++i;
+        }
+        else if (!digits())
+        {
+            return false;
+        }
+        if (i < text.size() && text[i] == '.')
+        {
+            ++i;
+            if (!digits()) return false;
+        }
+        if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+        {
+            ++i;
+            if (i < text.size() && (text[i] == '+' || text[i] == '-')) ++i;
+            if (!digits()) return false;
+        }
+        return i == text.size();
+    }
+}
+
+// =============================================================
+//                          JsonReader
+// =============================================================
+
+/**
+ * @brief Reads a document that is already in memory; the text must outlive Parse().
+ */
+JsonReader::JsonReader(std::string_view text)
+    : m_blockStart(text.data()), m_position(text.data()), m_end(text.data() + text.size())
+{
+}
+
+/**
+ * @brief Reads the whole document and reports it to the handler.
+ * @param handler Receives the document; may stop the reader by returning false.
+ * @return True if the document was read completely, false on a syntax error or when the
+ *         handler stopped; GetError() and GetErrorOffset() tell where.
+ */
+bool JsonReader::Parse(JsonHandler& handler)
+{
+    if (m_stream)
+    {
+        m_block.resize(READ_BLOCK_SIZE);
+        m_blockStart = m_position = m_end = m_block.data();
+        m_blockOffset = 0;
+    }
+    m_containers.clear();
+    m_error.clear();
+    m_errorOffset = 0;
+
+    // Editors and PowerShell on Windows like to start UTF-8 files with a byte order mark
+    char ch;
+    if (Peek(ch) && ch == '\xEF')
+    {
+        if (!ReadLiteral("\xEF\xBB\xBF")) return false;
+    }
+
+    bool expectValue = true;
+    while (true)
+    {
+        SkipWhitespace();
+        if (expectValue)
+        {
+            if (!Peek(ch))
+            {
+                return Fail(m_containers.empty() ? "The document is empty" : "Unexpected end of the document");
+            }
+
+            std::string_view text;
+            bool accepted = true;
+            if (ch == '{' || ch == '[')
+            {
+                ++m_position;
+                if (m_containers.size() == MAX_DEPTH)
+                {
+                    return Fail("Containers are nested too deeply");
+                }
+                bool isObject = ch == '{';
+                m_containers.push_back(isObject);
+                if (!(isObject ? handler.OnStartObject() : handler.OnStartArray()))
+                {
+                    return Fail("Stopped by the handler");
+                }
+
+                SkipWhitespace();
+                if (Peek(ch) && ch == (isObject ? '}' : ']'))
+                {
+                    ++m_position;
+                    m_containers.pop_back();
+                    accepted = isObject ? handler.OnEndObject() : handler.OnEndArray();
+                }
+                else if (isObject)
+                {
+                    if (!ReadKey(handler)) return false;
+                    continue;
+                }
+                else
+                {
+                    continue;
+                }
+            }
+            else if (ch == '"')
+            {
+                if (!ReadString(text)) return false;
+                accepted = handler.OnString(text);
+            }
+            else if (ch == '-' || IsDigit(ch))
+            {
+                if (!ReadNumber(text)) return false;
+                accepted = handler.OnNumber(text);
+            }
+            else if (ch == 't')
+            {
+                if (!ReadLiteral("true")) return false;
+                accepted = handler.OnBool(true);
+            }
+            else if (ch == 'f')
+            {
+                if (!ReadLiteral("false")) return false;
+                accepted = handler.OnBool(false);
+            }
+            else if (ch == 'n')
+            {
+                if (!ReadLiteral("null")) return false;
+                accepted = handler.OnNull();
+            }
+            else
+            {
+                return Fail("Expected a value");
+            }
+            if (!accepted)
+            {
+                return Fail("Stopped by the handler");
+            }
+            expectValue = false;
+            continue;
+        }
+
+        // After a value: the end of the document, a separator or the end of the container
+        if (m_containers.empty())
+        {
+            return Peek(ch) ? Fail("Unexpected data after the document") : true;
+        }
+        bool inObject = m_containers.back();
+        if (!Next(ch))
+        {
+            return Fail("Unexpected end of the document");
+        }
+        if (ch == ',')
+        {
+            if (inObject)
+            {
+                SkipWhitespace();
+                if (!ReadKey(handler)) return false;
+            }
+            expectValue = true;
+        }
+        else if (ch == (inObject ? '}' : ']'))
+        {
+            m_containers.pop_back();
+            if (!(inObject ? handler.OnEndObject() : handler.OnEndArray()))
+            {
+                return Fail("Stopped by the handler");
+            }
+        }
+        else
+        {
+            --m_position;
+            return Fail(inObject ? "Expected ',' or '}'" : "Expected ',' or ']'");
+        }
+    }
+}
+
+/**
+ * @brief Converts the text of a number to an integer.
+ * @return False for fractions, exponents and values out of range.
+ */
+bool JsonReader::ParseInteger(std::string_view text, int64_t& value)
+{
+    bool negative = !text.empty() && text[0] == '-';
+    size_t i = negative ? 1 : 0;
+    if (i == text.size()) return false;
+
+    uint64_t magnitude = 0;
+    const uint64_t limit = negative ? uint64_t{ 1 } << 63 : static_cast<uint64_t>((std::numeric_limits<int64_t>::max)());
+    for (; i < text.size(); ++i)
+    {
+        if (!IsDigit(text[i])) return false;
+        unsigned digit = static_cast<unsigned>(text[i] - '0');
+        if (magnitude > (limit - digit) / 10) return false;
+        magnitude = magnitude * 10 + digit;
+    }
+    value = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+bool JsonReader::Fail(const char* message)
+{
+    m_error = message;
+    m_errorOffset = m_blockOffset + static_cast<uint64_t>(m_position - m_blockStart);
+    return false;
+}
+
+/**
+ * @brief Replaces the current block with the next one from the stream.
+ * @return False at the end of the document.
+ */
+bool JsonReader::Refill()
+{
+    if (!m_stream || !*m_stream)
+    {
+        return false;
+    }
+    m_blockOffset += static_cast<uint64_t>(m_end - m_blockStart);
+    m_stream->read(m_block.data(), static_cast<std::streamsize>(m_block.size()));
+    m_position = m_blockStart;
+    m_end = m_blockStart + m_stream->gcount();
+    return m_position < m_end;
+}
+
+void JsonReader::SkipWhitespace()
+{
+    do
+    {
+        while (m_position < m_end && (*m_position == ' ' || *m_position == '\n' || *m_position == '\r' || *m_position == '\t'))
+        {
+            ++m_position;
+        }
+    } while (m_position == m_end && Refill());
+}
+
+bool JsonReader::Peek(char& ch)
+{
+    if (m_position == m_end && !Refill())
+    {
+        return false;
+    }
+    ch = *m_position;
+    return true;
+}
+
+bool JsonReader::Next(char& ch)
+{
+    if (!Peek(ch))
+    {
+        return false;
+    }
+    ++m_position;
+    return true;
+}
+
+/**
+ * @brief Reads a member name and the colon after it.
+ */
+bool JsonReader::ReadKey(JsonHandler& handler)
+{
+    char ch;
+    if (!Peek(ch) || ch != '"')
+    {
+        return Fail("Expected a member name");
+    }
+    std::string_view key;
+    if (!ReadString(key)) return false;
+    if (!handler.OnKey(key))
+    {
+        return Fail("Stopped by the handler");
+    }
+    SkipWhitespace();
+    if (!Next(ch) || ch != ':')
+    {
+        return Fail("Expected ':'");
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a string, starting at its opening quote.
+ * @param value Receives the decoded string; valid until the next read.
+ */
+bool JsonReader::ReadString(std::string_view& value)
+{
+    ++m_position;
+
+    // Most strings lie within the block and have no escapes
+    const char* start = m_position;
+    const char* end = start;
+    while (end < m_end && !EndsString(*end)) ++end;
+    if (end < m_end && *end == '"')
+    {
+        value = std::string_view(start, static_cast<size_t>(end - start));
+        m_position = end + 1;
+        return true;
+    }
+
+    m_scratch.assign(start, end);
+    m_position = end;
+    while (true)
+    {
+        char ch;
+        if (!Peek(ch))
+        {
+            return Fail("Unterminated string");
+        }
+        if (ch == '"')
+        {
+            ++m_position;
+            value = m_scratch;
+            return true;
+        }
+        if (ch == '\\')
+        {
+            ++m_position;
+            if (!ReadEscape()) return false;
+            continue;
+        }
+        if (static_cast<unsigned char>(ch) < 0x20)
+        {
+            return Fail("Control character in a string");
+        }
+
+        const char* run = m_position;
+        while (m_position < m_end && !EndsString(*m_position)) ++m_position;
+        m_scratch.append(run, m_position);
+    }
+}
+
+/**
+ * @brief Decodes an escape sequence after its backslash into the scratch string.
+ *        Unpaired surrogates become U+FFFD.
+ */
+bool JsonReader::ReadEscape()
+{
+    char ch;
+    if (!Next(ch))
+    {
+        return Fail("Unterminated string");
+    }
+    switch (ch)
+    {
+    case '"': case '\\': case '/': m_scratch += ch; return true;
+    case 'b': m_scratch += '\b'; return true;
+    case 'f': m_scratch += '\f'; return true;
+    case 'n': m_scratch += '\n'; return true;
+    case 'r': m_scratch += '\r'; return true;
+    case 't': m_scratch += '\t'; return true;
+    case 'u': break;
+    default: return Fail("Invalid escape sequence");
+    }
+
+    uint32_t codePoint;
+    if (!ReadHexQuad(codePoint)) return false;
+    if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+    {
+        // A high surrogate must be followed by an escaped low surrogate
+        char next;
+        if (Peek(next) && next == '\\')
+        {
+            ++m_position;
+            if (!Next(next) || next != 'u')
+            {
+                --m_position;
+                AppendCodePoint(REPLACEMENT_CHARACTER, m_scratch);
+                return ReadEscape();
+            }
+            uint32_t low;
+            if (!ReadHexQuad(low)) return false;
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                AppendCodePoint(0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00), m_scratch);
+                return true;
+            }
+            AppendCodePoint(REPLACEMENT_CHARACTER, m_scratch);
+            codePoint = low;
+            if (codePoint >= 0xD800 && codePoint <= 0xDFFF) codePoint = REPLACEMENT_CHARACTER;
+        }
+        else
+        {
+            codePoint = REPLACEMENT_CHARACTER;
+        }
+    }
+    else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+    {
+        codePoint = REPLACEMENT_CHARACTER;
+    }
+    AppendCodePoint(codePoint, m_scratch);
+    return true;
+}
+
+bool JsonReader::ReadHexQuad(uint32_t& value)
+{
+    value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        char ch;
+        if (!Next(ch))
+        {
+            return Fail("Unterminated string");
+        }
+        uint32_t digit;
+        if (ch >= '0' && ch <= '9') digit = static_cast<uint32_t>(ch - '0');
+        else if (ch >= 'a' && ch <= 'f') digit = static_cast<uint32_t>(ch - 'a' + 10);
+        else if (ch >= 'A' && ch <= 'F') digit = static_cast<uint32_t>(ch - 'A' + 10);
+        else return Fail("Invalid \\u escape");
+        value = value * 16 + digit;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a number.
+ * @param text Receives the text of the number; valid until the next read.
+ */
+bool JsonReader::ReadNumber(std::string_view& text)
+{
+    m_scratch.clear();
+    char ch;
+    while (Peek(ch) && (IsDigit(ch) || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E'))
+    {
+        m_scratch += ch;
+        ++m_position;
+    }
+    if (!IsValidNumber(m_scratch))
+    {
+        return Fail("Invalid number");
+    }
+    text = m_scratch;
+    return true;
+}
+
+bool JsonReader::ReadLiteral(const char* literal)
+{
+    for (; *literal; ++literal)
+    {
+        char ch;
+        if (!Next(ch) || ch != *literal)
+        {
+            return Fail("Expected a value");
+        }
+    }
+    return true;
+}
+
+// =============================================================
+//                          JsonWriter
+// =============================================================
+
+JsonWriter::~JsonWriter()
+{
+    Flush();
+}
+
+void JsonWriter::BeginObject(bool singleLine)
+{
+    BeginContainer('{', singleLine);
+}
+
+void JsonWriter::EndObject()
+{
+    EndContainer('}');
+}
+
+void JsonWriter::BeginArray(bool singleLine)
+{
+    BeginContainer('[', singleLine);
+}
+
+void JsonWriter::EndArray()
+{
+    EndContainer(']');
+}
+
+void JsonWriter::Key(std::string_view key)
+{
+    BeginValue();
+    m_block += '"';
+    AppendEscaped(key);
+    m_block += "\": ";
+    m_afterKey = true;
+}
+
+void JsonWriter::String(std::string_view utf8)
+{
+    BeginValue();
+    m_block += '"';
+    AppendEscaped(utf8);
+    m_block += '"';
+    FlushIfFull();
+}
+
+void JsonWriter::String(std::wstring_view text)
+{
+    BeginValue();
+    m_block += '"';
+    size_t i = 0;
+    while (i < text.size())
+    {
+        // Escapes are all ASCII; other characters are encoded a run at a time
+        size_t run = i;
+        while (run < text.size() && static_cast<uint32_t>(text[run]) >= 0x80) ++run;
+        if (run > i)
+        {
+            AppendUtf8(text.substr(i, run - i), m_block);
+            i = run;
+            continue;
+        }
+        char ch = static_cast<char>(text[i++]);
+        AppendEscaped(std::string_view(&ch, 1));
+    }
+    m_block += '"';
+    FlushIfFull();
+}
+
+void JsonWriter::Integer(int64_t value)
+{
+    BeginValue();
+    m_block += std::to_string(value);
+}
+
+void JsonWriter::Bool(bool value)
+{
+    BeginValue();
+    m_block += value ? "true" : "false";
+}
+
+void JsonWriter::Null()
+{
+    BeginValue();
+    m_block += "null";
+}
+
+/**
+ * @brief Writes what has been produced so far to the stream.
+ * @return False if the stream failed.
+ */
+bool JsonWriter::Flush()
+{
+    m_stream.write(m_block.data(), static_cast<std::streamsize>(m_block.size()));
+    m_block.clear();
+    return !m_stream.fail();
+}
+
+/**
+ * @brief Writes the separator and line break before a value or member, unless it follows its key.
+ */
+void JsonWriter::BeginValue()
+{
+    if (m_afterKey)
+    {
+        m_afterKey = false;
+        return;
+    }
+    if (m_containers.empty())
+    {
+        return;
+    }
+    Container& container = m_containers.back();
+    if (!container.isEmpty)
+    {
+        m_block += ',';
+    }
+    if (!container.singleLine)
+    {
+        NewLine(m_containers.size());
+    }
+    else if (!container.isEmpty)
+    {
+        m_block += ' ';
+    }
+    container.isEmpty = false;
+}
+
+void JsonWriter::BeginContainer(char open, bool singleLine)
+{
+    BeginValue();
+    m_block += open;
+    Container container;
+    container.singleLine = singleLine || (!m_containers.empty() && m_containers.back().singleLine);
+    m_containers.push_back(container);
+}
+
+void JsonWriter::EndContainer(char close)
+{
+    Container container = m_containers.back();
+    m_containers.pop_back();
+    if (!container.isEmpty && !container.singleLine)
+    {
+        NewLine(m_containers.size());
+    }
+    m_block += close;
+    if (m_containers.empty())
+    {
+        m_block += '\n';
+    }
+    FlushIfFull();
+}
+
+void JsonWriter::NewLine(size_t depth)
+{
+    m_block += '\n';
+    m_block.append(depth * 2, ' ');
+}
+
+void JsonWriter::AppendEscaped(std::string_view utf8)
+{
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    for (char ch : utf8)
+    {
+        switch (ch)
+        {
+        case '"': m_block += "\\\""; break;
+        case '\\': m_block += "\\\\"; break;
+        case '\n': m_block += "\\n"; break;
+        case '\r': m_block += "\\r"; break;
+        case '\t': m_block += "\\t"; break;
+        case '\b': m_block += "\\b"; break;
+        case '\f': m_block += "\\f"; break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20)
+            {
+                m_block += "\\u00";
+                m_block += HEX_DIGITS[ch >> 4];
+                m_block += HEX_DIGITS[ch & 0xF];
+            }
+            else
+            {
+                m_block += ch;
+            }
+        }
+    }
+}
+
+void JsonWriter::FlushIfFull()
+{
+    if (m_block.size() >= BLOCK_SIZE)
+    {
+        Flush();
+    }
+}
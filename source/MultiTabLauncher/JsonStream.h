@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Receives the contents of a JSON document from JsonReader, in document order.
+ *
+ * Strings and numbers are passed as views that are only valid during the call. Strings
+ * are UTF-8 with their escapes resolved; numbers are passed as their text, so that
+ * integers are not rounded through a double. Returning false stops the reader.
+ */
+class JsonHandler
+{
+public:
+    virtual ~JsonHandler() = default;
+
+    virtual bool OnStartObject() = 0;
+    virtual bool OnKey(std::string_view key) = 0;
+    virtual bool OnEndObject() = 0;
+    virtual bool OnStartArray() = 0;
+    virtual bool OnEndArray() = 0;
+    virtual bool OnString(std::string_view value) = 0;
+    virtual bool OnNumber(std::string_view text) = 0;
+    virtual bool OnBool(bool value) = 0;
+    virtual bool OnNull() = 0;
+};
+
+/**
+ * @brief Reads JSON (RFC 8259) in a single pass and reports it to a JsonHandler, without
+ *        building a tree.
+ *
+ * A stream is read in blocks of READ_BLOCK_SIZE bytes, so memory use does not grow with
+ * the document: only the current block, one string that crosses a block or contains
+ * escapes, and the nesting of containers are held. Strings that lie within a block and
+ * have no escapes are passed straight from the block. Invalid UTF-8 is passed through.
+ */
+class JsonReader
+{
+public:
+    static const size_t READ_BLOCK_SIZE = 64 * 1024;
+    static const size_t MAX_DEPTH = 256;
+
+    explicit JsonReader(std::istream& stream) : m_stream(&stream) {}
+    explicit JsonReader(std::string_view text);
+
+    JsonReader(const JsonReader&) = delete;
+    JsonReader& operator=(const JsonReader&) = delete;
+
+    bool Parse(JsonHandler& handler);
+
+    const std::string& GetError() const { return m_error; }
+    uint64_t GetErrorOffset() const { return m_errorOffset; }
+
+    static bool ParseInteger(std::string_view text, int64_t& value);
+
+private:
+    bool Fail(const char* message);
+    bool Refill();
+    void SkipWhitespace();
+    bool Peek(char& ch);
+    bool Next(char& ch);
+    bool ReadKey(JsonHandler& handler);
+    bool ReadString(std::string_view& value);
+    bool ReadEscape();
+    bool ReadHexQuad(uint32_t& value);
+    bool ReadNumber(std::string_view& text);
+    bool ReadLiteral(const char* literal);
+
+    std::istream* m_stream{ nullptr };  // Null when reading from memory
+    std::vector<char> m_block;
+    const char* m_blockStart{ nullptr };
+    const char* m_position{ nullptr };
+    const char* m_end{ nullptr };
+    uint64_t m_blockOffset{ 0 };        // Offset of the current block in the document
+
+    std::string m_scratch;              // Strings that cross a block or contain escapes
+    std::vector<bool> m_containers;     // True for objects, false for arrays
+
+    std::string m_error;
+    uint64_t m_errorOffset{ 0 };
+};
+
+/**
+ * @brief Writes JSON to a stream as it is produced, in blocks of about BLOCK_SIZE bytes.
+ *
+ * Containers are indented by two spaces per level with one member per line; containers
+ * opened with singleLine set, and everything in them, stay on one line. Wide strings are
+ * written as UTF-8. The caller is responsible for a well-formed sequence of calls.
+ */
+class JsonWriter
+{
+public:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    explicit JsonWriter(std::ostream& stream) : m_stream(stream) {}
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void BeginObject(bool singleLine = false);
+    void EndObject();
+    void BeginArray(bool singleLine = false);
+    void EndArray();
+    void Key(std::string_view key);
+    void String(std::string_view utf8);
+    void String(std::wstring_view text);
+    void Integer(int64_t value);
+    void Bool(bool value);
+    void Null();
+
+    bool Flush();
+
+private:
+    struct Container
+    {
+        bool singleLine{ false };
+        bool isEmpty{ true };
+    };
+
+    void BeginValue();
+    void BeginContainer(char open, bool singleLine);
+    void EndContainer(char close);
+    void NewLine(size_t depth);
+    void AppendEscaped(std::string_view utf8);
+    void FlushIfFull();
+
+    std::ostream& m_stream;
+    std::string m_block;
+    std::vector<Container> m_containers;
+    bool m_afterKey{ false };
+};
@@ -0,0 +1,210 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace
+{
+    const int SUB_BUCKET_BITS = 6;
+    const uint64_t SUB_BUCKET_COUNT = uint64_t{ 1 } << SUB_BUCKET_BITS;
+    const uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+
+    bool ParseNumber(std::wstring_view text, uint64_t& value)
+    {
+        if (text.empty() || text.size() > 19) return false;
+        value = 0;
+        for (wchar_t ch : text)
+        {
+            if (ch < L'0' || ch > L'9') return false;
+            value = value * 10 + (ch - L'0');
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Returns the bucket a value is counted in.
+ */
+size_t LatencyHistogram::GetBucketIndex(uint64_t value)
+{
+    value = (std::min)(value, MAX_VALUE);
+    if (value < SUB_BUCKET_COUNT)
+    {
+        return static_cast<size_t>(value);
+    }
+    int shift = std::bit_width(value) - SUB_BUCKET_BITS;
+    return static_cast<size_t>(SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF + ((value >> shift) - SUB_BUCKET_HALF));
+}
+
+/**
+ * @brief Returns the smallest value counted in a bucket.
+ */
+uint64_t LatencyHistogram::GetBucketLowest(size_t index)
+{
+    if (index < SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+    uint64_t offset = index - SUB_BUCKET_COUNT;
+    int shift = static_cast<int>(offset / SUB_BUCKET_HALF) + 1;
+    return (offset % SUB_BUCKET_HALF + SUB_BUCKET_HALF) << shift;
+}
+
+/**
+ * @brief Returns the largest value counted in a bucket.
+ */
+uint64_t LatencyHistogram::GetBucketHighest(size_t index)
+{
+    if (index < SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+    int shift = static_cast<int>((index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF) + 1;
+    return GetBucketLowest(index) + (uint64_t{ 1 } << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t microseconds)
+{
+    size_t index = GetBucketIndex(microseconds);
+    if (index >= m_counts.size())
+    {
+        m_counts.resize(index + 1);
+    }
+    if (m_counts[index] != UINT32_MAX)
+    {
+        ++m_counts[index];
+        ++m_totalCount;
+    }
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+    if (other.m_counts.size() > m_counts.size())
+    {
+        m_counts.resize(other.m_counts.size());
+    }
+    m_totalCount = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i)
+    {
+        uint64_t sum = uint64_t{ m_counts[i] } + (i < other.m_counts.size() ? other.m_counts[i] : 0);
+        m_counts[i] = static_cast<uint32_t>((std::min)(sum, uint64_t{ UINT32_MAX }));
+        m_totalCount += m_counts[i];
+    }
+}
+
+void LatencyHistogram::Clear()
+{
+    m_counts.clear();
+    m_totalCount = 0;
+}
+
+/**
+ * @brief Returns the value below which the given share of the recorded values lie.
+ * @param percentile The share in percent, from 0 to 100.
+ * @return The highest value of the bucket the percentile falls in; 0 if nothing was recorded.
+ */
+uint64_t LatencyHistogram::GetPercentile(double percentile) const
+{
+    if (m_totalCount == 0)
+    {
+        return 0;
+    }
+    percentile = (std::clamp)(percentile, 0.0, 100.0);
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(m_totalCount)));
+    rank = (std::clamp)(rank, uint64_t{ 1 }, m_totalCount);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i)
+    {
+        seen += m_counts[i];
+        if (seen >= rank)
+        {
+            return GetBucketHighest(i);
+        }
+    }
+    return GetMax();
+}
+
+uint64_t LatencyHistogram::GetMax() const
+{
+    for (size_t i = m_counts.size(); i > 0; --i)
+    {
+        if (m_counts[i - 1] != 0) return GetBucketHighest(i - 1);
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the mean, taking the middle of each bucket for its values.
+ */
+double LatencyHistogram::GetMean() const
+{
+    if (m_totalCount == 0)
+    {
+        return 0;
+    }
+    double sum = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i)
+    {
+        if (m_counts[i] == 0) continue;
+        double middle = (static_cast<double>(GetBucketLowest(i)) + static_cast<double>(GetBucketHighest(i))) / 2;
+        sum += middle * m_counts[i];
+    }
+    return sum / static_cast<double>(m_totalCount);
+}
+
+/**
+ * @brief Writes the non-empty buckets as "index:count" pairs separated by ',', short
+ *        enough to be kept as a single INI value.
+ */
+std::wstring LatencyHistogram::Serialize() const
+{
+    std::wstring text;
+    for (size_t i = 0; i < m_counts.size(); ++i)
+    {
+        if (m_counts[i] == 0) continue;
+        if (!text.empty()) text += L',';
+        text += std::to_wstring(i);
+        text += L':';
+        text += std::to_wstring(m_counts[i]);
+    }
+    return text;
+}
+
+/**
+ * @brief Reads a histogram written by Serialize(), replacing the recorded values.
+ * @return True on success. On failure the histogram is left empty.
+ */
+bool LatencyHistogram::Parse(std::wstring_view text)
+{
+    Clear();
+    const size_t maxIndex = GetBucketIndex(MAX_VALUE);
+    while (!text.empty())
+    {
+        size_t comma = text.find(L',');
+        std::wstring_view item = text.substr(0, comma);
+        text = comma == std::wstring_view::npos ? std::wstring_view() : text.substr(comma + 1);
+
+        size_t colon = item.find(L':');
+        uint64_t index = 0;
+        uint64_t count = 0;
+        if (colon == std::wstring_view::npos || !ParseNumber(item.substr(0, colon), index) ||
+            !ParseNumber(item.substr(colon + 1), count) || index > maxIndex)
+        {
+            Clear();
+            return false;
+        }
+        if (index >= m_counts.size())
+        {
+            m_counts.resize(static_cast<size_t>(index) + 1);
+        }
+        uint64_t sum = uint64_t{ m_counts[index] } + count;
+        m_counts[index] = static_cast<uint32_t>((std::min)(sum, uint64_t{ UINT32_MAX }));
+    }
+    for (uint32_t count : m_counts)
+    {
+        m_totalCount += count;
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief A histogram of durations in microseconds with a bounded relative error.
+ *
+ * Values below 64 are counted exactly. Above that, every power of two is split into 32
+ * buckets, so a value is off by at most 1/32 (about 3%) of itself, as in an HDR
+ * histogram with two significant digits. The buckets are only allocated up to the
+ * largest recorded value; a program that starts within a second needs about 2 KB.
+ * Percentiles report the highest value of their bucket, so they never understate.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr uint64_t MAX_VALUE = (uint64_t{ 1 } << 36) - 1;  // About 19 hours; larger values are clamped
+
+    void Record(uint64_t microseconds);
+    void Merge(const LatencyHistogram& other);
+    void Clear();
+
+    bool IsEmpty() const { return m_totalCount == 0; }
+    uint64_t GetCount() const { return m_totalCount; }
+    uint64_t GetPercentile(double percentile) const;
+    uint64_t GetMax() const;
+    double GetMean() const;
+
+    std::wstring Serialize() const;
+    bool Parse(std::wstring_view text);
+
+    bool operator==(const LatencyHistogram&) const = default;
+
+    static size_t GetBucketIndex(uint64_t value);
+    static uint64_t GetBucketLowest(size_t index);
+    static uint64_t GetBucketHighest(size_t index);
+
+private:
+    std::vector<uint32_t> m_counts;     // Saturate at UINT32_MAX
+    uint64_t m_totalCount{ 0 };
+};
@@ -0,0 +1,256 @@
+#include "LaunchProfile.h"
+#include "TextKernels.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <vector>
+
+namespace
+{
+    const std::wstring_view PRIORITY_NAMES[] = { L"Normal", L"Idle", L"BelowNormal", L"AboveNormal", L"High" };
+
+    const int MAX_PROCESSOR = 63;
+
+    bool EqualsIgnoreCase(std::wstring_view a, std::wstring_view b)
+    {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (std::towupper(a[i]) != std::towupper(b[i])) return false;
+        }
+        return true;
+    }
+
+    // Orders variable names as CreateProcess expects: case-insensitive, by code unit
+    bool LessIgnoreCase(std::wstring_view a, std::wstring_view b)
+    {
+        size_t length = (std::min)(a.size(), b.size());
+        for (size_t i = 0; i < length; ++i)
+        {
+            wint_t x = std::towupper(a[i]);
+            wint_t y = std::towupper(b[i]);
+            if (x != y) return x < y;
+        }
+        return a.size() < b.size();
+    }
+
+    /**
+     * @brief Returns the name of an environment entry. Names may start with '=', as in the
+     *        per-drive current directories ("=C:=C:\Windows") that cmd.exe keeps.
+     */
+    std::wstring_view GetVariableName(std::wstring_view entry)
+    {
+        size_t equals = entry.find(L'=', 1);
+        return entry.substr(0, equals);
+    }
+
+    std::vector<std::wstring>::iterator FindVariable(std::vector<std::wstring>& entries, std::wstring_view name)
+    {
+        return std::find_if(entries.begin(), entries.end(), [&](const std::wstring& entry)
+            {
+                return EqualsIgnoreCase(GetVariableName(entry), name);
+            });
+    }
+
+    /**
+     * @brief Replaces %NAME% references with the variable's value, as ExpandEnvironmentStrings
+     *        does; references to variables that are not set are kept as they are.
+     */
+    std::wstring ExpandVariables(std::wstring_view text, std::vector<std::wstring>& entries)
+    {
+        std::wstring expanded;
+        size_t position = 0;
+        while (position < text.size())
+        {
+            size_t open = text.find(L'%', position);
+            size_t close = open == std::wstring_view::npos ? open : text.find(L'%', open + 1);
+            if (close == std::wstring_view::npos)
+            {
+                break;
+            }
+            expanded.append(text.substr(position, open - position));
+            std::wstring_view name = text.substr(open + 1, close - open - 1);
+            auto variable = name.empty() ? entries.end() : FindVariable(entries, name);
+            if (variable != entries.end())
+            {
+                expanded.append(std::wstring_view(*variable).substr(name.size() + 1));
+                position = close + 1;
+            }
+            else
+            {
+                // The closing '%' may open the next reference
+                expanded.append(text.substr(open, close - open));
+                position = close;
+            }
+        }
+        expanded.append(text.substr((std::min)(position, text.size())));
+        return expanded;
+    }
+}
+
+/**
+ * @brief Reads a priority class name (Idle, BelowNormal, Normal, AboveNormal or High).
+ * @param text The name, in any case; empty for Normal.
+ * @param priority Receives the priority; unchanged if the name is unknown.
+ * @return True if the name is known, false otherwise.
+ */
+bool ParseLaunchPriority(std::wstring_view text, LaunchPriority& priority)
+{
+    text = TrimBlanks(text);
+    if (text.empty())
+    {
+        priority = LaunchPriority::Normal;
+        return true;
+    }
+    for (size_t i = 0; i < std::size(PRIORITY_NAMES); ++i)
+    {
+        if (EqualsIgnoreCase(text, PRIORITY_NAMES[i]))
+        {
+            priority = static_cast<LaunchPriority>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const wchar_t* GetLaunchPriorityName(LaunchPriority priority)
+{
+    return PRIORITY_NAMES[static_cast<size_t>(priority)].data();
+}
+
+/**
+ * @brief Reads a list of processor numbers and ranges, such as "0-3,8".
+ * @param text The list; empty for all processors.
+ * @param mask Receives one bit per processor, 0 for all; unchanged if the list is invalid.
+ * @return True if the list is valid, false otherwise.
+ */
+bool ParseAffinityMask(std::wstring_view text, uint64_t& mask)
+{
+    auto parseProcessor = [](std::wstring_view number, int& processor)
+        {
+            number = TrimBlanks(number);
+            if (number.empty() || number.size() > 2) return false;
+            processor = 0;
+            for (wchar_t ch : number)
+            {
+                if (ch < L'0' || ch > L'9') return false;
+                processor = processor * 10 + (ch - L'0');
+            }
+            return processor <= MAX_PROCESSOR;
+        };
+
+    uint64_t result = 0;
+    if (!TrimBlanks(text).empty())
+    {
+        while (true)
+        {
+            size_t comma = text.find(L',');
+            std::wstring_view item = text.substr(0, comma);
+            size_t dash = item.find(L'-');
+            int first = 0;
+            int last = 0;
+            if (!parseProcessor(item.substr(0, dash), first)) return false;
+            last = first;
+            if (dash != std::wstring_view::npos && (!parseProcessor(item.substr(dash + 1), last) || last < first)) return false;
+            for (int processor = first; processor <= last; ++processor)
+            {
+                result |= uint64_t{ 1 } << processor;
+            }
+            if (comma == std::wstring_view::npos) break;
+            text.remove_prefix(comma + 1);
+        }
+    }
+    mask = result;
+    return true;
+}
+
+/**
+ * @brief Writes an affinity mask in the form ParseAffinityMask() reads, such as "0-3,8".
+ */
+std::wstring FormatAffinityMask(uint64_t mask)
+{
+    std::wstring text;
+    int processor = 0;
+    while (processor <= MAX_PROCESSOR)
+    {
+        if ((mask >> processor & 1) == 0)
+        {
+            ++processor;
+            continue;
+        }
+        int last = processor;
+        while (last < MAX_PROCESSOR && (mask >> (last + 1) & 1) != 0) ++last;
+
+        if (!text.empty()) text += L',';
+        text += std::to_wstring(processor);
+        if (last > processor) text += L'-' + std::to_wstring(last);
+        processor = last + 1;
+    }
+    return text;
+}
+
+/**
+ * @brief Builds the environment block for a program from the launcher's own environment.
+ *
+ * Overrides are applied in order, so one may refer to a variable set by an earlier one,
+ * as in "TOOLS=D:\Tools|PATH=%TOOLS%;%PATH%". The result is sorted as CreateProcess
+ * requires. Names compare without regard to case, as they do on Windows.
+ * @param parentBlock The environment to start from: "NAME=value" strings, each followed
+ *        by a null character, and an empty string at the end. NULL for an empty environment.
+ * @param overrides NAME=value entries separated by '|'; NAME= removes the variable.
+ * @return The block in the same format, including both terminating null characters.
+ */
+std::wstring BuildEnvironmentBlock(const wchar_t* parentBlock, std::wstring_view overrides)
+{
+    std::vector<std::wstring> entries;
+    for (const wchar_t* entry = parentBlock; entry && *entry; )
+    {
+        std::wstring_view text(entry);
+        entries.emplace_back(text);
+        entry += text.size() + 1;
+    }
+
+    while (!overrides.empty())
+    {
+        size_t separator = overrides.find(L'|');
+        std::wstring_view item = TrimBlanks(overrides.substr(0, separator));
+        overrides = separator == std::wstring_view::npos ? std::wstring_view() : overrides.substr(separator + 1);
+
+        size_t equals = item.find(L'=', 1);
+        if (equals == std::wstring_view::npos) continue;
+        std::wstring_view name = TrimBlanks(item.substr(0, equals));
+        if (name.empty()) continue;
+
+        std::wstring value = ExpandVariables(item.substr(equals + 1), entries);
+        auto variable = FindVariable(entries, name);
+        if (value.empty())
+        {
+            if (variable != entries.end()) entries.erase(variable);
+        }
+        else if (variable != entries.end())
+        {
+            // Keep the spelling of the existing name
+            variable->resize(GetVariableName(*variable).size() + 1);
+            variable->append(value);
+        }
+        else
+        {
+            entries.push_back(std::wstring(name) + L'=' + value);
+        }
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const std::wstring& a, const std::wstring& b)
+        {
+            return LessIgnoreCase(GetVariableName(a), GetVariableName(b));
+        });
+
+    std::wstring block;
+    for (const std::wstring& entry : entries)
+    {
+        block.append(entry);
+        block.push_back(L'\0');
+    }
+    if (block.empty()) block.push_back(L'\0');
+    block.push_back(L'\0');
+    return block;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Priority class a program is started with ([TabN] ButtonN_Priority).
+enum class LaunchPriority
+{
+    Normal,
+    Idle,
+    BelowNormal,
+    AboveNormal,
+    High,
+};
+
+/**
+ * @brief How a button starts its program, beyond the path and parameters.
+ *
+ * The profile only describes the launch; applying it to a process is up to the caller.
+ * The defaults start a program the way Explorer would.
+ */
+struct LaunchProfile
+{
+    std::wstring workingDirectory{ L"" };   // Relative to the executable directory; empty for the executable directory
+    std::wstring environment{ L"" };        // NAME=value overrides separated by '|'; NAME= removes a variable
+    LaunchPriority priority{ LaunchPriority::Normal };
+    uint64_t affinityMask{ 0 };             // Processors the program may run on; 0 for all
+    bool lowIoPriority{ false };
+
+    bool IsDefault() const { return *this == LaunchProfile(); }
+    bool operator==(const LaunchProfile&) const = default;
+};
+
+bool ParseLaunchPriority(std::wstring_view text, LaunchPriority& priority);
+const wchar_t* GetLaunchPriorityName(LaunchPriority priority);
+
+bool ParseAffinityMask(std::wstring_view text, uint64_t& mask);
+std::wstring FormatAffinityMask(uint64_t mask);
+
+std::wstring BuildEnvironmentBlock(const wchar_t* parentBlock, std::wstring_view overrides);
@@ -0,0 +1,334 @@
+#include "LaunchTimer.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+    // Launches whose program shows no window within this time are completed without one
+    const ULONGLONG FIRST_WINDOW_TIMEOUT = 60ULL * 10000000;   // 100 ns units
+
+    // How often exited and timed-out launches are looked for; windows are reported at once
+    const DWORD COMPLETION_CHECK_INTERVAL_MS = 100;
+
+    // The timer whose watch thread receives the window events
+    thread_local LaunchTimer* t_watchingTimer = NULL;
+
+    int64_t ToMicroseconds(ULONGLONG from, ULONGLONG to)
+    {
+        return to > from ? static_cast<int64_t>((to - from) / 10) : 0;
+    }
+
+    ULONGLONG ToTimestamp(const FILETIME& time)
+    {
+        return (static_cast<ULONGLONG>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    }
+}
+
+LaunchTimer::~LaunchTimer()
+{
+    Stop();
+}
+
+/**
+ * @brief Creates the wake event and starts the watch thread.
+ * @param hNotifyWindow Window notified when launches have been timed.
+ * @param notifyMessage Message posted when results are available.
+ * @return True on success, false on failure.
+ */
+bool LaunchTimer::Start(HWND hNotifyWindow, UINT notifyMessage)
+{
+    if (m_hWatchThread) return true;
+
+    m_hNotifyWindow = hNotifyWindow;
+    m_notifyMessage = notifyMessage;
+    m_stopping = false;
+
+    m_hWakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+    if (!m_hWakeEvent) return false;
+
+    m_hWatchThread = CreateThread(NULL, 0, WatchThreadProcedure, this, 0, NULL);
+    if (!m_hWatchThread)
+    {
+        CloseHandle(m_hWakeEvent);
+        m_hWakeEvent = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stops the watch thread. Launches still being timed are dropped.
+ */
+void LaunchTimer::Stop()
+{
+    if (!m_hWatchThread) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    SetEvent(m_hWakeEvent);
+    WaitForSingleObject(m_hWatchThread, INFINITE);
+
+    CloseHandle(m_hWatchThread);
+    CloseHandle(m_hWakeEvent);
+    m_hWatchThread = NULL;
+    m_hWakeEvent = NULL;
+
+    for (PendingLaunch& launch : m_queuedLaunches)
+    {
+        CloseHandle(launch.hProcess);
+    }
+    m_queuedLaunches.clear();
+}
+
+/**
+ * @brief Returns the current time in 100 ns units, on the clock process creation times use.
+ */
+ULONGLONG LaunchTimer::GetTimestamp()
+{
+    FILETIME now;
+    GetSystemTimePreciseAsFileTime(&now);
+    return ToTimestamp(now);
+}
+
+/**
+ * @brief Starts timing a launch.
+ * @param key The button that was launched.
+ * @param path The button's configured path.
+ * @param hProcess Handle to the started process, or NULL if the shell did not start one;
+ *                 the timer uses its own duplicate.
+ * @param clickTime GetTimestamp() before the launch.
+ * @param spawnTime GetTimestamp() after the launch call returned.
+ */
+void LaunchTimer::Track(ButtonKey key, const std::wstring& path, HANDLE hProcess, ULONGLONG clickTime, ULONGLONG spawnTime)
+{
+    if (!m_hWatchThread) return;
+
+    PendingLaunch launch;
+    launch.timing.key = key;
+    launch.timing.path = path;
+    launch.timing.microseconds[static_cast<int>(LaunchPhase::Spawn)] = ToMicroseconds(clickTime, spawnTime);
+    launch.clickTime = clickTime;
+
+    if (!hProcess || !DuplicateHandle(GetCurrentProcess(), hProcess, GetCurrentProcess(), &launch.hProcess,
+        SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, 0))
+    {
+        // Only the spawn time is known
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(std::move(launch.timing));
+        }
+        PostMessage(m_hNotifyWindow, m_notifyMessage, 0, 0);
+        return;
+    }
+    launch.processId = GetProcessId(launch.hProcess);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queuedLaunches.push_back(std::move(launch));
+    }
+    SetEvent(m_hWakeEvent);
+}
+
+/**
+ * @brief Drops the launches of a button that now launches another program or was removed,
+ *        timed or not, so their timings are not recorded for whatever takes its place.
+ */
+void LaunchTimer::Forget(ButtonKey key)
+{
+    if (!m_hWatchThread) return;
+
+    std::vector<PendingLaunch> forgotten;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto queued = std::stable_partition(m_queuedLaunches.begin(), m_queuedLaunches.end(),
+            [&](const PendingLaunch& launch) { return !(launch.timing.key == key); });
+        std::move(queued, m_queuedLaunches.end(), std::back_inserter(forgotten));
+        m_queuedLaunches.erase(queued, m_queuedLaunches.end());
+        m_results.erase(std::remove_if(m_results.begin(), m_results.end(),
+            [&](const LaunchTiming& timing) { return timing.key == key; }), m_results.end());
+        m_forgottenKeys.push_back(key);
+    }
+    for (PendingLaunch& launch : forgotten)
+    {
+        CloseHandle(launch.hProcess);
+    }
+    SetEvent(m_hWakeEvent);
+}
+
+/**
+ * @brief Returns the timings of completed launches and clears them.
+ */
+std::vector<LaunchTiming> LaunchTimer::TakeResults()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_results);
+}
+
+DWORD WINAPI LaunchTimer::WatchThreadProcedure(LPVOID param)
+{
+    Trace::SetThreadName("LaunchTimer");
+    t_watchingTimer = static_cast<LaunchTimer*>(param);
+    t_watchingTimer->RunWatchLoop();
+    t_watchingTimer = NULL;
+    return 0;
+}
+
+void CALLBACK LaunchTimer::WinEventProcedure(HWINEVENTHOOK, DWORD, HWND hwnd, LONG idObject, LONG idChild, DWORD, DWORD)
+{
+    if (idObject == OBJID_WINDOW && idChild == CHILDID_SELF && t_watchingTimer)
+    {
+        t_watchingTimer->OnWindowShown(hwnd, GetTimestamp());
+    }
+}
+
+BOOL CALLBACK LaunchTimer::EnumWindowsProcedure(HWND hwnd, LPARAM lParam)
+{
+    reinterpret_cast<LaunchTimer*>(lParam)->OnWindowShown(hwnd, GetTimestamp());
+    return TRUE;
+}
+
+void LaunchTimer::RunWatchLoop()
+{
+    HWINEVENTHOOK hHook = NULL;
+    while (true)
+    {
+        std::vector<PendingLaunch> newLaunches;
+        std::vector<ButtonKey> forgottenKeys;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping) break;
+            newLaunches.swap(m_queuedLaunches);
+            forgottenKeys.swap(m_forgottenKeys);
+        }
+        DropForgottenLaunches(forgottenKeys);
+
+        for (PendingLaunch& launch : newLaunches)
+        {
+            FILETIME creationTime, exitTime, kernelTime, userTime;
+            if (GetProcessTimes(launch.hProcess, &creationTime, &exitTime, &kernelTime, &userTime))
+            {
+                launch.timing.microseconds[static_cast<int>(LaunchPhase::ProcessStart)] =
+                    ToMicroseconds(launch.clickTime, ToTimestamp(creationTime));
+            }
+            m_pendingLaunches.push_back(std::move(launch));
+        }
+
+        // Window events are only listened for while launches are being timed
+        if (!m_pendingLaunches.empty() && !hHook)
+        {
+            hHook = SetWinEventHook(EVENT_OBJECT_SHOW, EVENT_OBJECT_SHOW, NULL, WinEventProcedure, 0, 0,
+                WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+        }
+        // A window may have come up before the launch reached this thread
+        if (!newLaunches.empty())
+        {
+            EnumWindows(EnumWindowsProcedure, reinterpret_cast<LPARAM>(this));
+        }
+
+        if (CompleteFinishedLaunches())
+        {
+            PostMessage(m_hNotifyWindow, m_notifyMessage, 0, 0);
+        }
+        if (m_pendingLaunches.empty() && hHook)
+        {
+            UnhookWinEvent(hHook);
+            hHook = NULL;
+        }
+
+        // The hook delivers its events through this thread's message queue
+        MsgWaitForMultipleObjects(1, &m_hWakeEvent, FALSE,
+            m_pendingLaunches.empty() ? INFINITE : COMPLETION_CHECK_INTERVAL_MS, QS_ALLINPUT);
+        MSG msg;
+        while (PeekMessageW(&msg, NULL, 0, 0, PM_REMOVE))
+        {
+            DispatchMessageW(&msg);
+        }
+    }
+
+    if (hHook) UnhookWinEvent(hHook);
+    for (PendingLaunch& launch : m_pendingLaunches)
+    {
+        CloseHandle(launch.hProcess);
+    }
+    m_pendingLaunches.clear();
+}
+
+/**
+ * @brief Records the first window of a timed process: a visible, unowned top-level window.
+ */
+void LaunchTimer::OnWindowShown(HWND hwnd, ULONGLONG time)
+{
+    if (GetAncestor(hwnd, GA_ROOT) != hwnd || GetWindow(hwnd, GW_OWNER) != NULL || !IsWindowVisible(hwnd))
+    {
+        return;
+    }
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+    for (PendingLaunch& launch : m_pendingLaunches)
+    {
+        int64_t& firstWindow = launch.timing.microseconds[static_cast<int>(LaunchPhase::FirstWindow)];
+        if (launch.processId == processId && firstWindow < 0)
+        {
+            firstWindow = ToMicroseconds(launch.clickTime, time);
+        }
+    }
+}
+
+/**
+ * @brief Drops the pending launches of forgotten buttons.
+ */
+void LaunchTimer::DropForgottenLaunches(const std::vector<ButtonKey>& keys)
+{
+    for (ButtonKey key : keys)
+    {
+        auto forgotten = std::stable_partition(m_pendingLaunches.begin(), m_pendingLaunches.end(), [&](const PendingLaunch& launch)
+            {
+                return !(launch.timing.key == key);
+            });
+        for (auto it = forgotten; it != m_pendingLaunches.end(); ++it)
+        {
+            CloseHandle(it->hProcess);
+        }
+        m_pendingLaunches.erase(forgotten, m_pendingLaunches.end());
+    }
+}
+
+/**
+ * @brief Moves launches that showed a window, exited or timed out to the results.
+ * @return True if any launch was completed.
+ */
+bool LaunchTimer::CompleteFinishedLaunches()
+{
+    ULONGLONG now = GetTimestamp();
+    std::vector<LaunchTiming> completed;
+    for (size_t i = 0; i < m_pendingLaunches.size(); )
+    {
+        PendingLaunch& launch = m_pendingLaunches[i];
+        bool finished = launch.timing.microseconds[static_cast<int>(LaunchPhase::FirstWindow)] >= 0 ||
+            WaitForSingleObject(launch.hProcess, 0) == WAIT_OBJECT_0 ||
+            now - launch.clickTime >= FIRST_WINDOW_TIMEOUT;
+        if (!finished)
+        {
+            ++i;
+            continue;
+        }
+        CloseHandle(launch.hProcess);
+        completed.push_back(std::move(launch.timing));
+        m_pendingLaunches.erase(m_pendingLaunches.begin() + i);
+    }
+    if (completed.empty())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (LaunchTiming& timing : completed)
+    {
+        m_results.push_back(std::move(timing));
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <windows.h>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ConfigModel.h"
+
+// Points of a launch that are timed from the click, in the order they are reached.
+enum class LaunchPhase
+{
+    Spawn,          // ShellExecuteEx or CreateProcess returned
+    ProcessStart,   // The process was created, as GetProcessTimes reports it
+    FirstWindow,    // The process showed its first top-level window
+};
+const int LAUNCH_PHASE_COUNT = 3;
+
+// The timings of one launch in microseconds; -1 for phases that were not reached.
+struct LaunchTiming
+{
+    ButtonKey key;
+    std::wstring path;      // As configured; used to discard results for edited buttons
+    std::array<int64_t, LAUNCH_PHASE_COUNT> microseconds{ -1, -1, -1 };
+};
+
+/**
+ * @brief Times launches on a watcher thread, so the UI never waits for a program to come up.
+ *
+ * The spawn time is measured by the caller around the launch call. The watcher reads the
+ * creation time of the process and listens for windows being shown with an out-of-context
+ * WinEvent hook, which is only installed while launches are being timed. A launch is
+ * complete when its first window appears, its process exits or it times out; the
+ * notification message is then posted and the timings can be collected with TakeResults().
+ */
+class LaunchTimer
+{
+public:
+    LaunchTimer() = default;
+    ~LaunchTimer();
+
+    LaunchTimer(const LaunchTimer&) = delete;
+    LaunchTimer& operator=(const LaunchTimer&) = delete;
+
+    bool Start(HWND hNotifyWindow, UINT notifyMessage);
+    void Stop();
+
+    static ULONGLONG GetTimestamp();
+    void Track(ButtonKey key, const std::wstring& path, HANDLE hProcess, ULONGLONG clickTime, ULONGLONG spawnTime);
+    void Forget(ButtonKey key);
+    std::vector<LaunchTiming> TakeResults();
+
+private:
+    struct PendingLaunch
+    {
+        LaunchTiming timing;
+        HANDLE hProcess{ NULL };    // Owned by the timer
+        DWORD processId{ 0 };
+        ULONGLONG clickTime{ 0 };
+    };
+
+    static DWORD WINAPI WatchThreadProcedure(LPVOID param);
+    static void CALLBACK WinEventProcedure(HWINEVENTHOOK hHook, DWORD event, HWND hwnd,
+        LONG idObject, LONG idChild, DWORD eventThread, DWORD eventTime);
+    static BOOL CALLBACK EnumWindowsProcedure(HWND hwnd, LPARAM lParam);
+    void RunWatchLoop();
+    void OnWindowShown(HWND hwnd, ULONGLONG time);
+    bool CompleteFinishedLaunches();
+    void DropForgottenLaunches(const std::vector<ButtonKey>& keys);
+
+    std::mutex m_mutex;
+    std::vector<PendingLaunch> m_queuedLaunches;
+    std::vector<LaunchTiming> m_results;
+    std::vector<ButtonKey> m_forgottenKeys;     // Buttons whose pending launches are dropped
+    bool m_stopping{ false };
+
+    std::vector<PendingLaunch> m_pendingLaunches;   // Watch thread only
+
+    HANDLE m_hWatchThread{ NULL };
+    HANDLE m_hWakeEvent{ NULL };
+    HWND m_hNotifyWindow{ NULL };
+    UINT m_notifyMessage{ 0 };
+};
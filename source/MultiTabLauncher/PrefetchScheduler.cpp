@@ -0,0 +1,69 @@
+#include "PrefetchScheduler.h"
+
+#include <algorithm>
+
+/**
+ * @brief Prefetches files in order until the budget is spent or the token is cancelled.
+ * @param nowMs A monotonic time in milliseconds, used to expire remembered files.
+ * @return The number of bytes prefetched.
+ */
+uint64_t PrefetchScheduler::RunPass(PrefetchBackend& backend, const std::vector<std::wstring>& files,
+                                    uint64_t budgetBytes, uint64_t nowMs, const CancellationToken& token)
+{
+    uint64_t remainingBudget = budgetBytes;
+    for (const std::wstring& file : files)
+    {
+        if (token.IsCancelled() || remainingBudget == 0) break;
+        remainingBudget -= PrefetchFile(backend, file, remainingBudget, nowMs, token);
+    }
+    return budgetBytes - remainingBudget;
+}
+
+/**
+ * @brief Tells whether a file is presumably still cached from an earlier pass.
+ */
+bool PrefetchScheduler::IsFresh(const std::wstring& filePath, uint64_t lastWriteTime, uint64_t nowMs) const
+{
+    auto found = m_prefetchedFiles.find(filePath);
+    return found != m_prefetchedFiles.end() &&
+        nowMs - found->second.prefetchedAt < REFRESH_INTERVAL_MS &&
+        found->second.lastWriteTime == lastWriteTime;
+}
+
+/**
+ * @brief Prefetches the beginning of a file, up to the remaining budget.
+ * @return The number of bytes prefetched.
+ */
+uint64_t PrefetchScheduler::PrefetchFile(PrefetchBackend& backend, const std::wstring& filePath,
+                                         uint64_t remainingBudget, uint64_t nowMs, const CancellationToken& token)
+{
+    uint64_t lastWriteTime = 0;
+    if (!backend.OpenFile(filePath, lastWriteTime)) return 0;
+    if (IsFresh(filePath, lastWriteTime, nowMs))
+    {
+        backend.CloseFile();
+        return 0;
+    }
+
+    uint64_t bytesPrefetched = 0;
+    bool completed = false;
+    while (!token.IsCancelled() && bytesPrefetched < remainingBudget)
+    {
+        uint64_t chunkSize = (std::min)(CHUNK_SIZE, remainingBudget - bytesPrefetched);
+        uint64_t chunkPrefetched = backend.PrefetchChunk(chunkSize);
+        if (chunkPrefetched == 0)
+        {
+            completed = true; // End of file or read error
+            break;
+        }
+        bytesPrefetched += chunkPrefetched;
+        backend.PauseBetweenChunks();
+    }
+    backend.CloseFile();
+
+    if (completed)
+    {
+        m_prefetchedFiles[filePath] = { lastWriteTime, nowMs };
+    }
+    return bytesPrefetched;
+}
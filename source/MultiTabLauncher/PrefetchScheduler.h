@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TaskExecutor.h"
+
+/**
+ * @brief How a platform brings files into its file cache, one file at a time.
+ *
+ * Prefetcher reads through Win32 file handles; the tests use posix_fadvise.
+ */
+class PrefetchBackend
+{
+public:
+    virtual ~PrefetchBackend() = default;
+
+    // Opens a file and returns its last write time, in the file system's own units
+    virtual bool OpenFile(const std::wstring& filePath, uint64_t& lastWriteTime) = 0;
+    // Caches up to maxBytes of the open file after the previous chunk; 0 at the end or on an error
+    virtual uint64_t PrefetchChunk(uint64_t maxBytes) = 0;
+    virtual void CloseFile() = 0;
+    // Waits between two chunks so prefetching never saturates the disk
+    virtual void PauseBetweenChunks() = 0;
+};
+
+/**
+ * @brief Decides what a prefetch pass reads: files in order of priority, in fixed-size
+ *        chunks, until the byte budget is spent or the pass is cancelled.
+ *
+ * Files that were read completely within the refresh interval and have not changed
+ * since are skipped; partially read files are read again by the next pass. Not
+ * thread-safe; one pass runs at a time.
+ */
+class PrefetchScheduler
+{
+public:
+    static constexpr uint64_t CHUNK_SIZE = 1024 * 1024;
+    static constexpr uint64_t REFRESH_INTERVAL_MS = 30 * 60 * 1000;
+
+    uint64_t RunPass(PrefetchBackend& backend, const std::vector<std::wstring>& files,
+                     uint64_t budgetBytes, uint64_t nowMs, const CancellationToken& token);
+
+    bool IsFresh(const std::wstring& filePath, uint64_t lastWriteTime, uint64_t nowMs) const;
+    size_t GetRememberedFileCount() const { return m_prefetchedFiles.size(); }
+
+private:
+    struct PrefetchedFile
+    {
+        uint64_t lastWriteTime{ 0 };
+        uint64_t prefetchedAt{ 0 };
+    };
+
+    uint64_t PrefetchFile(PrefetchBackend& backend, const std::wstring& filePath,
+                          uint64_t remainingBudget, uint64_t nowMs, const CancellationToken& token);
+
+    std::unordered_map<std::wstring, PrefetchedFile> m_prefetchedFiles;
+};
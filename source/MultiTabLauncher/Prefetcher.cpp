@@ -0,0 +1,142 @@
+#include "Prefetcher.h"
+#include "BackgroundModeScope.h"
+#include "Trace.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Pause between chunks so prefetching never saturates the disk
+    const DWORD PREFETCH_CHUNK_PAUSE_MS = 5;
+
+    // Reads files through the file cache with sequential-scan hints
+    class ReadFilePrefetchBackend : public PrefetchBackend
+    {
+    public:
+        ReadFilePrefetchBackend() : m_buffer(PrefetchScheduler::CHUNK_SIZE) {}
+        ~ReadFilePrefetchBackend() override { CloseFile(); }
+
+        bool OpenFile(const std::wstring& filePath, uint64_t& lastWriteTime) override
+        {
+            m_hFile = CreateFileW(
+                filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+            );
+            if (m_hFile == INVALID_HANDLE_VALUE) return false;
+
+            FILETIME writeTime = {};
+            GetFileTime(m_hFile, NULL, NULL, &writeTime);
+            lastWriteTime = (static_cast<uint64_t>(writeTime.dwHighDateTime) << 32) | writeTime.dwLowDateTime;
+            return true;
+        }
+
+        uint64_t PrefetchChunk(uint64_t maxBytes) override
+        {
+            DWORD chunkSize = static_cast<DWORD>((std::min)(static_cast<uint64_t>(m_buffer.size()), maxBytes));
+            DWORD chunkRead = 0;
+            if (!ReadFile(m_hFile, m_buffer.data(), chunkSize, &chunkRead, NULL)) return 0;
+            return chunkRead;
+        }
+
+        void CloseFile() override
+        {
+            if (m_hFile != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(m_hFile);
+                m_hFile = INVALID_HANDLE_VALUE;
+            }
+        }
+
+        void PauseBetweenChunks() override
+        {
+            Sleep(PREFETCH_CHUNK_PAUSE_MS);
+        }
+
+    private:
+        HANDLE m_hFile{ INVALID_HANDLE_VALUE };
+        std::vector<char> m_buffer;
+    };
+}
+
+Prefetcher::~Prefetcher()
+{
+    Stop();
+}
+
+/**
+ * @brief Starts taking prefetch passes.
+ * @param executor The executor the passes run on.
+ * @return True on success, false if the executor is not running.
+ */
+bool Prefetcher::Start(TaskExecutor& executor)
+{
+    if (m_tasks.IsRunning()) return true;
+    if (!executor.IsRunning()) return false;
+
+    m_tasks.Start(executor);
+    return true;
+}
+
+/**
+ * @brief Cancels the current pass and waits until it stopped.
+ */
+void Prefetcher::Stop()
+{
+    Cancel();
+    m_tasks.Stop();
+}
+
+/**
+ * @brief Starts a prefetch pass unless one is already running.
+ * @param files Files to read, in order of priority.
+ * @param budgetBytes Maximum number of bytes read during the pass.
+ * @return True if the pass was scheduled, false if the prefetcher is busy or stopped.
+ */
+bool Prefetcher::Schedule(std::vector<std::wstring> files, uint64_t budgetBytes)
+{
+    if (!m_tasks.IsRunning() || IsBusy()) return false;
+
+    CancellationToken token = CancellationToken::Create();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_passToken = token;
+    }
+    // A pass cancelled before it starts is dropped, which ends it as well
+    return m_tasks.Submit(TaskPriority::Background, token, [this, files = std::move(files), budgetBytes, token]()
+        {
+            RunPass(files, budgetBytes, token);
+        });
+}
+
+/**
+ * @brief Asks the running pass to stop after the current chunk.
+ */
+void Prefetcher::Cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_passToken.Cancel();
+}
+
+/**
+ * @brief Tests whether a pass is queued or running. Called from the UI thread only, like
+ *        Schedule(), so a pass can never start while another runs.
+ */
+bool Prefetcher::IsBusy() const
+{
+    return m_tasks.HasPendingTasks();
+}
+
+uint64_t Prefetcher::GetTotalBytesPrefetched() const
+{
+    return m_totalBytesPrefetched;
+}
+
+void Prefetcher::RunPass(const std::vector<std::wstring>& files, uint64_t budgetBytes, const CancellationToken& token)
+{
+    BackgroundModeScope backgroundMode;
+    ReadFilePrefetchBackend backend;
+
+    TRACE_SCOPE("PrefetchPass");
+    m_totalBytesPrefetched += m_scheduler.RunPass(backend, files, budgetBytes, GetTickCount64(), token);
+    TRACE_COUNTER("PrefetchedBytes", m_totalBytesPrefetched.load());
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "PrefetchScheduler.h"
+#include "TaskExecutor.h"
+
+/**
+ * @brief Reads files into the OS file cache in a Background task while the user is idle.
+ *
+ * PrefetchScheduler decides what a pass reads; this class reads it with ReadFile, pausing
+ * briefly between chunks. The task runs in background mode, so its reads use low I/O
+ * priority. One pass runs at a time.
+ */
+class Prefetcher
+{
+public:
+    Prefetcher() = default;
+    ~Prefetcher();
+
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    bool Start(TaskExecutor& executor);
+    void Stop();
+
+    bool Schedule(std::vector<std::wstring> files, uint64_t budgetBytes);
+    void Cancel();
+    bool IsBusy() const;
+
+    uint64_t GetTotalBytesPrefetched() const;
+
+private:
+    void RunPass(const std::vector<std::wstring>& files, uint64_t budgetBytes, const CancellationToken& token);
+
+    PrefetchScheduler m_scheduler; // Prefetch task only
+
+    mutable std::mutex m_mutex;
+    CancellationToken m_passToken;
+
+    std::atomic<uint64_t> m_totalBytesPrefetched{ 0 };
+
+    TaskGroup m_tasks;
+};
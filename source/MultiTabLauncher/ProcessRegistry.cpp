@@ -0,0 +1,107 @@
+#include "ProcessRegistry.h"
+
+#include <algorithm>
+
+/**
+ * @brief Records a process started from a button.
+ * @return False if the reference is already tracked.
+ */
+bool ProcessRegistry::Add(ButtonKey key, ProcessRef process, uint32_t processId)
+{
+    if (!m_processes.emplace(process, Process{ key, processId }).second)
+    {
+        return false;
+    }
+    m_buttons[GetButtonId(key)].push_back(process);
+    return true;
+}
+
+/**
+ * @brief Forgets a process that exited.
+ * @param key Receives the button the process was started from.
+ * @return False if the reference is not tracked, e.g. because it was already removed.
+ */
+bool ProcessRegistry::Remove(ProcessRef process, ButtonKey& key)
+{
+    auto it = m_processes.find(process);
+    if (it == m_processes.end())
+    {
+        return false;
+    }
+    key = it->second.key;
+    m_processes.erase(it);
+
+    auto button = m_buttons.find(GetButtonId(key));
+    std::vector<ProcessRef>& processes = button->second;
+    processes.erase(std::find(processes.begin(), processes.end(), process));
+    if (processes.empty())
+    {
+        m_buttons.erase(button);
+    }
+    return true;
+}
+
+/**
+ * @brief Forgets the processes of a button whose target changed or that was removed, so
+ *        that they are not attributed to whatever takes its place.
+ * @return Their references, for the caller to release.
+ */
+std::vector<ProcessRegistry::ProcessRef> ProcessRegistry::Forget(ButtonKey key)
+{
+    auto button = m_buttons.find(GetButtonId(key));
+    if (button == m_buttons.end())
+    {
+        return {};
+    }
+    std::vector<ProcessRef> processes = std::move(button->second);
+    m_buttons.erase(button);
+    for (ProcessRef process : processes)
+    {
+        m_processes.erase(process);
+    }
+    return processes;
+}
+
+/**
+ * @brief Forgets all processes.
+ * @return Their references, for the caller to release.
+ */
+std::vector<ProcessRegistry::ProcessRef> ProcessRegistry::TakeAll()
+{
+    std::vector<ProcessRef> processes;
+    processes.reserve(m_processes.size());
+    for (const auto& [process, info] : m_processes)
+    {
+        processes.push_back(process);
+    }
+    m_processes.clear();
+    m_buttons.clear();
+    return processes;
+}
+
+bool ProcessRegistry::IsRunning(ButtonKey key) const
+{
+    return m_buttons.count(GetButtonId(key)) != 0;
+}
+
+/**
+ * @brief Returns the IDs of the processes started from a button, most recent first.
+ */
+std::vector<uint32_t> ProcessRegistry::GetProcessIds(ButtonKey key) const
+{
+    std::vector<uint32_t> processIds;
+    auto button = m_buttons.find(GetButtonId(key));
+    if (button != m_buttons.end())
+    {
+        for (auto it = button->second.rbegin(); it != button->second.rend(); ++it)
+        {
+            processIds.push_back(m_processes.at(*it).processId);
+        }
+    }
+    return processIds;
+}
+
+uint64_t ProcessRegistry::GetButtonId(ButtonKey key)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(key.tab)) << 32) | static_cast<uint32_t>(key.button);
+}
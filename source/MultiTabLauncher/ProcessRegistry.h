@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "ConfigModel.h"
+
+/**
+ * @brief The processes started from buttons, by button and by the reference that is
+ *        waited on: a process handle on Windows, a pidfd elsewhere.
+ *
+ * Both lookups are hashed, so an exit costs the same with ten processes tracked as with
+ * ten thousand. The processes of a button are kept in launch order. The registry is not
+ * synchronized and does not own the references; ProcessTracker does both.
+ */
+class ProcessRegistry
+{
+public:
+    using ProcessRef = uint64_t;
+
+    bool Add(ButtonKey key, ProcessRef process, uint32_t processId);
+    bool Remove(ProcessRef process, ButtonKey& key);
+    std::vector<ProcessRef> Forget(ButtonKey key);
+    std::vector<ProcessRef> TakeAll();
+
+    bool IsRunning(ButtonKey key) const;
+    std::vector<uint32_t> GetProcessIds(ButtonKey key) const;
+    size_t GetCount() const { return m_processes.size(); }
+
+private:
+    struct Process
+    {
+        ButtonKey key;
+        uint32_t processId{ 0 };
+    };
+
+    static uint64_t GetButtonId(ButtonKey key);
+
+    std::unordered_map<ProcessRef, Process> m_processes;
+    std::unordered_map<uint64_t, std::vector<ProcessRef>> m_buttons;    // Oldest launch first
+};
@@ -0,0 +1,162 @@
+#include "ProcessTracker.h"
+#include "Trace.h"
+
+namespace
+{
+    ProcessRegistry::ProcessRef ToProcessRef(HANDLE hProcess)
+    {
+        return reinterpret_cast<uintptr_t>(hProcess);
+    }
+}
+
+ProcessTracker::~ProcessTracker()
+{
+    Stop();
+}
+
+/**
+ * @brief Starts accepting processes.
+ * @param hNotifyWindow Window that receives exit notifications.
+ * @param notifyMessage Message posted when a tracked process exits.
+ * @return True on success, false on failure.
+ */
+bool ProcessTracker::Start(HWND hNotifyWindow, UINT notifyMessage)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hNotifyWindow = hNotifyWindow;
+    m_notifyMessage = notifyMessage;
+    m_isStarted = true;
+    return true;
+}
+
+/**
+ * @brief Unregisters all waits, waiting for callbacks in progress, and closes the
+ *        remaining process handles. The processes themselves keep running.
+ */
+void ProcessTracker::Stop()
+{
+    std::unordered_map<HANDLE, std::unique_ptr<Waiter>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStarted = false;
+        m_registry.TakeAll();
+        waiters.swap(m_waiters);
+    }
+    for (auto& [hProcess, waiter] : waiters)
+    {
+        UnregisterWaitEx(waiter->hWait, INVALID_HANDLE_VALUE);
+        CloseHandle(hProcess);
+    }
+}
+
+/**
+ * @brief Starts tracking a process. The tracker takes ownership of the handle.
+ * @param key The button that launched the process.
+ * @param hProcess Process handle with SYNCHRONIZE access.
+ */
+void ProcessTracker::Track(ButtonKey key, HANDLE hProcess)
+{
+    if (!hProcess) return;
+
+    auto waiter = std::make_unique<Waiter>();
+    waiter->tracker = this;
+    waiter->hProcess = hProcess;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_isStarted || !m_registry.Add(key, ToProcessRef(hProcess), GetProcessId(hProcess)))
+    {
+        CloseHandle(hProcess);
+        return;
+    }
+    // The callback takes the lock before it looks at the waiter, so it cannot run ahead of this
+    if (!RegisterWaitForSingleObject(&waiter->hWait, hProcess, OnProcessExited, waiter.get(), INFINITE, WT_EXECUTEONLYONCE))
+    {
+        ButtonKey removedKey;
+        m_registry.Remove(ToProcessRef(hProcess), removedKey);
+        CloseHandle(hProcess);
+        return;
+    }
+    m_waiters.emplace(hProcess, std::move(waiter));
+}
+
+/**
+ * @brief Stops tracking the processes started from a button, e.g. because the button now
+ *        launches another program. The processes keep running.
+ */
+void ProcessTracker::Forget(ButtonKey key)
+{
+    std::vector<std::unique_ptr<Waiter>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (ProcessRegistry::ProcessRef process : m_registry.Forget(key))
+        {
+            auto it = m_waiters.find(reinterpret_cast<HANDLE>(static_cast<uintptr_t>(process)));
+            waiters.push_back(std::move(it->second));
+            m_waiters.erase(it);
+        }
+    }
+    for (std::unique_ptr<Waiter>& waiter : waiters)
+    {
+        UnregisterWaitEx(waiter->hWait, INVALID_HANDLE_VALUE);
+        CloseHandle(waiter->hProcess);
+    }
+}
+
+/**
+ * @brief Checks whether any process started from the given button is still running.
+ */
+bool ProcessTracker::IsRunning(ButtonKey key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_registry.IsRunning(key);
+}
+
+/**
+ * @brief Returns the IDs of running processes started from the given button,
+ *        most recently launched first.
+ */
+std::vector<DWORD> ProcessTracker::GetProcessIds(ButtonKey key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<uint32_t> processIds = m_registry.GetProcessIds(key);
+    return std::vector<DWORD>(processIds.begin(), processIds.end());
+}
+
+size_t ProcessTracker::GetTrackedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_registry.GetCount();
+}
+
+/**
+ * @brief Reaps an exited process on a thread pool wait thread. After the lock is released,
+ *        only copies are used, so Stop() need not wait for the rest of the callback.
+ */
+VOID CALLBACK ProcessTracker::OnProcessExited(PVOID context, BOOLEAN /*timedOut*/)
+{
+    Waiter* waiter = static_cast<Waiter*>(context);
+    ProcessTracker* tracker = waiter->tracker;
+
+    std::unique_ptr<Waiter> exited;
+    ButtonKey exitedKey;
+    HWND hNotifyWindow = NULL;
+    UINT notifyMessage = 0;
+    {
+        std::lock_guard<std::mutex> lock(tracker->m_mutex);
+        auto it = tracker->m_waiters.find(waiter->hProcess);
+        if (it == tracker->m_waiters.end())
+        {
+            return; // Stop() is unregistering the wait and closes the handle
+        }
+        exited = std::move(it->second);
+        tracker->m_waiters.erase(it);
+        tracker->m_registry.Remove(ToProcessRef(exited->hProcess), exitedKey);
+        hNotifyWindow = tracker->m_hNotifyWindow;
+        notifyMessage = tracker->m_notifyMessage;
+    }
+    // Unregistering from within the callback must not wait for it
+    UnregisterWaitEx(exited->hWait, NULL);
+    CloseHandle(exited->hProcess);
+    TRACE_INSTANT("ProcessExited");
+    PostMessage(hNotifyWindow, notifyMessage, (WPARAM)exitedKey.tab, (LPARAM)exitedKey.button);
+}
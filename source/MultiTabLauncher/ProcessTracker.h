@@ -0,0 +1,57 @@
+#pragma once
+
+#include <windows.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "ConfigModel.h"
+#include "ProcessRegistry.h"
+
+/**
+ * @brief Keeps the handles of processes started by the launcher and reaps them
+ *        asynchronously.
+ *
+ * Every handle is registered with the thread pool's wait threads, which wait on up to
+ * MAXIMUM_WAIT_OBJECTS - 1 handles each, so no thread is woken before a process exits,
+ * however many are tracked. When a process exits its handle is closed and the
+ * notification message is posted to the notify window with wParam = tab index and
+ * lParam = button index. The bookkeeping is a ProcessRegistry keyed by the handle.
+ */
+class ProcessTracker
+{
+public:
+    ProcessTracker() = default;
+    ~ProcessTracker();
+
+    ProcessTracker(const ProcessTracker&) = delete;
+    ProcessTracker& operator=(const ProcessTracker&) = delete;
+
+    bool Start(HWND hNotifyWindow, UINT notifyMessage);
+    void Stop();
+
+    void Track(ButtonKey key, HANDLE hProcess);
+    void Forget(ButtonKey key);
+    bool IsRunning(ButtonKey key) const;
+    std::vector<DWORD> GetProcessIds(ButtonKey key) const;
+    size_t GetTrackedCount() const;
+
+private:
+    // The context of a registered wait; lives until the wait is unregistered
+    struct Waiter
+    {
+        ProcessTracker* tracker{ nullptr };
+        HANDLE hProcess{ NULL };
+        HANDLE hWait{ NULL };
+    };
+
+    static VOID CALLBACK OnProcessExited(PVOID context, BOOLEAN timedOut);
+
+    mutable std::mutex m_mutex;
+    ProcessRegistry m_registry;
+    std::unordered_map<HANDLE, std::unique_ptr<Waiter>> m_waiters;
+    bool m_isStarted{ false };
+
+    HWND m_hNotifyWindow{ NULL };
+    UINT m_notifyMessage{ 0 };
+};
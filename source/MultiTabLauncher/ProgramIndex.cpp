@@ -0,0 +1,410 @@
+#include "ProgramIndex.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <filesystem>
+#include <system_error>
+#include <unordered_map>
+
+namespace
+{
+    const size_t MAX_DIRECTORIES = UINT16_MAX;
+    const int PREFIX_SCORE = 1000000;
+
+    wchar_t FoldChar(wchar_t c)
+    {
+        if (c < 0x80)
+        {
+            return (c >= L'A' && c <= L'Z') ? static_cast<wchar_t>(c + (L'a' - L'A')) : c;
+        }
+        return static_cast<wchar_t>(std::towlower(c));
+    }
+
+    int CompareFolded(std::wstring_view a, std::wstring_view b)
+    {
+        size_t length = (std::min)(a.size(), b.size());
+        for (size_t i = 0; i < length; ++i)
+        {
+            wchar_t ca = FoldChar(a[i]);
+            wchar_t cb = FoldChar(b[i]);
+            if (ca != cb) return ca < cb ? -1 : 1;
+        }
+        return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+    }
+
+    bool StartsWithFolded(std::wstring_view text, std::wstring_view prefix)
+    {
+        return text.size() >= prefix.size() && CompareFolded(text.substr(0, prefix.size()), prefix) == 0;
+    }
+
+    uint32_t GetCharacterBit(wchar_t c)
+    {
+        c = FoldChar(c);
+        if (c >= L'a' && c <= L'z') return uint32_t{ 1 } << (c - L'a');
+        if (c >= L'0' && c <= L'9') return uint32_t{ 1 } << (26 + (c - L'0') % 6);
+        return 0;
+    }
+
+    uint32_t GetCharacterMask(std::wstring_view text)
+    {
+        uint32_t mask = 0;
+        for (wchar_t c : text)
+        {
+            mask |= GetCharacterBit(c);
+        }
+        return mask;
+    }
+
+    bool IsWordStart(std::wstring_view name, size_t index)
+    {
+        if (index == 0) return true;
+        wchar_t previous = name[index - 1];
+        if (previous == L' ' || previous == L'-' || previous == L'_' || previous == L'.') return true;
+        return std::iswupper(name[index]) && std::iswlower(previous);
+    }
+
+    /**
+     * @brief Scores a name that contains the query as a subsequence: characters that follow
+     *        each other or start a word count more, and long names a little less.
+     * @return The score, or -1 if the name does not contain the query.
+     */
+    int GetFuzzyScore(std::wstring_view name, std::wstring_view foldedQuery)
+    {
+        int score = 0;
+        size_t position = 0;
+        size_t previousMatch = SIZE_MAX;
+        for (wchar_t queryChar : foldedQuery)
+        {
+            while (position < name.size() && FoldChar(name[position]) != queryChar)
+            {
+                ++position;
+            }
+            if (position == name.size())
+            {
+                return -1;
+            }
+            score += 1;
+            if (previousMatch != SIZE_MAX && position == previousMatch + 1) score += 5;
+            if (IsWordStart(name, position)) score += 3;
+            previousMatch = position++;
+        }
+        return score * 16 - static_cast<int>((std::min)(name.size(), size_t{ 15 }));
+    }
+}
+
+/**
+ * @brief Scans the directories and builds the index from scratch.
+ * @param directories The directories in search order; at most 65535 are used.
+ * @param extensions The extensions of launchable files, with the dot, e.g. ".exe".
+ * @param token Stops the scan between two directories; the index is then left empty.
+ */
+void ProgramIndex::Build(const std::vector<ProgramIndexDirectory>& directories, const std::vector<std::wstring>& extensions,
+                         const CancellationToken& token)
+{
+    m_directories.assign(directories.begin(), directories.begin() + (std::min)(directories.size(), MAX_DIRECTORIES));
+    m_extensions.clear();
+    for (const std::wstring& extension : extensions)
+    {
+        std::wstring folded;
+        for (wchar_t c : extension) folded += FoldChar(c);
+        m_extensions.push_back(std::move(folded));
+    }
+
+    std::vector<ScanResult> scans;
+    for (size_t i = 0; i < m_directories.size(); ++i)
+    {
+        if (token.IsCancelled()) return;
+        scans.push_back(ScanDirectory(i));
+    }
+    m_names.clear();
+    m_entries.clear();
+    m_folders.clear();
+    m_folderDirectories.clear();
+    Merge(std::move(scans), std::vector<bool>(m_directories.size(), true));
+}
+
+/**
+ * @brief Scans one directory again after it changed and replaces its programs in the index.
+ */
+void ProgramIndex::RescanDirectory(size_t directoryIndex)
+{
+    if (directoryIndex >= m_directories.size())
+    {
+        return;
+    }
+    std::vector<ScanResult> scans;
+    scans.push_back(ScanDirectory(directoryIndex));
+    std::vector<bool> replaced(m_directories.size(), false);
+    replaced[directoryIndex] = true;
+    Merge(std::move(scans), replaced);
+}
+
+/**
+ * @brief Returns the programs whose name starts with the query, shortest first, followed
+ *        by those that contain its characters in order, best first. Each name is offered
+ *        once, from the first directory that has it.
+ * @param query What was typed; queries that contain a path return nothing.
+ * @param maxResults The maximum number of matches to return.
+ */
+std::vector<ProgramMatch> ProgramIndex::Complete(std::wstring_view query, size_t maxResults) const
+{
+    std::vector<ProgramMatch> matches;
+    if (query.empty() || maxResults == 0 || query.find_first_of(L"\\/:") != std::wstring_view::npos)
+    {
+        return matches;
+    }
+
+    // Prefix matches form one run of the sorted entries
+    auto first = std::lower_bound(m_entries.begin(), m_entries.end(), query,
+        [this](const Entry& entry, std::wstring_view value) { return CompareFolded(GetName(entry), value) < 0; });
+    std::vector<const Entry*> prefixEntries;
+    for (auto it = first; it != m_entries.end() && StartsWithFolded(GetName(*it), query); ++it)
+    {
+        if (prefixEntries.empty() || CompareFolded(GetName(*prefixEntries.back()), GetName(*it)) != 0)
+        {
+            prefixEntries.push_back(&*it);
+        }
+    }
+    size_t prefixCount = (std::min)(prefixEntries.size(), maxResults);
+    std::partial_sort(prefixEntries.begin(), prefixEntries.begin() + prefixCount, prefixEntries.end(),
+        [](const Entry* a, const Entry* b) { return a->nameLength != b->nameLength ? a->nameLength < b->nameLength : a < b; });
+    for (size_t i = 0; i < prefixCount; ++i)
+    {
+        const Entry& entry = *prefixEntries[i];
+        matches.push_back({ std::wstring(GetName(entry)), GetPath(entry), PREFIX_SCORE - entry.nameLength });
+    }
+    if (matches.size() == maxResults)
+    {
+        return matches;
+    }
+
+    std::wstring foldedQuery;
+    for (wchar_t c : query) foldedQuery += FoldChar(c);
+    const uint32_t queryMask = GetCharacterMask(foldedQuery);
+
+    std::vector<std::pair<int, const Entry*>> fuzzyEntries;
+    const Entry* previous = nullptr;
+    for (const Entry& entry : m_entries)
+    {
+        const Entry* before = previous;
+        previous = &entry;
+        if ((entry.characterMask & queryMask) != queryMask)
+        {
+            continue;
+        }
+        // A name in a later directory is shadowed by the one before it
+        std::wstring_view name = GetName(entry);
+        if ((before && CompareFolded(GetName(*before), name) == 0) || StartsWithFolded(name, foldedQuery))
+        {
+            continue;
+        }
+
+        int score = GetFuzzyScore(name, foldedQuery);
+        if (score >= 0)
+        {
+            fuzzyEntries.emplace_back(score, &entry);
+        }
+    }
+    size_t fuzzyCount = (std::min)(fuzzyEntries.size(), maxResults - matches.size());
+    std::partial_sort(fuzzyEntries.begin(), fuzzyEntries.begin() + fuzzyCount, fuzzyEntries.end(),
+        [](const auto& a, const auto& b) { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+    for (size_t i = 0; i < fuzzyCount; ++i)
+    {
+        const Entry& entry = *fuzzyEntries[i].second;
+        matches.push_back({ std::wstring(GetName(entry)), GetPath(entry), fuzzyEntries[i].first });
+    }
+    return matches;
+}
+
+/**
+ * @brief Looks up a file name, case-insensitively, in the first directory that has it.
+ *        Only directories searched on their own count, as they do for PATH; programs in
+ *        application folders are offered for completion but never found by bare name.
+ * @param fileName A bare file name with its extension, e.g. "notepad.exe".
+ * @param fullPath Receives the full path if found.
+ * @return True if found, false if not or if the name contains a path.
+ */
+bool ProgramIndex::FindProgram(std::wstring_view fileName, std::wstring& fullPath) const
+{
+    if (fileName.empty() || fileName.find_first_of(L"\\/:") != std::wstring_view::npos)
+    {
+        return false;
+    }
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), fileName,
+        [this](const Entry& entry, std::wstring_view value) { return CompareFolded(GetName(entry), value) < 0; });
+    for (; it != m_entries.end() && CompareFolded(GetName(*it), fileName) == 0; ++it)
+    {
+        if (!m_directories[it->directory].recursive)
+        {
+            fullPath = GetPath(*it);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the heap memory held by the index, in bytes.
+ */
+size_t ProgramIndex::GetByteSize() const
+{
+    size_t bytes = m_names.capacity() * sizeof(wchar_t) + m_entries.capacity() * sizeof(Entry) +
+        m_folders.capacity() * sizeof(std::wstring) + m_folderDirectories.capacity() * sizeof(uint16_t);
+    for (const std::wstring& folder : m_folders)
+    {
+        bytes += folder.capacity() * sizeof(wchar_t);
+    }
+    return bytes;
+}
+
+ProgramIndex::ScanResult ProgramIndex::ScanDirectory(size_t directoryIndex) const
+{
+    namespace fs = std::filesystem;
+
+    ScanResult scan;
+    const ProgramIndexDirectory& directory = m_directories[directoryIndex];
+    std::unordered_map<std::wstring, uint32_t> folderIndices;
+    auto addFile = [&](const fs::directory_entry& file)
+    {
+        std::error_code ec;
+        std::wstring name = file.path().filename().wstring();
+        if (name.size() > UINT16_MAX || !HasProgramExtension(name) || !file.is_regular_file(ec))
+        {
+            return;
+        }
+
+        std::wstring folder = file.path().parent_path().wstring();
+        auto [it, isNew] = folderIndices.try_emplace(folder, static_cast<uint32_t>(scan.folders.size()));
+        if (isNew)
+        {
+            scan.folders.push_back(std::move(folder));
+        }
+
+        Entry entry;
+        entry.nameOffset = static_cast<uint32_t>(scan.names.size());
+        entry.nameLength = static_cast<uint16_t>(name.size());
+        entry.directory = static_cast<uint16_t>(directoryIndex);
+        entry.folder = it->second;
+        entry.characterMask = GetCharacterMask(name);
+        scan.names += name;
+        scan.entries.push_back(entry);
+    };
+
+    std::error_code ec;
+    const fs::directory_options options = fs::directory_options::skip_permission_denied;
+    if (directory.recursive)
+    {
+        fs::recursive_directory_iterator it(directory.path, options, ec);
+        for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+        {
+            if (it.depth() >= MAX_RECURSION_DEPTH) it.disable_recursion_pending();
+            addFile(*it);
+        }
+    }
+    else
+    {
+        fs::directory_iterator it(directory.path, options, ec);
+        for (; !ec && it != fs::directory_iterator(); it.increment(ec))
+        {
+            addFile(*it);
+        }
+    }
+    return scan;
+}
+
+bool ProgramIndex::HasProgramExtension(std::wstring_view fileName) const
+{
+    size_t dot = fileName.rfind(L'.');
+    if (dot == std::wstring_view::npos)
+    {
+        return false;
+    }
+    std::wstring_view extension = fileName.substr(dot);
+    return std::any_of(m_extensions.begin(), m_extensions.end(),
+        [extension](const std::wstring& candidate) { return CompareFolded(extension, candidate) == 0; });
+}
+
+/**
+ * @brief Replaces the entries of the scanned directories with the scan results, keeping
+ *        the entries of the others and the sort order.
+ * @param scans New scan results, one per replaced directory.
+ * @param replaced Flags the directories whose old entries are dropped.
+ */
+void ProgramIndex::Merge(std::vector<ScanResult> scans, const std::vector<bool>& replaced)
+{
+    std::wstring names;
+    std::vector<Entry> entries;
+    std::vector<std::wstring> folders;
+    std::vector<uint16_t> folderDirectories;
+
+    // Kept entries stay sorted; their names and folders are packed again without the gaps
+    std::vector<uint32_t> folderMap(m_folders.size(), UINT32_MAX);
+    for (size_t i = 0; i < m_folders.size(); ++i)
+    {
+        if (!replaced[m_folderDirectories[i]])
+        {
+            folderMap[i] = static_cast<uint32_t>(folders.size());
+            folders.push_back(std::move(m_folders[i]));
+            folderDirectories.push_back(m_folderDirectories[i]);
+        }
+    }
+    for (const Entry& old : m_entries)
+    {
+        if (replaced[old.directory]) continue;
+        Entry entry = old;
+        entry.nameOffset = static_cast<uint32_t>(names.size());
+        entry.folder = folderMap[old.folder];
+        names.append(GetName(old));
+        entries.push_back(entry);
+    }
+    const size_t keptCount = entries.size();
+
+    for (ScanResult& scan : scans)
+    {
+        const uint32_t nameBase = static_cast<uint32_t>(names.size());
+        const uint32_t folderBase = static_cast<uint32_t>(folders.size());
+        names += scan.names;
+        for (std::wstring& folder : scan.folders)
+        {
+            folderDirectories.push_back(scan.entries.empty() ? 0 : scan.entries.front().directory);
+            folders.push_back(std::move(folder));
+        }
+        for (Entry entry : scan.entries)
+        {
+            entry.nameOffset += nameBase;
+            entry.folder += folderBase;
+            entries.push_back(entry);
+        }
+    }
+
+    names.shrink_to_fit();
+    entries.shrink_to_fit();
+    m_names = std::move(names);
+    m_entries = std::move(entries);
+    m_folders = std::move(folders);
+    m_folderDirectories = std::move(folderDirectories);
+
+    auto isBefore = [this](const Entry& a, const Entry& b) { return IsBefore(a, b); };
+    if (scans.size() == 1)
+    {
+        std::sort(m_entries.begin() + keptCount, m_entries.end(), isBefore);
+        std::inplace_merge(m_entries.begin(), m_entries.begin() + keptCount, m_entries.end(), isBefore);
+    }
+    else
+    {
+        std::sort(m_entries.begin(), m_entries.end(), isBefore);
+    }
+}
+
+std::wstring ProgramIndex::GetPath(const Entry& entry) const
+{
+    return (std::filesystem::path(m_folders[entry.folder]) / GetName(entry)).wstring();
+}
+
+bool ProgramIndex::IsBefore(const Entry& a, const Entry& b) const
+{
+    int order = CompareFolded(GetName(a), GetName(b));
+    if (order != 0) return order < 0;
+    if (a.directory != b.directory) return a.directory < b.directory;
+    return a.folder < b.folder;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TaskExecutor.h"
+
+// A directory searched for programs. PATH entries are searched on their own; application
+// folders such as the Start Menu include their subdirectories.
+struct ProgramIndexDirectory
+{
+    std::wstring path;
+    bool recursive{ false };
+};
+
+// A program offered for completion.
+struct ProgramMatch
+{
+    std::wstring name;      // File name, e.g. "notepad.exe"
+    std::wstring path;      // Full path
+    int score{ 0 };         // Higher is better; prefix matches score above all fuzzy ones
+};
+
+/**
+ * @brief The launchable programs found in a list of directories, for completion and for
+ *        resolving bare file names without walking PATH.
+ *
+ * Entries are kept sorted by file name, case-insensitively, and then by the order of their
+ * directory, so a prefix is looked up with a binary search and the first exact match is
+ * the one a PATH search would find. Names live in one shared buffer, and an entry takes
+ * 16 bytes besides its name. Each entry also keeps a bitmask of the letters and digits in
+ * its name, so fuzzy queries skip most names without comparing characters.
+ *
+ * The index is not synchronized: build or update a copy and publish it, as ProgramIndexer
+ * does. Queries on a published index can run on any number of threads.
+ */
+class ProgramIndex
+{
+public:
+    static constexpr int MAX_RECURSION_DEPTH = 4;
+
+    void Build(const std::vector<ProgramIndexDirectory>& directories, const std::vector<std::wstring>& extensions,
+               const CancellationToken& token = CancellationToken());
+    void RescanDirectory(size_t directoryIndex);
+
+    std::vector<ProgramMatch> Complete(std::wstring_view query, size_t maxResults) const;
+    bool FindProgram(std::wstring_view fileName, std::wstring& fullPath) const;
+
+    const std::vector<ProgramIndexDirectory>& GetDirectories() const { return m_directories; }
+    size_t GetEntryCount() const { return m_entries.size(); }
+    size_t GetByteSize() const;
+
+private:
+    struct Entry
+    {
+        uint32_t nameOffset;    // Into m_names
+        uint16_t nameLength;
+        uint16_t directory;     // Index into m_directories; lower is searched first
+        uint32_t folder;        // Index into m_folders
+        uint32_t characterMask; // Bit per letter or digit in the name
+    };
+
+    // Files found in one directory, before they are merged into the index
+    struct ScanResult
+    {
+        std::wstring names;
+        std::vector<Entry> entries;
+        std::vector<std::wstring> folders;
+    };
+
+    ScanResult ScanDirectory(size_t directoryIndex) const;
+    bool HasProgramExtension(std::wstring_view fileName) const;
+    void Merge(std::vector<ScanResult> scans, const std::vector<bool>& replaced);
+
+    std::wstring_view GetName(const Entry& entry) const { return std::wstring_view(m_names).substr(entry.nameOffset, entry.nameLength); }
+    std::wstring GetPath(const Entry& entry) const;
+    bool IsBefore(const Entry& a, const Entry& b) const;
+
+    std::vector<ProgramIndexDirectory> m_directories;
+    std::vector<std::wstring> m_extensions;     // Lowercase, with the dot
+    std::wstring m_names;
+    std::vector<Entry> m_entries;
+    std::vector<std::wstring> m_folders;
+    std::vector<uint16_t> m_folderDirectories;  // Directory each folder was found in
+};
@@ -0,0 +1,225 @@
+#include "ProgramIndexer.h"
+#include "BackgroundModeScope.h"
+#include "Trace.h"
+
+#include <algorithm>
+
+ProgramIndexer::~ProgramIndexer()
+{
+    Stop();
+}
+
+/**
+ * @brief Starts building the index.
+ * @param executor The executor the scans run on.
+ * @param directories The directories to index, in search order.
+ * @param extensions The extensions of launchable files, with the dot.
+ * @return True on success, false if the executor is not running or the timer could not be created.
+ */
+bool ProgramIndexer::Start(TaskExecutor& executor, std::vector<ProgramIndexDirectory> directories, std::vector<std::wstring> extensions)
+{
+    if (m_tasks.IsRunning()) return true;
+    if (!executor.IsRunning()) return false;
+
+    m_directories = std::move(directories);
+    m_extensions = std::move(extensions);
+    m_isChanged.assign(m_directories.size(), false);
+    m_isRescanPending = false;
+    m_stopping = false;
+
+    m_rescanTimer = CreateThreadpoolTimer(OnRescanDue, this, NULL);
+    if (!m_rescanTimer) return false;
+
+    m_tasks.Start(executor);
+    if (!m_tasks.Submit(TaskPriority::Background, [this]() { BuildIndex(); }))
+    {
+        m_tasks.Stop();
+        CloseThreadpoolTimer(m_rescanTimer);
+        m_rescanTimer = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stops watching the directories and releases the index. A first build stops after
+ *        the directory it is scanning; a rescan in progress is finished first.
+ */
+void ProgramIndexer::Stop()
+{
+    if (!m_tasks.IsRunning()) return;
+
+    // Once stopping is set, no callback or task sets a wait or the timer again
+    std::vector<std::unique_ptr<Watch>> watches;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        watches = std::move(m_watches);
+    }
+    for (const std::unique_ptr<Watch>& watch : watches)
+    {
+        SetThreadpoolWait(watch->wait, NULL, NULL);
+        WaitForThreadpoolWaitCallbacks(watch->wait, TRUE);
+        CloseThreadpoolWait(watch->wait);
+        FindCloseChangeNotification(watch->hChange);
+    }
+    SetThreadpoolTimer(m_rescanTimer, NULL, 0, 0);
+    WaitForThreadpoolTimerCallbacks(m_rescanTimer, TRUE);
+    CloseThreadpoolTimer(m_rescanTimer);
+    m_rescanTimer = NULL;
+
+    m_tasks.Stop();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.reset();
+}
+
+/**
+ * @brief Returns the latest index, or nullptr while the first one is being built.
+ *        Safe to call from any thread.
+ */
+std::shared_ptr<const ProgramIndex> ProgramIndexer::GetIndex() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index;
+}
+
+/**
+ * @brief Builds the first index, then starts watching the directories. Runs on the executor.
+ */
+void ProgramIndexer::BuildIndex()
+{
+    // Lower both CPU and I/O priority; scanning PATH never competes with the user
+    BackgroundModeScope backgroundMode;
+    {
+        TRACE_SCOPE("BuildProgramIndex");
+        auto index = std::make_shared<ProgramIndex>();
+        index->Build(m_directories, m_extensions, m_tasks.GetToken());
+        if (m_tasks.GetToken().IsCancelled()) return;
+        TRACE_COUNTER("ProgramIndexEntries", index->GetEntryCount());
+        Publish(std::move(index));
+    }
+    if (!m_tasks.GetToken().IsCancelled())
+    {
+        WatchDirectories();
+    }
+}
+
+/**
+ * @brief Scans the directories that changed into a copy of the index. Runs on the executor.
+ */
+void ProgramIndexer::RescanChangedDirectories()
+{
+    BackgroundModeScope backgroundMode;
+    std::vector<bool> isChanged;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        isChanged.swap(m_isChanged);
+        m_isChanged.assign(isChanged.size(), false);
+    }
+
+    {
+        TRACE_SCOPE("UpdateProgramIndex");
+        auto index = std::make_shared<ProgramIndex>(*GetIndex());
+        for (size_t i = 0; i < isChanged.size(); ++i)
+        {
+            if (isChanged[i])
+            {
+                index->RescanDirectory(i);
+            }
+        }
+        Publish(std::move(index));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isRescanPending = false;
+    if (std::find(m_isChanged.begin(), m_isChanged.end(), true) != m_isChanged.end())
+    {
+        ScheduleRescan();
+    }
+}
+
+/**
+ * @brief Opens a change notification per directory and waits for it in the thread pool.
+ */
+void ProgramIndexer::WatchDirectories()
+{
+    std::vector<std::unique_ptr<Watch>> watches;
+    for (size_t i = 0; i < m_directories.size(); ++i)
+    {
+        HANDLE hChange = FindFirstChangeNotificationW(m_directories[i].path.c_str(), m_directories[i].recursive,
+            FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME);
+        if (hChange == INVALID_HANDLE_VALUE) continue;
+
+        auto watch = std::make_unique<Watch>();
+        watch->indexer = this;
+        watch->directory = i;
+        watch->hChange = hChange;
+        watch->wait = CreateThreadpoolWait(OnDirectoryChanged, watch.get(), NULL);
+        if (!watch->wait)
+        {
+            FindCloseChangeNotification(hChange);
+            continue;
+        }
+        watches.push_back(std::move(watch));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping)
+    {
+        for (const std::unique_ptr<Watch>& watch : watches)
+        {
+            CloseThreadpoolWait(watch->wait);
+            FindCloseChangeNotification(watch->hChange);
+        }
+        return;
+    }
+    for (const std::unique_ptr<Watch>& watch : watches)
+    {
+        SetThreadpoolWait(watch->wait, watch->hChange, NULL);
+    }
+    m_watches = std::move(watches);
+}
+
+/**
+ * @brief Sets the timer of the rescan unless one is pending. Called with the lock held.
+ */
+void ProgramIndexer::ScheduleRescan()
+{
+    if (m_isRescanPending || m_stopping) return;
+
+    m_isRescanPending = true;
+    ULARGE_INTEGER delay;
+    delay.QuadPart = static_cast<ULONGLONG>(-static_cast<LONGLONG>(RESCAN_DELAY_MS) * 10000); // Relative, in 100 ns
+    FILETIME dueTime;
+    dueTime.dwLowDateTime = delay.LowPart;
+    dueTime.dwHighDateTime = delay.HighPart;
+    SetThreadpoolTimer(m_rescanTimer, &dueTime, 0, 0);
+}
+
+VOID CALLBACK ProgramIndexer::OnDirectoryChanged(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WAIT wait, TP_WAIT_RESULT)
+{
+    Watch* watch = static_cast<Watch*>(context);
+    ProgramIndexer* indexer = watch->indexer;
+    std::lock_guard<std::mutex> lock(indexer->m_mutex);
+    if (indexer->m_stopping) return;
+
+    // Later changes join the pending rescan rather than postponing it
+    indexer->m_isChanged[watch->directory] = true;
+    indexer->ScheduleRescan();
+    if (FindNextChangeNotification(watch->hChange))
+    {
+        SetThreadpoolWait(wait, watch->hChange, NULL);
+    }
+}
+
+VOID CALLBACK ProgramIndexer::OnRescanDue(PTP_CALLBACK_INSTANCE, PVOID context, PTP_TIMER)
+{
+    ProgramIndexer* indexer = static_cast<ProgramIndexer*>(context);
+    indexer->m_tasks.Submit(TaskPriority::Background, [indexer]() { indexer->RescanChangedDirectories(); });
+}
+
+void ProgramIndexer::Publish(std::shared_ptr<const ProgramIndex> index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index = std::move(index);
+}
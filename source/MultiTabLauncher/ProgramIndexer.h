@@ -0,0 +1,67 @@
+#pragma once
+
+#include <windows.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ProgramIndex.h"
+#include "TaskExecutor.h"
+
+/**
+ * @brief Builds the program index in a Background task and keeps it current.
+ *
+ * After the first build a thread-pool wait watches a change notification per directory,
+ * for file and folder names only. A change marks its directory, and a second later a task
+ * scans the marked directories again into a copy of the index, so an installer writing
+ * many files costs one rescan. Only one scan runs at a time; changes during a rescan are
+ * picked up by the next. Each finished index is published as a whole; readers keep the
+ * index they got for as long as they use it.
+ */
+class ProgramIndexer
+{
+public:
+    static constexpr DWORD RESCAN_DELAY_MS = 1000;
+
+    ProgramIndexer() = default;
+    ~ProgramIndexer();
+
+    ProgramIndexer(const ProgramIndexer&) = delete;
+    ProgramIndexer& operator=(const ProgramIndexer&) = delete;
+
+    bool Start(TaskExecutor& executor, std::vector<ProgramIndexDirectory> directories, std::vector<std::wstring> extensions);
+    void Stop();
+
+    std::shared_ptr<const ProgramIndex> GetIndex() const;
+
+private:
+    // A directory whose changes are watched
+    struct Watch
+    {
+        ProgramIndexer* indexer{ nullptr };
+        size_t directory{ 0 };
+        HANDLE hChange{ INVALID_HANDLE_VALUE };
+        PTP_WAIT wait{ NULL };
+    };
+
+    static VOID CALLBACK OnDirectoryChanged(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WAIT wait, TP_WAIT_RESULT result);
+    static VOID CALLBACK OnRescanDue(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer);
+    void BuildIndex();
+    void RescanChangedDirectories();
+    void WatchDirectories();
+    void ScheduleRescan();
+    void Publish(std::shared_ptr<const ProgramIndex> index);
+
+    std::vector<ProgramIndexDirectory> m_directories;
+    std::vector<std::wstring> m_extensions;
+
+    mutable std::mutex m_mutex;
+    std::shared_ptr<const ProgramIndex> m_index;    // Null until the first build finished
+    std::vector<bool> m_isChanged;
+    bool m_isRescanPending{ false };                // Timer set or rescan queued or running
+    bool m_stopping{ false };
+
+    std::vector<std::unique_ptr<Watch>> m_watches;  // Set by the build task
+    PTP_TIMER m_rescanTimer{ NULL };
+    TaskGroup m_tasks;
+};
@@ -0,0 +1,145 @@
+#include "ResourceAccountant.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+    const char* const OWNER_NAMES[RESOURCE_OWNER_COUNT] = {
+        "Buttons", "TabPages", "TabStrip", "Theme", "Tray", "IconCache", "Configuration",
+    };
+}
+
+void ResourceAccountant::Add(ResourceOwner owner, ResourceKind kind, int64_t delta)
+{
+    m_counts[static_cast<int>(owner)][static_cast<int>(kind)] += delta;
+    UpdatePeak(kind);
+}
+
+void ResourceAccountant::Set(ResourceOwner owner, ResourceKind kind, int64_t value)
+{
+    m_counts[static_cast<int>(owner)][static_cast<int>(kind)] = value;
+    UpdatePeak(kind);
+}
+
+int64_t ResourceAccountant::GetCount(ResourceOwner owner, ResourceKind kind) const
+{
+    return m_counts[static_cast<int>(owner)][static_cast<int>(kind)];
+}
+
+int64_t ResourceAccountant::GetTotal(ResourceKind kind) const
+{
+    int64_t total = 0;
+    for (const auto& counts : m_counts)
+    {
+        total += counts[static_cast<int>(kind)];
+    }
+    return total;
+}
+
+/**
+ * @brief Returns the highest total of a kind of resource since the accountant was created.
+ */
+int64_t ResourceAccountant::GetPeak(ResourceKind kind) const
+{
+    return m_peaks[static_cast<int>(kind)];
+}
+
+void ResourceAccountant::UpdatePeak(ResourceKind kind)
+{
+    int64_t& peak = m_peaks[static_cast<int>(kind)];
+    peak = (std::max)(peak, GetTotal(kind));
+}
+
+/**
+ * @brief Formats the counters as a table with one row per owner, the totals and the peaks.
+ */
+std::string ResourceAccountant::FormatReport() const
+{
+    std::string report;
+    char line[128];
+    auto appendRow = [&](const char* name, const std::array<int64_t, RESOURCE_KIND_COUNT>& values)
+        {
+            std::snprintf(line, sizeof(line), "%-14s %10lld %12lld %10lld %14lld\n", name,
+                static_cast<long long>(values[0]), static_cast<long long>(values[1]),
+                static_cast<long long>(values[2]), static_cast<long long>(values[3]));
+            report += line;
+        };
+
+    std::snprintf(line, sizeof(line), "%-14s %10s %12s %10s %14s\n", "Owner", "Icons", "GDI objects", "Windows", "Heap bytes");
+    report += line;
+    for (int owner = 0; owner < RESOURCE_OWNER_COUNT; ++owner)
+    {
+        appendRow(OWNER_NAMES[owner], m_counts[owner]);
+    }
+    std::array<int64_t, RESOURCE_KIND_COUNT> totals{};
+    for (int kind = 0; kind < RESOURCE_KIND_COUNT; ++kind)
+    {
+        totals[kind] = GetTotal(static_cast<ResourceKind>(kind));
+    }
+    appendRow("Total", totals);
+    appendRow("Peak", m_peaks);
+    return report;
+}
+
+/**
+ * @brief Chooses the pages to release so that the live icons and windows fit the limits.
+ *
+ * Pages are released least recently visited first. The pinned tab, the one on screen,
+ * is never chosen, so a single page larger than the limits stays.
+ * @param pages The pages that are loaded.
+ * @param limits The caps; 0 for no cap.
+ * @param liveIcons The icons held in total, including those outside pages.
+ * @param liveWindows The windows held in total, including those outside pages.
+ * @param pinnedTab The tab whose page must stay.
+ * @return The tabs whose pages to release, in the order chosen.
+ */
+std::vector<int> ResourceAccountant::SelectPagesOverLimits(std::vector<PageUsage> pages, const ResourceLimits& limits,
+    int64_t liveIcons, int64_t liveWindows, int pinnedTab)
+{
+    auto isOverLimits = [&]()
+        {
+            return (limits.maxIcons > 0 && liveIcons > limits.maxIcons) ||
+                (limits.maxWindows > 0 && liveWindows > limits.maxWindows);
+        };
+
+    std::vector<int> evicted;
+    if (!isOverLimits())
+    {
+        return evicted;
+    }
+    std::stable_sort(pages.begin(), pages.end(), [](const PageUsage& a, const PageUsage& b)
+        {
+            return a.lastVisit < b.lastVisit;
+        });
+    for (const PageUsage& page : pages)
+    {
+        if (!isOverLimits()) break;
+        if (page.tab == pinnedTab) continue;
+        evicted.push_back(page.tab);
+        liveIcons -= page.icons;
+        liveWindows -= page.windows;
+    }
+    return evicted;
+}
+
+/**
+ * @brief Chooses the pages that were not visited for a while.
+ * @param pages The pages that are loaded.
+ * @param now The current time, on the clock of PageUsage::lastVisit.
+ * @param maxIdle The time after which an unvisited page is released.
+ * @param pinnedTab The tab whose page must stay.
+ * @return The tabs whose pages to release.
+ */
+std::vector<int> ResourceAccountant::SelectIdlePages(const std::vector<PageUsage>& pages, uint64_t now, uint64_t maxIdle, int pinnedTab)
+{
+    std::vector<int> evicted;
+    for (const PageUsage& page : pages)
+    {
+        if (page.tab != pinnedTab && now - page.lastVisit >= maxIdle)
+        {
+            evicted.push_back(page.tab);
+        }
+    }
+    return evicted;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Parts of the launcher that hold resources, as reported in the diagnostics dump.
+enum class ResourceOwner
+{
+    Buttons,        // Button windows and their icons
+    TabPages,       // Page windows that parent the buttons of a tab
+    TabStrip,
+    Theme,          // Brushes, pens and fonts
+    Tray,
+    IconCache,      // Scaled icon pixels kept for reuse
+    Configuration,  // Tabs and buttons in memory
+};
+const int RESOURCE_OWNER_COUNT = 7;
+
+// Kinds of resources that are counted.
+enum class ResourceKind
+{
+    Icons,
+    GdiObjects,
+    Windows,
+    HeapBytes,
+};
+const int RESOURCE_KIND_COUNT = 4;
+
+// Caps on resources held by tab pages; 0 for no cap.
+struct ResourceLimits
+{
+    int64_t maxIcons{ 0 };
+    int64_t maxWindows{ 0 };
+};
+
+// The resources held by the page of one tab, as a candidate for eviction.
+struct PageUsage
+{
+    int tab{ 0 };
+    int64_t icons{ 0 };
+    int64_t windows{ 0 };   // Including the page window itself
+    uint64_t lastVisit{ 0 }; // Any monotonic clock
+};
+
+/**
+ * @brief Counts the live resources of each part of the launcher and decides which tab
+ *        pages to release to stay within a budget.
+ *
+ * Counters that change all the time (icons and windows) are updated with Add() where
+ * the resources are created and destroyed; the others are set with Set() before a
+ * report. The eviction policy only sees PageUsage records, so it does not depend on
+ * what a page actually holds. The class does not touch any system resources itself.
+ */
+class ResourceAccountant
+{
+public:
+    void Add(ResourceOwner owner, ResourceKind kind, int64_t delta);
+    void Set(ResourceOwner owner, ResourceKind kind, int64_t value);
+    int64_t GetCount(ResourceOwner owner, ResourceKind kind) const;
+    int64_t GetTotal(ResourceKind kind) const;
+    int64_t GetPeak(ResourceKind kind) const;
+
+    std::string FormatReport() const;
+
+    static std::vector<int> SelectPagesOverLimits(std::vector<PageUsage> pages, const ResourceLimits& limits,
+        int64_t liveIcons, int64_t liveWindows, int pinnedTab);
+    static std::vector<int> SelectIdlePages(const std::vector<PageUsage>& pages, uint64_t now, uint64_t maxIdle, int pinnedTab);
+
+private:
+    void UpdatePeak(ResourceKind kind);
+
+    std::array<std::array<int64_t, RESOURCE_KIND_COUNT>, RESOURCE_OWNER_COUNT> m_counts{};
+    std::array<int64_t, RESOURCE_KIND_COUNT> m_peaks{};
+};
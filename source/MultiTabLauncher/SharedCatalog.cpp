@@ -0,0 +1,135 @@
+#include "SharedCatalog.h"
+#include "Trace.h"
+
+#include <vector>
+
+SharedCatalog::~SharedCatalog()
+{
+    Close();
+}
+
+/**
+ * @brief Maps a catalog snapshot, replacing the catalog that is open.
+ * @param snapshotPath The path of a file written by Publish().
+ * @return True on success. On failure the catalog that was open stays open, so that a
+ *         snapshot in the middle of being replaced does not empty the launcher.
+ */
+bool SharedCatalog::Open(const std::wstring& snapshotPath)
+{
+    TRACE_SCOPE("OpenSharedCatalog");
+
+    HANDLE hFile = CreateFileW(snapshotPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize = {};
+    HANDLE hMapping = NULL;
+    if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0 && static_cast<ULONGLONG>(fileSize.QuadPart) <= SIZE_MAX)
+    {
+        hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    CloseHandle(hFile); // The mapping keeps the file open
+    if (!hMapping)
+    {
+        return false;
+    }
+
+    const void* view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    IniDocument document;
+    if (!view || !document.AttachSnapshot(view, static_cast<size_t>(fileSize.QuadPart)))
+    {
+        if (view) UnmapViewOfFile(view);
+        CloseHandle(hMapping);
+        return false;
+    }
+
+    Close();
+    m_document = document;
+    m_hMapping = hMapping;
+    m_view = view;
+    return true;
+}
+
+/**
+ * @brief Unmaps the catalog; the document is empty afterwards.
+ */
+void SharedCatalog::Close()
+{
+    m_document.Parse(std::wstring());
+    if (m_view)
+    {
+        UnmapViewOfFile(m_view);
+        m_view = NULL;
+    }
+    if (m_hMapping)
+    {
+        CloseHandle(m_hMapping);
+        m_hMapping = NULL;
+    }
+}
+
+/**
+ * @brief Writes a document as the catalog snapshot that sessions map.
+ *
+ * The snapshot is written to a temporary file next to the target and moved into place,
+ * so sessions never see a partial file. A snapshot that sessions still have mapped cannot
+ * be overwritten, so it is renamed aside first and deleted by a later publish once it is
+ * no longer mapped.
+ * @param document The parsed catalog.
+ * @param snapshotPath The path sessions open the catalog from.
+ * @return True on success, false on failure.
+ */
+bool SharedCatalog::Publish(const IniDocument& document, const std::wstring& snapshotPath)
+{
+    std::vector<char> snapshot = document.SaveSnapshot();
+    std::wstring tempPath = snapshotPath + L".tmp" + std::to_wstring(GetCurrentProcessId());
+
+    HANDLE hFile = CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    DWORD written = 0;
+    bool ok = snapshot.size() <= MAXDWORD &&
+        WriteFile(hFile, snapshot.data(), static_cast<DWORD>(snapshot.size()), &written, NULL) &&
+        written == snapshot.size() && FlushFileBuffers(hFile);
+    CloseHandle(hFile);
+    if (!ok)
+    {
+        DeleteFileW(tempPath.c_str());
+        return false;
+    }
+
+    // Remove snapshots retired by earlier publishes; those still mapped fail and stay
+    std::wstring retiredPattern = snapshotPath + L".old*";
+    WIN32_FIND_DATAW findData;
+    HANDLE hFind = FindFirstFileW(retiredPattern.c_str(), &findData);
+    if (hFind != INVALID_HANDLE_VALUE)
+    {
+        std::wstring directory = snapshotPath.substr(0, snapshotPath.find_last_of(L"\\/") + 1);
+        do {
+            DeleteFileW((directory + findData.cFileName).c_str());
+        } while (FindNextFileW(hFind, &findData));
+        FindClose(hFind);
+    }
+
+    if (GetFileAttributesW(snapshotPath.c_str()) != INVALID_FILE_ATTRIBUTES)
+    {
+        std::wstring retiredPath = snapshotPath + L".old" + std::to_wstring(GetTickCount64());
+        if (!MoveFileExW(snapshotPath.c_str(), retiredPath.c_str(), 0))
+        {
+            DeleteFileW(tempPath.c_str());
+            return false;
+        }
+        DeleteFileW(retiredPath.c_str()); // Succeeds if no session has it mapped
+    }
+    if (!MoveFileExW(tempPath.c_str(), snapshotPath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        DeleteFileW(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
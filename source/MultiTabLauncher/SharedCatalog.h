@@ -0,0 +1,39 @@
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include "IniDocument.h"
+
+/**
+ * @brief A machine-wide catalog of tabs and buttons, mapped read-only from a snapshot file.
+ *
+ * The catalog is published once with Publish() as an IniDocument snapshot. Every session
+ * maps the same file and queries it in place, so the pages of the catalog are shared by
+ * all sessions instead of each one holding a parsed copy. Users layer their own INI file
+ * over it (see LayeredIni).
+ *
+ * Sessions open the file with FILE_SHARE_DELETE, which lets Publish() rename a mapped
+ * snapshot out of the way and put the new one in its place; sessions keep reading the old
+ * one until they reopen.
+ */
+class SharedCatalog
+{
+public:
+    SharedCatalog() = default;
+    ~SharedCatalog();
+
+    SharedCatalog(const SharedCatalog&) = delete;
+    SharedCatalog& operator=(const SharedCatalog&) = delete;
+
+    bool Open(const std::wstring& snapshotPath);
+    void Close();
+    bool IsOpen() const { return m_view != NULL; }
+    const IniDocument& GetDocument() const { return m_document; }
+
+    static bool Publish(const IniDocument& document, const std::wstring& snapshotPath);
+
+private:
+    IniDocument m_document;     // Empty while no catalog is open
+    HANDLE m_hMapping{ NULL };
+    const void* m_view{ NULL };
+};
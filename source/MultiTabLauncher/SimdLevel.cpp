@@ -0,0 +1,76 @@
+#include "SimdLevel.h"
+
+#include <atomic>
+
+#if MTL_ENABLE_SIMD && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace
+{
+    std::atomic<SimdLevel> g_limit{ SimdLevel::Avx2 };
+
+#if MTL_ENABLE_SIMD
+    /**
+     * @brief Tests whether the processor has AVX2 and the system saves the YMM registers.
+     */
+    bool HasAvx2()
+    {
+#if defined(_MSC_VER)
+        int registers[4];
+        __cpuid(registers, 0);
+        if (registers[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(registers, 1);
+        const int osxsave = 1 << 27;
+        const int avx = 1 << 28;
+        if ((registers[2] & (osxsave | avx)) != (osxsave | avx))
+        {
+            return false;
+        }
+        // XMM and YMM state
+        if ((_xgetbv(0) & 0x6) != 0x6)
+        {
+            return false;
+        }
+        __cpuidex(registers, 7, 0);
+        return (registers[1] & (1 << 5)) != 0;
+#else
+        // Checks the operating system support as well
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    SimdLevel GetSupportedLevel()
+    {
+#if MTL_ENABLE_SIMD
+        return HasAvx2() ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+}
+
+/**
+ * @brief Returns the most capable instruction set that the build and the processor
+ *        support, within the limit set by LimitSimdLevel.
+ */
+SimdLevel GetSimdLevel()
+{
+    static const SimdLevel supported = GetSupportedLevel();
+    SimdLevel limit = g_limit.load(std::memory_order_relaxed);
+    return limit < supported ? limit : supported;
+}
+
+/**
+ * @brief Keeps the kernels from using more than the given instruction set, so that tests
+ *        and benchmarks can compare the paths with each other in one process.
+ */
+void LimitSimdLevel(SimdLevel level)
+{
+    g_limit.store(level, std::memory_order_relaxed);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Vector code is compiled on x86 and x64, where SSE2 is always present; build with
+// MTL_ENABLE_SIMD=0 to leave only the plain loops
+#ifndef MTL_ENABLE_SIMD
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define MTL_ENABLE_SIMD 1
+#else
+#define MTL_ENABLE_SIMD 0
+#endif
+#endif
+
+// AVX2 code is compiled into the same files and only called where the processor has it
+#if MTL_ENABLE_SIMD && (defined(__GNUC__) || defined(__clang__))
+#define MTL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MTL_TARGET_AVX2
+#endif
+
+/**
+ * @brief The instruction sets the bulk kernels may use, from least to most capable.
+ */
+enum class SimdLevel
+{
+    Scalar,
+    Sse2,
+    Avx2,       // Detected with CPUID at first use
+};
+
+SimdLevel GetSimdLevel();
+void LimitSimdLevel(SimdLevel level);
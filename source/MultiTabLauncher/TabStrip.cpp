@@ -0,0 +1,417 @@
+#include "TabStrip.h"
+#include "Trace.h"
+
+#include <windowsx.h>
+#include <commctrl.h>
+#include <algorithm>
+
+namespace
+{
+    LPCWSTR TAB_STRIP_CLASS_NAME = L"MultiTabLauncher.TabStrip";
+
+    // Sizes in pixels at 96 DPI
+    const int HEADER_PADDING = 16;      // Left and right of the header text
+    const int MIN_HEADER_WIDTH = 48;
+    const int VERTICAL_PADDING = 8;
+    const int ACCENT_HEIGHT = 3;        // Bar under the selected header
+    const int ARROW_WIDTH = 28;
+    const int WHEEL_SCROLL_PIXELS = 60; // Per wheel notch
+
+    const COLORREF TEXT_COLOR = RGB(204, 204, 204);
+    const COLORREF SELECTED_TEXT_COLOR = RGB(255, 255, 255);
+    const COLORREF DISABLED_TEXT_COLOR = RGB(100, 100, 100);
+}
+
+/**
+ * @brief Registers the window class used by all tab strips.
+ * @return True on success, false on failure.
+ */
+bool TabStrip::RegisterWindowClass(HINSTANCE hInstance)
+{
+    WNDCLASSEX wc = { sizeof(WNDCLASSEX) };
+    wc.lpfnWndProc = WindowProcedure;
+    wc.hInstance = hInstance;
+    wc.hCursor = LoadCursor(NULL, IDC_ARROW);
+    wc.lpszClassName = TAB_STRIP_CLASS_NAME;
+    return RegisterClassEx(&wc) != 0;
+}
+
+/**
+ * @brief Creates the strip window. Position and size are set by the parent's layout.
+ * @return True on success, false on failure.
+ */
+bool TabStrip::Create(HWND hParent, HINSTANCE hInstance)
+{
+    CreateWindowEx(0, TAB_STRIP_CLASS_NAME, L"", WS_CHILD | WS_VISIBLE,
+        0, 0, 0, 0, hParent, NULL, hInstance, this);
+    return m_hwnd != NULL;
+}
+
+/**
+ * @brief Sets the DPI that paddings and arrow sizes are scaled for. Call SetFont()
+ *        afterwards with a font for the same DPI.
+ */
+void TabStrip::SetDpi(UINT dpi)
+{
+    m_dpi = dpi;
+    InvalidateLayout();
+}
+
+void TabStrip::SetFont(HFONT hFont)
+{
+    m_hFont = hFont;
+
+    HDC hdc = GetDC(m_hwnd);
+    HGDIOBJ hOldFont = SelectObject(hdc, m_hFont);
+    TEXTMETRIC tm = {};
+    GetTextMetrics(hdc, &tm);
+    SelectObject(hdc, hOldFont);
+    ReleaseDC(m_hwnd, hdc);
+
+    m_height = tm.tmHeight + 2 * Scale(VERTICAL_PADDING) + Scale(ACCENT_HEIGHT);
+    InvalidateLayout();
+}
+
+/**
+ * @brief Sets the brushes of the strip. The strip does not take ownership.
+ */
+void TabStrip::SetBrushes(HBRUSH hBackground, HBRUSH hSelected, HBRUSH hAccent)
+{
+    m_hBackgroundBrush = hBackground;
+    m_hSelectedBrush = hSelected;
+    m_hAccentBrush = hAccent;
+    InvalidateRect(m_hwnd, NULL, FALSE);
+}
+
+/**
+ * @brief Replaces all tabs. The first tab is selected.
+ */
+void TabStrip::SetTabs(std::vector<std::wstring> names)
+{
+    m_names = std::move(names);
+    m_selected = m_names.empty() ? -1 : 0;
+    m_scrollX = 0;
+    InvalidateLayout();
+}
+
+void TabStrip::InsertTab(int index, const std::wstring& name)
+{
+    index = std::clamp(index, 0, GetTabCount());
+    m_names.insert(m_names.begin() + index, name);
+    if (m_selected < 0 || index <= m_selected) ++m_selected;
+    InvalidateLayout();
+}
+
+void TabStrip::DeleteTab(int index)
+{
+    if (index < 0 || index >= GetTabCount()) return;
+
+    m_names.erase(m_names.begin() + index);
+    if (index < m_selected || m_selected >= GetTabCount()) --m_selected;
+    InvalidateLayout();
+}
+
+void TabStrip::SetTabName(int index, const std::wstring& name)
+{
+    if (index < 0 || index >= GetTabCount()) return;
+
+    m_names[index] = name;
+    InvalidateLayout();
+}
+
+/**
+ * @brief Selects a tab and scrolls it into view without notifying the parent.
+ */
+void TabStrip::SetCurSel(int index)
+{
+    if (index < 0 || index >= GetTabCount()) return;
+
+    m_selected = index;
+    EnsureVisible(index);
+    InvalidateRect(m_hwnd, NULL, FALSE);
+}
+
+LRESULT CALLBACK TabStrip::WindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    TabStrip* pStrip = NULL;
+    if (msg == WM_NCCREATE)
+    {
+        pStrip = (TabStrip*)((LPCREATESTRUCT)lParam)->lpCreateParams;
+        pStrip->m_hwnd = hwnd;
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG_PTR)pStrip);
+    }
+    else
+    {
+        pStrip = (TabStrip*)GetWindowLongPtr(hwnd, GWLP_USERDATA);
+    }
+
+    if (msg == WM_NCDESTROY && pStrip)
+    {
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, 0);
+        pStrip->m_hwnd = NULL;
+        pStrip = NULL;
+    }
+    return pStrip ? pStrip->HandleMessage(msg, wParam, lParam) : DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+LRESULT TabStrip::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    switch (msg)
+    {
+    case WM_SIZE:
+    {
+        ScrollTo(m_scrollX); // The scroll range depends on the width
+        InvalidateRect(m_hwnd, NULL, FALSE);
+        return 0;
+    }
+
+    case WM_ERASEBKGND:
+    {
+        return 1;
+    }
+
+    case WM_PAINT:
+    {
+        TRACE_SCOPE("PaintTabStrip");
+        PAINTSTRUCT ps;
+        HDC hdc = BeginPaint(m_hwnd, &ps);
+
+        RECT rc;
+        GetClientRect(m_hwnd, &rc);
+
+        HDC memDC = CreateCompatibleDC(hdc);
+        HBITMAP bmp = CreateCompatibleBitmap(hdc, rc.right, rc.bottom);
+        HBITMAP oldBmp = (HBITMAP)SelectObject(memDC, bmp);
+
+        Paint(memDC, rc);
+        BitBlt(hdc, 0, 0, rc.right, rc.bottom, memDC, 0, 0, SRCCOPY);
+
+        SelectObject(memDC, oldBmp);
+        DeleteObject(bmp);
+        DeleteDC(memDC);
+
+        EndPaint(m_hwnd, &ps);
+        return 0;
+    }
+
+    case WM_LBUTTONDOWN:
+    {
+        SetFocus(m_hwnd);
+        int x = GET_X_LPARAM(lParam);
+        int viewWidth = GetViewWidth();
+        if (x >= viewWidth)
+        {
+            // Arrow buttons page through the headers
+            int page = (std::max)(viewWidth * 3 / 4, Scale(MIN_HEADER_WIDTH));
+            ScrollTo(x < viewWidth + Scale(ARROW_WIDTH) ? m_scrollX - page : m_scrollX + page);
+        }
+        else
+        {
+            int index = HitTest(x);
+            if (index >= 0) SelectByUser(index);
+        }
+        return 0;
+    }
+
+    case WM_MOUSEWHEEL:
+    case WM_MOUSEHWHEEL:
+    {
+        // Turning the wheel away from the user scrolls left, tilting it right scrolls right
+        int delta = GET_WHEEL_DELTA_WPARAM(wParam);
+        m_wheelRemainder += (msg == WM_MOUSEWHEEL ? -delta : delta) * WHEEL_SCROLL_PIXELS;
+        int pixels = m_wheelRemainder / WHEEL_DELTA;
+        m_wheelRemainder -= pixels * WHEEL_DELTA;
+        ScrollTo(m_scrollX + pixels);
+        return 0;
+    }
+
+    case WM_GETDLGCODE:
+    {
+        return DLGC_WANTARROWS;
+    }
+
+    case WM_KEYDOWN:
+    {
+        switch (wParam)
+        {
+        case VK_LEFT: SelectByUser(m_selected - 1); break;
+        case VK_RIGHT: SelectByUser(m_selected + 1); break;
+        case VK_HOME: SelectByUser(0); break;
+        case VK_END: SelectByUser(GetTabCount() - 1); break;
+        }
+        return 0;
+    }
+
+    case WM_SETFOCUS:
+    case WM_KILLFOCUS:
+    {
+        InvalidateRect(m_hwnd, NULL, FALSE); // Focus rectangle
+        return 0;
+    }
+    }
+    return DefWindowProc(m_hwnd, msg, wParam, lParam);
+}
+
+void TabStrip::InvalidateLayout()
+{
+    m_layoutValid = false;
+    InvalidateRect(m_hwnd, NULL, FALSE);
+}
+
+/**
+ * @brief Measures the header widths if the names or the font changed.
+ */
+void TabStrip::UpdateLayout()
+{
+    if (m_layoutValid) return;
+    TRACE_SCOPE("MeasureTabs");
+
+    HDC hdc = GetDC(m_hwnd);
+    HGDIOBJ hOldFont = SelectObject(hdc, m_hFont);
+
+    m_offsets.resize(m_names.size() + 1);
+    int x = 0;
+    for (size_t i = 0; i < m_names.size(); ++i)
+    {
+        SIZE textSize = {};
+        GetTextExtentPoint32W(hdc, m_names[i].c_str(), static_cast<int>(m_names[i].length()), &textSize);
+        m_offsets[i] = x;
+        x += (std::max)(static_cast<int>(textSize.cx) + 2 * Scale(HEADER_PADDING), Scale(MIN_HEADER_WIDTH));
+    }
+    m_offsets.back() = x;
+
+    SelectObject(hdc, hOldFont);
+    ReleaseDC(m_hwnd, hdc);
+    m_layoutValid = true;
+}
+
+/**
+ * @brief Draws the visible headers and, if needed, the arrow buttons.
+ */
+void TabStrip::Paint(HDC hdc, const RECT& rcClient)
+{
+    FillRect(hdc, &rcClient, m_hBackgroundBrush);
+
+    // Tabs may have been removed since the last scroll
+    UpdateLayout();
+    int viewWidth = GetViewWidth();
+    m_scrollX = std::clamp(m_scrollX, 0, (std::max)(m_offsets.back() - viewWidth, 0));
+
+    HGDIOBJ hOldFont = SelectObject(hdc, m_hFont);
+    SetBkMode(hdc, TRANSPARENT);
+
+    // Start at the header under the left edge and stop past the right edge
+    int first = static_cast<int>(std::upper_bound(m_offsets.begin(), m_offsets.end() - 1, m_scrollX) - m_offsets.begin()) - 1;
+    IntersectClipRect(hdc, 0, 0, viewWidth, rcClient.bottom);
+    for (int i = (std::max)(first, 0); i < GetTabCount() && m_offsets[i] - m_scrollX < viewWidth; ++i)
+    {
+        RECT rcHeader = { m_offsets[i] - m_scrollX, 0, m_offsets[i + 1] - m_scrollX, rcClient.bottom };
+        bool isSelected = i == m_selected;
+        if (isSelected)
+        {
+            FillRect(hdc, &rcHeader, m_hSelectedBrush);
+            RECT rcAccent = { rcHeader.left, rcHeader.bottom - Scale(ACCENT_HEIGHT), rcHeader.right, rcHeader.bottom };
+            FillRect(hdc, &rcAccent, m_hAccentBrush);
+        }
+
+        SetTextColor(hdc, isSelected ? SELECTED_TEXT_COLOR : TEXT_COLOR);
+        RECT rcText = rcHeader;
+        rcText.bottom -= Scale(ACCENT_HEIGHT);
+        DrawTextW(hdc, m_names[i].c_str(), -1, &rcText, DT_CENTER | DT_VCENTER | DT_SINGLELINE | DT_NOPREFIX);
+
+        if (isSelected && GetFocus() == m_hwnd)
+        {
+            InflateRect(&rcText, -2, -2);
+            DrawFocusRect(hdc, &rcText);
+        }
+    }
+    SelectClipRgn(hdc, NULL);
+
+    if (HasOverflow())
+    {
+        int maxScroll = m_offsets.back() - viewWidth;
+        RECT rcLeft = { viewWidth, 0, viewWidth + Scale(ARROW_WIDTH), rcClient.bottom };
+        RECT rcRight = { viewWidth + Scale(ARROW_WIDTH), 0, rcClient.right, rcClient.bottom };
+        SetTextColor(hdc, m_scrollX > 0 ? TEXT_COLOR : DISABLED_TEXT_COLOR);
+        DrawTextW(hdc, L"<", -1, &rcLeft, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+        SetTextColor(hdc, m_scrollX < maxScroll ? TEXT_COLOR : DISABLED_TEXT_COLOR);
+        DrawTextW(hdc, L">", -1, &rcRight, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+    }
+    SelectObject(hdc, hOldFont);
+}
+
+/**
+ * @brief Finds the header at a horizontal client position.
+ * @return The tab index, or -1 if there is no header there.
+ */
+int TabStrip::HitTest(int x)
+{
+    UpdateLayout();
+    if (x < 0 || x >= GetViewWidth()) return -1;
+
+    int contentX = x + m_scrollX;
+    int index = static_cast<int>(std::upper_bound(m_offsets.begin(), m_offsets.end(), contentX) - m_offsets.begin()) - 1;
+    return index < GetTabCount() ? index : -1;
+}
+
+/**
+ * @brief Returns the width available to headers, which excludes the arrow buttons.
+ */
+int TabStrip::GetViewWidth()
+{
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    return HasOverflow() ? (std::max)(static_cast<int>(rc.right) - 2 * Scale(ARROW_WIDTH), 0) : static_cast<int>(rc.right);
+}
+
+bool TabStrip::HasOverflow()
+{
+    UpdateLayout();
+    RECT rc;
+    GetClientRect(m_hwnd, &rc);
+    return m_offsets.back() > rc.right;
+}
+
+/**
+ * @brief Scrolls the headers, clamped to the scroll range.
+ */
+void TabStrip::ScrollTo(int scrollX)
+{
+    UpdateLayout();
+    int maxScroll = (std::max)(m_offsets.back() - GetViewWidth(), 0);
+    scrollX = std::clamp(scrollX, 0, maxScroll);
+    if (scrollX != m_scrollX)
+    {
+        m_scrollX = scrollX;
+        InvalidateRect(m_hwnd, NULL, FALSE);
+    }
+}
+
+void TabStrip::EnsureVisible(int index)
+{
+    UpdateLayout();
+    int viewWidth = GetViewWidth();
+    if (m_offsets[index] < m_scrollX)
+    {
+        ScrollTo(m_offsets[index]);
+    }
+    else if (m_offsets[index + 1] > m_scrollX + viewWidth)
+    {
+        ScrollTo(m_offsets[index + 1] - viewWidth);
+    }
+}
+
+/**
+ * @brief Selects a tab in response to user input and notifies the parent.
+ */
+void TabStrip::SelectByUser(int index)
+{
+    if (GetTabCount() == 0) return;
+
+    index = std::clamp(index, 0, GetTabCount() - 1);
+    if (index == m_selected) return;
+
+    SetCurSel(index);
+    NMHDR nmhdr = { m_hwnd, (UINT_PTR)GetDlgCtrlID(m_hwnd), TCN_SELCHANGE };
+    SendMessage(GetParent(m_hwnd), WM_NOTIFY, nmhdr.idFrom, (LPARAM)&nmhdr);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A single row of tab headers that scrolls horizontally instead of wrapping.
+ *
+ * Header widths are measured once per name and kept as running offsets, so that
+ * hit-testing and painting only touch the headers inside the visible range no matter
+ * how many tabs exist. When the headers do not fit, arrow buttons appear at the right
+ * end; the strip also scrolls with the mouse wheel and, when focused, follows the arrow,
+ * Home and End keys. A selection made by the user is reported to the parent window as
+ * WM_NOTIFY with TCN_SELCHANGE, as a tab control would.
+ */
+class TabStrip
+{
+public:
+    static bool RegisterWindowClass(HINSTANCE hInstance);
+
+    TabStrip() = default;
+
+    TabStrip(const TabStrip&) = delete;
+    TabStrip& operator=(const TabStrip&) = delete;
+
+    bool Create(HWND hParent, HINSTANCE hInstance);
+    HWND GetHandle() const { return m_hwnd; }
+
+    void SetDpi(UINT dpi);
+    void SetFont(HFONT hFont);
+    void SetBrushes(HBRUSH hBackground, HBRUSH hSelected, HBRUSH hAccent);
+    int GetPreferredHeight() const { return m_height; }
+
+    void SetTabs(std::vector<std::wstring> names);
+    void InsertTab(int index, const std::wstring& name);
+    void DeleteTab(int index);
+    void SetTabName(int index, const std::wstring& name);
+    int GetTabCount() const { return static_cast<int>(m_names.size()); }
+
+    int GetCurSel() const { return m_selected; }
+    void SetCurSel(int index);
+
+private:
+    static LRESULT CALLBACK WindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+    LRESULT HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam);
+
+    int Scale(int pixels) const { return MulDiv(pixels, m_dpi, 96); }
+    void InvalidateLayout();
+    void UpdateLayout();
+    void Paint(HDC hdc, const RECT& rcClient);
+    int HitTest(int x);
+    int GetViewWidth();
+    bool HasOverflow();
+    void ScrollTo(int scrollX);
+    void EnsureVisible(int index);
+    void SelectByUser(int index);
+
+    HWND m_hwnd{ NULL };
+    HFONT m_hFont{ NULL };
+    HBRUSH m_hBackgroundBrush{ NULL };
+    HBRUSH m_hSelectedBrush{ NULL };
+    HBRUSH m_hAccentBrush{ NULL };
+    UINT m_dpi{ 96 };
+    int m_height{ 0 };
+
+    std::vector<std::wstring> m_names;
+    std::vector<int> m_offsets;     // Left edge of each header, plus the total width at the end
+    bool m_layoutValid{ false };
+
+    int m_selected{ -1 };
+    int m_scrollX{ 0 };
+    int m_wheelRemainder{ 0 };
+};
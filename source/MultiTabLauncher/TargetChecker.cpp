@@ -0,0 +1,218 @@
+#include "TargetChecker.h"
+#include "Trace.h"
+
+#include <cwctype>
+#include <filesystem>
+#include <system_error>
+
+namespace
+{
+    std::wstring ToLower(std::wstring text)
+    {
+        for (wchar_t& ch : text)
+        {
+            ch = static_cast<wchar_t>(std::towlower(ch));
+        }
+        return text;
+    }
+
+    // Targets that are opened by the shell rather than found on disk: URLs, shell: folders
+    // and ::{CLSID} namespaces. One letter before the colon is a drive, not a scheme.
+    bool IsShellOnlyTarget(const std::wstring& path)
+    {
+        if (path.rfind(L"::", 0) == 0) return true;
+
+        size_t colon = path.find(L':');
+        if (colon == std::wstring::npos || colon < 2) return false;
+        for (size_t i = 0; i < colon; ++i)
+        {
+            wchar_t ch = path[i];
+            bool isLetter = (ch >= L'a' && ch <= L'z') || (ch >= L'A' && ch <= L'Z');
+            bool isSchemeChar = (ch >= L'0' && ch <= L'9') || ch == L'+' || ch == L'-' || ch == L'.';
+            if (!isLetter && (i == 0 || !isSchemeChar)) return false;
+        }
+        return true;
+    }
+
+    DirectoryListingStatus GetListingStatus(const std::error_code& error)
+    {
+        if (error == std::errc::permission_denied)
+        {
+            return DirectoryListingStatus::AccessDenied;
+        }
+        if (error == std::errc::host_unreachable || error == std::errc::network_unreachable ||
+            error == std::errc::network_down || error == std::errc::timed_out || error == std::errc::connection_refused)
+        {
+            return DirectoryListingStatus::Unreachable;
+        }
+        return DirectoryListingStatus::Missing;
+    }
+}
+
+DirectoryListingStatus FileSystemDirectoryLister::ListDirectory(const std::wstring& directory, std::vector<std::wstring>& names)
+{
+    names.clear();
+    std::error_code error;
+    std::filesystem::directory_iterator it(std::filesystem::path(directory), error);
+    for (; !error && it != std::filesystem::directory_iterator(); it.increment(error))
+    {
+        names.push_back(it->path().filename().wstring());
+    }
+    return error ? GetListingStatus(error) : DirectoryListingStatus::Listed;
+}
+
+bool FileSystemDirectoryLister::IsNetworkDirectory(const std::wstring& directory)
+{
+    return directory.rfind(L"\\\\", 0) == 0 || directory.rfind(L"//", 0) == 0;
+}
+
+/**
+ * @brief Checks targets, setting the state of each.
+ * @param lister Lists the directories that are not cached or whose listing expired.
+ * @param targets The targets; their expanded paths are checked.
+ * @param applicationDirectory Directory that relative paths with a directory part start from.
+ * @param searchDirectories Directories searched, in order, for names without a directory.
+ * @param nowMs The current time, in milliseconds from any fixed point.
+ * @param token Stops the pass between two directories; targets not reached stay Unknown.
+ */
+void TargetChecker::CheckAll(DirectoryLister& lister, std::vector<TargetCheck>& targets, const std::wstring& applicationDirectory,
+                             const std::vector<std::wstring>& searchDirectories, uint64_t nowMs, const CancellationToken& token)
+{
+    // The targets in each directory, so that its listing is looked up once for all of them
+    struct DirectoryTargets
+    {
+        std::wstring directory;
+        std::vector<std::pair<size_t, std::wstring>> files;
+    };
+    std::unordered_map<std::wstring, DirectoryTargets> byDirectory;
+    std::vector<size_t> bareNames;
+
+    for (size_t index = 0; index < targets.size(); ++index)
+    {
+        const std::wstring& path = targets[index].expandedPath;
+        targets[index].state = TargetState::Unknown;
+        if (path.empty() || IsShellOnlyTarget(path))
+        {
+            continue;
+        }
+
+        std::filesystem::path target(path);
+        std::wstring directory;
+        if (target.is_absolute())
+        {
+            // A drive or share root is found by listing it
+            directory = target.has_filename() ? target.parent_path().wstring() : path;
+        }
+        else if (target.has_parent_path())
+        {
+            // Paths with a directory part are relative to the application directory
+            directory = (std::filesystem::path(applicationDirectory) / target).parent_path().wstring();
+        }
+        else
+        {
+            bareNames.push_back(index);
+            continue;
+        }
+        DirectoryTargets& group = byDirectory[ToLower(directory)];
+        if (group.files.empty()) group.directory = std::move(directory);
+        group.files.emplace_back(index, target.filename().wstring());
+    }
+
+    for (const auto& [key, group] : byDirectory)
+    {
+        if (token.IsCancelled()) return;
+        const DirectoryListing& listing = GetListing(lister, group.directory, nowMs);
+        for (const auto& [index, fileName] : group.files)
+        {
+            targets[index].state = listing.Find(fileName);
+        }
+    }
+    for (size_t index : bareNames)
+    {
+        if (token.IsCancelled()) return;
+        targets[index].state = FindBareName(lister, targets[index].expandedPath, searchDirectories, nowMs);
+    }
+}
+
+/**
+ * @brief Searches for a name without a directory like SearchPath does, trying .exe if it
+ *        has no extension, then among the registered programs.
+ */
+TargetState TargetChecker::FindBareName(DirectoryLister& lister, const std::wstring& fileName,
+                                        const std::vector<std::wstring>& searchDirectories, uint64_t nowMs)
+{
+    bool anyUnreachable = false;
+    bool hasExtension = std::filesystem::path(fileName).has_extension();
+    for (const std::wstring& directory : searchDirectories)
+    {
+        const DirectoryListing& listing = GetListing(lister, directory, nowMs);
+        TargetState state = listing.Find(fileName);
+        if (state == TargetState::Missing && !hasExtension)
+        {
+            state = listing.Find(fileName + L".exe");
+        }
+        if (state == TargetState::Ok) return TargetState::Ok;
+        if (state == TargetState::Unreachable) anyUnreachable = true;
+    }
+    if (lister.IsRegisteredProgram(hasExtension ? fileName : fileName + L".exe"))
+    {
+        return TargetState::Ok;
+    }
+    return anyUnreachable ? TargetState::Unreachable : TargetState::Missing;
+}
+
+/**
+ * @brief Returns the cached listing of a directory, listing it again if it expired.
+ */
+const TargetChecker::DirectoryListing& TargetChecker::GetListing(DirectoryLister& lister, const std::wstring& directory, uint64_t nowMs)
+{
+    std::wstring cacheKey = ToLower(directory);
+    auto found = m_listings.find(cacheKey);
+    if (found != m_listings.end() && nowMs - found->second.fetchedAt < found->second.timeToLive)
+    {
+        return found->second;
+    }
+
+    TRACE_SCOPE("EnumerateDirectory");
+    DirectoryListing& listing = m_listings[cacheKey];
+    listing = DirectoryListing();
+    listing.fetchedAt = nowMs;
+    listing.status = lister.ListDirectory(directory, m_names);
+    m_listingCount++;
+    if (listing.status == DirectoryListingStatus::Unreachable)
+    {
+        listing.timeToLive = UNREACHABLE_LISTING_TTL_MS;
+    }
+    else
+    {
+        listing.timeToLive = lister.IsNetworkDirectory(directory) ? NETWORK_LISTING_TTL_MS : LOCAL_LISTING_TTL_MS;
+    }
+    if (listing.status == DirectoryListingStatus::Listed)
+    {
+        listing.names.reserve(m_names.size());
+        for (std::wstring& name : m_names)
+        {
+            listing.names.insert(ToLower(std::move(name)));
+        }
+    }
+    return listing;
+}
+
+/**
+ * @brief Looks a file name up in the listing; an empty name stands for the directory itself.
+ */
+TargetState TargetChecker::DirectoryListing::Find(const std::wstring& fileName) const
+{
+    switch (status)
+    {
+    case DirectoryListingStatus::Unreachable:
+        return TargetState::Unreachable;
+    case DirectoryListingStatus::Missing:
+        return TargetState::Missing;
+    case DirectoryListingStatus::AccessDenied:
+        return fileName.empty() ? TargetState::Ok : TargetState::Unknown;
+    case DirectoryListingStatus::Listed:
+        break;
+    }
+    return fileName.empty() || names.count(ToLower(fileName)) ? TargetState::Ok : TargetState::Missing;
+}
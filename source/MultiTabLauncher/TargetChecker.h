@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "ConfigModel.h"
+#include "TaskExecutor.h"
+
+// Result of checking whether a button's target exists.
+enum class TargetState
+{
+    Unknown,     // Not checked yet, or cannot be checked (URLs, shell namespaces, access denied)
+    Ok,
+    Missing,
+    Unreachable  // The containing network location did not respond
+};
+
+// A button target to check, together with the result of the check.
+struct TargetCheck
+{
+    ButtonKey key;
+    std::wstring path;          // As configured; used to discard stale results
+    std::wstring expandedPath;  // With environment variables expanded
+    TargetState state{ TargetState::Unknown };
+};
+
+enum class DirectoryListingStatus
+{
+    Listed,
+    Missing,        // The directory does not exist
+    Unreachable,    // The network location holding it did not respond
+    AccessDenied
+};
+
+/**
+ * @brief How a platform lists directories and finds programs registered outside them.
+ *
+ * TargetValidator lists with FindFirstFileEx and looks into App Paths; FileSystemDirectoryLister
+ * uses std::filesystem.
+ */
+class DirectoryLister
+{
+public:
+    virtual ~DirectoryLister() = default;
+
+    // Replaces names with those of the files and directories in the directory
+    virtual DirectoryListingStatus ListDirectory(const std::wstring& directory, std::vector<std::wstring>& names) = 0;
+    // Listings of network locations are kept longer
+    virtual bool IsNetworkDirectory(const std::wstring& directory) = 0;
+    // Whether a program name without a directory is registered to be launched by name
+    virtual bool IsRegisteredProgram(const std::wstring& fileName) = 0;
+};
+
+/**
+ * @brief Directories listed with std::filesystem; no program is registered by name.
+ */
+class FileSystemDirectoryLister : public DirectoryLister
+{
+public:
+    DirectoryListingStatus ListDirectory(const std::wstring& directory, std::vector<std::wstring>& names) override;
+    bool IsNetworkDirectory(const std::wstring& directory) override;
+    bool IsRegisteredProgram(const std::wstring&) override { return false; }
+};
+
+/**
+ * @brief Decides whether button targets exist from cached directory listings.
+ *
+ * Instead of probing every file, the targets are grouped by parent directory, each
+ * directory is listed once and the file names are looked up in the listing. Listings
+ * are cached with a time-to-live that is longer for network locations, so shares are
+ * not listed on every pass, and shorter for locations that did not respond. Names
+ * without a directory are searched for in the given directories like SearchPath does,
+ * then among the registered programs. Names are compared without case. Not
+ * thread-safe; one pass runs at a time.
+ */
+class TargetChecker
+{
+public:
+    static constexpr uint64_t LOCAL_LISTING_TTL_MS = 60 * 1000;
+    static constexpr uint64_t NETWORK_LISTING_TTL_MS = 10 * 60 * 1000;
+    static constexpr uint64_t UNREACHABLE_LISTING_TTL_MS = 2 * 60 * 1000;
+
+    void CheckAll(DirectoryLister& lister, std::vector<TargetCheck>& targets, const std::wstring& applicationDirectory,
+                  const std::vector<std::wstring>& searchDirectories, uint64_t nowMs, const CancellationToken& token);
+
+    size_t GetCachedDirectoryCount() const { return m_listings.size(); }
+    uint64_t GetListingCount() const { return m_listingCount; }
+
+private:
+    struct DirectoryListing
+    {
+        DirectoryListingStatus status{ DirectoryListingStatus::Listed };
+        uint64_t fetchedAt{ 0 };
+        uint64_t timeToLive{ 0 };
+        std::unordered_set<std::wstring> names; // Lower case
+
+        TargetState Find(const std::wstring& fileName) const;
+    };
+
+    TargetState FindBareName(DirectoryLister& lister, const std::wstring& fileName,
+                             const std::vector<std::wstring>& searchDirectories, uint64_t nowMs);
+    const DirectoryListing& GetListing(DirectoryLister& lister, const std::wstring& directory, uint64_t nowMs);
+
+    std::unordered_map<std::wstring, DirectoryListing> m_listings;  // By lower-case path
+    std::vector<std::wstring> m_names;                              // Reused between listings
+    uint64_t m_listingCount{ 0 };
+};
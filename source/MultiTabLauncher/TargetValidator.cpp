@@ -0,0 +1,218 @@
+#include "TargetValidator.h"
+#include "BackgroundModeScope.h"
+#include "Trace.h"
+
+#include <shlwapi.h>
+#include <algorithm>
+
+namespace
+{
+    bool IsNetworkErrorCode(DWORD error)
+    {
+        return error == ERROR_BAD_NETPATH || error == ERROR_BAD_NET_NAME || error == ERROR_NETWORK_UNREACHABLE;
+    }
+
+    // Lists directories with FindFirstFileEx and finds programs registered in App Paths
+    class FindFileDirectoryLister : public DirectoryLister
+    {
+    public:
+        DirectoryListingStatus ListDirectory(const std::wstring& directory, std::vector<std::wstring>& names) override
+        {
+            names.clear();
+            std::wstring pattern = directory;
+            if (!pattern.empty() && pattern.back() != L'\\' && pattern.back() != L'/')
+            {
+                pattern += L'\\';
+            }
+            pattern += L'*';
+
+            WIN32_FIND_DATAW findData;
+            HANDLE hFind = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &findData, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+            if (hFind == INVALID_HANDLE_VALUE)
+            {
+                DWORD error = GetLastError();
+                if (IsNetworkErrorCode(error)) return DirectoryListingStatus::Unreachable;
+                if (error == ERROR_ACCESS_DENIED) return DirectoryListingStatus::AccessDenied;
+                // ERROR_FILE_NOT_FOUND only means the directory is empty
+                return error == ERROR_FILE_NOT_FOUND ? DirectoryListingStatus::Listed : DirectoryListingStatus::Missing;
+            }
+
+            do {
+                names.push_back(findData.cFileName);
+            } while (FindNextFileW(hFind, &findData));
+            FindClose(hFind);
+            return DirectoryListingStatus::Listed;
+        }
+
+        bool IsNetworkDirectory(const std::wstring& directory) override
+        {
+            return PathIsNetworkPathW(directory.c_str()) != FALSE;
+        }
+
+        bool IsRegisteredProgram(const std::wstring& fileName) override
+        {
+            std::wstring subKey = L"Software\\Microsoft\\Windows\\CurrentVersion\\App Paths\\" + fileName;
+            for (HKEY hRoot : { HKEY_CURRENT_USER, HKEY_LOCAL_MACHINE })
+            {
+                HKEY hKey;
+                if (RegOpenKeyEx(hRoot, subKey.c_str(), 0, KEY_READ, &hKey) == ERROR_SUCCESS)
+                {
+                    RegCloseKey(hKey);
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+}
+
+TargetValidator::~TargetValidator()
+{
+    Stop();
+}
+
+/**
+ * @brief Starts taking validation requests.
+ * @param executor The executor the validation passes run on.
+ * @param applicationDirectory Directory searched first for relative names.
+ * @param hNotifyWindow Window notified when a validation pass is complete.
+ * @param notifyMessage Message posted when results are available.
+ * @return True on success, false if the executor is not running.
+ */
+bool TargetValidator::Start(TaskExecutor& executor, const std::wstring& applicationDirectory, HWND hNotifyWindow, UINT notifyMessage)
+{
+    if (m_tasks.IsRunning()) return true;
+    if (!executor.IsRunning()) return false;
+
+    m_applicationDirectory = applicationDirectory;
+    m_hNotifyWindow = hNotifyWindow;
+    m_notifyMessage = notifyMessage;
+    m_isTaskQueued = false;
+    m_tasks.Start(executor);
+    return true;
+}
+
+/**
+ * @brief Stops validating. A pass in progress is abandoned after its current directory.
+ */
+void TargetValidator::Stop()
+{
+    m_tasks.Stop();
+}
+
+/**
+ * @brief Queues targets for validation, replacing any request not yet started.
+ */
+void TargetValidator::Submit(std::vector<TargetCheck> targets)
+{
+    if (!m_tasks.IsRunning()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingTargets = std::move(targets);
+        m_hasPendingTargets = true;
+        if (m_isTaskQueued)
+        {
+            return; // The queued task takes these targets
+        }
+        m_isTaskQueued = true;
+    }
+    if (!m_tasks.Submit(TaskPriority::Background, [this]() { RunValidationPasses(); }))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isTaskQueued = false;
+    }
+}
+
+/**
+ * @brief Drops the queued check and the results of a button that now has another target
+ *        or was removed. A check already running is dropped with the next TakeResults().
+ */
+void TargetValidator::Forget(ButtonKey key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto isForgotten = [&](const TargetCheck& target) { return target.key == key; };
+    m_pendingTargets.erase(std::remove_if(m_pendingTargets.begin(), m_pendingTargets.end(), isForgotten), m_pendingTargets.end());
+    m_results.erase(std::remove_if(m_results.begin(), m_results.end(), isForgotten), m_results.end());
+}
+
+/**
+ * @brief Returns the results of completed passes and clears them.
+ */
+std::vector<TargetCheck> TargetValidator::TakeResults()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_results);
+}
+
+/**
+ * @brief Runs validation passes until no targets are pending. Runs on the executor.
+ */
+void TargetValidator::RunValidationPasses()
+{
+    // Lower both CPU and I/O priority so validation never competes with the user
+    BackgroundModeScope backgroundMode;
+    const CancellationToken& token = m_tasks.GetToken();
+    while (true)
+    {
+        std::vector<TargetCheck> targets;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_hasPendingTargets || token.IsCancelled())
+            {
+                m_isTaskQueued = false;
+                return;
+            }
+            targets = std::move(m_pendingTargets);
+            m_pendingTargets.clear();
+            m_hasPendingTargets = false;
+        }
+
+        TRACE_SCOPE("ValidateTargets");
+        TRACE_COUNTER("ValidatedTargets", targets.size());
+        FindFileDirectoryLister lister;
+        m_checker.CheckAll(lister, targets, m_applicationDirectory, GetSearchDirectories(), GetTickCount64(), token);
+        if (token.IsCancelled()) continue;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.insert(m_results.end(), targets.begin(), targets.end());
+        }
+        PostMessage(m_hNotifyWindow, m_notifyMessage, 0, 0);
+    }
+}
+
+/**
+ * @brief Returns the application directory followed by the directories on PATH.
+ */
+std::vector<std::wstring> TargetValidator::GetSearchDirectories() const
+{
+    std::vector<std::wstring> directories;
+    if (!m_applicationDirectory.empty())
+    {
+        directories.push_back(m_applicationDirectory);
+    }
+
+    DWORD length = GetEnvironmentVariableW(L"PATH", NULL, 0);
+    if (length == 0) return directories;
+
+    std::wstring pathVariable(length, L'\0');
+    length = GetEnvironmentVariableW(L"PATH", pathVariable.data(), length);
+    pathVariable.resize(length);
+
+    size_t start = 0;
+    while (start <= pathVariable.size())
+    {
+        size_t end = pathVariable.find(L';', start);
+        if (end == std::wstring::npos) end = pathVariable.size();
+
+        std::wstring directory = pathVariable.substr(start, end - start);
+        directory.erase(std::remove(directory.begin(), directory.end(), L'"'), directory.end());
+        if (!directory.empty())
+        {
+            directories.push_back(directory);
+        }
+        start = end + 1;
+    }
+    return directories;
+}
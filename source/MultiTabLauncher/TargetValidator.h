@@ -0,0 +1,52 @@
+#pragma once
+
+#include <windows.h>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "TargetChecker.h"
+#include "TaskExecutor.h"
+
+/**
+ * @brief Checks button targets in tasks on the Background lane of the executor.
+ *
+ * TargetChecker decides from cached directory listings; this class lists directories
+ * with FindFirstFileEx, looks bare names up in the application directory, the PATH
+ * directories and App Paths, and runs the passes. When a pass completes, the notification
+ * message is posted and the results can be collected with TakeResults(). One task runs
+ * at a time and takes every pass submitted while it runs, so the listing cache needs no
+ * lock.
+ */
+class TargetValidator
+{
+public:
+    TargetValidator() = default;
+    ~TargetValidator();
+
+    TargetValidator(const TargetValidator&) = delete;
+    TargetValidator& operator=(const TargetValidator&) = delete;
+
+    bool Start(TaskExecutor& executor, const std::wstring& applicationDirectory, HWND hNotifyWindow, UINT notifyMessage);
+    void Stop();
+
+    void Submit(std::vector<TargetCheck> targets);
+    void Forget(ButtonKey key);
+    std::vector<TargetCheck> TakeResults();
+
+private:
+    void RunValidationPasses();
+    std::vector<std::wstring> GetSearchDirectories() const;
+
+    std::wstring m_applicationDirectory;
+    TargetChecker m_checker;    // Validation task only
+
+    std::mutex m_mutex;
+    std::vector<TargetCheck> m_pendingTargets;
+    std::vector<TargetCheck> m_results;
+    bool m_hasPendingTargets{ false };
+    bool m_isTaskQueued{ false };   // Queued or running; it takes the pending targets
+
+    TaskGroup m_tasks;
+    HWND m_hNotifyWindow{ NULL };
+    UINT m_notifyMessage{ 0 };
+};
@@ -0,0 +1,385 @@
+#include "TaskExecutor.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <system_error>
+
+namespace
+{
+    const size_t MAX_DEFAULT_WORKERS = 8;
+
+    const char* const LANE_NAMES[TASK_PRIORITY_COUNT] = { "Interactive", "Visible", "Background" };
+    const char* const LANE_COUNTER_NAMES[TASK_PRIORITY_COUNT] = {
+        "QueuedTasks.Interactive", "QueuedTasks.Visible", "QueuedTasks.Background",
+    };
+
+    // The executor and worker the current thread belongs to, if any
+    thread_local const void* t_executor = nullptr;
+    thread_local size_t t_workerIndex = 0;
+
+    uint64_t ToMicroseconds(std::chrono::steady_clock::duration duration)
+    {
+        return static_cast<uint64_t>((std::max)(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), std::chrono::microseconds::rep{ 0 }));
+    }
+}
+
+CancellationToken CancellationToken::Create()
+{
+    CancellationToken token;
+    token.m_cancelled = std::make_shared<std::atomic<bool>>(false);
+    return token;
+}
+
+void CancellationToken::Cancel() const
+{
+    if (m_cancelled)
+    {
+        m_cancelled->store(true, std::memory_order_relaxed);
+    }
+}
+
+TaskExecutor::~TaskExecutor()
+{
+    Stop();
+}
+
+/**
+ * @brief Sets the functions a worker calls around the tasks of a lane: enter before the
+ *        first such task, leave when the worker exits. Call before Start().
+ */
+void TaskExecutor::SetLaneHooks(TaskPriority lane, std::function<void()> enter, std::function<void()> leave)
+{
+    m_laneHooks[static_cast<int>(lane)] = { std::move(enter), std::move(leave) };
+}
+
+/**
+ * @brief Starts the workers and resets the statistics.
+ * @param workerCount The number of workers; 0 for half the processors, between 2 and 8.
+ * @return True on success, false if the threads could not be created.
+ */
+bool TaskExecutor::Start(size_t workerCount)
+{
+    if (!m_workers.empty()) return true;
+
+    if (workerCount == 0)
+    {
+        workerCount = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 2, MAX_DEFAULT_WORKERS);
+    }
+    m_stopping = false;
+    m_nextWorker = 0;
+    for (int lane = 0; lane < TASK_PRIORITY_COUNT; ++lane)
+    {
+        m_queued[lane] = 0;
+        m_submitted[lane] = 0;
+    }
+
+    // All workers exist before the first thread starts stealing from them
+    for (size_t i = 0; i < workerCount; ++i)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < workerCount; ++i)
+    {
+        try
+        {
+            m_workers[i]->thread = std::thread(&TaskExecutor::RunWorker, this, i);
+        }
+        catch (const std::system_error&)
+        {
+            Stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Stops the workers. Running tasks finish; queued tasks are dropped and counted as
+ *        cancelled. Must not be called from a task.
+ */
+void TaskExecutor::Stop()
+{
+    if (m_workers.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+    for (const std::unique_ptr<Worker>& worker : m_workers)
+    {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+    m_workers.clear();
+}
+
+/**
+ * @brief Queues a task. Tasks submitted from a worker of this executor are queued on that
+ *        worker; others are spread over the workers.
+ * @param lane The lane of the task.
+ * @param token Skips the task if cancelled before it starts.
+ * @param task The work to do on a worker thread.
+ * @return True if the task was queued, false if the executor is not running.
+ */
+bool TaskExecutor::Submit(TaskPriority lane, CancellationToken token, Task task)
+{
+    if (m_workers.empty() || m_stopping) return false;
+
+    const int laneIndex = static_cast<int>(lane);
+    size_t target = (t_executor == this) ? t_workerIndex : m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    Worker& worker = *m_workers[target];
+
+    m_submitted[laneIndex]++;
+    int64_t queued = ++m_queued[laneIndex];
+    m_unfinished++;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.lanes[laneIndex].push_back({ std::move(task), std::move(token), Clock::now() });
+    }
+
+    // Pairs with the sleeping worker, which counts itself before it checks m_queuedTotal:
+    // either the worker sees this task or this sees the worker
+    m_queuedTotal++;
+    if (m_sleepingWorkers > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_wakeCondition.notify_one();
+    }
+    TRACE_COUNTER(LANE_COUNTER_NAMES[laneIndex], queued);
+    return true;
+}
+
+/**
+ * @brief Waits until no task is queued or running. Must not be called from a task.
+ */
+void TaskExecutor::WaitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_idleCondition.wait(lock, [this]() { return m_unfinished == 0; });
+}
+
+/**
+ * @brief Returns the counters of a lane, summed over the workers.
+ */
+TaskLaneStatistics TaskExecutor::GetStatistics(TaskPriority lane) const
+{
+    const int laneIndex = static_cast<int>(lane);
+    TaskLaneStatistics statistics;
+    statistics.queued = m_queued[laneIndex];
+    statistics.submitted = m_submitted[laneIndex];
+    for (const std::unique_ptr<Worker>& worker : m_workers)
+    {
+        std::lock_guard<std::mutex> lock(worker->countersMutex);
+        const LaneCounters& counters = worker->counters[laneIndex];
+        statistics.completed += counters.completed;
+        statistics.cancelled += counters.cancelled;
+        statistics.waitLatency.Merge(counters.waitLatency);
+        statistics.runLatency.Merge(counters.runLatency);
+    }
+    return statistics;
+}
+
+/**
+ * @brief Formats the statistics as a table with one row per lane; latencies in microseconds.
+ */
+std::string TaskExecutor::FormatReport() const
+{
+    std::string report;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-12s %7s %10s %10s %10s %10s %10s %10s %10s\n", "Lane", "Queued", "Submitted",
+        "Completed", "Cancelled", "Wait p50", "Wait p99", "Run p50", "Run p99");
+    report += line;
+    for (int lane = 0; lane < TASK_PRIORITY_COUNT; ++lane)
+    {
+        TaskLaneStatistics statistics = GetStatistics(static_cast<TaskPriority>(lane));
+        std::snprintf(line, sizeof(line), "%-12s %7lld %10llu %10llu %10llu %10llu %10llu %10llu %10llu\n", LANE_NAMES[lane],
+            static_cast<long long>(statistics.queued), static_cast<unsigned long long>(statistics.submitted),
+            static_cast<unsigned long long>(statistics.completed), static_cast<unsigned long long>(statistics.cancelled),
+            static_cast<unsigned long long>(statistics.waitLatency.GetPercentile(50)),
+            static_cast<unsigned long long>(statistics.waitLatency.GetPercentile(99)),
+            static_cast<unsigned long long>(statistics.runLatency.GetPercentile(50)),
+            static_cast<unsigned long long>(statistics.runLatency.GetPercentile(99)));
+        report += line;
+    }
+    std::snprintf(line, sizeof(line), "Workers: %zu\n", m_workers.size());
+    report += line;
+    return report;
+}
+
+void TaskExecutor::RunWorker(size_t index)
+{
+    Trace::SetThreadName("TaskExecutor");
+    t_executor = this;
+    t_workerIndex = index;
+
+    Worker& worker = *m_workers[index];
+    std::array<bool, TASK_PRIORITY_COUNT> enteredLanes{};
+    QueuedTask task;
+    int lane = 0;
+    while (true)
+    {
+        if (TakeTask(index, task, lane))
+        {
+            if (task.token.IsCancelled() || m_stopping)
+            {
+                std::lock_guard<std::mutex> lock(worker.countersMutex);
+                worker.counters[lane].cancelled++;
+            }
+            else
+            {
+                if (!enteredLanes[lane])
+                {
+                    enteredLanes[lane] = true;
+                    if (m_laneHooks[lane].enter) m_laneHooks[lane].enter();
+                }
+                Clock::time_point start = Clock::now();
+                task.run();
+                Clock::time_point end = Clock::now();
+
+                std::lock_guard<std::mutex> lock(worker.countersMutex);
+                LaneCounters& counters = worker.counters[lane];
+                counters.completed++;
+                counters.waitLatency.Record(ToMicroseconds(start - task.queuedAt));
+                counters.runLatency.Record(ToMicroseconds(end - start));
+            }
+            task = QueuedTask(); // Releases what the task captured before waiting for the next
+            FinishTask();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        if (m_stopping) break;
+        m_sleepingWorkers++;
+        m_wakeCondition.wait(lock, [this]() { return m_queuedTotal > 0 || m_stopping; });
+        m_sleepingWorkers--;
+    }
+
+    for (int i = TASK_PRIORITY_COUNT - 1; i >= 0; --i)
+    {
+        if (enteredLanes[i] && m_laneHooks[i].leave) m_laneHooks[i].leave();
+    }
+    t_executor = nullptr;
+}
+
+/**
+ * @brief Takes the most urgent task available to a worker: the newest of its own, or else
+ *        the oldest of another worker, lane by lane.
+ * @return True if a task was taken.
+ */
+bool TaskExecutor::TakeTask(size_t index, QueuedTask& task, int& lane)
+{
+    const size_t workerCount = m_workers.size();
+    for (int candidateLane = 0; candidateLane < TASK_PRIORITY_COUNT; ++candidateLane)
+    {
+        // Counted before a task is queued and after it is taken, so 0 means none is queued
+        if (m_queued[candidateLane].load(std::memory_order_relaxed) == 0) continue;
+
+        for (size_t i = 0; i < workerCount; ++i)
+        {
+            Worker& victim = *m_workers[(index + i) % workerCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            std::deque<QueuedTask>& queue = victim.lanes[candidateLane];
+            if (queue.empty()) continue;
+
+            if (i == 0)
+            {
+                task = std::move(queue.back());
+                queue.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            lane = candidateLane;
+            m_queued[candidateLane]--;
+            m_queuedTotal--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskExecutor::FinishTask()
+{
+    if (--m_unfinished == 0)
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_idleCondition.notify_all();
+    }
+}
+
+TaskGroup::PendingTask::PendingTask(std::shared_ptr<State> taskState)
+    : state(std::move(taskState))
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->pendingTasks++;
+}
+
+TaskGroup::PendingTask::~PendingTask()
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (--state->pendingTasks == 0)
+    {
+        state->finishedCondition.notify_all();
+    }
+}
+
+TaskGroup::~TaskGroup()
+{
+    Stop();
+}
+
+/**
+ * @brief Starts submitting to an executor, with a new token.
+ */
+void TaskGroup::Start(TaskExecutor& executor)
+{
+    if (m_executor) return;
+
+    m_token = CancellationToken::Create();
+    m_executor = &executor;
+}
+
+/**
+ * @brief Cancels the tasks of the group and waits until the running ones returned.
+ */
+void TaskGroup::Stop()
+{
+    if (!m_executor) return;
+
+    m_token.Cancel();
+    m_executor = nullptr;
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->finishedCondition.wait(lock, [this]() { return m_state->pendingTasks == 0; });
+}
+
+/**
+ * @brief Queues a task of the group.
+ * @param lane The lane of the task.
+ * @param token Skips the task if cancelled before it starts, as the group's own token does.
+ * @param task The work to do; it can check GetToken() to return early.
+ * @return True if the task was queued, false if the group or the executor is stopped.
+ */
+bool TaskGroup::Submit(TaskPriority lane, CancellationToken token, TaskExecutor::Task task)
+{
+    TaskExecutor* executor = m_executor;
+    if (!executor) return false;
+
+    auto pending = std::make_shared<PendingTask>(m_state);
+    CancellationToken groupToken = m_token;
+    return executor->Submit(lane, std::move(token), [pending, groupToken, task = std::move(task)]()
+        {
+            if (!groupToken.IsCancelled()) task();
+        });
+}
+
+/**
+ * @brief Tests whether a task of the group is queued or running.
+ */
+bool TaskGroup::HasPendingTasks() const
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->pendingTasks > 0;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LatencyHistogram.h"
+
+// Lanes of the executor, most urgent first. A task of a lane runs before any queued task
+// of a later lane, on any worker.
+enum class TaskPriority
+{
+    Interactive,    // The user is waiting for it, e.g. a launch
+    Visible,        // Affects what is on screen, e.g. icons of the current tab
+    Background      // Prefetching, validation and other work nobody waits for
+};
+const int TASK_PRIORITY_COUNT = 3;
+
+/**
+ * @brief A flag shared by the code that submits tasks and the tasks themselves.
+ *
+ * Cancelling skips tasks with the token that have not started yet; a running task can
+ * check IsCancelled() to stop early. Copies share the flag. A default-constructed token
+ * can never be cancelled.
+ */
+class CancellationToken
+{
+public:
+    CancellationToken() = default;
+
+    static CancellationToken Create();
+
+    void Cancel() const;
+    bool IsCancelled() const { return m_cancelled && m_cancelled->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+// Counters of one lane since the executor was started.
+struct TaskLaneStatistics
+{
+    int64_t queued{ 0 };            // Waiting now
+    uint64_t submitted{ 0 };
+    uint64_t completed{ 0 };
+    uint64_t cancelled{ 0 };        // Skipped because of their token or Stop()
+    LatencyHistogram waitLatency;   // From submission to start, in microseconds
+    LatencyHistogram runLatency;    // In microseconds
+};
+
+/**
+ * @brief A fixed pool of worker threads shared by all background work of the launcher.
+ *
+ * Every worker has a deque per lane. Tasks submitted by a worker go to its own deques,
+ * others are spread over the workers in turn. A worker takes the newest task of its own
+ * deque, whose data is most likely still in its cache, and otherwise steals the oldest
+ * task of another worker, lane by lane, so an idle worker never waits while others have
+ * work queued and more urgent lanes are always served first.
+ *
+ * Lane hooks run on a worker the first time it runs a task of that lane and when it
+ * exits, e.g. to initialize COM for lanes whose tasks use the shell. Tasks must not
+ * throw and must not wait for other tasks.
+ */
+class TaskExecutor
+{
+public:
+    using Task = std::function<void()>;
+
+    TaskExecutor() = default;
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    void SetLaneHooks(TaskPriority lane, std::function<void()> enter, std::function<void()> leave);
+    bool Start(size_t workerCount = 0);
+    void Stop();
+    bool IsRunning() const { return !m_workers.empty(); }
+
+    bool Submit(TaskPriority lane, Task task) { return Submit(lane, CancellationToken(), std::move(task)); }
+    bool Submit(TaskPriority lane, CancellationToken token, Task task);
+    void WaitUntilIdle();
+
+    size_t GetWorkerCount() const { return m_workers.size(); }
+    TaskLaneStatistics GetStatistics(TaskPriority lane) const;
+    std::string FormatReport() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct QueuedTask
+    {
+        Task run;
+        CancellationToken token;
+        Clock::time_point queuedAt;
+    };
+
+    struct LaneCounters
+    {
+        uint64_t completed{ 0 };
+        uint64_t cancelled{ 0 };
+        LatencyHistogram waitLatency;
+        LatencyHistogram runLatency;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::array<std::deque<QueuedTask>, TASK_PRIORITY_COUNT> lanes;
+        mutable std::mutex countersMutex;   // Only contended while statistics are read
+        std::array<LaneCounters, TASK_PRIORITY_COUNT> counters;
+        std::thread thread;
+    };
+
+    struct LaneHooks
+    {
+        std::function<void()> enter;
+        std::function<void()> leave;
+    };
+
+    void RunWorker(size_t index);
+    bool TakeTask(size_t index, QueuedTask& task, int& lane);
+    void FinishTask();
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::array<LaneHooks, TASK_PRIORITY_COUNT> m_laneHooks;
+    std::atomic<size_t> m_nextWorker{ 0 };
+
+    std::array<std::atomic<int64_t>, TASK_PRIORITY_COUNT> m_queued{};
+    std::array<std::atomic<uint64_t>, TASK_PRIORITY_COUNT> m_submitted{};
+    std::atomic<int64_t> m_queuedTotal{ 0 };
+    std::atomic<int64_t> m_unfinished{ 0 };     // Queued or running
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_idleCondition;
+    std::atomic<int> m_sleepingWorkers{ 0 };
+    std::atomic<bool> m_stopping{ false };
+};
+
+/**
+ * @brief The tasks one part of the launcher submitted to an executor, so that the part
+ *        can stop them before it releases what they use.
+ *
+ * The tasks share the group's token, which Stop() cancels. Stop() then waits until every
+ * task submitted through the group has either run or been dropped by the executor, which
+ * replaces the worker thread a part would otherwise own and join. A task is counted until
+ * the executor releases it, so a task the executor skips or drops at its own Stop() is
+ * never waited for in vain. Stop() must not be called from a task of the group.
+ */
+class TaskGroup
+{
+public:
+    TaskGroup() = default;
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void Start(TaskExecutor& executor);
+    void Stop();
+    bool IsRunning() const { return m_executor.load() != nullptr; }
+
+    bool Submit(TaskPriority lane, TaskExecutor::Task task) { return Submit(lane, m_token, std::move(task)); }
+    bool Submit(TaskPriority lane, CancellationToken token, TaskExecutor::Task task);
+    const CancellationToken& GetToken() const { return m_token; }
+    bool HasPendingTasks() const;
+
+private:
+    // Shared with the tasks, so that a task dropped after the group is gone finds it alive
+    struct State
+    {
+        mutable std::mutex mutex;
+        std::condition_variable finishedCondition;
+        size_t pendingTasks{ 0 };
+    };
+
+    // Held by a submitted task; its release marks the task finished, run or not
+    struct PendingTask
+    {
+        std::shared_ptr<State> state;
+
+        explicit PendingTask(std::shared_ptr<State> taskState);
+        ~PendingTask();
+    };
+
+    std::atomic<TaskExecutor*> m_executor{ nullptr };
+    CancellationToken m_token;
+    std::shared_ptr<State> m_state{ std::make_shared<State>() };
+};
@@ -0,0 +1,467 @@
+#include "TextKernels.h"
+
+#include <cwctype>
+#include "SimdLevel.h"
+
+#if MTL_ENABLE_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace
+{
+    const char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+#if MTL_ENABLE_SIMD
+    unsigned LowestSetBit(unsigned mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+#endif
+
+    // The kernels are written for UTF-16 and UTF-32 code units, as wchar_t is 16 bits on
+    // Windows but 32 bits elsewhere. Each vector loop handles whole blocks and returns where
+    // it stopped; the plain loop after it finishes the rest.
+
+#if MTL_ENABLE_SIMD
+    template <typename Unit>
+    const Unit* FindUnitSse2(const Unit* first, const Unit* last, Unit ch)
+    {
+        constexpr size_t lanes = 16 / sizeof(Unit);
+        const __m128i needle = sizeof(Unit) == 2 ? _mm_set1_epi16(static_cast<short>(ch)) : _mm_set1_epi32(static_cast<int>(ch));
+        while (static_cast<size_t>(last - first) >= lanes)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            __m128i equal = sizeof(Unit) == 2 ? _mm_cmpeq_epi16(block, needle) : _mm_cmpeq_epi32(block, needle);
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(equal));
+            if (mask != 0)
+            {
+                return first + LowestSetBit(mask) / sizeof(Unit);
+            }
+            first += lanes;
+        }
+        return first;
+    }
+
+    template <typename Unit>
+    MTL_TARGET_AVX2 const Unit* FindUnitAvx2(const Unit* first, const Unit* last, Unit ch)
+    {
+        constexpr size_t lanes = 32 / sizeof(Unit);
+        const __m256i needle = sizeof(Unit) == 2 ? _mm256_set1_epi16(static_cast<short>(ch)) : _mm256_set1_epi32(static_cast<int>(ch));
+        while (static_cast<size_t>(last - first) >= lanes)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            __m256i equal = sizeof(Unit) == 2 ? _mm256_cmpeq_epi16(block, needle) : _mm256_cmpeq_epi32(block, needle);
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(equal));
+            if (mask != 0)
+            {
+                return first + LowestSetBit(mask) / sizeof(Unit);
+            }
+            first += lanes;
+        }
+        return FindUnitSse2(first, last, ch);
+    }
+
+    size_t CountAsciiBytesSse2(const char* bytes, size_t length)
+    {
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            // The top bit of every byte is set in non-ASCII bytes only
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(block));
+            if (mask != 0)
+            {
+                return i + LowestSetBit(mask);
+            }
+        }
+        return i;
+    }
+
+    MTL_TARGET_AVX2 size_t CountAsciiBytesAvx2(const char* bytes, size_t length)
+    {
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(block));
+            if (mask != 0)
+            {
+                return i + LowestSetBit(mask);
+            }
+        }
+        return i + CountAsciiBytesSse2(bytes + i, length - i);
+    }
+
+    template <typename Unit>
+    size_t WidenBytesSse2(const char* bytes, size_t length, Unit* destination)
+    {
+        size_t i = 0;
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+            __m128i low = _mm_unpacklo_epi8(block, zero);
+            __m128i high = _mm_unpackhi_epi8(block, zero);
+            __m128i* out = reinterpret_cast<__m128i*>(destination + i);
+            if constexpr (sizeof(Unit) == 2)
+            {
+                _mm_storeu_si128(out, low);
+                _mm_storeu_si128(out + 1, high);
+            }
+            else
+            {
+                _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+            }
+        }
+        return i;
+    }
+
+    template <typename Unit>
+    MTL_TARGET_AVX2 size_t WidenBytesAvx2(const char* bytes, size_t length, Unit* destination)
+    {
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+            __m256i* out = reinterpret_cast<__m256i*>(destination + i);
+            if constexpr (sizeof(Unit) == 2)
+            {
+                _mm256_storeu_si256(out, _mm256_cvtepu8_epi16(block));
+            }
+            else
+            {
+                _mm256_storeu_si256(out, _mm256_cvtepu8_epi32(block));
+                _mm256_storeu_si256(out + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(block, 8)));
+            }
+        }
+        return i;
+    }
+
+    /**
+     * @brief Appends the ASCII units at the start of a run as bytes, 16 at a time.
+     * @return The first unit not appended: the first non-ASCII one or the start of the last,
+     *         partial block.
+     */
+    template <typename Unit>
+    const Unit* NarrowAsciiSse2(const Unit* first, const Unit* last, std::string& bytes)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i highBits = sizeof(Unit) == 2 ? _mm_set1_epi16(static_cast<short>(0xFF80)) : _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+        char block[16];
+        while (last - first >= 16)
+        {
+            __m128i units[16 / (16 / sizeof(Unit))];
+            __m128i any = zero;
+            for (size_t j = 0; j < sizeof(units) / sizeof(units[0]); ++j)
+            {
+                units[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first) + j);
+                any = _mm_or_si128(any, _mm_and_si128(units[j], highBits));
+            }
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) != 0xFFFF)
+            {
+                break;
+            }
+            // Saturating packs keep values below 0x80 as they are
+            __m128i packed;
+            if constexpr (sizeof(Unit) == 2)
+            {
+                packed = _mm_packus_epi16(units[0], units[1]);
+            }
+            else
+            {
+                packed = _mm_packus_epi16(_mm_packs_epi32(units[0], units[1]), _mm_packs_epi32(units[2], units[3]));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(block), packed);
+            bytes.append(block, 16);
+            first += 16;
+        }
+        return first;
+    }
+#endif
+
+    template <typename Unit>
+    const Unit* FindUnit(const Unit* first, const Unit* last, Unit ch, SimdLevel level)
+    {
+#if MTL_ENABLE_SIMD
+        if (level >= SimdLevel::Avx2) first = FindUnitAvx2(first, last, ch);
+        else if (level >= SimdLevel::Sse2) first = FindUnitSse2(first, last, ch);
+#else
+        (void)level;
+#endif
+        for (; first != last; ++first)
+        {
+            if (*first == ch) return first;
+        }
+        return last;
+    }
+
+    size_t CountAsciiBytes(const char* bytes, size_t length, SimdLevel level)
+    {
+        size_t i = 0;
+#if MTL_ENABLE_SIMD
+        if (level >= SimdLevel::Avx2) i = CountAsciiBytesAvx2(bytes, length);
+        else if (level >= SimdLevel::Sse2) i = CountAsciiBytesSse2(bytes, length);
+#else
+        (void)level;
+#endif
+        while (i < length && static_cast<unsigned char>(bytes[i]) < 0x80) ++i;
+        return i;
+    }
+
+    template <typename Unit>
+    void WidenBytes(const char* bytes, size_t length, Unit* destination, SimdLevel level)
+    {
+        size_t i = 0;
+#if MTL_ENABLE_SIMD
+        if (level >= SimdLevel::Avx2) i = WidenBytesAvx2(bytes, length, destination);
+        else if (level >= SimdLevel::Sse2) i = WidenBytesSse2(bytes, length, destination);
+#else
+        (void)level;
+#endif
+        for (; i < length; ++i)
+        {
+            destination[i] = static_cast<Unit>(static_cast<unsigned char>(bytes[i]));
+        }
+    }
+
+    /**
+     * @brief Decodes UTF-8 as MultiByteToWideChar does: every ill-formed sequence, up to
+     *        the byte where it stops being a valid prefix, becomes one U+FFFD.
+     */
+    template <typename Unit>
+    void DecodeUtf8Units(const char* bytes, size_t length, std::basic_string<Unit>& text)
+    {
+        const SimdLevel level = GetSimdLevel();
+        // No sequence produces more code units than it has bytes
+        text.resize(length);
+        Unit* out = text.data();
+        size_t i = 0;
+        while (i < length)
+        {
+            size_t ascii = CountAsciiBytes(bytes + i, length - i, level);
+            WidenBytes(bytes + i, ascii, out, level);
+            i += ascii;
+            out += ascii;
+            if (i == length) break;
+
+            unsigned char lead = static_cast<unsigned char>(bytes[i]);
+            int continuationCount = 0;
+            char32_t codePoint = 0;
+            unsigned char lowest = 0x80;
+            unsigned char highest = 0xBF;
+            if (lead >= 0xC2 && lead <= 0xDF)
+            {
+                continuationCount = 1;
+                codePoint = lead & 0x1F;
+            }
+            else if (lead >= 0xE0 && lead <= 0xEF)
+            {
+                continuationCount = 2;
+                codePoint = lead & 0x0F;
+                if (lead == 0xE0) lowest = 0xA0;    // Overlong
+                if (lead == 0xED) highest = 0x9F;   // Surrogates
+            }
+            else if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                continuationCount = 3;
+                codePoint = lead & 0x07;
+                if (lead == 0xF0) lowest = 0x90;    // Overlong
+                if (lead == 0xF4) highest = 0x8F;   // Beyond U+10FFFF
+            }
+            else
+            {
+                *out++ = static_cast<Unit>(REPLACEMENT_CHARACTER);
+                ++i;
+                continue;
+            }
+
+            size_t next = i + 1;
+            int decoded = 0;
+            for (; decoded < continuationCount && next < length; ++decoded, ++next)
+            {
+                unsigned char byte = static_cast<unsigned char>(bytes[next]);
+                if (byte < lowest || byte > highest) break;
+                codePoint = (codePoint << 6) | (byte & 0x3F);
+                lowest = 0x80;
+                highest = 0xBF;
+            }
+            i = next;
+
+            if (decoded < continuationCount)
+            {
+                *out++ = static_cast<Unit>(REPLACEMENT_CHARACTER);
+            }
+            else if (sizeof(Unit) == 2 && codePoint > 0xFFFF)
+            {
+                codePoint -= 0x10000;
+                *out++ = static_cast<Unit>(0xD800 + (codePoint >> 10));
+                *out++ = static_cast<Unit>(0xDC00 + (codePoint & 0x3FF));
+            }
+            else
+            {
+                *out++ = static_cast<Unit>(codePoint);
+            }
+        }
+        text.resize(out - text.data());
+    }
+}
+
+/**
+ * @brief Detects the encoding of a text file from its byte order mark.
+ * @param bytes The start of the file.
+ * @param bomLength Receives the length of the byte order mark; 0 if there is none.
+ */
+TextEncoding DetectTextEncoding(std::string_view bytes, size_t& bomLength)
+{
+    if (bytes.size() >= 2 && static_cast<unsigned char>(bytes[0]) == 0xFF && static_cast<unsigned char>(bytes[1]) == 0xFE)
+    {
+        bomLength = 2;
+        return TextEncoding::Utf16Le;
+    }
+    if (bytes.size() >= 3 && bytes.compare(0, 3, "\xEF\xBB\xBF") == 0)
+    {
+        bomLength = 3;
+        return TextEncoding::Utf8;
+    }
+    bomLength = 0;
+    return TextEncoding::Ansi;
+}
+
+/**
+ * @brief Counts the ASCII bytes at the start of a string.
+ * @return The offset of the first byte above 0x7F, or the length if there is none.
+ */
+size_t CountAsciiPrefix(std::string_view bytes)
+{
+    return CountAsciiBytes(bytes.data(), bytes.size(), GetSimdLevel());
+}
+
+/**
+ * @brief Converts ASCII text to wide characters.
+ * @param ascii The text; bytes above 0x7F are converted as Latin-1.
+ * @param destination Receives ascii.size() characters.
+ */
+void WidenAscii(std::string_view ascii, wchar_t* destination)
+{
+    WidenBytes(ascii.data(), ascii.size(), destination, GetSimdLevel());
+}
+
+/**
+ * @brief Converts UTF-8 text without a byte order mark to UTF-16 (UTF-32 where wchar_t is 32 bits).
+ *        Runs of ASCII, which make up most of a configuration file, are converted 16 bytes at a time.
+ */
+std::wstring DecodeUtf8(std::string_view bytes)
+{
+    std::wstring text;
+    DecodeUtf8Units(bytes.data(), bytes.size(), text);
+    return text;
+}
+
+/**
+ * @brief Converts UTF-8 text into an existing string, reusing its buffer.
+ */
+void DecodeUtf8(std::string_view bytes, std::wstring& text)
+{
+    DecodeUtf8Units(bytes.data(), bytes.size(), text);
+}
+
+/**
+ * @brief Appends wide text as UTF-8, as WideCharToMultiByte does: unpaired surrogates
+ *        become U+FFFD. Runs of ASCII are narrowed 16 characters at a time.
+ */
+void AppendUtf8(std::wstring_view text, std::string& bytes)
+{
+    bytes.reserve(bytes.size() + text.size());
+#if MTL_ENABLE_SIMD
+    const bool vectorized = GetSimdLevel() >= SimdLevel::Sse2;
+#endif
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+#if MTL_ENABLE_SIMD
+        if (vectorized && text[i] < 0x80)
+        {
+            i = NarrowAsciiSse2(text.data() + i, text.data() + text.size(), bytes) - text.data();
+            if (i == text.size()) break;
+        }
+#endif
+        char32_t codePoint = static_cast<char32_t>(text[i]);
+        if (codePoint < 0x80)
+        {
+            bytes += static_cast<char>(codePoint);
+            continue;
+        }
+        if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+        {
+            bool isPair = codePoint <= 0xDBFF && i + 1 < text.size() &&
+                static_cast<char32_t>(text[i + 1]) >= 0xDC00 && static_cast<char32_t>(text[i + 1]) <= 0xDFFF;
+            if (isPair)
+            {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (static_cast<char32_t>(text[++i]) - 0xDC00);
+            }
+            else
+            {
+                codePoint = REPLACEMENT_CHARACTER;
+            }
+        }
+        else if (codePoint > 0x10FFFF)
+        {
+            codePoint = REPLACEMENT_CHARACTER;
+        }
+
+        if (codePoint < 0x800)
+        {
+            bytes += static_cast<char>(0xC0 | (codePoint >> 6));
+        }
+        else if (codePoint < 0x10000)
+        {
+            bytes += static_cast<char>(0xE0 | (codePoint >> 12));
+            bytes += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        }
+        else
+        {
+            bytes += static_cast<char>(0xF0 | (codePoint >> 18));
+            bytes += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            bytes += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        }
+        bytes += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+/**
+ * @brief Finds the first occurrence of a character, like std::find.
+ * @return The character, or last if there is none.
+ */
+const wchar_t* FindChar(const wchar_t* first, const wchar_t* last, wchar_t ch)
+{
+    return FindUnit(first, last, ch, GetSimdLevel());
+}
+
+bool IsBlankNonAscii(wchar_t ch)
+{
+    return std::iswspace(ch) != 0;
+}
+
+/**
+ * @brief Removes leading and trailing whitespace.
+ * @return The part of text between them, without copying.
+ */
+std::wstring_view TrimBlanks(std::wstring_view text)
+{
+    size_t first = 0;
+    size_t last = text.length();
+    while (first < last && IsBlank(text[first])) ++first;
+    while (last > first && IsBlank(text[last - 1])) --last;
+    return text.substr(first, last - first);
+}
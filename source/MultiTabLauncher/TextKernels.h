@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Bulk text routines used to decode and parse configuration files.
+ *
+ * Scanning and ASCII conversion work on 16 bytes at a time with SSE2, which every x86
+ * and x64 Windows target has, or 32 with AVX2 where CPUID reports it (see SimdLevel.h).
+ * They fall back to plain loops elsewhere or with MTL_ENABLE_SIMD=0. All paths give
+ * identical results. Whitespace follows std::iswspace, with the answer for ASCII
+ * computed inline instead of per call.
+ */
+
+enum class TextEncoding
+{
+    Ansi,       // No byte order mark; the profile API assumes the ANSI code page
+    Utf8,
+    Utf16Le,
+};
+
+TextEncoding DetectTextEncoding(std::string_view bytes, size_t& bomLength);
+
+size_t CountAsciiPrefix(std::string_view bytes);
+void WidenAscii(std::string_view ascii, wchar_t* destination);
+std::wstring DecodeUtf8(std::string_view bytes);
+void DecodeUtf8(std::string_view bytes, std::wstring& text);
+void AppendUtf8(std::wstring_view text, std::string& bytes);
+
+const wchar_t* FindChar(const wchar_t* first, const wchar_t* last, wchar_t ch);
+
+bool IsBlankNonAscii(wchar_t ch);
+std::wstring_view TrimBlanks(std::wstring_view text);
+
+/**
+ * @brief Tests for whitespace as std::iswspace does.
+ */
+inline bool IsBlank(wchar_t ch)
+{
+    if (ch < 0x80)
+    {
+        return ch == L' ' || (ch >= L'\t' && ch <= L'\r');
+    }
+    return IsBlankNonAscii(ch);
+}
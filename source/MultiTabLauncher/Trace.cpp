@@ -0,0 +1,193 @@
+#include "Trace.h"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Trace
+{
+    std::atomic<bool> g_enabled{ false };
+
+    namespace
+    {
+        // Events kept per thread; older events are overwritten when the buffer is full
+        const size_t RING_BUFFER_CAPACITY = 16384;
+
+        enum class EventType : uint8_t
+        {
+            Span,
+            Counter,
+            Instant
+        };
+
+        struct Event
+        {
+            const char* name;
+            uint64_t timestamp;
+            uint64_t duration;
+            int64_t value;
+            EventType type;
+        };
+
+        struct ThreadBuffer
+        {
+            std::mutex mutex; // Only contended while the trace is being written
+            std::vector<Event> events;
+            size_t next{ 0 };
+            bool wrapped{ false };
+            uint32_t threadId{ 0 };
+            const char* threadName{ nullptr };
+        };
+
+        const std::chrono::steady_clock::time_point g_clockStart = std::chrono::steady_clock::now();
+
+        std::mutex g_registryMutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> g_threadBuffers; // Outlive their threads
+        uint32_t g_nextThreadId = 1;
+
+        ThreadBuffer& GetThreadBuffer()
+        {
+            thread_local std::shared_ptr<ThreadBuffer> buffer;
+            if (!buffer)
+            {
+                buffer = std::make_shared<ThreadBuffer>();
+                buffer->events.resize(RING_BUFFER_CAPACITY);
+
+                std::lock_guard<std::mutex> lock(g_registryMutex);
+                buffer->threadId = g_nextThreadId++;
+                g_threadBuffers.push_back(buffer);
+            }
+            return *buffer;
+        }
+
+        void Append(const Event& event)
+        {
+            ThreadBuffer& buffer = GetThreadBuffer();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            buffer.events[buffer.next] = event;
+            if (++buffer.next == buffer.events.size())
+            {
+                buffer.next = 0;
+                buffer.wrapped = true;
+            }
+        }
+
+        void WriteJsonString(std::ofstream& out, const char* text)
+        {
+            out << '"';
+            for (const char* p = text ? text : ""; *p; ++p)
+            {
+                unsigned char ch = static_cast<unsigned char>(*p);
+                if (ch == '"' || ch == '\\') out << '\\' << *p;
+                else if (ch < 0x20) out << ' ';
+                else out << *p;
+            }
+            out << '"';
+        }
+    }
+
+    void SetEnabled(bool enabled)
+    {
+        g_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    uint64_t NowMicroseconds()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - g_clockStart).count());
+    }
+
+    /**
+     * @brief Names the calling thread in the exported trace.
+     */
+    void SetThreadName(const char* name)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.threadName = name;
+    }
+
+    void RecordSpan(const char* name, uint64_t startMicroseconds, uint64_t durationMicroseconds)
+    {
+        if (!IsEnabled()) return;
+        Append({ name, startMicroseconds, durationMicroseconds, 0, EventType::Span });
+    }
+
+    void RecordCounter(const char* name, int64_t value)
+    {
+        if (!IsEnabled()) return;
+        Append({ name, NowMicroseconds(), 0, value, EventType::Counter });
+    }
+
+    void RecordInstant(const char* name)
+    {
+        if (!IsEnabled()) return;
+        Append({ name, NowMicroseconds(), 0, 0, EventType::Instant });
+    }
+
+    /**
+     * @brief Writes all buffered events as a Chrome trace JSON file.
+     * @param filePath The file to create or overwrite.
+     * @return True on success, false on failure.
+     */
+    bool WriteChromeTrace(const std::filesystem::path& filePath)
+    {
+        std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            buffers = g_threadBuffers;
+        }
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        auto beginEvent = [&]()
+            {
+                out << (first ? "\n" : ",\n");
+                first = false;
+            };
+
+        for (const std::shared_ptr<ThreadBuffer>& buffer : buffers)
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+
+            if (buffer->threadName)
+            {
+                beginEvent();
+                out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+                WriteJsonString(out, buffer->threadName);
+                out << "}}";
+            }
+
+            // Oldest event first
+            size_t count = buffer->wrapped ? buffer->events.size() : buffer->next;
+            size_t start = buffer->wrapped ? buffer->next : 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Event& event = buffer->events[(start + i) % buffer->events.size()];
+                beginEvent();
+                out << "{\"name\":";
+                WriteJsonString(out, event.name);
+                out << ",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":" << event.timestamp;
+                switch (event.type)
+                {
+                case EventType::Span:
+                    out << ",\"ph\":\"X\",\"dur\":" << event.duration << "}";
+                    break;
+                case EventType::Counter:
+                    out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+                    break;
+                case EventType::Instant:
+                    out << ",\"ph\":\"i\",\"s\":\"t\"}";
+                    break;
+                }
+            }
+        }
+        out << "\n]}\n";
+        return out.good();
+    }
+}
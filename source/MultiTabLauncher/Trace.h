@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+// Set to 0 to compile all tracing macros out of the build.
+#ifndef MTL_ENABLE_TRACING
+#define MTL_ENABLE_TRACING 1
+#endif
+
+/**
+ * @brief Low-overhead instrumentation exported in the Chrome trace event format.
+ *
+ * Spans, counters and instant events are appended to a ring buffer owned by the
+ * recording thread, so threads never contend with each other. When tracing is
+ * disabled at run time, recording costs one relaxed atomic load. Event names must
+ * be string literals (or otherwise outlive the trace), as only the pointer is stored.
+ * The buffers are written out with WriteChromeTrace(), which produces a file that
+ * can be opened in chrome://tracing or Perfetto.
+ */
+namespace Trace
+{
+    extern std::atomic<bool> g_enabled;
+
+    void SetEnabled(bool enabled);
+    inline bool IsEnabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+    // Microseconds since the trace clock started.
+    uint64_t NowMicroseconds();
+
+    void SetThreadName(const char* name);
+    void RecordSpan(const char* name, uint64_t startMicroseconds, uint64_t durationMicroseconds);
+    void RecordCounter(const char* name, int64_t value);
+    void RecordInstant(const char* name);
+
+    bool WriteChromeTrace(const std::filesystem::path& filePath);
+
+    // Records the lifetime of a scope as a span.
+    class ScopedSpan
+    {
+    public:
+        explicit ScopedSpan(const char* name)
+            : m_name(IsEnabled() ? name : nullptr), m_start(m_name ? NowMicroseconds() : 0)
+        {
+        }
+
+        ~ScopedSpan()
+        {
+            if (m_name)
+            {
+                RecordSpan(m_name, m_start, NowMicroseconds() - m_start);
+            }
+        }
+
+        ScopedSpan(const ScopedSpan&) = delete;
+        ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    private:
+        const char* m_name;
+        uint64_t m_start;
+    };
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if MTL_ENABLE_TRACING
+#define TRACE_SCOPE(name) Trace::ScopedSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#define TRACE_COUNTER(name, value) do { if (Trace::IsEnabled()) Trace::RecordCounter(name, static_cast<int64_t>(value)); } while (0)
+#define TRACE_INSTANT(name) do { if (Trace::IsEnabled()) Trace::RecordInstant(name); } while (0)
+#else
+#define TRACE_SCOPE(name) do { } while (0)
+#define TRACE_COUNTER(name, value) do { } while (0)
+#define TRACE_INSTANT(name) do { } while (0)
+#endif
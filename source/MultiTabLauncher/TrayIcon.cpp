@@ -0,0 +1,63 @@
+#include "TrayIcon.h"
+
+TrayIcon::~TrayIcon()
+{
+    Remove();
+}
+
+/**
+ * @brief Adds the icon to the notification area.
+ * @param hwnd The window that receives the callback message.
+ * @param callbackMessage The message posted for mouse events on the icon.
+ * @param hIcon The icon; owned by the caller and kept alive while the icon is shown.
+ * @param tip The tooltip text.
+ * @return True on success, false on failure.
+ */
+bool TrayIcon::Add(HWND hwnd, UINT callbackMessage, HICON hIcon, const wchar_t* tip)
+{
+    if (m_added) return true;
+
+    m_data = {};
+    m_data.cbSize = sizeof(m_data);
+    m_data.hWnd = hwnd;
+    m_data.uID = 1;
+    m_data.uFlags = NIF_MESSAGE | NIF_ICON | NIF_TIP;
+    m_data.uCallbackMessage = callbackMessage;
+    m_data.hIcon = hIcon;
+    lstrcpynW(m_data.szTip, tip, ARRAYSIZE(m_data.szTip));
+    return Restore();
+}
+
+/**
+ * @brief Adds the icon again after Explorer restarted.
+ * @return True on success, false on failure or if Add() was not called.
+ */
+bool TrayIcon::Restore()
+{
+    if (!m_data.hWnd) return false;
+
+    m_added = Shell_NotifyIconW(NIM_ADD, &m_data) != FALSE;
+    return m_added;
+}
+
+/**
+ * @brief Removes the icon from the notification area.
+ */
+void TrayIcon::Remove()
+{
+    if (m_added)
+    {
+        Shell_NotifyIconW(NIM_DELETE, &m_data);
+        m_added = false;
+    }
+    m_data = {};
+}
+
+/**
+ * @brief Returns the message broadcast when the taskbar is created, e.g. after Explorer restarted.
+ */
+UINT TrayIcon::GetTaskbarCreatedMessage()
+{
+    static const UINT message = RegisterWindowMessageW(L"TaskbarCreated");
+    return message;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <windows.h>
+#include <shellapi.h>
+
+/**
+ * @brief An icon in the notification area that reports mouse events to a window.
+ *
+ * The callback message arrives with lParam = the mouse message (WM_LBUTTONUP,
+ * WM_RBUTTONUP, ...). Explorer forgets all icons when it restarts; the owner window
+ * calls Restore() when it receives GetTaskbarCreatedMessage().
+ */
+class TrayIcon
+{
+public:
+    TrayIcon() = default;
+    ~TrayIcon();
+
+    TrayIcon(const TrayIcon&) = delete;
+    TrayIcon& operator=(const TrayIcon&) = delete;
+
+    bool Add(HWND hwnd, UINT callbackMessage, HICON hIcon, const wchar_t* tip);
+    bool Restore();
+    void Remove();
+    bool IsAdded() const { return m_added; }
+
+    static UINT GetTaskbarCreatedMessage();
+
+private:
+    NOTIFYICONDATAW m_data{};
+    bool m_added{ false };
+};
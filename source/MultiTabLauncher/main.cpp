@@ -1,54 +1,138 @@
 #include <windows.h>
 #include <windowsx.h>
 #include <commctrl.h>
+#include <dwmapi.h>
+#include <psapi.h>
+#include <algorithm>
+#include <array>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
 #include <shlwapi.h>
 #include <string>
+#include <thread>
 #include <vector>
 #include <cwctype>
 #include "resource.h"
+#include "BrokerClient.h"
+#include "BrokerDispatcher.h"
+#include "BrokerHost.h"
+#include "CatalogSync.h"
+#include "CatalogUpdater.h"
+#include "CompletionQueue.h"
+#include "ConfigJson.h"
+#include "ConfigModel.h"
+#include "ConfigWatcher.h"
+#include "DefaultConfig.h"
+#include "GridLayout.h"
+#include "IconCache.h"
+#include "IniDocument.h"
+#include "InteractionReplay.h"
+#include "InteractionTrace.h"
+#include "LatencyHistogram.h"
+#include "LaunchProfile.h"
+#include "LaunchTimer.h"
+#include "Prefetcher.h"
+#include "ProcessTracker.h"
+#include "ProgramIndexer.h"
+#include "ResourceAccountant.h"
+#include "SharedCatalog.h"
+#include "TabStrip.h"
+#include "TargetValidator.h"
+#include "TaskExecutor.h"
+#include "TextKernels.h"
+#include "TrayIcon.h"
+#include "Trace.h"
 
 #pragma comment(lib, "comctl32.lib")
 #pragma comment(lib, "Shlwapi.lib")
+#pragma comment(lib, "dwmapi.lib")
 
 // =============================================================
 //                   Global Constants and Variables
 // =============================================================
 
-const int MAX_TABS = 50;
+// Button control ID = BUTTON_ID_BASE + button index; the tab index is kept in GWLP_USERDATA
 const int BUTTON_ID_BASE = 1000;
 
+// --- Sizes in pixels at 96 DPI, scaled with ScaleForDpi() ---
+const int ICON_SIZE = 32;
+const int TAB_FONT_HEIGHT = 24;
+const int BUTTON_FONT_HEIGHT = 16;
+
+// --- Application-Defined Messages ---
+const UINT WM_APP_PROCESSEXITED = WM_APP + 1;   // wParam = tab index, lParam = button index
+const UINT WM_APP_CONFIGCHANGED = WM_APP + 2;
+const UINT WM_APP_TARGETSVALIDATED = WM_APP + 3;
+const UINT WM_APP_TRAYICON = WM_APP + 4;        // lParam = mouse message
+const UINT WM_APP_SUMMON = WM_APP + 5;          // Sent by a second instance; returns TRUE if resident
+const UINT WM_APP_LAUNCHTIMED = WM_APP + 6;
+
+// --- System Menu Commands (must be below 0xF000 and multiples of 16) ---
+const UINT IDM_SAVE_TRACE = 0x0010;
+const UINT IDM_EXPORT_LAUNCH_STATS = 0x0020;
+const UINT IDM_SAVE_DIAGNOSTICS = 0x0030;
+
+// --- Hotkeys ---
+const int SHOW_HOTKEY_ID = 1;
+
+// --- Timers ---
+const UINT_PTR CONFIG_RELOAD_TIMER_ID = 1;
+const UINT CONFIG_RELOAD_DELAY_MS = 300;        // Editors often save in several steps
+const UINT_PTR TARGET_VALIDATION_TIMER_ID = 2;
+const UINT TARGET_VALIDATION_INTERVAL_MS = 5 * 60 * 1000;
+const UINT_PTR PREFETCH_IDLE_TIMER_ID = 3;
+const UINT PREFETCH_IDLE_CHECK_INTERVAL_MS = 5000;
+const UINT_PTR RESOURCE_IDLE_TIMER_ID = 4;
+const UINT RESOURCE_IDLE_CHECK_INTERVAL_MS = 60 * 1000;
+const int DEFAULT_CATALOG_SYNC_MINUTES = 5;
+
 // --- Application State ---
-int g_tabCount = 0;
 int g_currentTab = 0;
-int g_buttonRows = 3;
-int g_buttonCols = 8;
-int g_buttonCountPerTab = g_buttonRows * g_buttonCols;
+UINT g_dpi = 96;                    // DPI of the monitor the main window is on
 
 // --- Window and Path Information ---
 LPCWSTR g_windowClassName = L"MultiTab Launcher";
+LPCWSTR g_tabPageClassName = L"MultiTabLauncher.TabPage";
 const HICON g_hDefaultIcon = LoadIcon(NULL, IDI_APPLICATION);
 std::wstring g_executableDirectory;
 std::wstring g_configFilePath;
+std::wstring g_usageFilePath;
+std::wstring g_catalogFilePath;     // Shared catalog snapshot; empty if none is used
+std::wstring g_catalogSourcePath;   // Network snapshot the catalog is synced from; empty if mapped in place
+std::wstring g_catalogCacheDirectory;
 
 // --- Handles ---
 HWND g_hMainWindow = NULL;
-HWND g_hTabControl = NULL;
+TabStrip g_tabStrip;
 
 // --- Data Structures ---
-struct ButtonInfo
+struct ButtonInfo : ButtonConfig
 {
     HWND hButton{ NULL };
-    std::wstring name{ L"" };
-    std::wstring path{ L"" };
-    std::wstring parameters{ L"" };
-    bool adminMode{ false };
     HICON hIcon{ NULL };
+    TargetState targetState{ TargetState::Unknown };
+    unsigned int launchCount{ 0 };
+    std::wstring environmentBlock;          // Built on the first launch from environmentBlockSource
+    std::wstring environmentBlockSource;    // The profile.environment the block was built for
+    std::array<LatencyHistogram, LAUNCH_PHASE_COUNT> launchLatency; // Indexed by LaunchPhase
+};
+struct TabInfo
+{
+    std::wstring name;
+    int buttonRows{ 3 };
+    int buttonCols{ 8 };
+    std::vector<ButtonInfo> buttons;
+    HWND hPage{ NULL };             // Parent of the buttons; created with them on the first visit
+    int iconSize{ 0 };              // Size the button icons were loaded at
+    RECT layoutArea{};              // Area the page was last laid out in
+    ULONGLONG lastVisitTick{ 0 };   // GetTickCount64() when the tab was last shown or left
 };
-std::vector<std::vector<ButtonInfo>> g_tabButtonData;
-std::vector<std::wstring> g_tabNames;
+std::vector<TabInfo> g_tabs;
 
 // --- GDI Resources ---
 HBRUSH g_hBackgroundBrush = NULL;
@@ -56,6 +140,107 @@ HBRUSH g_hTabBrush = NULL;
 HBRUSH g_hButtonBrush = NULL;
 HPEN g_hBorderPen = NULL;
 HFONT g_hTabFont = NULL;
+HFONT g_hButtonFont = NULL;
+HBRUSH g_hRunningBrush = NULL;
+HBRUSH g_hMissingBrush = NULL;
+HBRUSH g_hUnreachableBrush = NULL;
+HBRUSH g_hAccentBrush = NULL;
+
+// --- Launched Processes ---
+ProcessTracker g_processTracker;
+LaunchTimer g_launchTimer;
+
+// --- Configuration Hot-Reload ---
+ConfigWatcher g_configWatcher;
+ConfigWatcher g_catalogWatcher;
+bool g_isEditingButton = false; // The settings dialog holds a pointer into g_tabs
+
+// --- Configuration Saving ---
+// A button edit waiting to be written to the INI file on the executor
+struct PendingButtonSave
+{
+    ButtonKey key;
+    ButtonConfig config;
+    bool hasCatalog{ false };       // Decides which file the first write creates
+};
+std::mutex g_pendingSavesMutex;
+std::deque<PendingButtonSave> g_pendingSaves;   // Written in order, by one task at a time
+bool g_isSaveTaskQueued = false;                // Until that task has written them all
+
+// --- Shared Catalog ---
+SharedCatalog g_sharedCatalog;      // Base layer under the user's INI file
+CatalogUpdater g_catalogUpdater;
+DWORD g_catalogSyncIntervalMs = 0;
+
+// --- Target Health Validation ---
+TargetValidator g_targetValidator;
+
+// --- Idle-Time Prefetch ---
+Prefetcher g_prefetcher;
+PrefetchSettings g_prefetchSettings;
+DWORD g_lastPrefetchInputTime = 0;  // Last-input tick of the idle period already prefetched
+
+// --- Icons ---
+IconCache g_iconCache;              // Icons scaled to the sizes in use, per target path
+
+// An icon being extracted on the executor, and the buttons waiting for it
+struct IconLoad
+{
+    CancellationToken token;
+    std::vector<ButtonKey> buttons;
+};
+std::map<std::pair<std::wstring, int>, IconLoad> g_iconLoads;   // By path and size; UI thread only
+
+// An icon extracted on the executor, applied on the UI thread
+struct LoadedIcon
+{
+    std::wstring path;
+    int size{ 0 };
+    bool isLoaded{ false };         // False if the target has no icon
+    BgraImage image;
+};
+
+// --- Background Work ---
+TaskExecutor g_taskExecutor;        // Shared workers for work that must not block the UI
+CompletionQueue g_completionQueue;  // Results of that work, run by the message loop
+HANDLE g_hCompletionEvent = NULL;   // Set when the completion queue stops being empty
+std::vector<HWND> g_pendingRepaints; // Windows to invalidate once the current completions have run
+const std::chrono::milliseconds COMPLETION_BUDGET(4); // Completions run between two looks at the input queue
+
+// --- Program Index ---
+ProgramIndexer g_programIndexer;    // Programs on PATH and in application folders
+ProgramIndexSettings g_programIndexSettings;
+HWND g_hPathSuggestionList = NULL;  // Completions under the path field of the settings dialog
+bool g_isSettingPathText = false;   // The path field is being set from a completion
+const int MAX_PATH_SUGGESTIONS = 8;
+
+// --- Resource Budget ---
+ResourceAccountant g_resourceAccountant;
+ResourceSettings g_resourceSettings;
+ULONGLONG g_lastActivityTick = 0;   // Last time the launcher was activated or used
+bool g_isWorkingSetTrimmed = false; // Trimmed since the last activity
+
+// --- Resident Mode ---
+ResidentSettings g_residentSettings;
+TrayIcon g_trayIcon;
+HICON g_hTrayIcon = NULL;
+bool g_isResidentHidden = false;    // Hidden to the notification area
+bool g_isWindowCloaked = false;     // Hidden by DWM cloaking, so that its contents stay painted
+bool g_isExiting = false;           // Closing exits even in resident mode
+HWND g_hReturnFocusWindow = NULL;   // Foreground window before the launcher was summoned
+
+// --- Elevation Broker ---
+BrokerClient g_brokerClient;        // Launches administrator buttons without a prompt each time
+bool g_isBrokerEnabled = false;     // [Elevation] Broker=1
+
+// --- Tracing ---
+uint64_t g_startupTraceStart = 0;   // WinMain entry, for the time to first paint
+bool g_hasPainted = false;
+
+// --- Interaction Recording ---
+bool g_isRecordingInteractions = false; // Started with /record
+ULONGLONG g_interactionRecordStart = 0;
+InteractionTrace g_interactionTrace;
 
 
 // =============================================================
@@ -64,17 +249,46 @@ HFONT g_hTabFont = NULL;
 
 // --- Window Procedures ---
 LRESULT CALLBACK MainWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+LRESULT CALLBACK TabPageWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+bool RegisterTabPageClass(HINSTANCE hInstance);
 INT_PTR CALLBACK ButtonSettingsDialogProcedure(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
 LRESULT CALLBACK SelectAllEditSubclassProcedure(HWND hEdit, UINT msg, WPARAM wParam, LPARAM lParam, UINT_PTR, DWORD_PTR);
+LRESULT CALLBACK PathEditSubclassProcedure(HWND hEdit, UINT msg, WPARAM wParam, LPARAM lParam, UINT_PTR, DWORD_PTR);
+LRESULT CALLBACK PathSuggestionListSubclassProcedure(HWND hList, UINT msg, WPARAM wParam, LPARAM lParam, UINT_PTR, DWORD_PTR);
 
 // --- Control Management ---
-void InitializeTabControl(HWND hwnd);
-void CreateButtonsForTab(HWND hwnd, int tabIndex);
+void InitializeTabStrip(HWND hwnd);
+void EnsureTabPageCreated(HWND hwnd, int tabIndex);
+void DestroyTabPage(int tabIndex);
+void CreateButtonWindow(HWND hPage, int tabIndex, int buttonIndex, int x, int y, int width, int height);
+void InitializeTab(TabInfo& tab, const TabConfig& config, const IniDocument& usage, int tabIndex);
+void InitializeButton(ButtonInfo& info, const ButtonConfig& config, const IniDocument& usage, const IniDocument::Section* usageSection, int buttonIndex);
+void ReloadButtonIcon(int tabIndex, int buttonIndex);
+void SetButtonIcon(ButtonInfo& info, HICON hIcon);
+void QueueIconLoad(int tabIndex, int buttonIndex, const std::wstring& path, int size);
+void ApplyLoadedIcon(LoadedIcon& loaded);
+void CancelIconLoads(int tabIndex);
+void RefreshTabIcons(int tabIndex);
+void DestroyButton(ButtonInfo& info);
+bool FindButtonByWindow(HWND hButton, ButtonKey& key);
+bool IsValidButton(int tabIndex, int buttonIndex);
+int GetTabCount();
+void SwitchToTab(HWND hwnd, int newTab);
+void ShowTabPage(HWND hOldPage, HWND hNewPage);
 void UpdateLayoutOnResize(HWND hwnd);
+void LayoutTabPage(HWND hwnd, int tabIndex);
+RECT GetButtonAreaRect(HWND hwnd);
+RECT GetButtonRect(const RECT& area, int rows, int cols, int buttonIndex);
 
 // --- GDI Resource Management ---
 void InitializeGdiResources();
 void ReleaseGdiResources();
+void CreateScaledFonts();
+void EnableDpiAwareness();
+UINT GetWindowDpi(HWND hwnd);
+void ApplyDpi(HWND hwnd, UINT dpi);
+int ScaleForDpi(int pixels);
+int GetIconSize();
 
 // --- Window State Persistence ---
 void SaveWindowPosition(HWND hwnd);
@@ -82,22 +296,104 @@ void RestoreWindowPosition(HWND hwnd);
 
 // --- Configuration (INI File) Handling ---
 void LoadConfigurationFromFile();
-bool SaveButtonConfigurationToFile(int tabIndex, int buttonIndex, const ButtonInfo& info);
+LauncherConfig ReadConfigurationModel(const std::wstring& filePath);
+LauncherConfig CaptureCurrentConfiguration();
+void ReloadConfigurationFromFile(HWND hwnd);
+void ApplyConfigurationDiff(HWND hwnd, const LauncherConfig& config, const ConfigDiff& diff);
+void ForgetButtonActivity(ButtonKey key);
+bool SaveButtonConfigurationToFile(int tabIndex, int buttonIndex, const ButtonConfig& info);
+void QueueButtonConfigurationSave(int tabIndex, int buttonIndex, const ButtonConfig& info);
+void WritePendingButtonSaves();
+bool HasPendingButtonSaves();
+bool EnsureConfigFileExists(bool hasCatalog);
 bool GenerateDefaultConfigFile();
-std::wstring GetDefaultConfigString();
-std::wstring ReadStringFromIni(LPCWSTR section, LPCWSTR key, LPCWSTR defaultValue, LPCWSTR filePath);
+bool GenerateOverlayConfigFile();
+std::wstring GetCatalogFilePath();
+void ConfigureCatalogSync();
+bool PublishCatalog();
+bool ConvertConfiguration();
+bool ReadConfigurationFile(const std::wstring& filePath, LauncherConfig& config);
+bool IsJsonPath(const std::wstring& filePath);
+void ReportCommandLineError(const std::wstring& message);
+IniDocument ReadIniFile(const std::wstring& filePath);
+std::wstring DecodeIniText(const std::string& bytes);
 bool WriteUtf16LeFile(const wchar_t* filename, const std::wstring& text);
+std::wstring GetLaunchCountKey(int buttonIndex);
+void SaveLaunchCount(int tabIndex, int buttonIndex, unsigned int launchCount);
+std::wstring GetLaunchLatencyKey(int buttonIndex, LaunchPhase phase);
+void SaveLaunchLatency(int tabIndex, int buttonIndex, const ButtonInfo& info);
+
+// --- Resident Mode ---
+void ApplyResidentSettings(HWND hwnd);
+void HideResidentWindow(HWND hwnd, bool returnFocus);
+void ShowResidentWindow(HWND hwnd);
+void ShowTrayMenu(HWND hwnd);
+void TrimResidentMemory();
+bool SetWindowCloaked(HWND hwnd, bool cloaked);
+bool ParseHotkey(const std::wstring& text, UINT& modifiers, UINT& virtualKey);
+bool SummonRunningInstance();
+
+// --- Resource Budget ---
+void NoteLauncherActivity();
+std::vector<PageUsage> CollectPageUsage();
+void ReleaseTabPages(const std::vector<int>& tabs);
+void EnforceResourceLimits(int pinnedTab);
+void TrimIdleResources(HWND hwnd);
+void TrimWorkingSet();
+void UpdateResourceGauges();
 
 // --- Core Application Logic ---
-bool LaunchApplication(const std::wstring& filePath, const std::wstring& parameters, bool asAdmin);
+bool LaunchApplication(const std::wstring& filePath, const std::wstring& parameters, bool asAdmin,
+    const LaunchProfile& profile, const wchar_t* environmentBlock, HANDLE* phProcess);
+bool StartApplication(const std::wstring& filePath, const std::wstring& parameters, bool asAdmin,
+    const LaunchProfile& profile, const wchar_t* environmentBlock, HANDLE* phProcess, DWORD* pErrorCode);
+void ShowLaunchError(const std::wstring& filePath, DWORD errorCode);
+bool CreateProcessWithProfile(const std::wstring& executablePath, const std::wstring& parameters,
+    const std::wstring& workingDirectory, const LaunchProfile& profile, const wchar_t* environmentBlock, HANDLE* phProcess);
+void ApplyLaunchProfile(HANDLE hProcess, const LaunchProfile& profile, bool includePriority);
+DWORD GetPriorityClassFlag(LaunchPriority priority);
+const wchar_t* GetEnvironmentBlock(ButtonInfo& info);
 void OnLaunchButtonClick(int tabIndex, int buttonIndex);
+void QueueLaunch(int tabIndex, int buttonIndex, bool asAdmin, ULONGLONG clickTime);
+void ApplyLaunchResult(ButtonKey key, const std::wstring& path, const std::wstring& parameters, bool launched,
+    HANDLE hProcess, DWORD errorCode, ULONGLONG clickTime);
+bool IsSameButtonTarget(ButtonKey key, const std::wstring& path, const std::wstring& parameters);
+void OnApplicationLaunched(int tabIndex, int buttonIndex, HANDLE hProcess, ULONGLONG clickTime);
+void LaunchThroughBroker(int tabIndex, int buttonIndex, ULONGLONG clickTime);
+void ApplyBrokerReply(ButtonKey key, const std::wstring& path, const std::wstring& parameters, ULONGLONG clickTime, const BrokerReply& reply);
+bool RunLaunchBroker();
+bool ActivateRunningInstance(int tabIndex, int buttonIndex);
+void ValidateButtonTargets();
+void ApplyTargetValidationResults();
+void ApplyLaunchTimings();
+void CheckIdlePrefetch();
+std::vector<std::wstring> CollectPrefetchFiles();
 int DisplayButtonSettingsDialog(int tabIdx, int btnIdx);
+void UpdatePathSuggestions(HWND hDlg);
+void AcceptPathSuggestion(HWND hDlg, int item);
+void HidePathSuggestions();
 
 // --- Utility Functions ---
-HICON ExtractIconFromFile(const std::wstring& filePath);
+bool ExtractIconImage(const std::wstring& filePath, int size, BgraImage& image);
+HICON CreateDefaultIcon(int size);
+void StartTaskExecutor();
+void StartProgramIndexer();
+bool RunCompletions();
+void RequestRepaint(HWND hwnd);
 std::wstring ResolveExecutablePath(const wchar_t* targetFile);
 std::wstring ExpandEnvironmentVariables(const std::wstring& str);
 std::wstring GetTextFromDialogControl(HWND hDlg, int nCtlId);
+bool HasCommandLineSwitch(const wchar_t* name);
+bool SaveTraceFile();
+void RecordInteraction(InteractionKind kind, int a, int b);
+bool SaveInteractionTrace();
+bool ReplayInteractionTrace();
+bool ExportLaunchStatistics();
+bool SaveDiagnostics();
+HWND FindMainWindowOfProcess(DWORD processId);
+#if MTL_ENABLE_BENCHMARKS
+bool RunBenchmarks();   // LauncherBenchmarks.cpp, only linked into MultiTabLauncherBenchmarks.exe
+#endif
 inline void trim(std::wstring& s);
 inline void rtrim(std::wstring& s);
 inline void ltrim(std::wstring& s);
@@ -109,9 +405,9 @@ inline void ltrim(std::wstring& s);
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
 {
-    // Initialize common controls (for the tab control)
-    INITCOMMONCONTROLSEX icc = { sizeof(INITCOMMONCONTROLSEX), ICC_TAB_CLASSES };
-    InitCommonControlsEx(&icc);
+    g_startupTraceStart = Trace::NowMicroseconds();
+    EnableDpiAwareness();
+    g_dpi = GetWindowDpi(NULL);
 
     // Get the directory of the executable to resolve relative paths
     std::wstring modulePath(MAX_PATH, L'\0');
@@ -136,11 +432,68 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
     g_executableDirectory = exePath.parent_path().wstring();
     SetCurrentDirectoryW(g_executableDirectory.c_str());
     g_configFilePath = g_executableDirectory + L"\\MultiTabLauncher.ini";
+    g_usageFilePath = g_executableDirectory + L"\\MultiTabLauncher.usage.ini";
+
+    // Publishing the shared catalog runs headless and exits
+    if (HasCommandLineSwitch(L"/publish-catalog"))
+    {
+        return PublishCatalog() ? 0 : 1;
+    }
+    if (HasCommandLineSwitch(L"/convert"))
+    {
+        return ConvertConfiguration() ? 0 : 1;
+    }
+    g_catalogFilePath = GetCatalogFilePath();
+    ConfigureCatalogSync();
+
+    // The elevation broker of a running launcher, started by it with a consent prompt
+    if (HasCommandLineSwitch(L"/broker"))
+    {
+        return RunLaunchBroker() ? 0 : 1;
+    }
+
+#if MTL_ENABLE_BENCHMARKS
+    // Measurements run headless and exit; results go to MultiTabLauncher.bench.json
+    if (HasCommandLineSwitch(L"/benchmark"))
+    {
+        return RunBenchmarks() ? 0 : 1;
+    }
+#endif
+    if (HasCommandLineSwitch(L"/replay"))
+    {
+        return ReplayInteractionTrace() ? 0 : 1;
+    }
+
+    // Every headless switch is handled above, so that a resident launcher in this session
+    // does not swallow it. Otherwise show that launcher instead of starting another one.
+    if (SummonRunningInstance())
+    {
+        return 0;
+    }
+
+    // Recorded sessions are written to MultiTabLauncher.interactions.bin at exit, for /replay
+    if (HasCommandLineSwitch(L"/record"))
+    {
+        g_isRecordingInteractions = true;
+        g_interactionRecordStart = GetTickCount64();
+    }
+
+    // Tracing is enabled with /trace, or [Diagnostics] Trace=1 once the configuration is
+    // read, and written out at exit
+    if (HasCommandLineSwitch(L"/trace"))
+    {
+        Trace::SetEnabled(true);
+        Trace::SetThreadName("UI");
+    }
 
     // Load configuration from INI and initialize GDI resources
     LoadConfigurationFromFile();
     InitializeGdiResources();
 
+    // Start the shared workers before the first tab page queues its icons
+    StartTaskExecutor();
+    StartProgramIndexer();
+
     // Register the window class
     WNDCLASSEX wc = { sizeof(WNDCLASSEX) };
     wc.lpfnWndProc = MainWindowProcedure;
@@ -151,17 +504,20 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
     wc.hIcon = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_APPICON));
     wc.hIconSm = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_APPICON));
 
-    if (!RegisterClassEx(&wc))
+    if (!RegisterClassEx(&wc) || !RegisterTabPageClass(hInstance) || !TabStrip::RegisterWindowClass(hInstance))
     {
         MessageBox(NULL, L"Window Registration Failed!", L"Error", MB_OK | MB_ICONERROR);
         return 1;
     }
 
+    // Resident launchers started with /tray, e.g. at logon, start hidden but painted
+    g_isResidentHidden = g_residentSettings.enabled && HasCommandLineSwitch(L"/tray");
+
     // Create the main window
     g_hMainWindow = CreateWindowEx(
         WS_EX_CLIENTEDGE, g_windowClassName, L"MultiTab Launcher",
-        WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT, 800,
-        600, NULL, NULL, hInstance, NULL
+        WS_OVERLAPPEDWINDOW | WS_CLIPCHILDREN, CW_USEDEFAULT, CW_USEDEFAULT, ScaleForDpi(800),
+        ScaleForDpi(600), NULL, NULL, hInstance, NULL
     );
 
     if (g_hMainWindow == NULL)
@@ -170,17 +526,55 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
         return 1;
     }
 
-    ShowWindow(g_hMainWindow, nCmdShow);
-    UpdateWindow(g_hMainWindow);
+    AppendMenuW(GetSystemMenu(g_hMainWindow, FALSE), MF_SEPARATOR, 0, NULL);
+    AppendMenuW(GetSystemMenu(g_hMainWindow, FALSE), MF_STRING, IDM_EXPORT_LAUNCH_STATS, L"Export Launch Statistics");
+    AppendMenuW(GetSystemMenu(g_hMainWindow, FALSE), MF_STRING, IDM_SAVE_DIAGNOSTICS, L"Save Diagnostics");
+    if (Trace::IsEnabled())
+    {
+        AppendMenuW(GetSystemMenu(g_hMainWindow, FALSE), MF_STRING, IDM_SAVE_TRACE, L"Save Trace");
+    }
+
+    if (!g_isResidentHidden)
+    {
+        ShowWindow(g_hMainWindow, nCmdShow);
+        UpdateWindow(g_hMainWindow);
+    }
+    else if (g_isWindowCloaked)
+    {
+        ShowWindow(g_hMainWindow, SW_SHOWNOACTIVATE);
+        UpdateWindow(g_hMainWindow);
+        TrimResidentMemory();
+    }
 
-    // Main message loop
-    MSG msg;
-    while (GetMessage(&msg, NULL, 0, 0))
+    // Main message loop. Messages, and input first of all, are handled before completions
+    // of background work, which run a few milliseconds at a time in between, so that the
+    // launcher stays responsive while hundreds of icons arrive
+    MSG msg = {};
+    bool hasMoreCompletions = false;
+    while (true)
     {
-        TranslateMessage(&msg);
-        DispatchMessage(&msg);
+        MsgWaitForMultipleObjectsEx(g_hCompletionEvent ? 1 : 0, &g_hCompletionEvent, hasMoreCompletions ? 0 : INFINITE,
+            QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE) && msg.message != WM_QUIT)
+        {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+        if (msg.message == WM_QUIT)
+        {
+            break;
+        }
+        hasMoreCompletions = RunCompletions();
     }
 
+    if (Trace::IsEnabled())
+    {
+        SaveTraceFile();
+    }
+    if (g_isRecordingInteractions)
+    {
+        SaveInteractionTrace();
+    }
     return (int)msg.wParam;
 }
 
@@ -190,59 +584,98 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
 
 LRESULT CALLBACK MainWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
+    // Explorer restarted and forgot the notification area icons
+    if (msg == TrayIcon::GetTaskbarCreatedMessage() && msg != 0)
+    {
+        g_trayIcon.Restore();
+        return 0;
+    }
+
     switch (msg)
     {
     case WM_CREATE:
     {
+        if (g_isResidentHidden)
+        {
+            g_isWindowCloaked = SetWindowCloaked(hwnd, true);
+        }
         RestoreWindowPosition(hwnd);
-        InitializeTabControl(hwnd);
-        // Show buttons for the initially selected tab
-        for (int i = 0; i < g_buttonCountPerTab; i++)
+        if (GetWindowDpi(hwnd) != g_dpi)
+        {
+            g_dpi = GetWindowDpi(hwnd);
+            CreateScaledFonts();
+        }
         {
-            ShowWindow(g_tabButtonData[0][i].hButton, SW_SHOW);
+            TRACE_SCOPE("CreateControls");
+            InitializeTabStrip(hwnd);
+            EnsureTabPageCreated(hwnd, g_currentTab);
         }
+        g_processTracker.Start(hwnd, WM_APP_PROCESSEXITED);
+        g_launchTimer.Start(hwnd, WM_APP_LAUNCHTIMED);
+        g_configWatcher.Start(g_configFilePath, hwnd, WM_APP_CONFIGCHANGED);
+        if (g_sharedCatalog.IsOpen())
+        {
+            g_catalogWatcher.Start(g_catalogFilePath, hwnd, WM_APP_CONFIGCHANGED);
+        }
+        if (!g_catalogSourcePath.empty())
+        {
+            g_catalogUpdater.Start(g_taskExecutor, g_catalogSourcePath + L".pack", g_catalogCacheDirectory, g_catalogFilePath,
+                g_catalogSyncIntervalMs, hwnd, WM_APP_CONFIGCHANGED);
+        }
+        if (g_targetValidator.Start(g_taskExecutor, g_executableDirectory, hwnd, WM_APP_TARGETSVALIDATED))
+        {
+            ValidateButtonTargets();
+            SetTimer(hwnd, TARGET_VALIDATION_TIMER_ID, TARGET_VALIDATION_INTERVAL_MS, NULL);
+        }
+        if (g_prefetcher.Start(g_taskExecutor))
+        {
+            SetTimer(hwnd, PREFETCH_IDLE_TIMER_ID, PREFETCH_IDLE_CHECK_INTERVAL_MS, NULL);
+        }
+        SetTimer(hwnd, RESOURCE_IDLE_TIMER_ID, RESOURCE_IDLE_CHECK_INTERVAL_MS, NULL);
+        NoteLauncherActivity();
+        ApplyResidentSettings(hwnd);
+        // Show the page of the initially selected tab
+        ShowTabPage(NULL, g_tabs[g_currentTab].hPage);
+        RecordInteraction(InteractionKind::SelectTab, g_currentTab, 0);
         break;
     }
 
     case WM_SIZE:
     {
+        RecordInteraction(InteractionKind::Resize, LOWORD(lParam), HIWORD(lParam));
         UpdateLayoutOnResize(hwnd);
         break;
     }
 
+    case WM_DPICHANGED:
+    {
+        // Moved to a monitor with another scale factor: rescale, then take the suggested bounds
+        ApplyDpi(hwnd, HIWORD(wParam));
+        const RECT* prcSuggested = (const RECT*)lParam;
+        SetWindowPos(hwnd, NULL, prcSuggested->left, prcSuggested->top,
+            prcSuggested->right - prcSuggested->left, prcSuggested->bottom - prcSuggested->top,
+            SWP_NOZORDER | SWP_NOACTIVATE);
+        break;
+    }
+
     case WM_NOTIFY:
     {
         LPNMHDR nmhdr = (LPNMHDR)lParam;
-        if (nmhdr->hwndFrom == g_hTabControl && nmhdr->code == TCN_SELCHANGE)
+        if (nmhdr->hwndFrom == g_tabStrip.GetHandle() && nmhdr->code == TCN_SELCHANGE)
         {
-            int newTab = TabCtrl_GetCurSel(g_hTabControl);
-            if (newTab != g_currentTab)
-            {
-                // Hide buttons of the old tab
-                for (int i = 0; i < g_buttonCountPerTab; i++)
-                {
-                    ShowWindow(g_tabButtonData[g_currentTab][i].hButton, SW_HIDE);
-                }
-                // Show buttons of the new tab
-                for (int i = 0; i < g_buttonCountPerTab; i++)
-                {
-                    ShowWindow(g_tabButtonData[newTab][i].hButton, SW_SHOW);
-                }
-                g_currentTab = newTab;
-                InvalidateRect(hwnd, NULL, FALSE); // Redraw window
-            }
+            RecordInteraction(InteractionKind::SelectTab, g_tabStrip.GetCurSel(), 0);
+            SwitchToTab(hwnd, g_tabStrip.GetCurSel());
         }
         break;
     }
 
     case WM_COMMAND:
     {
-        int buttonId = LOWORD(wParam);
-        if (buttonId >= BUTTON_ID_BASE && buttonId < BUTTON_ID_BASE + (g_tabCount * g_buttonCountPerTab))
+        ButtonKey key;
+        if (HIWORD(wParam) == BN_CLICKED && FindButtonByWindow((HWND)lParam, key))
         {
-            int tabIndex = (buttonId - BUTTON_ID_BASE) / g_buttonCountPerTab;
-            int buttonIndex = (buttonId - BUTTON_ID_BASE) % g_buttonCountPerTab;
-            OnLaunchButtonClick(tabIndex, buttonIndex);
+            RecordInteraction(InteractionKind::Launch, key.tab, key.button);
+            OnLaunchButtonClick(key.tab, key.button);
         }
         break;
     }
@@ -251,36 +684,182 @@ LRESULT CALLBACK MainWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
     {
         // Handle right-click on a button to open the settings dialog
         HWND hCtrl = (HWND)wParam;
-        for (int tab = 0; tab < g_tabCount; ++tab)
+        ButtonKey key;
+        if (FindButtonByWindow(hCtrl, key))
         {
-            for (int btn = 0; btn < g_buttonCountPerTab; ++btn)
+            std::wstring previousPath = g_tabs[key.tab].buttons[key.button].path;
+            g_isEditingButton = true;
+            int dialogResult = DisplayButtonSettingsDialog(key.tab, key.button);
+            g_isEditingButton = false;
+
+            if (dialogResult == IDOK)
             {
-                if (hCtrl == g_tabButtonData[tab][btn].hButton)
+                RecordInteraction(InteractionKind::EditButton, key.tab, key.button);
+
+                // Update button text and icon after dialog closes
+                ButtonInfo& info = g_tabs[key.tab].buttons[key.button];
+                if (info.path != previousPath)
                 {
-                    if (DisplayButtonSettingsDialog(tab, btn) == IDOK)
-                    {
-                        // Update button text and icon after dialog closes
-                        ButtonInfo& info = g_tabButtonData[tab][btn];
-                        SetWindowTextW(info.hButton, info.name.c_str());
-
-                        HICON hOldIcon = info.hIcon;
-                        info.hIcon = info.path.empty() ? NULL : ExtractIconFromFile(info.path);
-
-                        if (hOldIcon && hOldIcon != g_hDefaultIcon)
-                        {
-                            DestroyIcon(hOldIcon);
-                        }
-
-                        InvalidateRect(hCtrl, NULL, TRUE);
-                        SaveButtonConfigurationToFile(tab, btn, info);
-                        SetCurrentDirectoryW(g_executableDirectory.c_str());
-                    }
+                    ForgetButtonActivity(key);
                 }
+                SetWindowTextW(info.hButton, info.name.c_str());
+                ReloadButtonIcon(key.tab, key.button);
+
+                info.targetState = TargetState::Unknown;
+                InvalidateRect(hCtrl, NULL, TRUE);
+                QueueButtonConfigurationSave(key.tab, key.button, info);
+                SetCurrentDirectoryW(g_executableDirectory.c_str());
+                ValidateButtonTargets();
+            }
+        }
+        break;
+    }
+
+    case WM_APP_PROCESSEXITED:
+    {
+        // A process launched from a button has exited; redraw the button's running marker
+        int tabIndex = (int)wParam;
+        int buttonIndex = (int)lParam;
+        // Buttons of tabs without a page have no window; a NULL window would repaint the whole desktop
+        if (IsValidButton(tabIndex, buttonIndex) && g_tabs[tabIndex].buttons[buttonIndex].hButton)
+        {
+            InvalidateRect(g_tabs[tabIndex].buttons[buttonIndex].hButton, NULL, TRUE);
+        }
+        break;
+    }
+
+    case WM_APP_CONFIGCHANGED:
+    {
+        // Restart the timer on every notification so a burst of writes reloads once
+        SetTimer(hwnd, CONFIG_RELOAD_TIMER_ID, CONFIG_RELOAD_DELAY_MS, NULL);
+        break;
+    }
+
+    case WM_TIMER:
+    {
+        if (wParam == CONFIG_RELOAD_TIMER_ID)
+        {
+            if (g_isEditingButton || HasPendingButtonSaves())
+            {
+                break; // Keep the timer running and retry once the dialog is closed and edits are written
+            }
+            KillTimer(hwnd, CONFIG_RELOAD_TIMER_ID);
+            ReloadConfigurationFromFile(hwnd);
+        }
+        else if (wParam == TARGET_VALIDATION_TIMER_ID)
+        {
+            ValidateButtonTargets();
+        }
+        else if (wParam == PREFETCH_IDLE_TIMER_ID)
+        {
+            CheckIdlePrefetch();
+        }
+        else if (wParam == RESOURCE_IDLE_TIMER_ID)
+        {
+            TrimIdleResources(hwnd);
+        }
+        break;
+    }
+
+    case WM_ACTIVATE:
+    {
+        NoteLauncherActivity();
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+    }
+
+    case WM_APP_TARGETSVALIDATED:
+    {
+        ApplyTargetValidationResults();
+        break;
+    }
+
+    case WM_APP_LAUNCHTIMED:
+    {
+        ApplyLaunchTimings();
+        break;
+    }
+
+    case WM_HOTKEY:
+    {
+        // The hotkey toggles: it hides the launcher if it is the active window
+        if (wParam == SHOW_HOTKEY_ID)
+        {
+            if (!g_isResidentHidden && GetForegroundWindow() == hwnd)
+            {
+                HideResidentWindow(hwnd, true);
             }
+            else
+            {
+                ShowResidentWindow(hwnd);
+            }
+        }
+        break;
+    }
+
+    case WM_APP_TRAYICON:
+    {
+        if (lParam == WM_LBUTTONUP)
+        {
+            ShowResidentWindow(hwnd);
+        }
+        else if (lParam == WM_RBUTTONUP)
+        {
+            ShowTrayMenu(hwnd);
+        }
+        break;
+    }
+
+    case WM_APP_SUMMON:
+    {
+        if (!g_residentSettings.enabled)
+        {
+            return FALSE;
         }
+        ShowResidentWindow(hwnd);
+        return TRUE;
+    }
+
+    case WM_CLOSE:
+    {
+        // Resident launchers stay running in the notification area
+        if (g_residentSettings.enabled && !g_isExiting)
+        {
+            HideResidentWindow(hwnd, true);
+            break;
+        }
+        DestroyWindow(hwnd);
         break;
     }
 
+    case WM_SYSCOMMAND:
+    {
+        if ((wParam & 0xFFF0) == IDM_SAVE_TRACE)
+        {
+            if (!SaveTraceFile())
+            {
+                MessageBox(hwnd, L"Failed to save the trace file.", L"Error", MB_OK | MB_ICONERROR);
+            }
+            break;
+        }
+        if ((wParam & 0xFFF0) == IDM_EXPORT_LAUNCH_STATS)
+        {
+            if (!ExportLaunchStatistics())
+            {
+                MessageBox(hwnd, L"Failed to export the launch statistics.", L"Error", MB_OK | MB_ICONERROR);
+            }
+            break;
+        }
+        if ((wParam & 0xFFF0) == IDM_SAVE_DIAGNOSTICS)
+        {
+            if (!SaveDiagnostics())
+            {
+                MessageBox(hwnd, L"Failed to save the diagnostics file.", L"Error", MB_OK | MB_ICONERROR);
+            }
+            break;
+        }
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+    }
+
     case WM_CTLCOLORBTN:
     {
         // Set custom colors for buttons (used as a base for owner-draw)
@@ -295,6 +874,8 @@ LRESULT CALLBACK MainWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
         LPDRAWITEMSTRUCT pDIS = (LPDRAWITEMSTRUCT)lParam;
         if (pDIS->CtlType == ODT_BUTTON)
         {
+            TRACE_SCOPE("WM_DRAWITEM");
+
             // Determine button state and set background color
             bool isSelected = pDIS->itemState & ODS_SELECTED;
             HBRUSH brush = isSelected ? CreateSolidBrush(RGB(9, 71, 113)) : g_hButtonBrush;
@@ -307,20 +888,48 @@ LRESULT CALLBACK MainWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
             Rectangle(pDIS->hDC, pDIS->rcItem.left, pDIS->rcItem.top, pDIS->rcItem.right, pDIS->rcItem.bottom);
 
             // Get button info
-            int buttonId = GetDlgCtrlID(pDIS->hwndItem);
-            int tabIndex = (buttonId - BUTTON_ID_BASE) / g_buttonCountPerTab;
-            int btnIndex = (buttonId - BUTTON_ID_BASE) % g_buttonCountPerTab;
-            const ButtonInfo& btnInfo = g_tabButtonData[tabIndex][btnIndex];
+            ButtonKey key;
+            if (!FindButtonByWindow(pDIS->hwndItem, key))
+            {
+                return TRUE;
+            }
+            int tabIndex = key.tab;
+            int btnIndex = key.button;
+            const ButtonInfo& btnInfo = g_tabs[tabIndex].buttons[btnIndex];
+
+            // Mark buttons whose launched process is still running with an accent bar
+            if (g_processTracker.IsRunning({ tabIndex, btnIndex }))
+            {
+                const int runningBarHeight = ScaleForDpi(3);
+                RECT rcBar = pDIS->rcItem;
+                InflateRect(&rcBar, -1, -1);
+                rcBar.top = rcBar.bottom - runningBarHeight;
+                FillRect(pDIS->hDC, &rcBar, g_hRunningBrush);
+            }
+
+            // Flag buttons whose target is missing or unreachable with a corner marker
+            if (btnInfo.targetState == TargetState::Missing || btnInfo.targetState == TargetState::Unreachable)
+            {
+                const int markerSize = ScaleForDpi(8);
+                const int markerMargin = ScaleForDpi(4);
+                RECT rcMarker = {
+                    pDIS->rcItem.right - markerMargin - markerSize, pDIS->rcItem.top + markerMargin,
+                    pDIS->rcItem.right - markerMargin, pDIS->rcItem.top + markerMargin + markerSize
+                };
+                FillRect(pDIS->hDC, &rcMarker, btnInfo.targetState == TargetState::Missing ? g_hMissingBrush : g_hUnreachableBrush);
+            }
 
             // Get button text
             WCHAR text[256];
             GetWindowText(pDIS->hwndItem, text, 256);
+            SelectObject(pDIS->hDC, g_hButtonFont);
             SIZE textSize{};
             GetTextExtentPoint32(pDIS->hDC, text, lstrlenW(text), &textSize);
 
-            // Calculate vertical alignment for icon and text
-            const int iconSize = 32;
-            const int spaceBetweenIconAndText = 8;
+            // Calculate vertical alignment for icon and text. Icons are loaded at this size,
+            // so drawing them does not scale.
+            const int iconSize = GetIconSize();
+            const int spaceBetweenIconAndText = ScaleForDpi(8);
             int totalHeight = (btnInfo.hIcon ? iconSize + spaceBetweenIconAndText : 0) + textSize.cy;
             int startY = pDIS->rcItem.top + (pDIS->rcItem.bottom - pDIS->rcItem.top - totalHeight) / 2;
 
@@ -353,6 +962,7 @@ LRESULT CALLBACK MainWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
     case WM_PAINT:
     {
         // Use double-buffering to prevent flicker during resize or redraw
+        TRACE_SCOPE("WM_PAINT");
         PAINTSTRUCT ps;
         HDC hdc = BeginPaint(hwnd, &ps);
 
@@ -363,13 +973,9 @@ LRESULT CALLBACK MainWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
         HBITMAP bmp = CreateCompatibleBitmap(hdc, rc.right, rc.bottom);
         HBITMAP oldBmp = (HBITMAP)SelectObject(memDC, bmp);
 
-        // Draw background
+        // Draw background; the tab strip and the buttons paint themselves
         FillRect(memDC, &rc, g_hBackgroundBrush);
 
-        // Draw the tab control into the memory DC. This is key for achieving
-        // a transparent-like effect for the tab control's background.
-        SendMessage(g_hTabControl, WM_PRINTCLIENT, (WPARAM)memDC, (LPARAM)(PRF_ERASEBKGND | PRF_CLIENT | PRF_CHILDREN));
-
         // Copy the completed image from the memory DC to the screen
         BitBlt(hdc, 0, 0, rc.right, rc.bottom, memDC, 0, 0, SRCCOPY);
 
@@ -378,11 +984,32 @@ LRESULT CALLBACK MainWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
         DeleteDC(memDC);
 
         EndPaint(hwnd, &ps);
+
+        if (!g_hasPainted)
+        {
+            g_hasPainted = true;
+            Trace::RecordSpan("StartupToFirstPaint", g_startupTraceStart, Trace::NowMicroseconds() - g_startupTraceStart);
+        }
         break;
     }
 
     case WM_DESTROY:
     {
+        // Background work is cancelled before the executor waits for its workers
+        g_programIndexer.Stop();
+        g_prefetcher.Stop();
+        g_targetValidator.Stop();
+        g_catalogUpdater.Stop();
+        g_taskExecutor.Stop();
+        WritePendingButtonSaves(); // Edits the executor had not written yet
+        g_brokerClient.Stop();
+        g_configWatcher.Stop();
+        g_catalogWatcher.Stop();
+        g_processTracker.Stop();
+        g_launchTimer.Stop();
+        UnregisterHotKey(hwnd, SHOW_HOTKEY_ID);
+        g_trayIcon.Remove();
+        if (g_hTrayIcon) DestroyIcon(g_hTrayIcon);
         SaveWindowPosition(hwnd);
         ReleaseGdiResources();
         PostQuitMessage(0);
@@ -395,6 +1022,41 @@ LRESULT CALLBACK MainWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
     return 0;
 }
 
+// =============================================================
+//              TabPageWindowProcedure - Tab Page Window
+// =============================================================
+
+/**
+ * @brief Registers the window class of the tab pages, the containers of each tab's buttons.
+ * @param hInstance The application instance.
+ * @return True on success, false on failure.
+ */
+bool RegisterTabPageClass(HINSTANCE hInstance)
+{
+    WNDCLASSEX wc = { sizeof(WNDCLASSEX) };
+    wc.lpfnWndProc = TabPageWindowProcedure;
+    wc.hInstance = hInstance;
+    wc.hCursor = LoadCursor(NULL, IDC_ARROW);
+    wc.hbrBackground = g_hBackgroundBrush;
+    wc.lpszClassName = g_tabPageClassName;
+    return RegisterClassEx(&wc) != 0;
+}
+
+LRESULT CALLBACK TabPageWindowProcedure(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    switch (msg)
+    {
+    case WM_COMMAND:
+    case WM_DRAWITEM:
+        // Buttons notify their page; the main window handles them.
+        // WM_CONTEXTMENU reaches the main window through DefWindowProc.
+        return SendMessage(GetParent(hwnd), msg, wParam, lParam);
+
+    default:
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+    }
+}
+
 // =============================================================
 //                   GDI Resource Management
 // =============================================================
@@ -408,11 +1070,116 @@ void InitializeGdiResources()
     g_hTabBrush = CreateSolidBrush(RGB(37, 37, 38));
     g_hButtonBrush = CreateSolidBrush(RGB(60, 60, 60));
     g_hBorderPen = CreatePen(PS_SOLID, 1, RGB(50, 50, 50));
+    g_hRunningBrush = CreateSolidBrush(RGB(0, 122, 204));
+    g_hMissingBrush = CreateSolidBrush(RGB(209, 52, 56));
+    g_hUnreachableBrush = CreateSolidBrush(RGB(202, 130, 0));
+    g_hAccentBrush = CreateSolidBrush(RGB(0, 122, 204));
+    CreateScaledFonts();
+}
+
+/**
+ * @brief Creates the tab and button fonts for the current DPI, replacing any previous ones.
+ */
+void CreateScaledFonts()
+{
+    HFONT hOldTabFont = g_hTabFont;
+    HFONT hOldButtonFont = g_hButtonFont;
 
     LOGFONT lf = {};
-    lf.lfHeight = 24;
+    lf.lfHeight = ScaleForDpi(TAB_FONT_HEIGHT);
     lf.lfWeight = FW_BOLD;
     g_hTabFont = CreateFontIndirect(&lf);
+
+    LOGFONT buttonFont = {};
+    buttonFont.lfHeight = -ScaleForDpi(BUTTON_FONT_HEIGHT);
+    buttonFont.lfQuality = CLEARTYPE_QUALITY;
+    wcscpy_s(buttonFont.lfFaceName, L"Segoe UI");
+    g_hButtonFont = CreateFontIndirect(&buttonFont);
+
+    if (g_tabStrip.GetHandle())
+    {
+        g_tabStrip.SetDpi(g_dpi);
+        g_tabStrip.SetFont(g_hTabFont);
+    }
+    if (hOldTabFont) DeleteObject(hOldTabFont);
+    if (hOldButtonFont) DeleteObject(hOldButtonFont);
+}
+
+/**
+ * @brief Makes the process per-monitor DPI aware, so that Windows does not stretch
+ *        the window bitmap. Per-monitor v2 (Windows 10 1703) also scales the settings
+ *        dialog; older systems get system DPI awareness.
+ */
+void EnableDpiAwareness()
+{
+    using SetProcessDpiAwarenessContextFunc = BOOL(WINAPI*)(DPI_AWARENESS_CONTEXT);
+    auto setProcessDpiAwarenessContext = reinterpret_cast<SetProcessDpiAwarenessContextFunc>(
+        GetProcAddress(GetModuleHandle(L"user32.dll"), "SetProcessDpiAwarenessContext"));
+    if (!setProcessDpiAwarenessContext || !setProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2))
+    {
+        SetProcessDPIAware();
+    }
+}
+
+/**
+ * @brief Returns the DPI of the monitor a window is on.
+ * @param hwnd The window, or NULL for the system DPI.
+ */
+UINT GetWindowDpi(HWND hwnd)
+{
+    using GetDpiForWindowFunc = UINT(WINAPI*)(HWND);
+    static auto getDpiForWindow = reinterpret_cast<GetDpiForWindowFunc>(
+        GetProcAddress(GetModuleHandle(L"user32.dll"), "GetDpiForWindow"));
+    if (hwnd && getDpiForWindow)
+    {
+        UINT dpi = getDpiForWindow(hwnd);
+        if (dpi != 0) return dpi;
+    }
+
+    HDC hdc = GetDC(NULL);
+    UINT dpi = static_cast<UINT>(GetDeviceCaps(hdc, LOGPIXELSY));
+    ReleaseDC(NULL, hdc);
+    return dpi != 0 ? dpi : 96;
+}
+
+/**
+ * @brief Rescales fonts, the tab strip and the icons of the current tab for a new DPI.
+ *        Other tabs get their icons when they are shown next.
+ * @param hwnd Handle to the main window.
+ * @param dpi The new DPI.
+ */
+void ApplyDpi(HWND hwnd, UINT dpi)
+{
+    if (dpi == g_dpi)
+    {
+        return;
+    }
+    TRACE_SCOPE("ApplyDpi");
+
+    g_dpi = dpi;
+    CreateScaledFonts();
+    if (g_currentTab < GetTabCount())
+    {
+        RefreshTabIcons(g_currentTab);
+    }
+    UpdateLayoutOnResize(hwnd);
+    RedrawWindow(hwnd, NULL, NULL, RDW_INVALIDATE | RDW_ERASE | RDW_ALLCHILDREN);
+}
+
+/**
+ * @brief Scales a size given at 96 DPI to the current DPI.
+ */
+int ScaleForDpi(int pixels)
+{
+    return MulDiv(pixels, g_dpi, 96);
+}
+
+/**
+ * @brief Returns the size button icons are drawn at for the current DPI.
+ */
+int GetIconSize()
+{
+    return ScaleForDpi(ICON_SIZE);
 }
 
 /**
@@ -421,9 +1188,9 @@ void InitializeGdiResources()
 void ReleaseGdiResources()
 {
     // Destroy all loaded button icons
-    for (auto& tab : g_tabButtonData)
+    for (auto& tab : g_tabs)
     {
-        for (auto& buttonInfo : tab)
+        for (auto& buttonInfo : tab.buttons)
         {
             if (buttonInfo.hIcon && buttonInfo.hIcon != g_hDefaultIcon)
             {
@@ -437,7 +1204,12 @@ void ReleaseGdiResources()
     DeleteObject(g_hTabBrush);
     DeleteObject(g_hButtonBrush);
     DeleteObject(g_hBorderPen);
+    DeleteObject(g_hRunningBrush);
+    DeleteObject(g_hMissingBrush);
+    DeleteObject(g_hUnreachableBrush);
+    DeleteObject(g_hAccentBrush);
     DeleteObject(g_hTabFont);
+    DeleteObject(g_hButtonFont);
 }
 
 // =============================================================
@@ -445,374 +1217,2487 @@ void ReleaseGdiResources()
 // =============================================================
 
 /**
- * @brief Creates the main tab control and populates it with tabs.
+ * @brief Creates the tab strip and populates it with the tab names.
+ *        Buttons are created per tab when the tab is first shown.
  * @param hwnd Handle to the parent window.
  */
-void InitializeTabControl(HWND hwnd)
+void InitializeTabStrip(HWND hwnd)
 {
-    g_hTabControl = CreateWindowEx(
-        0, WC_TABCONTROL, L"",
-        WS_CHILD | WS_VISIBLE | TCS_FLATBUTTONS | TCS_BUTTONS, 0,
-        0, 0, 0, hwnd, NULL, GetModuleHandle(NULL), NULL
-    );
-
-    SendMessage(g_hTabControl, WM_SETFONT, (WPARAM)g_hTabFont, TRUE);
-
-    // Insert tabs and create corresponding buttons for each tab
-    TCITEM tie = { TCIF_TEXT };
-    for (int i = 0; i < g_tabCount; ++i)
+    g_tabStrip.Create(hwnd, GetModuleHandle(NULL));
+    g_tabStrip.SetDpi(g_dpi);
+    g_tabStrip.SetFont(g_hTabFont);
+    g_tabStrip.SetBrushes(g_hTabBrush, g_hButtonBrush, g_hAccentBrush);
+
+    std::vector<std::wstring> names;
+    names.reserve(g_tabs.size());
+    for (const TabInfo& tab : g_tabs)
     {
-        tie.pszText = (LPWSTR)g_tabNames[i].c_str();
-        TabCtrl_InsertItem(g_hTabControl, i, &tie);
-        CreateButtonsForTab(hwnd, i);
+        names.push_back(tab.name);
     }
+    g_tabStrip.SetTabs(std::move(names));
+    g_tabStrip.SetCurSel(g_currentTab);
 }
 
 /**
- * @brief Creates the grid of buttons for a specific tab.
- * @param hwnd Handle to the parent window.
- * @param tabIndex The index of the tab for which to create buttons.
+ * @brief Creates the page window of a tab with its buttons and loads their icons, unless
+ *        already done. With thousands of tabs, only the tabs the user visits pay for this.
+ *        The page starts hidden; the buttons are visible within it.
+ * @param hwnd Handle to the main window.
+ * @param tabIndex The index of the tab for which to create the page.
  */
-void CreateButtonsForTab(HWND hwnd, int tabIndex)
+void EnsureTabPageCreated(HWND hwnd, int tabIndex)
 {
-    RECT rcTab;
-    GetClientRect(g_hTabControl, &rcTab);
-    TabCtrl_AdjustRect(g_hTabControl, FALSE, &rcTab);
+    TabInfo& tab = g_tabs[tabIndex];
+    if (tab.hPage)
+    {
+        return;
+    }
+    TRACE_SCOPE("CreateTabPage");
+
+    RECT rcArea = GetButtonAreaRect(hwnd);
+    RECT rcPage = { 0, 0, rcArea.right - rcArea.left, rcArea.bottom - rcArea.top };
+    tab.hPage = CreateWindowEx(
+        0, g_tabPageClassName, L"",
+        WS_CHILD | WS_CLIPCHILDREN,
+        rcArea.left, rcArea.top, rcPage.right, rcPage.bottom,
+        hwnd, NULL, GetModuleHandle(NULL), NULL
+    );
+    if (tab.hPage)
+    {
+        g_resourceAccountant.Add(ResourceOwner::TabPages, ResourceKind::Windows, 1);
+    }
+    for (int i = 0; i < static_cast<int>(tab.buttons.size()); ++i)
+    {
+        ReloadButtonIcon(tabIndex, i);
+        RECT rc = GetButtonRect(rcPage, tab.buttonRows, tab.buttonCols, i);
+        CreateButtonWindow(tab.hPage, tabIndex, i, rc.left, rc.top, rc.right - rc.left, rc.bottom - rc.top);
+    }
+    tab.iconSize = GetIconSize();
+    tab.layoutArea = rcArea;
+    tab.lastVisitTick = GetTickCount64();
 
-    int btnWidth = (rcTab.right - rcTab.left) / g_buttonCols;
-    int btnHeight = (rcTab.bottom - rcTab.top) / g_buttonRows;
+    // Make room by releasing the pages of tabs not visited for the longest time
+    EnforceResourceLimits(tabIndex);
+}
 
-    for (int row = 0; row < g_buttonRows; ++row)
+/**
+ * @brief Destroys the page window of a tab together with its buttons and their icons.
+ * @param tabIndex The index of the tab whose page to destroy.
+ */
+void DestroyTabPage(int tabIndex)
+{
+    TabInfo& tab = g_tabs[tabIndex];
+    CancelIconLoads(tabIndex);
+    for (ButtonInfo& info : tab.buttons)
     {
-        for (int col = 0; col < g_buttonCols; ++col)
-        {
-            int i = row * g_buttonCols + col;
-            int id = BUTTON_ID_BASE + tabIndex * g_buttonCountPerTab + i;
-            g_tabButtonData[tabIndex][i].hButton = CreateWindowEx(
-                0, L"BUTTON", g_tabButtonData[tabIndex][i].name.c_str(),
-                WS_CHILD | BS_PUSHBUTTON | BS_OWNERDRAW,
-                rcTab.left + col * btnWidth, rcTab.top + row * btnHeight, btnWidth, btnHeight,
-                hwnd, (HMENU)(INT_PTR)id, GetModuleHandle(NULL), NULL
-            );
-        }
+        DestroyButton(info);
+    }
+    if (tab.hPage)
+    {
+        DestroyWindow(tab.hPage);
+        tab.hPage = NULL;
+        g_resourceAccountant.Add(ResourceOwner::TabPages, ResourceKind::Windows, -1);
     }
 }
 
 /**
- * @brief Resizes the tab control and all buttons when the main window is resized.
- * @param hwnd Handle to the main window.
+ * @brief Creates the window of a single launch button on its tab page.
+ * @param hPage Handle to the page of the tab.
+ * @param tabIndex The index of the tab the button belongs to.
+ * @param buttonIndex The index of the button within the tab.
+ * @param x, y, width, height Initial position and size of the button within the page.
  */
-void UpdateLayoutOnResize(HWND hwnd)
+void CreateButtonWindow(HWND hPage, int tabIndex, int buttonIndex, int x, int y, int width, int height)
 {
-    RECT rcClient;
-    GetClientRect(hwnd, &rcClient);
-    MoveWindow(g_hTabControl, 0, 0, rcClient.right, rcClient.bottom, TRUE);
-
-    RECT rcTab;
-    GetClientRect(g_hTabControl, &rcTab);
-    TabCtrl_AdjustRect(g_hTabControl, FALSE, &rcTab);
+    ButtonInfo& info = g_tabs[tabIndex].buttons[buttonIndex];
+    info.hButton = CreateWindowEx(
+        0, L"BUTTON", info.name.c_str(),
+        WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON | BS_OWNERDRAW,
+        x, y, width, height,
+        hPage, (HMENU)(INT_PTR)(BUTTON_ID_BASE + buttonIndex), GetModuleHandle(NULL), NULL
+    );
+    if (info.hButton)
+    {
+        g_resourceAccountant.Add(ResourceOwner::Buttons, ResourceKind::Windows, 1);
+    }
+    SetWindowLongPtr(info.hButton, GWLP_USERDATA, tabIndex);
+}
 
-    int btnWidth = (rcTab.right - rcTab.left) / g_buttonCols;
-    int btnHeight = (rcTab.bottom - rcTab.top) / g_buttonRows;
+/**
+ * @brief Fills a tab's data from its configuration. No windows are created.
+ * @param tab The tab to initialize.
+ * @param config The tab's settings.
+ * @param usage The parsed usage file, for the launch counts.
+ * @param tabIndex The index of the tab.
+ */
+void InitializeTab(TabInfo& tab, const TabConfig& config, const IniDocument& usage, int tabIndex)
+{
+    tab.name = config.name;
+    tab.buttonRows = config.buttonRows;
+    tab.buttonCols = config.buttonCols;
+    tab.buttons.resize(config.buttons.size());
 
-    for (int tab = 0; tab < g_tabCount; ++tab)
+    const IniDocument::Section* usageSection = usage.FindSection(L"Tab" + std::to_wstring(tabIndex));
+    for (int btn = 0; btn < static_cast<int>(config.buttons.size()); ++btn)
     {
-        for (int i = 0; i < g_buttonCountPerTab; ++i)
-        {
-            if (g_tabButtonData[tab][i].hButton)
-            {
-                int row = i / g_buttonCols;
-                int col = i % g_buttonCols;
-                MoveWindow(g_tabButtonData[tab][i].hButton, rcTab.left + col * btnWidth,
-                    rcTab.top + row * btnHeight, btnWidth, btnHeight, TRUE);
-            }
-        }
+        InitializeButton(tab.buttons[btn], config.buttons[btn], usage, usageSection, btn);
     }
-    InvalidateRect(hwnd, NULL, FALSE);
 }
 
-// =============================================================
-//               Configuration (INI File) Handling
-// =============================================================
-
 /**
- * @brief Creates the INI file with default settings if it doesn't exist.
- * @return True if the file was created successfully, false otherwise.
+ * @brief Fills a button's data from its configuration and usage. The icon is loaded with the window.
+ * @param info The button to initialize.
+ * @param config The button's settings.
+ * @param usage The parsed usage file, for the launch count and latencies.
+ * @param usageSection The usage file section of the button's tab, or NULL if there is none.
+ * @param buttonIndex The index of the button within its tab.
  */
-bool GenerateDefaultConfigFile()
+void InitializeButton(ButtonInfo& info, const ButtonConfig& config, const IniDocument& usage, const IniDocument::Section* usageSection, int buttonIndex)
 {
-    return WriteUtf16LeFile(g_configFilePath.c_str(), GetDefaultConfigString());
+    static_cast<ButtonConfig&>(info) = config;
+    info.launchCount = static_cast<unsigned int>(usage.GetInt(usageSection, GetLaunchCountKey(buttonIndex), 0));
+    for (int phase = 0; phase < LAUNCH_PHASE_COUNT; ++phase)
+    {
+        info.launchLatency[phase].Parse(usage.GetString(usageSection, GetLaunchLatencyKey(buttonIndex, static_cast<LaunchPhase>(phase)), L""));
+    }
 }
 
 /**
- * @brief Safely reads a string from the INI file, handling buffer resizing.
- * @param section The section name in the INI file.
- * @param key The key name in the section.
- * @param defaultValue The default value to return if the key is not found.
- * @param filePath The path to the INI file.
- * @return The retrieved string value.
+ * @brief Loads a button's icon from its target, replacing the previous icon.
+ *
+ * Cached icons are set at once. Others are extracted on the task executor while the
+ * button keeps its previous icon, or shows the default one; icons of the current tab
+ * are extracted before those of other tabs.
+ * @param tabIndex The index of the tab the button belongs to.
+ * @param buttonIndex The index of the button within the tab.
  */
-std::wstring ReadStringFromIni(LPCWSTR section, LPCWSTR key, LPCWSTR defaultValue, LPCWSTR filePath)
+void ReloadButtonIcon(int tabIndex, int buttonIndex)
 {
-    std::vector<wchar_t> buffer(256);
-    while (true)
+    ButtonInfo& info = g_tabs[tabIndex].buttons[buttonIndex];
+    if (info.path.empty())
+    {
+        SetButtonIcon(info, NULL);
+        return;
+    }
+
+    const int size = GetIconSize();
+    HICON hIcon = g_iconCache.FindIcon(info.path, size);
+    if (!hIcon && !g_taskExecutor.IsRunning())
     {
-        DWORD charsCopied = GetPrivateProfileStringW(
-            section, key, defaultValue, buffer.data(), static_cast<DWORD>(buffer.size()), filePath
-        );
-        if (charsCopied < buffer.size() - 1)
+        // Without workers, e.g. in benchmarks, extract on this thread
+        TRACE_SCOPE("ExtractIcon");
+        BgraImage image;
+        if (ExtractIconImage(info.path, size, image))
         {
-            return std::wstring(buffer.data());
+            g_iconCache.AddImage(info.path, size, std::move(image));
+            hIcon = g_iconCache.FindIcon(info.path, size);
         }
-        buffer.resize(buffer.size() * 2);
+        if (!hIcon) hIcon = CreateDefaultIcon(size);
+    }
+    if (hIcon)
+    {
+        SetButtonIcon(info, hIcon);
+        return;
     }
+
+    if (!info.hIcon)
+    {
+        info.hIcon = g_hDefaultIcon;
+    }
+    QueueIconLoad(tabIndex, buttonIndex, info.path, size);
 }
 
 /**
- * @brief Loads all configuration settings from the INI file.
+ * @brief Replaces a button's icon, destroying the previous one.
+ * @param info The button.
+ * @param hIcon The new icon, owned by the button from now on, or NULL for none.
  */
-void LoadConfigurationFromFile()
+void SetButtonIcon(ButtonInfo& info, HICON hIcon)
 {
-    // If INI file doesn't exist, create it with default values
-    if (!PathFileExists(g_configFilePath.c_str()))
+    HICON hOldIcon = info.hIcon;
+    info.hIcon = hIcon;
+    if (hIcon && hIcon != g_hDefaultIcon)
     {
-        if (!GenerateDefaultConfigFile())
-        {
-            MessageBox(NULL, L"Failed to create config.ini file.", L"Error", MB_OK | MB_ICONERROR);
-            std::exit(1);
-        }
+        g_resourceAccountant.Add(ResourceOwner::Buttons, ResourceKind::Icons, 1);
     }
+    if (hOldIcon && hOldIcon != g_hDefaultIcon)
+    {
+        DestroyIcon(hOldIcon);
+        g_resourceAccountant.Add(ResourceOwner::Buttons, ResourceKind::Icons, -1);
+    }
+}
 
-    // Read general settings
-    g_tabCount = GetPrivateProfileInt(L"Tabs", L"Count", 10, g_configFilePath.c_str());
-    if (g_tabCount <= 0 || g_tabCount > MAX_TABS) g_tabCount = 10;
-
-    g_buttonRows = GetPrivateProfileInt(L"Tabs", L"ButtonRows", 3, g_configFilePath.c_str());
-    if (g_buttonRows <= 0) g_buttonRows = 3;
+/**
+ * @brief Extracts an icon on the task executor for a button. Buttons waiting for the same
+ *        path and size share one extraction.
+ * @param tabIndex, buttonIndex The button waiting for the icon.
+ * @param path The path to extract the icon of, as configured.
+ * @param size The width and height of the icon in pixels.
+ */
+void QueueIconLoad(int tabIndex, int buttonIndex, const std::wstring& path, int size)
+{
+    auto [it, isNew] = g_iconLoads.try_emplace(std::make_pair(path, size));
+    IconLoad& load = it->second;
+    ButtonKey key{ tabIndex, buttonIndex };
+    if (std::find(load.buttons.begin(), load.buttons.end(), key) == load.buttons.end())
+    {
+        load.buttons.push_back(key);
+    }
+    if (!isNew)
+    {
+        return;
+    }
 
-    g_buttonCols = GetPrivateProfileInt(L"Tabs", L"ButtonCols", 8, g_configFilePath.c_str());
-    if (g_buttonCols <= 0) g_buttonCols = 8;
+    load.token = CancellationToken::Create();
+    const TaskPriority lane = (tabIndex == g_currentTab) ? TaskPriority::Visible : TaskPriority::Background;
+    bool isQueued = g_taskExecutor.Submit(lane, load.token, [path, size]()
+    {
+        LoadedIcon loaded;
+        loaded.path = path;
+        loaded.size = size;
+        loaded.isLoaded = ExtractIconImage(path, size, loaded.image);
+        g_completionQueue.Push([loaded = std::move(loaded)]() mutable { ApplyLoadedIcon(loaded); });
+    });
+    if (!isQueued)
+    {
+        g_iconLoads.erase(it);
+        SetButtonIcon(g_tabs[tabIndex].buttons[buttonIndex], CreateDefaultIcon(size));
+    }
+}
 
-    g_buttonCountPerTab = g_buttonRows * g_buttonCols;
+/**
+ * @brief Caches an icon extracted on the task executor and sets it on the buttons still
+ *        waiting for it. Runs from the completion queue.
+ * @param loaded The extracted icon; its pixels are moved into the cache.
+ */
+void ApplyLoadedIcon(LoadedIcon& loaded)
+{
+    auto it = g_iconLoads.find(std::make_pair(loaded.path, loaded.size));
+    if (it == g_iconLoads.end())
+    {
+        return; // Cancelled after it started
+    }
+    std::vector<ButtonKey> buttons = std::move(it->second.buttons);
+    g_iconLoads.erase(it);
 
-    // Resize data structures
-    g_tabNames.resize(g_tabCount);
-    g_tabButtonData.resize(g_tabCount, std::vector<ButtonInfo>(g_buttonCountPerTab));
+    if (loaded.isLoaded)
+    {
+        g_iconCache.AddImage(loaded.path, loaded.size, std::move(loaded.image));
+    }
+    if (loaded.size != GetIconSize())
+    {
+        return; // The DPI changed meanwhile; the buttons queued loads at the new size
+    }
 
-    // Read tab names
-    for (int i = 0; i < g_tabCount; i++)
+    for (const ButtonKey& key : buttons)
     {
-        std::wstring key = L"Tab" + std::to_wstring(i);
-        std::wstring defaultName = L"Tab" + std::to_wstring(i + 1);
-        g_tabNames[i] = ReadStringFromIni(L"Tabs", key.c_str(), defaultName.c_str(), g_configFilePath.c_str());
-        if (g_tabNames[i].empty() || g_tabNames[i].length() > 30)
+        // The button may have been removed, unloaded or pointed elsewhere meanwhile
+        if (!IsValidButton(key.tab, key.button) || !g_tabs[key.tab].hPage)
+        {
+            continue;
+        }
+        ButtonInfo& info = g_tabs[key.tab].buttons[key.button];
+        if (info.path != loaded.path)
         {
-            g_tabNames[i] = defaultName;
+            continue;
         }
+        HICON hIcon = loaded.isLoaded ? g_iconCache.FindIcon(loaded.path, loaded.size) : NULL;
+        SetButtonIcon(info, hIcon ? hIcon : CreateDefaultIcon(loaded.size));
+        RequestRepaint(info.hButton);
     }
+}
 
-    // Read button information for each tab
-    for (int tab = 0; tab < g_tabCount; tab++)
+/**
+ * @brief Stops waiting for icons on a tab's buttons. Extractions no other tab waits for
+ *        are cancelled unless they already started.
+ * @param tabIndex The index of the tab.
+ */
+void CancelIconLoads(int tabIndex)
+{
+    for (auto it = g_iconLoads.begin(); it != g_iconLoads.end();)
     {
-        std::wstring section = L"Tab" + std::to_wstring(tab);
-        for (int btn = 0; btn < g_buttonCountPerTab; btn++)
+        std::vector<ButtonKey>& buttons = it->second.buttons;
+        buttons.erase(std::remove_if(buttons.begin(), buttons.end(), [tabIndex](const ButtonKey& key) { return key.tab == tabIndex; }), buttons.end());
+        if (buttons.empty())
         {
-            std::wstring keyBase = L"Button" + std::to_wstring(btn);
-            ButtonInfo& info = g_tabButtonData[tab][btn];
-
-            info.name = ReadStringFromIni(section.c_str(), (keyBase + L"_Name").c_str(), L"", g_configFilePath.c_str());
-            trim(info.name);
+            it->second.token.Cancel();
+            it = g_iconLoads.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
 
-            info.path = ReadStringFromIni(section.c_str(), (keyBase + L"_Path").c_str(), L"", g_configFilePath.c_str());
-            trim(info.path);
+/**
+ * @brief Reloads the icons of a tab's buttons if they were loaded for another DPI.
+ * @param tabIndex The index of the tab.
+ */
+void RefreshTabIcons(int tabIndex)
+{
+    TabInfo& tab = g_tabs[tabIndex];
+    if (!tab.hPage || tab.iconSize == GetIconSize())
+    {
+        return;
+    }
+    TRACE_SCOPE("RefreshTabIcons");
 
-            info.parameters = ReadStringFromIni(section.c_str(), (keyBase + L"_Params").c_str(), L"", g_configFilePath.c_str());
-            trim(info.parameters);
+    for (int i = 0; i < static_cast<int>(tab.buttons.size()); ++i)
+    {
+        ReloadButtonIcon(tabIndex, i);
+    }
+    tab.iconSize = GetIconSize();
+}
 
-            info.adminMode = GetPrivateProfileInt(section.c_str(), (keyBase + L"_Admin").c_str(), 0, g_configFilePath.c_str()) != 0;
+/**
+ * @brief Destroys a button's window and icon.
+ * @param info The button to destroy.
+ */
+void DestroyButton(ButtonInfo& info)
+{
+    if (info.hButton)
+    {
+        DestroyWindow(info.hButton);
+        info.hButton = NULL;
+        g_resourceAccountant.Add(ResourceOwner::Buttons, ResourceKind::Windows, -1);
+    }
+    if (info.hIcon && info.hIcon != g_hDefaultIcon)
+    {
+        DestroyIcon(info.hIcon);
+        g_resourceAccountant.Add(ResourceOwner::Buttons, ResourceKind::Icons, -1);
+    }
+    info.hIcon = NULL;
+}
 
-            info.hIcon = info.path.empty() ? NULL : ExtractIconFromFile(info.path);
-        }
+/**
+ * @brief Identifies a launch button from its window handle.
+ * @param hButton The window to look up.
+ * @param key Receives the tab and button index of the button.
+ * @return True if the window is one of the launch buttons, false otherwise.
+ */
+bool FindButtonByWindow(HWND hButton, ButtonKey& key)
+{
+    if (!hButton)
+    {
+        return false;
     }
+    int tabIndex = static_cast<int>(GetWindowLongPtr(hButton, GWLP_USERDATA));
+    int buttonIndex = GetDlgCtrlID(hButton) - BUTTON_ID_BASE;
+    if (!IsValidButton(tabIndex, buttonIndex) || g_tabs[tabIndex].buttons[buttonIndex].hButton != hButton)
+    {
+        return false;
+    }
+    key = { tabIndex, buttonIndex };
+    return true;
 }
 
 /**
- * @brief Saves the information for a single button to the INI file.
- * @param tabIndex The tab index of the button.
- * @param buttonIndex The index of the button within the tab.
- * @param info The ButtonInfo structure containing the data to save.
- * @return True on success, false on failure.
+ * @brief Checks that a tab and button index refer to an existing button.
  */
-bool SaveButtonConfigurationToFile(int tabIndex, int buttonIndex, const ButtonInfo& info)
+bool IsValidButton(int tabIndex, int buttonIndex)
 {
-    std::wstring section = L"Tab" + std::to_wstring(tabIndex);
-    std::wstring btnKey = L"Button" + std::to_wstring(buttonIndex);
+    return tabIndex >= 0 && tabIndex < GetTabCount() &&
+        buttonIndex >= 0 && buttonIndex < static_cast<int>(g_tabs[tabIndex].buttons.size());
+}
 
-    BOOL ok = TRUE;
-    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Name").c_str(), info.name.c_str(), g_configFilePath.c_str());
-    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Path").c_str(), info.path.c_str(), g_configFilePath.c_str());
-    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Params").c_str(), info.parameters.c_str(), g_configFilePath.c_str());
-    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Admin").c_str(), info.adminMode ? L"1" : L"0", g_configFilePath.c_str());
+/**
+ * @brief Returns the number of tabs.
+ */
+int GetTabCount()
+{
+    return static_cast<int>(g_tabs.size());
+}
 
-    return ok != 0;
+/**
+ * @brief Hides the page of the current tab and shows the page of another tab.
+ * @param hwnd Handle to the main window.
+ * @param newTab The index of the tab to show.
+ */
+void SwitchToTab(HWND hwnd, int newTab)
+{
+    if (newTab == g_currentTab || newTab < 0 || newTab >= GetTabCount())
+    {
+        return;
+    }
+    TRACE_SCOPE("SwitchTab");
+    NoteLauncherActivity();
+    g_tabs[g_currentTab].lastVisitTick = GetTickCount64();
+
+    // Create the new tab's page on first visit and fit it to the current size and DPI
+    EnsureTabPageCreated(hwnd, newTab);
+    RefreshTabIcons(newTab);
+    LayoutTabPage(hwnd, newTab);
+
+    ShowTabPage(g_tabs[g_currentTab].hPage, g_tabs[newTab].hPage);
+    g_currentTab = newTab;
+    g_tabs[newTab].lastVisitTick = GetTickCount64();
 }
 
-// =============================================================
-//                   Window State Persistence
-// =============================================================
+/**
+ * @brief Swaps the visible tab page in one deferred window operation without
+ *        intermediate redraws, then paints the new page and its buttons once.
+ *        The cost does not depend on the number of buttons on either page.
+ * @param hOldPage The page to hide, or NULL.
+ * @param hNewPage The page to show, or NULL.
+ */
+void ShowTabPage(HWND hOldPage, HWND hNewPage)
+{
+    // Both pages cover the same area, so hiding the old one needs no repaint underneath
+    const UINT flags = SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE | SWP_NOREDRAW;
+    HDWP hdwp = BeginDeferWindowPos(2);
+    if (hdwp && hOldPage)
+    {
+        hdwp = DeferWindowPos(hdwp, hOldPage, NULL, 0, 0, 0, 0, flags | SWP_HIDEWINDOW);
+    }
+    if (hdwp && hNewPage)
+    {
+        hdwp = DeferWindowPos(hdwp, hNewPage, NULL, 0, 0, 0, 0, flags | SWP_SHOWWINDOW);
+    }
+    if (hdwp)
+    {
+        EndDeferWindowPos(hdwp);
+    }
+    else
+    {
+        if (hOldPage) ShowWindow(hOldPage, SW_HIDE);
+        if (hNewPage) ShowWindow(hNewPage, SW_SHOW);
+    }
+
+    if (hNewPage)
+    {
+        RedrawWindow(hNewPage, NULL, NULL, RDW_INVALIDATE | RDW_ERASE | RDW_ALLCHILDREN);
+    }
+}
 
 /**
- * @brief Saves the main window's position and size to the registry.
+ * @brief Resizes the tab strip and the page of the current tab when the main window is resized.
+ *        Other pages are laid out when they are shown.
  * @param hwnd Handle to the main window.
  */
-void SaveWindowPosition(HWND hwnd)
+void UpdateLayoutOnResize(HWND hwnd)
 {
-    WINDOWPLACEMENT wp = { sizeof(WINDOWPLACEMENT) };
-    if (GetWindowPlacement(hwnd, &wp))
+    TRACE_SCOPE("UpdateLayout");
+
+    RECT rcClient;
+    GetClientRect(hwnd, &rcClient);
+    MoveWindow(g_tabStrip.GetHandle(), 0, 0, rcClient.right, g_tabStrip.GetPreferredHeight(), TRUE);
+
+    if (g_currentTab < GetTabCount())
     {
-        HKEY hKey;
-        if (RegCreateKeyEx(HKEY_CURRENT_USER, L"Software\\MultiTabLauncher", 0, NULL, 0, KEY_WRITE, NULL, &hKey, NULL) == ERROR_SUCCESS)
-        {
-            RegSetValueEx(hKey, L"Placement", 0, REG_BINARY, (BYTE*)&wp, sizeof(wp));
-            RegCloseKey(hKey);
-        }
+        LayoutTabPage(hwnd, g_currentTab);
     }
+    InvalidateRect(hwnd, NULL, FALSE);
 }
 
 /**
- * @brief Loads the main window's position and size from the registry.
+ * @brief Fits the page of a tab to the button area and moves its buttons into the grid,
+ *        unless the page already has the current size.
  * @param hwnd Handle to the main window.
+ * @param tabIndex The index of the tab.
  */
-void RestoreWindowPosition(HWND hwnd)
+void LayoutTabPage(HWND hwnd, int tabIndex)
 {
-    WINDOWPLACEMENT wp = { sizeof(WINDOWPLACEMENT) };
-    HKEY hKey;
-    DWORD size = sizeof(wp);
-    if (RegOpenKeyEx(HKEY_CURRENT_USER, L"Software\\MultiTabLauncher", 0, KEY_READ, &hKey) == ERROR_SUCCESS)
+    TabInfo& tab = g_tabs[tabIndex];
+    RECT rcArea = GetButtonAreaRect(hwnd);
+    if (!tab.hPage || EqualRect(&rcArea, &tab.layoutArea))
     {
-        if (RegQueryValueEx(hKey, L"Placement", NULL, NULL, (LPBYTE)&wp, &size) == ERROR_SUCCESS)
+        return;
+    }
+
+    RECT rcPage = { 0, 0, rcArea.right - rcArea.left, rcArea.bottom - rcArea.top };
+    MoveWindow(tab.hPage, rcArea.left, rcArea.top, rcPage.right, rcPage.bottom, TRUE);
+
+    HDWP hdwp = BeginDeferWindowPos(static_cast<int>(tab.buttons.size()));
+    for (int i = 0; i < static_cast<int>(tab.buttons.size()) && hdwp; ++i)
+    {
+        if (tab.buttons[i].hButton)
         {
-            wp.showCmd = SW_SHOWNORMAL; // Ensure window is shown normally on restore
-            SetWindowPlacement(hwnd, &wp);
+            RECT rc = GetButtonRect(rcPage, tab.buttonRows, tab.buttonCols, i);
+            hdwp = DeferWindowPos(hdwp, tab.buttons[i].hButton, NULL, rc.left, rc.top,
+                rc.right - rc.left, rc.bottom - rc.top, SWP_NOZORDER | SWP_NOACTIVATE);
         }
-        RegCloseKey(hKey);
     }
+    if (hdwp)
+    {
+        EndDeferWindowPos(hdwp);
+    }
+    tab.layoutArea = rcArea;
+}
+
+/**
+ * @brief Returns the part of the client area below the tab strip, where the buttons go.
+ * @param hwnd Handle to the main window.
+ */
+RECT GetButtonAreaRect(HWND hwnd)
+{
+    RECT rcArea;
+    GetClientRect(hwnd, &rcArea);
+    rcArea.top = (std::min)(static_cast<LONG>(g_tabStrip.GetPreferredHeight()), rcArea.bottom);
+    return rcArea;
 }
 
+/**
+ * @brief Computes the position of a button in the grid, as the replay of recorded
+ *        sessions does (see GetGridCell()).
+ * @param area The area covered by the grid.
+ * @param rows, cols The size of the grid.
+ * @param buttonIndex The index of the button, counted row by row.
+ * @return The button's rectangle. Cells have equal size; leftover pixels stay unused.
+ */
+RECT GetButtonRect(const RECT& area, int rows, int cols, int buttonIndex)
+{
+    GridRect gridArea = { static_cast<int>(area.left), static_cast<int>(area.top), static_cast<int>(area.right), static_cast<int>(area.bottom) };
+    GridRect cell = GetGridCell(gridArea, rows, cols, buttonIndex);
+    return { cell.left, cell.top, cell.right, cell.bottom };
+}
 
 // =============================================================
-//                        Core Application Logic
+//               Configuration (INI File) Handling
 // =============================================================
 
 /**
- * @brief Executes a process using ShellExecuteW, with fallback logic.
- * @param filePath Path to the executable or document.
- * @param parameters Command-line parameters.
- * @param asAdmin True to run the process with administrator privileges.
- * @return True on success, false on failure.
+ * @brief Writes the INI file for the configuration in use if it does not exist yet.
+ *
+ * A first run works from the built-in defaults, or from the shared catalog alone, without
+ * a file; it is created here before the first change is written to it. Runs on the
+ * executor, so the caller tells whether a catalog is in use.
+ * @param hasCatalog True to create an empty file of personal overrides of the catalog,
+ *        false to write the defaults.
+ * @return True if the file exists afterwards, false otherwise.
  */
-bool LaunchApplication(const std::wstring& filePath, const std::wstring& parameters, bool asAdmin)
+bool EnsureConfigFileExists(bool hasCatalog)
 {
-    std::wstring operation = asAdmin ? L"runas" : L"open";
+    if (PathFileExists(g_configFilePath.c_str()))
+    {
+        return true;
+    }
+    return hasCatalog ? GenerateOverlayConfigFile() : GenerateDefaultConfigFile();
+}
 
-    // Expand environment variables (e.g., %USERPROFILE%) before execution
-    std::wstring expandedPath = ExpandEnvironmentVariables(filePath);
-    std::wstring expandedParams = ExpandEnvironmentVariables(parameters);
+/**
+ * @brief Creates the INI file with default settings if it doesn't exist.
+ * @return True if the file was created successfully, false otherwise.
+ */
+bool GenerateDefaultConfigFile()
+{
+    return WriteUtf16LeFile(g_configFilePath.c_str(), GetDefaultConfigString());
+}
 
-    HINSTANCE result = ShellExecuteW(
-        NULL, operation.c_str(), expandedPath.c_str(),
-        expandedParams.empty() ? NULL : expandedParams.c_str(),
-        NULL, SW_SHOWNORMAL
-    );
+/**
+ * @brief Creates an empty INI file for personal changes when the tabs come from the shared catalog.
+ * @return True if the file was created successfully, false otherwise.
+ */
+bool GenerateOverlayConfigFile()
+{
+    return WriteUtf16LeFile(g_configFilePath.c_str(), L"; Personal overrides of the shared catalog\r\n");
+}
+
+/**
+ * @brief Determines the shared catalog snapshot to layer the INI file over.
+ *
+ * [Catalog] Snapshot= in the INI file names it, relative to the executable directory and
+ * with environment variables expanded. Without it, the machine-wide catalog in ProgramData
+ * is used if one was published.
+ * @return The path of the snapshot, or an empty string if there is none.
+ */
+std::wstring GetCatalogFilePath()
+{
+    wchar_t configured[MAX_PATH] = {};
+    GetPrivateProfileStringW(L"Catalog", L"Snapshot", L"", configured, MAX_PATH, g_configFilePath.c_str());
+    std::wstring path = ExpandEnvironmentVariables(configured);
+    trim(path);
+    if (!path.empty())
+    {
+        std::filesystem::path snapshotPath(path);
+        if (snapshotPath.is_relative())
+        {
+            snapshotPath = std::filesystem::path(g_executableDirectory) / snapshotPath;
+        }
+        return snapshotPath.lexically_normal().wstring();
+    }
+
+    std::wstring machineCatalog = ExpandEnvironmentVariables(L"%ProgramData%\\MultiTabLauncher\\MultiTabLauncher.catalog");
+    return PathFileExists(machineCatalog.c_str()) ? machineCatalog : std::wstring();
+}
 
-    if ((INT_PTR)result > 32)
+/**
+ * @brief Redirects a catalog on a network location to a local cache that is kept in sync
+ *        in the background, so that startup never waits for the share.
+ *
+ * The cache lives in %LOCALAPPDATA%, in a directory per source. [Catalog] SyncMinutes=
+ * sets the time between syncs; 0 maps the catalog on the share in place instead.
+ */
+void ConfigureCatalogSync()
+{
+    int syncMinutes = GetPrivateProfileIntW(L"Catalog", L"SyncMinutes", DEFAULT_CATALOG_SYNC_MINUTES, g_configFilePath.c_str());
+    if (g_catalogFilePath.empty() || syncMinutes <= 0 || !PathIsNetworkPathW(g_catalogFilePath.c_str()))
     {
-        return true; // Success
+        return;
     }
 
-    // If execution fails, try to find the executable's absolute path and retry
-    std::wstring absPath = ResolveExecutablePath(expandedPath.c_str());
-    if (!absPath.empty() && absPath != expandedPath)
+    std::wstring sourceKey = g_catalogFilePath;
+    CharLowerBuffW(sourceKey.data(), static_cast<DWORD>(sourceKey.length()));
+    std::string sourceKeyBytes;
+    AppendUtf8(sourceKey, sourceKeyBytes);
+
+    g_catalogSourcePath = g_catalogFilePath;
+    g_catalogCacheDirectory = ExpandEnvironmentVariables(L"%LOCALAPPDATA%\\MultiTabLauncher\\Catalog\\") +
+        DecodeUtf8(FormatChunkName(HashCatalogBytes(sourceKeyBytes)));
+    g_catalogFilePath = g_catalogCacheDirectory + L"\\MultiTabLauncher.catalog";
+    g_catalogSyncIntervalMs = static_cast<DWORD>((std::min)(syncMinutes, 24 * 60)) * 60 * 1000;
+}
+
+/**
+ * @brief Handles "/publish-catalog <source> <snapshot>": parses an INI or JSON file and
+ *        publishes it as the shared catalog snapshot, and as a pack of chunks in
+ *        "<snapshot>.pack" for launchers that sync it from a share.
+ * @return True on success, false on failure or missing arguments.
+ */
+bool PublishCatalog()
+{
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv) return false;
+
+    std::wstring sourcePath;
+    std::wstring snapshotPath;
+    for (int i = 1; i + 2 < argc; ++i)
     {
-        result = ShellExecuteW(
-            NULL, operation.c_str(), absPath.c_str(),
-            expandedParams.empty() ? NULL : expandedParams.c_str(),
-            NULL, SW_SHOWNORMAL
-        );
-        if ((INT_PTR)result > 32)
+        if (lstrcmpiW(argv[i], L"/publish-catalog") == 0)
         {
-            return true; // Success on retry
+            sourcePath = argv[i + 1];
+            snapshotPath = argv[i + 2];
+            break;
         }
     }
+    LocalFree(argv);
 
-    // Display a detailed error message on failure
-    std::wstring msg = L"ShellExecuteW failed.\n";
-    msg += L"File: " + filePath + L"\n";
-    msg += L"Error code: " + std::to_wstring((INT_PTR)result) + L"\n\n";
+    if (sourcePath.empty() || snapshotPath.empty() || !PathFileExists(sourcePath.c_str()))
+    {
+        return false;
+    }
 
-    switch ((INT_PTR)result)
+    // Snapshots are INI documents; a JSON catalog is published in the equivalent INI form
+    std::wstring text;
+    if (IsJsonPath(sourcePath))
     {
-    case 0: msg += L"The operating system is out of memory or resources."; break;
-    case ERROR_FILE_NOT_FOUND: msg += L"The specified file was not found."; break;
-    case ERROR_PATH_NOT_FOUND: msg += L"The specified path was not found."; break;
-    case ERROR_BAD_FORMAT: msg += L"The .exe file is invalid."; break;
+        LauncherConfig config;
+        if (!ReadConfigurationFile(sourcePath, config))
+        {
+            return false;
+        }
+        text = FormatLauncherConfig(config);
+    }
+    else
+    {
+        std::ifstream file(sourcePath, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        text = DecodeIniText(bytes);
+    }
+
+    std::string packText;
+    AppendUtf8(text, packText);
+    IniDocument document;
+    document.Parse(std::move(text));
+    return SharedCatalog::Publish(document, snapshotPath) && CatalogSync::PublishPack(packText, snapshotPath + L".pack");
+}
+
+/**
+ * @brief Handles "/convert <source> <target>": converts a configuration from JSON to INI
+ *        if the source ends in .json, and from INI to JSON otherwise.
+ * @return True on success, false on failure or missing arguments.
+ */
+bool ConvertConfiguration()
+{
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv) return false;
+
+    std::wstring sourcePath;
+    std::wstring targetPath;
+    for (int i = 1; i + 2 < argc; ++i)
+    {
+        if (lstrcmpiW(argv[i], L"/convert") == 0)
+        {
+            sourcePath = argv[i + 1];
+            targetPath = argv[i + 2];
+            break;
+        }
+    }
+    LocalFree(argv);
+
+    LauncherConfig config;
+    if (sourcePath.empty() || targetPath.empty() || !ReadConfigurationFile(sourcePath, config))
+    {
+        return false;
+    }
+    if (IsJsonPath(sourcePath))
+    {
+        return WriteUtf16LeFile(targetPath.c_str(), FormatLauncherConfig(config));
+    }
+    std::ofstream file(targetPath, std::ios::binary);
+    return file.is_open() && WriteLauncherConfigJson(config, file);
+}
+
+/**
+ * @brief Reads a configuration file on its own, without the shared catalog beneath it.
+ *        Files ending in .json are read as JSON and anything else as INI.
+ * @param filePath The file to read.
+ * @param config Receives the configuration.
+ * @return True on success, false if the file cannot be read or is not valid JSON.
+ */
+bool ReadConfigurationFile(const std::wstring& filePath, LauncherConfig& config)
+{
+    if (!PathFileExists(filePath.c_str()))
+    {
+        return false;
+    }
+    if (!IsJsonPath(filePath))
+    {
+        config = ParseLauncherConfig(IniDocument(), ReadIniFile(filePath));
+        return true;
+    }
+
+    std::ifstream file(filePath, std::ios::binary);
+    std::string error;
+    if (!file.is_open())
+    {
+        return false;
+    }
+    if (!ReadLauncherConfigJson(file, config, error))
+    {
+        ReportCommandLineError(filePath + L": " + DecodeUtf8(error));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks whether a file name ends in .json (case-insensitive).
+ */
+bool IsJsonPath(const std::wstring& filePath)
+{
+    return lstrcmpiW(PathFindExtensionW(filePath.c_str()), L".json") == 0;
+}
+
+/**
+ * @brief Writes an error of a headless command to the console it was started from, if any.
+ *        Without a console the exit code is the only report, so scripts never block.
+ */
+void ReportCommandLineError(const std::wstring& message)
+{
+    if (!AttachConsole(ATTACH_PARENT_PROCESS))
+    {
+        return;
+    }
+    HANDLE hConsole = CreateFileW(L"CONOUT$", GENERIC_WRITE, FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+    if (hConsole != INVALID_HANDLE_VALUE)
+    {
+        std::wstring line = L"\r\n" + message + L"\r\n";
+        DWORD written = 0;
+        WriteConsoleW(hConsole, line.c_str(), static_cast<DWORD>(line.length()), &written, NULL);
+        CloseHandle(hConsole);
+    }
+    FreeConsole();
+}
+
+/**
+ * @brief Reads and parses an INI file in one pass.
+ * @param filePath The path to the INI file.
+ * @return The parsed file; empty if the file cannot be read.
+ */
+IniDocument ReadIniFile(const std::wstring& filePath)
+{
+    IniDocument document;
+    std::ifstream file(filePath, std::ios::binary);
+    if (file.is_open())
+    {
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        document.Parse(DecodeIniText(bytes));
+    }
+    return document;
+}
+
+/**
+ * @brief Decodes the contents of an INI file: UTF-16 LE with a byte order mark, as the
+ *        launcher writes it, UTF-8 with a byte order mark, or otherwise the ANSI code page,
+ *        as the profile API assumes.
+ * @param bytes The raw file contents.
+ * @return The decoded text.
+ */
+std::wstring DecodeIniText(const std::string& bytes)
+{
+    size_t bomLength = 0;
+    TextEncoding encoding = DetectTextEncoding(bytes, bomLength);
+    std::string_view body = std::string_view(bytes).substr(bomLength);
+
+    if (encoding == TextEncoding::Utf16Le)
+    {
+        std::wstring text(body.size() / sizeof(wchar_t), L'\0');
+        memcpy(text.data(), body.data(), text.size() * sizeof(wchar_t));
+        return text;
+    }
+    if (encoding == TextEncoding::Utf8)
+    {
+        return DecodeUtf8(body);
+    }
+
+    // ASCII is the same in every ANSI code page
+    std::wstring text(body.size(), L'\0');
+    if (CountAsciiPrefix(body) == body.size())
+    {
+        WidenAscii(body, text.data());
+        return text;
+    }
+    int length = MultiByteToWideChar(CP_ACP, 0, body.data(), static_cast<int>(body.size()), text.data(), static_cast<int>(text.size()));
+    text.resize(length);
+    return text;
+}
+
+/**
+ * @brief Loads all configuration settings from the INI file.
+ */
+void LoadConfigurationFromFile()
+{
+    TRACE_SCOPE("LoadConfiguration");
+
+    if (!g_catalogFilePath.empty() && !g_sharedCatalog.Open(g_catalogFilePath) && !g_catalogSourcePath.empty() &&
+        CatalogUpdater::RestoreSnapshot(g_catalogCacheDirectory, g_catalogFilePath))
+    {
+        g_sharedCatalog.Open(g_catalogFilePath);
+    }
+
+    // Without an INI file the built-in defaults are used as they are; the file is only
+    // written by the first edit (see EnsureConfigFileExists)
+    LauncherConfig config;
+    if (PathFileExists(g_configFilePath.c_str()) || g_sharedCatalog.IsOpen())
+    {
+        config = ReadConfigurationModel(g_configFilePath);
+    }
+    else
+    {
+        config = GetDefaultLauncherConfig();
+    }
+    g_prefetchSettings = config.prefetch;
+    g_residentSettings = config.resident;
+    g_resourceSettings = config.resources;
+    g_isBrokerEnabled = config.elevation.broker;
+    g_programIndexSettings = config.programIndex;
+    if (config.diagnostics.trace && !Trace::IsEnabled())
+    {
+        // Only what follows is recorded; /trace also covers reading the configuration
+        Trace::SetEnabled(true);
+        Trace::SetThreadName("UI");
+    }
+
+    IniDocument usage = ReadIniFile(g_usageFilePath);
+    g_tabs.clear();
+    g_tabs.resize(config.GetTabCount());
+    for (int tab = 0; tab < config.GetTabCount(); tab++)
+    {
+        InitializeTab(g_tabs[tab], config.tabs[tab], usage, tab);
+    }
+}
+
+/**
+ * @brief Reads the complete configuration from an INI file without touching application state.
+ * @param filePath The path to the INI file, layered over the shared catalog if one is open.
+ * @return The configuration, with invalid values replaced by defaults.
+ */
+LauncherConfig ReadConfigurationModel(const std::wstring& filePath)
+{
+    TRACE_SCOPE("ReadConfigurationModel");
+    return ParseLauncherConfig(g_sharedCatalog.GetDocument(), ReadIniFile(filePath));
+}
+
+/**
+ * @brief Builds a configuration model from the currently displayed tabs and buttons.
+ */
+LauncherConfig CaptureCurrentConfiguration()
+{
+    LauncherConfig config;
+    config.tabs.resize(g_tabs.size());
+    for (size_t tab = 0; tab < g_tabs.size(); tab++)
+    {
+        TabConfig& tabConfig = config.tabs[tab];
+        tabConfig.name = g_tabs[tab].name;
+        tabConfig.buttonRows = g_tabs[tab].buttonRows;
+        tabConfig.buttonCols = g_tabs[tab].buttonCols;
+        tabConfig.buttons.assign(g_tabs[tab].buttons.begin(), g_tabs[tab].buttons.end());
+    }
+    return config;
+}
+
+/**
+ * @brief Re-reads the INI file and the shared catalog after either changed on disk and
+ *        applies only the differences.
+ * @param hwnd Handle to the main window.
+ */
+void ReloadConfigurationFromFile(HWND hwnd)
+{
+    TRACE_SCOPE("ReloadConfiguration");
+
+    // A synced catalog may arrive after startup, so the snapshot is opened even if it was not before
+    if (!g_catalogFilePath.empty())
+    {
+        g_sharedCatalog.Open(g_catalogFilePath); // Keeps the previous snapshot if the new one is not there yet
+    }
+
+    // Without a catalog, a missing file is deleted or in the middle of being replaced; keep
+    // the current state. Over a catalog it may simply not have been written yet.
+    if (!PathFileExists(g_configFilePath.c_str()) && !g_sharedCatalog.IsOpen())
+    {
+        return;
+    }
+
+    LauncherConfig config = ReadConfigurationModel(g_configFilePath);
+    g_prefetchSettings = config.prefetch;
+    g_resourceSettings = config.resources;
+    g_isBrokerEnabled = config.elevation.broker; // A running broker stays until exit
+    if (!(config.resident == g_residentSettings))
+    {
+        g_residentSettings = config.resident;
+        ApplyResidentSettings(hwnd);
+    }
+    if (!(config.programIndex == g_programIndexSettings))
+    {
+        g_programIndexSettings = config.programIndex;
+        g_programIndexer.Stop();
+        StartProgramIndexer();
+    }
+    ConfigDiff diff = DiffConfigs(CaptureCurrentConfiguration(), config);
+    if (!diff.IsEmpty())
+    {
+        ApplyConfigurationDiff(hwnd, config, diff);
+        ValidateButtonTargets();
+    }
+    EnforceResourceLimits(g_currentTab);
+}
+
+/**
+ * @brief Updates tabs, buttons and their windows to match a reloaded configuration.
+ * @param hwnd Handle to the main window.
+ * @param config The reloaded configuration.
+ * @param diff The differences between the current state and the reloaded configuration.
+ */
+void ApplyConfigurationDiff(HWND hwnd, const LauncherConfig& config, const ConfigDiff& diff)
+{
+    int commonTabs = (std::min)(diff.oldTabCount, diff.newTabCount);
+    IniDocument usage = ReadIniFile(g_usageFilePath);
+
+    // Buttons are keyed by position, so whatever takes the place of a removed button or
+    // target must not inherit its processes, timings and checks
+    for (const ButtonChange& change : diff.changedButtons)
+    {
+        if (change.pathChanged) ForgetButtonActivity({ change.tab, change.button });
+    }
+    for (ButtonKey key : diff.removedButtons)
+    {
+        ForgetButtonActivity(key);
+    }
+
+    // Hide the current tab while its buttons are being rearranged
+    ShowWindow(g_tabs[g_currentTab].hPage, SW_HIDE);
+
+    // Remove tabs that no longer exist
+    for (int tab = diff.oldTabCount - 1; tab >= diff.newTabCount; --tab)
+    {
+        DestroyTabPage(tab);
+        g_tabStrip.DeleteTab(tab);
+    }
+    g_tabs.resize(commonTabs);
+
+    // Grow or shrink the button grid of tabs whose size changed
+    for (int tab : diff.resizedTabs)
+    {
+        TabInfo& tabInfo = g_tabs[tab];
+        const TabConfig& tabConfig = config.tabs[tab];
+        int oldButtonCount = static_cast<int>(tabInfo.buttons.size());
+        int newButtonCount = tabConfig.GetButtonCount();
+        const IniDocument::Section* usageSection = usage.FindSection(L"Tab" + std::to_wstring(tab));
+
+        for (int btn = newButtonCount; btn < oldButtonCount; ++btn)
+        {
+            DestroyButton(tabInfo.buttons[btn]);
+        }
+        tabInfo.buttons.resize(newButtonCount);
+        tabInfo.buttonRows = tabConfig.buttonRows;
+        tabInfo.buttonCols = tabConfig.buttonCols;
+        for (int btn = oldButtonCount; btn < newButtonCount; ++btn)
+        {
+            InitializeButton(tabInfo.buttons[btn], tabConfig.buttons[btn], usage, usageSection, btn);
+            if (tabInfo.hPage)
+            {
+                ReloadButtonIcon(tab, btn);
+                CreateButtonWindow(tabInfo.hPage, tab, btn, 0, 0, 0, 0);
+            }
+        }
+        tabInfo.layoutArea = {}; // Lay out again when the tab is shown
+    }
+
+    // Rename tabs
+    for (int tab : diff.renamedTabs)
+    {
+        g_tabs[tab].name = config.tabs[tab].name;
+        g_tabStrip.SetTabName(tab, g_tabs[tab].name);
+    }
+
+    // Update changed buttons, extracting icons only where the path changed
+    for (const ButtonChange& change : diff.changedButtons)
+    {
+        ButtonInfo& info = g_tabs[change.tab].buttons[change.button];
+        static_cast<ButtonConfig&>(info) = config.tabs[change.tab].buttons[change.button];
+        if (change.pathChanged)
+        {
+            info.targetState = TargetState::Unknown;
+        }
+        if (!g_tabs[change.tab].hPage)
+        {
+            continue;
+        }
+        SetWindowTextW(info.hButton, info.name.c_str());
+        if (change.pathChanged)
+        {
+            ReloadButtonIcon(change.tab, change.button);
+        }
+        InvalidateRect(info.hButton, NULL, TRUE);
+    }
+
+    // Add new tabs; their pages are created when they are first shown
+    for (int tab = diff.oldTabCount; tab < diff.newTabCount; ++tab)
+    {
+        g_tabs.emplace_back();
+        InitializeTab(g_tabs[tab], config.tabs[tab], usage, tab);
+        g_tabStrip.InsertTab(tab, g_tabs[tab].name);
+    }
+
+    // Show the selected tab again, falling back to the last one if it was removed
+    if (g_currentTab >= GetTabCount())
+    {
+        g_currentTab = GetTabCount() - 1;
+    }
+    g_tabStrip.SetCurSel(g_currentTab);
+    EnsureTabPageCreated(hwnd, g_currentTab);
+    LayoutTabPage(hwnd, g_currentTab);
+    ShowTabPage(NULL, g_tabs[g_currentTab].hPage);
+}
+
+/**
+ * @brief Stops tracking the processes, launch timings and target checks of a button whose
+ *        target changed or that was removed.
+ */
+void ForgetButtonActivity(ButtonKey key)
+{
+    g_processTracker.Forget(key);
+    g_launchTimer.Forget(key);
+    g_targetValidator.Forget(key);
+}
+
+/**
+ * @brief Saves the information for a single button to the INI file, which must exist
+ *        (see EnsureConfigFileExists).
+ * @param tabIndex The tab index of the button.
+ * @param buttonIndex The index of the button within the tab.
+ * @param info The settings of the button to save.
+ * @return True on success, false on failure.
+ */
+bool SaveButtonConfigurationToFile(int tabIndex, int buttonIndex, const ButtonConfig& info)
+{
+    std::wstring section = L"Tab" + std::to_wstring(tabIndex);
+    std::wstring btnKey = L"Button" + std::to_wstring(buttonIndex);
+
+    BOOL ok = TRUE;
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Name").c_str(), info.name.c_str(), g_configFilePath.c_str());
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Path").c_str(), info.path.c_str(), g_configFilePath.c_str());
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Params").c_str(), info.parameters.c_str(), g_configFilePath.c_str());
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Admin").c_str(), info.adminMode ? L"1" : L"0", g_configFilePath.c_str());
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_SingleInstance").c_str(), info.singleInstance ? L"1" : L"0", g_configFilePath.c_str());
+    // The prefetch list is only edited in the INI file; omit the key when it is empty
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Prefetch").c_str(),
+        info.prefetchFiles.empty() ? NULL : info.prefetchFiles.c_str(), g_configFilePath.c_str());
+
+    // So is the launch profile; only the settings that differ from the defaults are written
+    const LaunchProfile& profile = info.profile;
+    std::wstring affinity = FormatAffinityMask(profile.affinityMask);
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_WorkDir").c_str(),
+        profile.workingDirectory.empty() ? NULL : profile.workingDirectory.c_str(), g_configFilePath.c_str());
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Env").c_str(),
+        profile.environment.empty() ? NULL : profile.environment.c_str(), g_configFilePath.c_str());
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Priority").c_str(),
+        profile.priority == LaunchPriority::Normal ? NULL : GetLaunchPriorityName(profile.priority), g_configFilePath.c_str());
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_Affinity").c_str(),
+        affinity.empty() ? NULL : affinity.c_str(), g_configFilePath.c_str());
+    ok &= WritePrivateProfileStringW(section.c_str(), (btnKey + L"_LowIo").c_str(),
+        profile.lowIoPriority ? L"1" : NULL, g_configFilePath.c_str());
+
+    return ok != 0;
+}
+
+/**
+ * @brief Writes a button edit to the INI file on the executor.
+ *
+ * The edit is already in g_tabs, so the UI does not wait for the file; on a first run
+ * that includes writing the whole default configuration. Edits are written in the order
+ * they were made, by one task at a time, and the configuration is not reloaded until
+ * they are all written.
+ * @param tabIndex The tab index of the button.
+ * @param buttonIndex The index of the button within the tab.
+ * @param info The settings of the button to save.
+ */
+void QueueButtonConfigurationSave(int tabIndex, int buttonIndex, const ButtonConfig& info)
+{
+    PendingButtonSave save;
+    save.key = { tabIndex, buttonIndex };
+    save.config = info;
+    // A synced catalog may not have arrived yet; defaults written now would hide it later
+    save.hasCatalog = g_sharedCatalog.IsOpen() || !g_catalogSourcePath.empty();
+
+    {
+        std::lock_guard<std::mutex> lock(g_pendingSavesMutex);
+        g_pendingSaves.push_back(std::move(save));
+        if (g_isSaveTaskQueued)
+        {
+            return; // The queued task writes this one too
+        }
+        g_isSaveTaskQueued = true;
+    }
+    if (!g_taskExecutor.Submit(TaskPriority::Interactive, []() { WritePendingButtonSaves(); }))
+    {
+        WritePendingButtonSaves();
+    }
+}
+
+/**
+ * @brief Writes the queued button edits to the INI file until none are left. Runs on the
+ *        executor, and on the UI thread at exit once the executor has stopped.
+ */
+void WritePendingButtonSaves()
+{
+    bool isFailureReported = false;
+    for (;;)
+    {
+        PendingButtonSave save;
+        {
+            std::lock_guard<std::mutex> lock(g_pendingSavesMutex);
+            if (g_pendingSaves.empty())
+            {
+                g_isSaveTaskQueued = false;
+                return;
+            }
+            save = std::move(g_pendingSaves.front());
+            g_pendingSaves.pop_front();
+        }
+
+        bool isSaved = EnsureConfigFileExists(save.hasCatalog) &&
+            SaveButtonConfigurationToFile(save.key.tab, save.key.button, save.config);
+        if (!isSaved && !isFailureReported)
+        {
+            isFailureReported = true;
+            g_completionQueue.Push([]()
+                {
+                    MessageBox(g_hMainWindow, L"Failed to save the button settings to MultiTabLauncher.ini.", L"Error", MB_OK | MB_ICONERROR);
+                });
+        }
+    }
+}
+
+/**
+ * @brief Tests whether button edits are still waiting to be written or being written.
+ */
+bool HasPendingButtonSaves()
+{
+    std::lock_guard<std::mutex> lock(g_pendingSavesMutex);
+    return g_isSaveTaskQueued;
+}
+
+/**
+ * @brief Returns the usage file key holding a button's launch count.
+ * @param buttonIndex The index of the button within its tab.
+ */
+std::wstring GetLaunchCountKey(int buttonIndex)
+{
+    return L"Button" + std::to_wstring(buttonIndex) + L"_Launches";
+}
+
+/**
+ * @brief Records a button's launch count in the usage file.
+ *        Usage is kept out of the INI so it does not trigger a configuration reload.
+ * @param tabIndex The tab index of the button.
+ * @param buttonIndex The index of the button within the tab.
+ * @param launchCount The number of launches to store.
+ */
+void SaveLaunchCount(int tabIndex, int buttonIndex, unsigned int launchCount)
+{
+    std::wstring section = L"Tab" + std::to_wstring(tabIndex);
+    WritePrivateProfileStringW(section.c_str(), GetLaunchCountKey(buttonIndex).c_str(), std::to_wstring(launchCount).c_str(), g_usageFilePath.c_str());
+}
+
+/**
+ * @brief Returns the usage file key holding a button's latency histogram for a launch phase.
+ * @param buttonIndex The index of the button within its tab.
+ * @param phase The launch phase.
+ */
+std::wstring GetLaunchLatencyKey(int buttonIndex, LaunchPhase phase)
+{
+    static const wchar_t* const suffixes[LAUNCH_PHASE_COUNT] = { L"_SpawnLatency", L"_StartLatency", L"_WindowLatency" };
+    return L"Button" + std::to_wstring(buttonIndex) + suffixes[static_cast<int>(phase)];
+}
+
+/**
+ * @brief Records a button's launch latency histograms in the usage file.
+ * @param tabIndex The tab index of the button.
+ * @param buttonIndex The index of the button within the tab.
+ * @param info The button.
+ */
+void SaveLaunchLatency(int tabIndex, int buttonIndex, const ButtonInfo& info)
+{
+    std::wstring section = L"Tab" + std::to_wstring(tabIndex);
+    for (int phase = 0; phase < LAUNCH_PHASE_COUNT; ++phase)
+    {
+        const LatencyHistogram& histogram = info.launchLatency[phase];
+        if (histogram.IsEmpty()) continue;
+        WritePrivateProfileStringW(section.c_str(), GetLaunchLatencyKey(buttonIndex, static_cast<LaunchPhase>(phase)).c_str(),
+            histogram.Serialize().c_str(), g_usageFilePath.c_str());
+    }
+}
+
+// =============================================================
+//                   Window State Persistence
+// =============================================================
+
+/**
+ * @brief Saves the main window's position and size to the registry.
+ * @param hwnd Handle to the main window.
+ */
+void SaveWindowPosition(HWND hwnd)
+{
+    WINDOWPLACEMENT wp = { sizeof(WINDOWPLACEMENT) };
+    if (GetWindowPlacement(hwnd, &wp))
+    {
+        HKEY hKey;
+        if (RegCreateKeyEx(HKEY_CURRENT_USER, L"Software\\MultiTabLauncher", 0, NULL, 0, KEY_WRITE, NULL, &hKey, NULL) == ERROR_SUCCESS)
+        {
+            RegSetValueEx(hKey, L"Placement", 0, REG_BINARY, (BYTE*)&wp, sizeof(wp));
+            RegCloseKey(hKey);
+        }
+    }
+}
+
+/**
+ * @brief Loads the main window's position and size from the registry.
+ * @param hwnd Handle to the main window.
+ */
+void RestoreWindowPosition(HWND hwnd)
+{
+    WINDOWPLACEMENT wp = { sizeof(WINDOWPLACEMENT) };
+    HKEY hKey;
+    DWORD size = sizeof(wp);
+    if (RegOpenKeyEx(HKEY_CURRENT_USER, L"Software\\MultiTabLauncher", 0, KEY_READ, &hKey) == ERROR_SUCCESS)
+    {
+        if (RegQueryValueEx(hKey, L"Placement", NULL, NULL, (LPBYTE)&wp, &size) == ERROR_SUCCESS)
+        {
+            // Ensure window is shown normally on restore; a launcher starting in the tray stays hidden
+            wp.showCmd = g_isResidentHidden ? SW_HIDE : SW_SHOWNORMAL;
+            SetWindowPlacement(hwnd, &wp);
+        }
+        RegCloseKey(hKey);
+    }
+}
+
+
+// =============================================================
+//                          Resident Mode
+// =============================================================
+
+/**
+ * @brief Adds or removes the notification area icon and the hotkey to match g_residentSettings.
+ * @param hwnd Handle to the main window.
+ */
+void ApplyResidentSettings(HWND hwnd)
+{
+    UnregisterHotKey(hwnd, SHOW_HOTKEY_ID);
+    if (!g_residentSettings.enabled)
+    {
+        if (g_isResidentHidden)
+        {
+            ShowResidentWindow(hwnd);
+        }
+        g_trayIcon.Remove();
+        return;
+    }
+
+    if (!g_hTrayIcon)
+    {
+        g_hTrayIcon = (HICON)LoadImageW(GetModuleHandle(NULL), MAKEINTRESOURCE(IDI_APPICON), IMAGE_ICON,
+            GetSystemMetrics(SM_CXSMICON), GetSystemMetrics(SM_CYSMICON), 0);
+    }
+    g_trayIcon.Add(hwnd, WM_APP_TRAYICON, g_hTrayIcon, L"MultiTab Launcher");
+
+    UINT modifiers = 0;
+    UINT virtualKey = 0;
+    if (!ParseHotkey(g_residentSettings.hotkey, modifiers, virtualKey) ||
+        !RegisterHotKey(hwnd, SHOW_HOTKEY_ID, modifiers | MOD_NOREPEAT, virtualKey))
+    {
+        std::wstring msg = L"The hotkey \"" + g_residentSettings.hotkey + L"\" is invalid or used by another program.\n"
+            L"The launcher can still be opened from the notification area.";
+        MessageBoxW(hwnd, msg.c_str(), L"MultiTab Launcher", MB_OK | MB_ICONWARNING);
+    }
+}
+
+/**
+ * @brief Hides the main window to the notification area.
+ *
+ * The window is cloaked rather than hidden where DWM supports it: it stays visible to
+ * the window manager, so its contents are kept and it reappears without repainting.
+ * @param hwnd Handle to the main window.
+ * @param returnFocus True to activate the window that was active before the launcher
+ *                    was shown; false when a launched program is about to take the foreground.
+ */
+void HideResidentWindow(HWND hwnd, bool returnFocus)
+{
+    if (g_isResidentHidden)
+    {
+        return;
+    }
+    TRACE_SCOPE("HideResidentWindow");
+
+    g_isResidentHidden = true;
+    g_isWindowCloaked = !IsIconic(hwnd) && SetWindowCloaked(hwnd, true);
+    if (!g_isWindowCloaked)
+    {
+        ShowWindow(hwnd, SW_HIDE);
+    }
+    else if (returnFocus && GetForegroundWindow() == hwnd && g_hReturnFocusWindow && IsWindow(g_hReturnFocusWindow))
+    {
+        SetForegroundWindow(g_hReturnFocusWindow);
+    }
+    g_hReturnFocusWindow = NULL;
+    TrimResidentMemory();
+}
+
+/**
+ * @brief Shows the main window from the notification area and activates it.
+ *        The time until DWM has composed the first frame is traced as "ShowToFirstFrame".
+ * @param hwnd Handle to the main window.
+ */
+void ShowResidentWindow(HWND hwnd)
+{
+    uint64_t start = Trace::NowMicroseconds();
+
+    HWND hForeground = GetForegroundWindow();
+    if (hForeground != hwnd)
+    {
+        g_hReturnFocusWindow = hForeground;
+    }
+
+    if (g_isWindowCloaked)
+    {
+        SetWindowCloaked(hwnd, false);
+        g_isWindowCloaked = false;
+    }
+    else if (!IsWindowVisible(hwnd) || IsIconic(hwnd))
+    {
+        ShowWindow(hwnd, IsIconic(hwnd) ? SW_RESTORE : SW_SHOW);
+    }
+    g_isResidentHidden = false;
+    SetForegroundWindow(hwnd);
+
+    if (Trace::IsEnabled())
+    {
+        // Pages other than the current one were released while hidden and are created on the next visit
+        UpdateWindow(hwnd);
+        DwmFlush();
+        Trace::RecordSpan("ShowToFirstFrame", start, Trace::NowMicroseconds() - start);
+    }
+}
+
+/**
+ * @brief Shows the context menu of the notification area icon.
+ * @param hwnd Handle to the main window.
+ */
+void ShowTrayMenu(HWND hwnd)
+{
+    const UINT IDM_TRAY_SHOW = 1;
+    const UINT IDM_TRAY_EXIT = 2;
+
+    HMENU hMenu = CreatePopupMenu();
+    if (!hMenu)
+    {
+        return;
+    }
+    AppendMenuW(hMenu, MF_STRING, IDM_TRAY_SHOW, L"Show");
+    AppendMenuW(hMenu, MF_SEPARATOR, 0, NULL);
+    AppendMenuW(hMenu, MF_STRING, IDM_TRAY_EXIT, L"Exit");
+    SetMenuDefaultItem(hMenu, IDM_TRAY_SHOW, FALSE);
+
+    // The menu only closes on a click elsewhere if its owner is the foreground window
+    POINT pt;
+    GetCursorPos(&pt);
+    SetForegroundWindow(hwnd);
+    UINT command = TrackPopupMenu(hMenu, TPM_RETURNCMD | TPM_RIGHTBUTTON | TPM_NONOTIFY, pt.x, pt.y, 0, hwnd, NULL);
+    PostMessage(hwnd, WM_NULL, 0, 0);
+    DestroyMenu(hMenu);
+
+    if (command == IDM_TRAY_SHOW)
+    {
+        ShowResidentWindow(hwnd);
+    }
+    else if (command == IDM_TRAY_EXIT)
+    {
+        g_isExiting = true;
+        DestroyWindow(hwnd);
+    }
+}
+
+/**
+ * @brief Releases memory that is not needed while the launcher is hidden. Pages of tabs
+ *        other than the current one are destroyed and recreated when visited, scaled icons
+ *        are extracted again, and the rest of the working set faults back in on use.
+ */
+void TrimResidentMemory()
+{
+    TRACE_SCOPE("TrimResidentMemory");
+
+    for (int tab = 0; tab < GetTabCount(); ++tab)
+    {
+        if (tab != g_currentTab && g_tabs[tab].hPage)
+        {
+            DestroyTabPage(tab);
+        }
+    }
+    TrimWorkingSet();
+    g_isWorkingSetTrimmed = true;
+}
+
+/**
+ * @brief Cloaks or uncloaks a window with DWM (Windows 8 and later).
+ * @return True on success, false if cloaking is not supported.
+ */
+bool SetWindowCloaked(HWND hwnd, bool cloaked)
+{
+    BOOL value = cloaked ? TRUE : FALSE;
+    return SUCCEEDED(DwmSetWindowAttribute(hwnd, DWMWA_CLOAK, &value, sizeof(value)));
+}
+
+/**
+ * @brief Parses a hotkey such as "Ctrl+Alt+Space" or "Win+Shift+F12".
+ *        Keys are a letter, a digit, F1 to F24 or one of Space, Tab, Insert, Delete,
+ *        Home, End, PageUp, PageDown and Pause.
+ * @param text The hotkey; names are case-insensitive.
+ * @param modifiers Receives the MOD_ flags.
+ * @param virtualKey Receives the virtual-key code.
+ * @return True if the hotkey is valid, false otherwise.
+ */
+bool ParseHotkey(const std::wstring& text, UINT& modifiers, UINT& virtualKey)
+{
+    static const struct
+    {
+        const wchar_t* name;
+        UINT virtualKey;
+    } namedKeys[] = {
+        { L"Space", VK_SPACE }, { L"Tab", VK_TAB }, { L"Insert", VK_INSERT }, { L"Delete", VK_DELETE },
+        { L"Home", VK_HOME }, { L"End", VK_END }, { L"PageUp", VK_PRIOR }, { L"PageDown", VK_NEXT },
+        { L"Pause", VK_PAUSE },
+    };
+
+    modifiers = 0;
+    virtualKey = 0;
+    size_t start = 0;
+    while (start <= text.length())
+    {
+        size_t end = text.find(L'+', start);
+        if (end == std::wstring::npos) end = text.length();
+        std::wstring part = text.substr(start, end - start);
+        trim(part);
+        start = end + 1;
+
+        if (virtualKey != 0 || part.empty())
+        {
+            return false; // The key must come last, once
+        }
+        if (lstrcmpiW(part.c_str(), L"Ctrl") == 0 || lstrcmpiW(part.c_str(), L"Control") == 0) modifiers |= MOD_CONTROL;
+        else if (lstrcmpiW(part.c_str(), L"Alt") == 0) modifiers |= MOD_ALT;
+        else if (lstrcmpiW(part.c_str(), L"Shift") == 0) modifiers |= MOD_SHIFT;
+        else if (lstrcmpiW(part.c_str(), L"Win") == 0) modifiers |= MOD_WIN;
+        else if (part.length() == 1 && std::iswalnum(part[0]) && part[0] < 0x80)
+        {
+            virtualKey = std::towupper(part[0]);
+        }
+        else if (part.length() >= 2 && std::towupper(part[0]) == L'F' && std::all_of(part.begin() + 1, part.end(), iswdigit))
+        {
+            int number = _wtoi(part.c_str() + 1);
+            if (number < 1 || number > 24) return false;
+            virtualKey = VK_F1 + number - 1;
+        }
+        else
+        {
+            for (const auto& key : namedKeys)
+            {
+                if (lstrcmpiW(part.c_str(), key.name) == 0) virtualKey = key.virtualKey;
+            }
+            if (virtualKey == 0) return false;
+        }
+    }
+    return virtualKey != 0;
+}
+
+/**
+ * @brief Asks a launcher already running in this session to show itself if it is resident.
+ * @return True if a resident launcher was shown and this instance should exit.
+ */
+bool SummonRunningInstance()
+{
+    HWND hExisting = FindWindowW(g_windowClassName, NULL);
+    if (!hExisting)
+    {
+        return false;
+    }
+
+    // Let the running launcher take the foreground, which this process was given by the user
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hExisting, &processId);
+    AllowSetForegroundWindow(processId);
+
+    DWORD_PTR result = FALSE;
+    return SendMessageTimeoutW(hExisting, WM_APP_SUMMON, 0, 0, SMTO_ABORTIFHUNG, 2000, &result) && result;
+}
+
+// =============================================================
+//                         Resource Budget
+// =============================================================
+
+/**
+ * @brief Records that the launcher was just used, which restarts the idle timeout.
+ */
+void NoteLauncherActivity()
+{
+    g_lastActivityTick = GetTickCount64();
+    g_isWorkingSetTrimmed = false;
+}
+
+/**
+ * @brief Describes the icons and windows held by each tab page that is loaded.
+ */
+std::vector<PageUsage> CollectPageUsage()
+{
+    std::vector<PageUsage> pages;
+    for (int tab = 0; tab < GetTabCount(); ++tab)
+    {
+        const TabInfo& tabInfo = g_tabs[tab];
+        if (!tabInfo.hPage) continue;
+
+        PageUsage page;
+        page.tab = tab;
+        page.windows = 1;
+        page.lastVisit = tabInfo.lastVisitTick;
+        for (const ButtonInfo& info : tabInfo.buttons)
+        {
+            if (info.hIcon && info.hIcon != g_hDefaultIcon) ++page.icons;
+            if (info.hButton) ++page.windows;
+        }
+        pages.push_back(page);
+    }
+    return pages;
+}
+
+/**
+ * @brief Destroys the pages of the given tabs; they are created again when visited.
+ */
+void ReleaseTabPages(const std::vector<int>& tabs)
+{
+    for (int tab : tabs)
+    {
+        DestroyTabPage(tab);
+    }
+    TRACE_COUNTER("LiveIcons", g_resourceAccountant.GetTotal(ResourceKind::Icons));
+    TRACE_COUNTER("LiveWindows", g_resourceAccountant.GetTotal(ResourceKind::Windows));
+}
+
+/**
+ * @brief Releases the pages of the least recently visited tabs while more icons or
+ *        windows are live than [Resources] allows.
+ * @param pinnedTab The tab that must keep its page, normally the one being shown.
+ */
+void EnforceResourceLimits(int pinnedTab)
+{
+    ResourceLimits limits;
+    limits.maxIcons = g_resourceSettings.maxIcons;
+    limits.maxWindows = g_resourceSettings.maxWindows;
+    ReleaseTabPages(ResourceAccountant::SelectPagesOverLimits(CollectPageUsage(), limits,
+        g_resourceAccountant.GetTotal(ResourceKind::Icons), g_resourceAccountant.GetTotal(ResourceKind::Windows), pinnedTab));
+}
+
+/**
+ * @brief Releases the pages of tabs not visited within the idle timeout, and trims the
+ *        working set once the launcher itself has not been used for that long.
+ * @param hwnd Handle to the main window.
+ */
+void TrimIdleResources(HWND hwnd)
+{
+    // The settings dialog holds a pointer into g_tabs
+    if (g_resourceSettings.idleTrimMinutes <= 0 || g_isEditingButton)
+    {
+        return;
+    }
+    TRACE_SCOPE("TrimIdleResources");
+
+    ULONGLONG now = GetTickCount64();
+    ULONGLONG maxIdle = static_cast<ULONGLONG>(g_resourceSettings.idleTrimMinutes) * 60 * 1000;
+    ReleaseTabPages(ResourceAccountant::SelectIdlePages(CollectPageUsage(), now, maxIdle, g_currentTab));
+
+    if (!g_isWorkingSetTrimmed && now - g_lastActivityTick >= maxIdle && GetForegroundWindow() != hwnd)
+    {
+        TrimWorkingSet();
+        g_isWorkingSetTrimmed = true;
+    }
+}
+
+/**
+ * @brief Drops the scaled icons, compacts the heap and lets Windows page out the rest of
+ *        the working set, which faults back in on use.
+ */
+void TrimWorkingSet()
+{
+    TRACE_SCOPE("TrimWorkingSet");
+
+    g_iconCache.Clear();
+    HeapCompact(GetProcessHeap(), 0);
+    SetProcessWorkingSetSize(GetCurrentProcess(), (SIZE_T)-1, (SIZE_T)-1);
+}
+
+/**
+ * @brief Sets the counters that are not tracked as resources come and go: the theme's
+ *        GDI objects, the tab strip and tray icon, the icon cache and the configuration.
+ */
+void UpdateResourceGauges()
+{
+    const HGDIOBJ themeObjects[] = {
+        g_hBackgroundBrush, g_hTabBrush, g_hButtonBrush, g_hBorderPen, g_hTabFont,
+        g_hButtonFont, g_hRunningBrush, g_hMissingBrush, g_hUnreachableBrush, g_hAccentBrush,
+    };
+    int64_t themeObjectCount = 0;
+    for (HGDIOBJ hObject : themeObjects)
+    {
+        if (hObject) ++themeObjectCount;
+    }
+    g_resourceAccountant.Set(ResourceOwner::Theme, ResourceKind::GdiObjects, themeObjectCount);
+    g_resourceAccountant.Set(ResourceOwner::TabStrip, ResourceKind::Windows, g_tabStrip.GetHandle() ? 1 : 0);
+    g_resourceAccountant.Set(ResourceOwner::Tray, ResourceKind::Icons, g_hTrayIcon ? 1 : 0);
+    g_resourceAccountant.Set(ResourceOwner::IconCache, ResourceKind::HeapBytes, static_cast<int64_t>(g_iconCache.GetByteSize()));
+
+    // An estimate: the structures and the strings they own
+    auto stringBytes = [](const std::wstring& text) { return static_cast<int64_t>(text.capacity() * sizeof(wchar_t)); };
+    int64_t configurationBytes = static_cast<int64_t>(g_tabs.capacity() * sizeof(TabInfo));
+    for (const TabInfo& tab : g_tabs)
+    {
+        configurationBytes += stringBytes(tab.name) + static_cast<int64_t>(tab.buttons.capacity() * sizeof(ButtonInfo));
+        for (const ButtonInfo& info : tab.buttons)
+        {
+            configurationBytes += stringBytes(info.name) + stringBytes(info.path) + stringBytes(info.parameters) +
+                stringBytes(info.prefetchFiles) + stringBytes(info.profile.workingDirectory) +
+                stringBytes(info.profile.environment) + stringBytes(info.environmentBlock) + stringBytes(info.environmentBlockSource);
+        }
+    }
+    g_resourceAccountant.Set(ResourceOwner::Configuration, ResourceKind::HeapBytes, configurationBytes);
+}
+
+
+// =============================================================
+//                        Core Application Logic
+// =============================================================
+
+/**
+ * @brief Executes a process using ShellExecuteExW, with fallback logic.
+ *
+ * Programs with a launch profile are started with CreateProcessW instead, so that their
+ * environment, priority, affinity and I/O priority are in place before they run. Documents,
+ * folders and programs run as administrator still go through the shell; their profile is
+ * applied once the process has started, and environment overrides do not apply to them.
+ * @param filePath Path to the executable or document.
+ * @param parameters Command-line parameters.
+ * @param asAdmin True to run the process with administrator privileges.
+ * @param profile The launch profile of the button.
+ * @param environmentBlock The environment of the program, or NULL for the launcher's own.
+ * @param phProcess Receives the handle of the started process, or NULL if the shell
+ *                  did not start a new process (e.g., a document opened in a running instance).
+ * @return True on success, false on failure.
+ */
+bool LaunchApplication(const std::wstring& filePath, const std::wstring& parameters, bool asAdmin,
+    const LaunchProfile& profile, const wchar_t* environmentBlock, HANDLE* phProcess)
+{
+    DWORD errorCode = 0;
+    if (StartApplication(filePath, parameters, asAdmin, profile, environmentBlock, phProcess, &errorCode))
+    {
+        return true;
+    }
+    ShowLaunchError(filePath, errorCode);
+    return false;
+}
+
+/**
+ * @brief Starts a process as LaunchApplication() does, without reporting failures. The
+ *        elevation broker starts its programs with it.
+ * @param pErrorCode Receives the shell's error code on failure, as shown by ShowLaunchError().
+ * @return True on success, false on failure.
+ */
+bool StartApplication(const std::wstring& filePath, const std::wstring& parameters, bool asAdmin,
+    const LaunchProfile& profile, const wchar_t* environmentBlock, HANDLE* phProcess, DWORD* pErrorCode)
+{
+    TRACE_SCOPE("LaunchApplication");
+    std::wstring operation = asAdmin ? L"runas" : L"open";
+    *phProcess = NULL;
+    *pErrorCode = 0;
+
+    // Expand environment variables (e.g., %USERPROFILE%) before execution
+    std::wstring expandedPath = ExpandEnvironmentVariables(filePath);
+    std::wstring expandedParams = ExpandEnvironmentVariables(parameters);
+
+    // The working directory is passed to the new process rather than set on the launcher
+    std::wstring workingDirectory = g_executableDirectory;
+    if (!profile.workingDirectory.empty())
+    {
+        workingDirectory = (std::filesystem::path(g_executableDirectory) / ExpandEnvironmentVariables(profile.workingDirectory)).wstring();
+    }
+
+    if (!asAdmin && !profile.IsDefault())
+    {
+        std::wstring executablePath = ResolveExecutablePath(expandedPath.c_str());
+        std::wstring extension = std::filesystem::path(executablePath).extension().wstring();
+        bool isProgram = lstrcmpiW(extension.c_str(), L".exe") == 0 || lstrcmpiW(extension.c_str(), L".com") == 0;
+        // Programs that need elevation fail here and are left to the shell
+        if (isProgram && CreateProcessWithProfile(executablePath, expandedParams, workingDirectory, profile, environmentBlock, phProcess))
+        {
+            return true;
+        }
+    }
+
+    SHELLEXECUTEINFOW sei = { sizeof(sei) };
+    sei.fMask = SEE_MASK_NOCLOSEPROCESS;
+    sei.lpVerb = operation.c_str();
+    sei.lpFile = expandedPath.c_str();
+    sei.lpParameters = expandedParams.empty() ? NULL : expandedParams.c_str();
+    sei.lpDirectory = workingDirectory.c_str();
+    sei.nShow = SW_SHOWNORMAL;
+
+    bool launched = ShellExecuteExW(&sei) != FALSE;
+    if (!launched)
+    {
+        // If execution fails, try to find the executable's absolute path and retry
+        std::wstring absPath = ResolveExecutablePath(expandedPath.c_str());
+        if (!absPath.empty() && absPath != expandedPath)
+        {
+            sei.lpFile = absPath.c_str();
+            launched = ShellExecuteExW(&sei) != FALSE;
+        }
+    }
+    if (launched)
+    {
+        *phProcess = sei.hProcess;
+        if (sei.hProcess && !profile.IsDefault())
+        {
+            ApplyLaunchProfile(sei.hProcess, profile, true);
+        }
+        return true;
+    }
+    *pErrorCode = static_cast<DWORD>(reinterpret_cast<INT_PTR>(sei.hInstApp));
+    return false;
+}
+
+/**
+ * @brief Displays a detailed error message for a launch that failed.
+ * @param filePath Path to the executable or document, as configured.
+ * @param errorCode The shell's error code.
+ */
+void ShowLaunchError(const std::wstring& filePath, DWORD errorCode)
+{
+    std::wstring msg = L"ShellExecuteW failed.\n";
+    msg += L"File: " + filePath + L"\n";
+    msg += L"Error code: " + std::to_wstring(errorCode) + L"\n\n";
+
+    switch (errorCode)
+    {
+    case 0: msg += L"The operating system is out of memory or resources."; break;
+    case ERROR_FILE_NOT_FOUND: msg += L"The specified file was not found."; break;
+    case ERROR_PATH_NOT_FOUND: msg += L"The specified path was not found."; break;
+    case ERROR_BAD_FORMAT: msg += L"The .exe file is invalid."; break;
     case SE_ERR_ACCESSDENIED: msg += L"Access is denied."; break;
     case SE_ERR_ASSOCINCOMPLETE: msg += L"The filename association is incomplete or invalid."; break;
     case SE_ERR_NOASSOC: msg += L"There is no application associated with the given file name extension."; break;
     case SE_ERR_OOM: msg += L"Not enough memory to complete the operation."; break;
     default: msg += L"An unknown error occurred."; break;
     }
-    MessageBoxW(NULL, msg.c_str(), L"Execution Error", MB_OK | MB_ICONERROR);
+    MessageBoxW(NULL, msg.c_str(), L"Execution Error", MB_OK | MB_ICONERROR);
+}
+
+/**
+ * @brief Starts a program suspended, applies its launch profile and lets it run.
+ * @param executablePath The absolute path of the program.
+ * @param parameters Command-line parameters, with environment variables expanded.
+ * @param workingDirectory The working directory of the program.
+ * @param profile The launch profile of the button.
+ * @param environmentBlock The environment of the program, or NULL for the launcher's own.
+ * @param phProcess Receives the handle of the started process.
+ * @return True on success, false if the process could not be created.
+ */
+bool CreateProcessWithProfile(const std::wstring& executablePath, const std::wstring& parameters,
+    const std::wstring& workingDirectory, const LaunchProfile& profile, const wchar_t* environmentBlock, HANDLE* phProcess)
+{
+    // CreateProcessW may write to the command line, so it gets its own copy
+    std::wstring commandLine = L"\"" + executablePath + L"\"";
+    if (!parameters.empty())
+    {
+        commandLine += L" " + parameters;
+    }
+
+    STARTUPINFOW si = { sizeof(si) };
+    si.dwFlags = STARTF_USESHOWWINDOW;
+    si.wShowWindow = SW_SHOWNORMAL;
+    PROCESS_INFORMATION pi = {};
+    DWORD creationFlags = CREATE_SUSPENDED | CREATE_UNICODE_ENVIRONMENT | GetPriorityClassFlag(profile.priority);
+    if (!CreateProcessW(executablePath.c_str(), commandLine.data(), NULL, NULL, FALSE, creationFlags,
+        const_cast<wchar_t*>(environmentBlock), workingDirectory.c_str(), &si, &pi))
+    {
+        return false;
+    }
+
+    ApplyLaunchProfile(pi.hProcess, profile, false);
+    ResumeThread(pi.hThread);
+    CloseHandle(pi.hThread);
+    *phProcess = pi.hProcess;
+    return true;
+}
+
+/**
+ * @brief Sets the priority, processor affinity and I/O priority of a started process.
+ *        Settings the process does not let the launcher change, such as those of an
+ *        elevated process, stay as they are.
+ * @param hProcess Handle to the process.
+ * @param profile The launch profile of the button.
+ * @param includePriority False if the priority class was already set when creating the process.
+ */
+void ApplyLaunchProfile(HANDLE hProcess, const LaunchProfile& profile, bool includePriority)
+{
+    if (includePriority && profile.priority != LaunchPriority::Normal)
+    {
+        SetPriorityClass(hProcess, GetPriorityClassFlag(profile.priority));
+    }
+
+    if (profile.affinityMask != 0)
+    {
+        // Processors the machine does not have are dropped from the mask
+        DWORD_PTR processMask = 0;
+        DWORD_PTR systemMask = 0;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+        {
+            DWORD_PTR mask = static_cast<DWORD_PTR>(profile.affinityMask) & systemMask;
+            if (mask != 0) SetProcessAffinityMask(hProcess, mask);
+        }
+    }
+
+    if (profile.lowIoPriority)
+    {
+        // The I/O priority of another process can only be set through ntdll
+        using NtSetInformationProcessFunction = LONG(WINAPI*)(HANDLE, ULONG, PVOID, ULONG);
+        static const auto ntSetInformationProcess = reinterpret_cast<NtSetInformationProcessFunction>(
+            GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtSetInformationProcess"));
+        const ULONG PROCESS_IO_PRIORITY = 33;   // ProcessIoPriority
+        ULONG ioPriority = 1;                   // IoPriorityLow
+        if (ntSetInformationProcess)
+        {
+            ntSetInformationProcess(hProcess, PROCESS_IO_PRIORITY, &ioPriority, sizeof(ioPriority));
+        }
+    }
+}
+
+/**
+ * @brief Maps a launch priority to its process creation flag.
+ */
+DWORD GetPriorityClassFlag(LaunchPriority priority)
+{
+    switch (priority)
+    {
+    case LaunchPriority::Idle: return IDLE_PRIORITY_CLASS;
+    case LaunchPriority::BelowNormal: return BELOW_NORMAL_PRIORITY_CLASS;
+    case LaunchPriority::AboveNormal: return ABOVE_NORMAL_PRIORITY_CLASS;
+    case LaunchPriority::High: return HIGH_PRIORITY_CLASS;
+    default: return NORMAL_PRIORITY_CLASS;
+    }
+}
+
+/**
+ * @brief Returns the environment of a button's program. The block is built on the first
+ *        launch and again only after the button's overrides changed.
+ * @param info The button.
+ * @return The block, or NULL if the button has no overrides and the program inherits the
+ *         launcher's environment.
+ */
+const wchar_t* GetEnvironmentBlock(ButtonInfo& info)
+{
+    if (info.profile.environment.empty())
+    {
+        return NULL;
+    }
+    if (info.environmentBlock.empty() || info.environmentBlockSource != info.profile.environment)
+    {
+        LPWCH parentBlock = GetEnvironmentStringsW();
+        info.environmentBlock = BuildEnvironmentBlock(parentBlock, info.profile.environment);
+        if (parentBlock) FreeEnvironmentStringsW(parentBlock);
+        info.environmentBlockSource = info.profile.environment;
+    }
+    return info.environmentBlock.c_str();
+}
+
+/**
+ * @brief Handles the click event for a launch button.
+ * @param tabIndex The index of the tab containing the clicked button.
+ * @param buttonIndex The index of the clicked button.
+ */
+void OnLaunchButtonClick(int tabIndex, int buttonIndex)
+{
+    NoteLauncherActivity();
+    ButtonInfo& buttonInfo = g_tabs[tabIndex].buttons[buttonIndex];
+    if (!buttonInfo.path.empty())
+    {
+        // Leave the disk to the program being launched
+        g_prefetcher.Cancel();
+
+        // Bring an already running instance forward instead of spawning another copy
+        if (buttonInfo.singleInstance && ActivateRunningInstance(tabIndex, buttonIndex))
+        {
+            if (g_residentSettings.enabled) HideResidentWindow(g_hMainWindow, false);
+            return;
+        }
+
+        ULONGLONG clickTime = LaunchTimer::GetTimestamp();
+        if (buttonInfo.adminMode && g_isBrokerEnabled)
+        {
+            LaunchThroughBroker(tabIndex, buttonIndex, clickTime);
+            return;
+        }
+
+        QueueLaunch(tabIndex, buttonIndex, buttonInfo.adminMode, clickTime);
+    }
+}
+
+/**
+ * @brief Launches a button's program on the Interactive lane, so that the UI does not wait
+ *        for the shell; the result is applied by the message loop. Without the executor the
+ *        program is launched right away.
+ * @param asAdmin True to run the program with administrator privileges.
+ * @param clickTime When the button was clicked.
+ */
+void QueueLaunch(int tabIndex, int buttonIndex, bool asAdmin, ULONGLONG clickTime)
+{
+    ButtonInfo& buttonInfo = g_tabs[tabIndex].buttons[buttonIndex];
+    const wchar_t* environmentBlock = GetEnvironmentBlock(buttonInfo);
+    ButtonKey key{ tabIndex, buttonIndex };
+    bool isQueued = g_taskExecutor.Submit(TaskPriority::Interactive,
+        [key, path = buttonInfo.path, parameters = buttonInfo.parameters, asAdmin, profile = buttonInfo.profile,
+            environment = environmentBlock ? buttonInfo.environmentBlock : std::wstring(), clickTime]()
+        {
+            HANDLE hProcess = NULL;
+            DWORD errorCode = 0;
+            bool launched = StartApplication(path, parameters, asAdmin, profile,
+                environment.empty() ? NULL : environment.c_str(), &hProcess, &errorCode);
+            g_completionQueue.Push([key, path, parameters, launched, hProcess, errorCode, clickTime]()
+                {
+                    ApplyLaunchResult(key, path, parameters, launched, hProcess, errorCode, clickTime);
+                });
+        });
+    if (!isQueued)
+    {
+        HANDLE hProcess = NULL;
+        if (LaunchApplication(buttonInfo.path, buttonInfo.parameters, asAdmin, buttonInfo.profile, environmentBlock, &hProcess))
+        {
+            OnApplicationLaunched(tabIndex, buttonIndex, hProcess, clickTime);
+        }
+    }
+}
+
+/**
+ * @brief Applies the result of a launch made on the executor. A button that was edited or
+ *        removed meanwhile leaves its program running untracked.
+ * @param path The button's target when the launch was queued.
+ * @param parameters The button's parameters when the launch was queued.
+ * @param launched True if the program was started.
+ * @param hProcess Handle of the started process, or NULL.
+ * @param errorCode The shell's error code if the launch failed.
+ * @param clickTime When the button was clicked.
+ */
+void ApplyLaunchResult(ButtonKey key, const std::wstring& path, const std::wstring& parameters, bool launched,
+    HANDLE hProcess, DWORD errorCode, ULONGLONG clickTime)
+{
+    if (!launched)
+    {
+        ShowLaunchError(path, errorCode);
+        return;
+    }
+    if (!IsSameButtonTarget(key, path, parameters))
+    {
+        if (hProcess) CloseHandle(hProcess);
+        return;
+    }
+    OnApplicationLaunched(key.tab, key.button, hProcess, clickTime);
+}
+
+/**
+ * @brief Tests whether a button still has the target it had when a launch was requested.
+ */
+bool IsSameButtonTarget(ButtonKey key, const std::wstring& path, const std::wstring& parameters)
+{
+    return IsValidButton(key.tab, key.button) &&
+        g_tabs[key.tab].buttons[key.button].path == path && g_tabs[key.tab].buttons[key.button].parameters == parameters;
+}
+
+/**
+ * @brief Records a launch from a button: times it, counts it and tracks its process.
+ * @param hProcess Handle of the started process, or NULL; the tracker takes it over.
+ * @param clickTime When the button was clicked.
+ */
+void OnApplicationLaunched(int tabIndex, int buttonIndex, HANDLE hProcess, ULONGLONG clickTime)
+{
+    ButtonInfo& buttonInfo = g_tabs[tabIndex].buttons[buttonIndex];
+    // Time the launch before the tracker may close the handle
+    g_launchTimer.Track({ tabIndex, buttonIndex }, buttonInfo.path, hProcess, clickTime, LaunchTimer::GetTimestamp());
+    // The launched program takes the foreground from the hidden launcher
+    if (g_residentSettings.enabled) HideResidentWindow(g_hMainWindow, false);
+    SaveLaunchCount(tabIndex, buttonIndex, ++buttonInfo.launchCount);
+    if (hProcess)
+    {
+        g_processTracker.Track({ tabIndex, buttonIndex }, hProcess);
+        TRACE_COUNTER("TrackedProcesses", g_processTracker.GetTrackedCount());
+        InvalidateRect(buttonInfo.hButton, NULL, TRUE);
+    }
+}
+
+/**
+ * @brief Launches an administrator button through the elevation broker, starting the
+ *        broker first if it is not running. The reply is applied by the message loop.
+ */
+void LaunchThroughBroker(int tabIndex, int buttonIndex, ULONGLONG clickTime)
+{
+    if (!g_brokerClient.IsRunning())
+    {
+        g_brokerClient.Stop();
+        g_brokerClient.Start();
+    }
+
+    const ButtonInfo& buttonInfo = g_tabs[tabIndex].buttons[buttonIndex];
+    BrokerLaunchRequest request;
+    request.tab = static_cast<uint32_t>(tabIndex);
+    request.button = static_cast<uint32_t>(buttonIndex);
+    request.path = buttonInfo.path;
+    request.parameters = buttonInfo.parameters;
+    ButtonKey key{ tabIndex, buttonIndex };
+    g_brokerClient.Submit(request, [key, path = buttonInfo.path, parameters = buttonInfo.parameters, clickTime](const BrokerReply& reply)
+    {
+        g_completionQueue.Push([key, path, parameters, clickTime, reply]() { ApplyBrokerReply(key, path, parameters, clickTime, reply); });
+    });
+}
+
+/**
+ * @brief Applies the broker's reply to a launch request. Launches the broker could not
+ *        make are retried with a consent prompt of their own, as without the broker.
+ * @param path The button's target when the request was sent.
+ * @param parameters The button's parameters when the request was sent.
+ * @param clickTime When the button was clicked.
+ */
+void ApplyBrokerReply(ButtonKey key, const std::wstring& path, const std::wstring& parameters, ULONGLONG clickTime, const BrokerReply& reply)
+{
+    HANDLE hProcess = reinterpret_cast<HANDLE>(static_cast<uintptr_t>(reply.processHandle));
+    if (!IsSameButtonTarget(key, path, parameters))
+    {
+        // The button was edited or removed while the request was out
+        if (hProcess) CloseHandle(hProcess);
+        return;
+    }
+
+    switch (reply.status)
+    {
+    case BrokerStatus::Launched:
+        OnApplicationLaunched(key.tab, key.button, hProcess, clickTime);
+        return;
+    case BrokerStatus::Failed:
+        // A declined consent prompt needs no message
+        if (reply.errorCode != ERROR_CANCELLED) ShowLaunchError(path, reply.errorCode);
+        return;
+    case BrokerStatus::Rejected:
+        // The broker only launches the buttons as they were when it started; a new one, started
+        // with the next launch, knows the edited ones. Restart() does not wait for the old one
+        g_brokerClient.Restart();
+        break;
+    case BrokerStatus::Unavailable:
+        break;
+    }
+    QueueLaunch(key.tab, key.button, true, clickTime);
+}
+
+/**
+ * @brief Brings the main window of a process launched from a button to the foreground.
+ * @param tabIndex The index of the tab containing the button.
+ * @param buttonIndex The index of the button.
+ * @return True if a running instance was activated, false if none has a window.
+ */
+bool ActivateRunningInstance(int tabIndex, int buttonIndex)
+{
+    for (DWORD processId : g_processTracker.GetProcessIds({ tabIndex, buttonIndex }))
+    {
+        HWND hTarget = FindMainWindowOfProcess(processId);
+        if (hTarget)
+        {
+            if (IsIconic(hTarget))
+            {
+                ShowWindow(hTarget, SW_RESTORE);
+            }
+            SetForegroundWindow(hTarget);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Queues the targets of all configured buttons for background validation.
+ */
+void ValidateButtonTargets()
+{
+    std::vector<TargetCheck> targets;
+    for (int tab = 0; tab < GetTabCount(); ++tab)
+    {
+        for (int btn = 0; btn < static_cast<int>(g_tabs[tab].buttons.size()); ++btn)
+        {
+            const ButtonInfo& info = g_tabs[tab].buttons[btn];
+            if (!info.path.empty())
+            {
+                targets.push_back({ { tab, btn }, info.path, ExpandEnvironmentVariables(info.path) });
+            }
+        }
+    }
+    g_targetValidator.Submit(std::move(targets));
+}
+
+/**
+ * @brief Stores the results of a validation pass and redraws buttons whose state changed.
+ */
+void ApplyTargetValidationResults()
+{
+    for (const TargetCheck& result : g_targetValidator.TakeResults())
+    {
+        if (!IsValidButton(result.key.tab, result.key.button))
+        {
+            continue;
+        }
+
+        ButtonInfo& info = g_tabs[result.key.tab].buttons[result.key.button];
+        // Ignore results for buttons edited while the pass was running
+        if (info.path == result.path && info.targetState != result.state)
+        {
+            info.targetState = result.state;
+            if (info.hButton) InvalidateRect(info.hButton, NULL, TRUE);
+        }
+    }
+}
+
+/**
+ * @brief Adds the timings of completed launches to the buttons' latency histograms and
+ *        records them in the usage file.
+ */
+void ApplyLaunchTimings()
+{
+    for (const LaunchTiming& timing : g_launchTimer.TakeResults())
+    {
+        if (!IsValidButton(timing.key.tab, timing.key.button))
+        {
+            continue;
+        }
+
+        ButtonInfo& info = g_tabs[timing.key.tab].buttons[timing.key.button];
+        // A launch of the previous target says nothing about the new one
+        if (info.path != timing.path)
+        {
+            continue;
+        }
+        for (int phase = 0; phase < LAUNCH_PHASE_COUNT; ++phase)
+        {
+            if (timing.microseconds[phase] >= 0)
+            {
+                info.launchLatency[phase].Record(static_cast<uint64_t>(timing.microseconds[phase]));
+            }
+        }
+        SaveLaunchLatency(timing.key.tab, timing.key.button, info);
+    }
+}
+
+/**
+ * @brief Called periodically; prefetches the most launched programs once per idle period
+ *        and cancels a running prefetch as soon as the user is active again.
+ */
+void CheckIdlePrefetch()
+{
+    LASTINPUTINFO lii = { sizeof(LASTINPUTINFO) };
+    if (!GetLastInputInfo(&lii))
+    {
+        return;
+    }
+
+    DWORD idleMs = GetTickCount() - lii.dwTime;
+    if (idleMs < static_cast<DWORD>(g_prefetchSettings.idleSeconds) * 1000)
+    {
+        g_prefetcher.Cancel();
+        return;
+    }
+
+    if (!g_prefetchSettings.enabled || g_prefetchSettings.budgetMegabytes <= 0 ||
+        lii.dwTime == g_lastPrefetchInputTime || g_prefetcher.IsBusy())
+    {
+        return;
+    }
+
+    uint64_t budgetBytes = static_cast<uint64_t>(g_prefetchSettings.budgetMegabytes) * 1024 * 1024;
+    if (g_prefetcher.Schedule(CollectPrefetchFiles(), budgetBytes))
+    {
+        g_lastPrefetchInputTime = lii.dwTime;
+    }
+}
+
+/**
+ * @brief Lists the executables and companion files of the most launched buttons.
+ * @return Absolute file paths, most launched first.
+ */
+std::vector<std::wstring> CollectPrefetchFiles()
+{
+    std::vector<const ButtonInfo*> ranked;
+    for (const TabInfo& tab : g_tabs)
+    {
+        for (const ButtonInfo& info : tab.buttons)
+        {
+            if (!info.path.empty() && info.launchCount > 0)
+            {
+                ranked.push_back(&info);
+            }
+        }
+    }
+
+    size_t topCount = (std::min)(ranked.size(), static_cast<size_t>((std::max)(g_prefetchSettings.topButtonCount, 0)));
+    std::partial_sort(ranked.begin(), ranked.begin() + topCount, ranked.end(), [](const ButtonInfo* a, const ButtonInfo* b)
+        {
+            return a->launchCount > b->launchCount;
+        });
+
+    std::vector<std::wstring> files;
+    auto addFile = [&files](const std::wstring& file)
+        {
+            if (std::find(files.begin(), files.end(), file) == files.end())
+            {
+                files.push_back(file);
+            }
+        };
+
+    for (size_t i = 0; i < topCount; ++i)
+    {
+        std::wstring target = ExpandEnvironmentVariables(ranked[i]->path);
+        if (PathIsURLW(target.c_str())) continue;
+        if (PathIsRelativeW(target.c_str()))
+        {
+            target = ResolveExecutablePath(target.c_str());
+            if (PathIsRelativeW(target.c_str())) continue; // Not found on disk
+        }
+        addFile(target);
+
+        // Companion files are relative to the target's directory unless absolute
+        std::filesystem::path targetDirectory = std::filesystem::path(target).parent_path();
+        size_t start = 0;
+        while (start < ranked[i]->prefetchFiles.size())
+        {
+            size_t end = ranked[i]->prefetchFiles.find(L';', start);
+            if (end == std::wstring::npos) end = ranked[i]->prefetchFiles.size();
+
+            std::wstring companion = ranked[i]->prefetchFiles.substr(start, end - start);
+            trim(companion);
+            if (!companion.empty())
+            {
+                companion = ExpandEnvironmentVariables(companion);
+                addFile(PathIsRelativeW(companion.c_str()) ? (targetDirectory / companion).wstring() : companion);
+            }
+            start = end + 1;
+        }
+    }
+    return files;
+}
+
+// =============================================================
+//                     Utility Functions
+// =============================================================
+
+/**
+ * @brief Extracts the icon associated with a file and scales it. Safe to call from the
+ *        task executor.
+ * @param filePath Path to the file (can be relative or absolute).
+ * @param size The width and height of the icon in pixels.
+ * @param image Receives the pixels.
+ * @return True on success, false if the file was not found or has no icon.
+ */
+bool ExtractIconImage(const std::wstring& filePath, int size, BgraImage& image)
+{
+    if (filePath.empty()) return false;
+
+    std::wstring pathToIcon = filePath;
+    // If the path is relative, try to find its full path to help SHGetFileInfo
+    if (PathIsRelativeW(pathToIcon.c_str()))
+    {
+        pathToIcon = ResolveExecutablePath(filePath.c_str());
+    }
+    return !pathToIcon.empty() && IconCache::ExtractImage(pathToIcon, size, image);
+}
+
+/**
+ * @brief Returns a copy of the default application icon, for targets without an icon.
+ * @return A new icon owned by the caller.
+ */
+HICON CreateDefaultIcon(int size)
+{
+    return (HICON)CopyImage(g_hDefaultIcon, IMAGE_ICON, size, size, LR_COPYFROMRESOURCE);
+}
+
+/**
+ * @brief Starts the workers of the task executor and the queue their results come back
+ *        through. Workers initialize COM before their first task, since icon extraction
+ *        goes through the shell.
+ */
+void StartTaskExecutor()
+{
+    g_hCompletionEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+    if (!g_hCompletionEvent)
+    {
+        return; // Icons are then extracted and programs launched on the UI thread as they used to be
+    }
+    g_completionQueue.SetWakeHandler([]() { SetEvent(g_hCompletionEvent); });
+
+    for (int lane = 0; lane < TASK_PRIORITY_COUNT; ++lane)
+    {
+        // Every lane initializes its own apartment; nested calls only add a reference
+        g_taskExecutor.SetLaneHooks(static_cast<TaskPriority>(lane),
+            []() { CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE); },
+            []() { CoUninitialize(); });
+    }
+    g_taskExecutor.Start();
+}
+
+/**
+ * @brief Starts indexing the programs that can be launched by name or completed in the
+ *        settings dialog.
+ *
+ * Directories are listed in the order SearchPathW uses: the executable directory, the
+ * system and Windows directories, then PATH. They are followed by the application folders
+ * in [ProgramIndex] Directories=, separated by semicolons and searched with their
+ * subdirectories; the Start Menu by default. Files with an extension in PATHEXT or .lnk
+ * are indexed. [ProgramIndex] Enabled=0 turns indexing off. The settings are those of
+ * the configuration last read, so a reload that changes them calls this again.
+ */
+void StartProgramIndexer()
+{
+    if (!g_programIndexSettings.enabled)
+    {
+        return;
+    }
+
+    std::vector<ProgramIndexDirectory> directories;
+    auto addDirectories = [&directories](const std::wstring& list, bool recursive)
+    {
+        size_t start = 0;
+        while (start < list.size())
+        {
+            size_t end = list.find(L';', start);
+            if (end == std::wstring::npos) end = list.size();
+
+            std::wstring directory = list.substr(start, end - start);
+            directory.erase(std::remove(directory.begin(), directory.end(), L'"'), directory.end());
+            trim(directory);
+            directory = ExpandEnvironmentVariables(directory);
+            while (directory.size() > 3 && (directory.back() == L'\\' || directory.back() == L'/'))
+            {
+                directory.pop_back();
+            }
+            bool isListed = std::any_of(directories.begin(), directories.end(),
+                [&directory](const ProgramIndexDirectory& listed) { return lstrcmpiW(listed.path.c_str(), directory.c_str()) == 0; });
+            if (!directory.empty() && !isListed && PathIsDirectoryW(directory.c_str()))
+            {
+                directories.push_back({ directory, recursive });
+            }
+            start = end + 1;
+        }
+    };
+
+    wchar_t systemDirectory[MAX_PATH] = {};
+    wchar_t windowsDirectory[MAX_PATH] = {};
+    GetSystemDirectoryW(systemDirectory, MAX_PATH);
+    GetWindowsDirectoryW(windowsDirectory, MAX_PATH);
+    addDirectories(g_executableDirectory, false);
+    addDirectories(systemDirectory, false);
+    addDirectories(windowsDirectory, false);
+    addDirectories(ExpandEnvironmentVariables(L"%PATH%"), false);
+
+    addDirectories(g_programIndexSettings.directories, true);
+
+    std::vector<std::wstring> extensions = { L".lnk" };
+    std::wstring pathExtensions = ExpandEnvironmentVariables(L"%PATHEXT%");
+    if (pathExtensions == L"%PATHEXT%") pathExtensions = L".COM;.EXE;.BAT;.CMD";
+    size_t start = 0;
+    while (start < pathExtensions.size())
+    {
+        size_t end = pathExtensions.find(L';', start);
+        if (end == std::wstring::npos) end = pathExtensions.size();
+
+        std::wstring extension = pathExtensions.substr(start, end - start);
+        trim(extension);
+        if (extension.size() > 1 && extension[0] == L'.')
+        {
+            extensions.push_back(extension);
+        }
+        start = end + 1;
+    }
 
-    return false;
+    g_programIndexer.Start(g_taskExecutor, std::move(directories), std::move(extensions));
 }
 
 /**
- * @brief Handles the click event for a launch button.
- * @param tabIndex The index of the tab containing the clicked button.
- * @param buttonIndex The index of the clicked button.
+ * @brief Runs the completions queued by background work for up to COMPLETION_BUDGET, then
+ *        invalidates the windows they changed, each once.
+ * @return True if completions were left for the next turn of the message loop.
  */
-void OnLaunchButtonClick(int tabIndex, int buttonIndex)
+bool RunCompletions()
 {
-    const ButtonInfo& buttonInfo = g_tabButtonData[tabIndex][buttonIndex];
-    if (!buttonInfo.path.empty())
+    CompletionDrainResult result = g_completionQueue.Drain(COMPLETION_BUDGET);
+    if (result.completed > 0)
     {
-        LaunchApplication(buttonInfo.path, buttonInfo.parameters, buttonInfo.adminMode);
-        // Reset current directory in case the launched process changed it
-        SetCurrentDirectoryW(g_executableDirectory.c_str());
+        TRACE_COUNTER("PendingCompletions", g_completionQueue.GetPendingCount());
     }
-}
 
-// =============================================================
-//                     Utility Functions
-// =============================================================
+    std::sort(g_pendingRepaints.begin(), g_pendingRepaints.end());
+    g_pendingRepaints.erase(std::unique(g_pendingRepaints.begin(), g_pendingRepaints.end()), g_pendingRepaints.end());
+    for (HWND hwnd : g_pendingRepaints)
+    {
+        // Hidden pages paint their buttons when they are shown
+        if (IsWindowVisible(hwnd))
+        {
+            InvalidateRect(hwnd, NULL, TRUE);
+        }
+    }
+    g_pendingRepaints.clear();
+    return result.hasMore;
+}
 
 /**
- * @brief Extracts the large icon associated with a file.
- * @param filePath Path to the file (can be relative or absolute).
- * @return HICON handle to the extracted icon, or a default icon on failure.
+ * @brief Invalidates a window after the completions being run, together with the other
+ *        windows they change.
  */
-HICON ExtractIconFromFile(const std::wstring& filePath)
+void RequestRepaint(HWND hwnd)
 {
-    if (filePath.empty()) return NULL;
-
-    std::wstring pathToIcon = filePath;
-    // If the path is relative, try to find its full path to help SHGetFileInfo
-    if (PathIsRelativeW(pathToIcon.c_str()))
+    if (hwnd)
     {
-        pathToIcon = ResolveExecutablePath(filePath.c_str());
-    }
-
-    if (!pathToIcon.empty())
-    {
-        SHFILEINFOW sfi = {};
-        if (SHGetFileInfoW(pathToIcon.c_str(), 0, &sfi, sizeof(sfi), SHGFI_ICON | SHGFI_LARGEICON))
-        {
-            return sfi.hIcon;
-        }
+        g_pendingRepaints.push_back(hwnd);
     }
-    // Fallback to a copy of the default application icon if extraction fails
-    return (HICON)CopyIcon(g_hDefaultIcon);
 }
 
 /**
@@ -822,6 +3707,8 @@ HICON ExtractIconFromFile(const std::wstring& filePath)
  */
 std::wstring ResolveExecutablePath(const wchar_t* targetFile)
 {
+    TRACE_SCOPE("ResolveExecutablePath");
+
     // 1. Check in the application's own directory first
     if (!g_executableDirectory.empty())
     {
@@ -832,7 +3719,18 @@ std::wstring ResolveExecutablePath(const wchar_t* targetFile)
         }
     }
 
-    // 2. Search using the system's PATH environment variables
+    // 2. Look the name up in the program index, which lists PATH in the same order. A
+    //    program removed since the last rescan falls through to the search below.
+    if (std::shared_ptr<const ProgramIndex> index = g_programIndexer.GetIndex())
+    {
+        std::wstring indexedPath;
+        if (index->FindProgram(targetFile, indexedPath) && PathFileExistsW(indexedPath.c_str()))
+        {
+            return indexedPath;
+        }
+    }
+
+    // 3. Search using the system's PATH environment variables
     std::wstring buffer(MAX_PATH, L'\0');
     do {
         DWORD pathLen = SearchPathW(NULL, targetFile, NULL, static_cast<DWORD>(buffer.length()), buffer.data(), NULL);
@@ -848,7 +3746,7 @@ std::wstring ResolveExecutablePath(const wchar_t* targetFile)
         buffer.resize(buffer.length() * 2);
     } while (true);
 
-    // 3. Fallback to the original name. ShellExecute might still find it.
+    // 4. Fallback to the original name. ShellExecute might still find it.
     return std::wstring(targetFile);
 }
 
@@ -893,27 +3791,374 @@ bool WriteUtf16LeFile(const wchar_t* filename, const std::wstring& text)
     return true;
 }
 
+/**
+ * @brief Finds the visible, unowned top-level window of a process.
+ * @param processId The ID of the process.
+ * @return Handle to the window, or NULL if the process has none.
+ */
+HWND FindMainWindowOfProcess(DWORD processId)
+{
+    struct SearchState
+    {
+        DWORD processId;
+        HWND hFound;
+    } state = { processId, NULL };
+
+    EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL
+        {
+            SearchState* pState = (SearchState*)lParam;
+            DWORD windowProcessId = 0;
+            GetWindowThreadProcessId(hwnd, &windowProcessId);
+            if (windowProcessId == pState->processId && IsWindowVisible(hwnd) && GetWindow(hwnd, GW_OWNER) == NULL)
+            {
+                pState->hFound = hwnd;
+                return FALSE; // Stop enumeration
+            }
+            return TRUE;
+        }, (LPARAM)&state);
+
+    return state.hFound;
+}
+
+/**
+ * @brief Checks whether a switch such as "/trace" was passed on the command line.
+ * @param name The switch, including its leading slash.
+ * @return True if the switch is present (case-insensitive).
+ */
+bool HasCommandLineSwitch(const wchar_t* name)
+{
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv) return false;
+
+    bool found = false;
+    for (int i = 1; i < argc && !found; ++i)
+    {
+        found = lstrcmpiW(argv[i], name) == 0;
+    }
+    LocalFree(argv);
+    return found;
+}
+
+/**
+ * @brief Writes the recorded trace next to the executable as MultiTabLauncher.trace.json.
+ * @return True on success, false on failure.
+ */
+bool SaveTraceFile()
+{
+    return Trace::WriteChromeTrace(std::filesystem::path(g_executableDirectory) / L"MultiTabLauncher.trace.json");
+}
+
+/**
+ * @brief Adds an interaction to the recorded session if the launcher was started with /record.
+ * @param kind What the user did.
+ * @param a, b The tab and button, or the client width and height (see InteractionKind).
+ */
+void RecordInteraction(InteractionKind kind, int a, int b)
+{
+    if (!g_isRecordingInteractions)
+    {
+        return;
+    }
+    uint32_t timeMs = static_cast<uint32_t>((std::min)(GetTickCount64() - g_interactionRecordStart, ULONGLONG{ UINT32_MAX }));
+    g_interactionTrace.events.push_back({ timeMs, kind, a, b });
+}
+
+/**
+ * @brief Writes the recorded session next to the executable as MultiTabLauncher.interactions.bin.
+ * @return True on success, false on failure.
+ */
+bool SaveInteractionTrace()
+{
+    g_interactionTrace.tabStripHeight = g_tabStrip.GetPreferredHeight();
+    std::string data = g_interactionTrace.Serialize();
+    std::ofstream file(std::filesystem::path(g_executableDirectory) / L"MultiTabLauncher.interactions.bin", std::ios::binary);
+    file.write(data.data(), data.size());
+    file.close();
+    return !file.fail();
+}
+
+/**
+ * @brief Replays a recorded session (/replay [trace]) against the configuration without
+ *        opening a window, and writes the latency of each kind of interaction to
+ *        MultiTabLauncher.replay.txt. Without a trace, MultiTabLauncher.interactions.bin is used.
+ * @return True on success, false if the trace cannot be read.
+ */
+bool ReplayInteractionTrace()
+{
+    const int REPLAY_REPETITIONS = 10;
+
+    std::filesystem::path tracePath = std::filesystem::path(g_executableDirectory) / L"MultiTabLauncher.interactions.bin";
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv) return false;
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (lstrcmpiW(argv[i], L"/replay") == 0)
+        {
+            tracePath = argv[i + 1];
+            break;
+        }
+    }
+    LocalFree(argv);
+
+    std::ifstream file(tracePath, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    InteractionTrace trace;
+    if (!file.is_open() || !trace.Parse(data))
+    {
+        ReportCommandLineError(L"Cannot read the interaction trace " + tracePath.wstring());
+        return false;
+    }
+
+    // The configuration the launcher would start with
+    if (!g_catalogFilePath.empty())
+    {
+        g_sharedCatalog.Open(g_catalogFilePath);
+    }
+    LauncherConfig config = (PathFileExists(g_configFilePath.c_str()) || g_sharedCatalog.IsOpen()) ?
+        ReadConfigurationModel(g_configFilePath) : GetDefaultLauncherConfig();
+
+    std::string report = ReplayInteractions(config, trace, REPLAY_REPETITIONS).Format();
+    std::ofstream output(std::filesystem::path(g_executableDirectory) / L"MultiTabLauncher.replay.txt", std::ios::binary);
+    output.write(report.data(), report.size());
+    output.close();
+    return !output.fail();
+}
+
+/**
+ * @brief Runs as the elevation broker of the launcher given on the command line
+ *        ("/broker <process id> <token>"), until that launcher disconnects or exits.
+ *
+ * The broker reads the configuration once, now that the user has consented to the
+ * elevation, and only starts the administrator buttons in it. Programs are started
+ * directly rather than with "runas", since the broker already runs elevated, so their
+ * launch profile, including environment overrides, applies in full.
+ * @return True if the launcher disconnected, false on any failure.
+ */
+bool RunLaunchBroker()
+{
+    DWORD launcherProcessId = 0;
+    std::string token;
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv) return false;
+    for (int i = 1; i + 2 < argc; ++i)
+    {
+        if (lstrcmpiW(argv[i], L"/broker") == 0)
+        {
+            launcherProcessId = wcstoul(argv[i + 1], NULL, 10);
+            if (!ParseBrokerToken(argv[i + 2], token)) launcherProcessId = 0;
+            break;
+        }
+    }
+    LocalFree(argv);
+    if (launcherProcessId == 0)
+    {
+        return false;
+    }
+
+    // The configuration the launcher was started with, as for /replay
+    if (!g_catalogFilePath.empty())
+    {
+        g_sharedCatalog.Open(g_catalogFilePath);
+    }
+    LauncherConfig config = (PathFileExists(g_configFilePath.c_str()) || g_sharedCatalog.IsOpen()) ?
+        ReadConfigurationModel(g_configFilePath) : GetDefaultLauncherConfig();
+
+    BrokerHost host;
+    if (!host.Open(launcherProcessId))
+    {
+        return false;
+    }
+    BrokerDispatcher dispatcher(std::move(config), std::move(token), [&host](const ButtonConfig& button)
+        {
+            std::wstring environmentBlock;
+            if (!button.profile.environment.empty())
+            {
+                LPWCH parentBlock = GetEnvironmentStringsW();
+                environmentBlock = BuildEnvironmentBlock(parentBlock, button.profile.environment);
+                if (parentBlock) FreeEnvironmentStringsW(parentBlock);
+            }
+
+            BrokerReply reply;
+            HANDLE hProcess = NULL;
+            DWORD errorCode = 0;
+            if (!StartApplication(button.path, button.parameters, false, button.profile,
+                environmentBlock.empty() ? NULL : environmentBlock.c_str(), &hProcess, &errorCode))
+            {
+                reply.status = BrokerStatus::Failed;
+                reply.errorCode = errorCode;
+                return reply;
+            }
+            reply.status = BrokerStatus::Launched;
+            if (hProcess)
+            {
+                reply.processId = GetProcessId(hProcess);
+                reply.processHandle = host.ShareProcessHandle(hProcess);
+                CloseHandle(hProcess);
+            }
+            return reply;
+        });
+    return host.Run(dispatcher);
+}
+
+/**
+ * @brief Writes the launch latencies of all buttons next to the executable as
+ *        MultiTabLauncher.latency.csv and opens it.
+ *
+ * There is one row per button and launch phase, with times in milliseconds from the click.
+ * @return True on success, false on failure.
+ */
+bool ExportLaunchStatistics()
+{
+    static const wchar_t* const phaseNames[LAUNCH_PHASE_COUNT] = { L"Spawn", L"ProcessStart", L"FirstWindow" };
+    auto milliseconds = [](double microseconds)
+        {
+            wchar_t text[32];
+            swprintf(text, std::size(text), L"%.1f", microseconds / 1000);
+            return std::wstring(text);
+        };
+
+    std::wstring csv = L"Tab,Button,Name,Phase,Count,Mean (ms),P50 (ms),P90 (ms),P99 (ms),Max (ms)\r\n";
+    for (int tab = 0; tab < GetTabCount(); ++tab)
+    {
+        for (int btn = 0; btn < static_cast<int>(g_tabs[tab].buttons.size()); ++btn)
+        {
+            const ButtonInfo& info = g_tabs[tab].buttons[btn];
+            std::wstring name = info.name;
+            for (size_t quote = name.find(L'"'); quote != std::wstring::npos; quote = name.find(L'"', quote + 2))
+            {
+                name.insert(quote, 1, L'"');
+            }
+            for (int phase = 0; phase < LAUNCH_PHASE_COUNT; ++phase)
+            {
+                const LatencyHistogram& histogram = info.launchLatency[phase];
+                if (histogram.IsEmpty()) continue;
+                csv += std::to_wstring(tab) + L',' + std::to_wstring(btn) + L",\"" + name + L"\"," + phaseNames[phase] + L',' +
+                    std::to_wstring(histogram.GetCount()) + L',' + milliseconds(histogram.GetMean()) + L',' +
+                    milliseconds(static_cast<double>(histogram.GetPercentile(50))) + L',' +
+                    milliseconds(static_cast<double>(histogram.GetPercentile(90))) + L',' +
+                    milliseconds(static_cast<double>(histogram.GetPercentile(99))) + L',' +
+                    milliseconds(static_cast<double>(histogram.GetMax())) + L"\r\n";
+            }
+        }
+    }
+
+    // UTF-8 with a byte order mark, which spreadsheet programs recognize
+    int length = WideCharToMultiByte(CP_UTF8, 0, csv.data(), static_cast<int>(csv.size()), NULL, 0, NULL, NULL);
+    std::string bytes = "\xEF\xBB\xBF" + std::string(length, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, csv.data(), static_cast<int>(csv.size()), bytes.data() + 3, length, NULL, NULL);
+
+    std::filesystem::path csvPath = std::filesystem::path(g_executableDirectory) / L"MultiTabLauncher.latency.csv";
+    std::ofstream file(csvPath, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file.write(bytes.data(), bytes.size());
+    file.close();
+    if (!file)
+    {
+        return false;
+    }
+    ShellExecuteW(NULL, L"open", csvPath.c_str(), NULL, NULL, SW_SHOWNORMAL);
+    return true;
+}
+
+/**
+ * @brief Writes the resource counters of the launcher, together with what Windows reports
+ *        for the process, next to the executable as MultiTabLauncher.diagnostics.txt and opens it.
+ * @return True on success, false on failure.
+ */
+bool SaveDiagnostics()
+{
+    UpdateResourceGauges();
+
+    int loadedPages = 0;
+    for (const TabInfo& tab : g_tabs)
+    {
+        if (tab.hPage) ++loadedPages;
+    }
+
+    char line[256];
+    std::string text = "MultiTabLauncher resource diagnostics\r\n\r\n";
+    snprintf(line, sizeof(line), "Tabs: %d, pages loaded: %d\r\n", GetTabCount(), loadedPages);
+    text += line;
+    snprintf(line, sizeof(line), "Limits: MaxIcons=%d MaxWindows=%d IdleTrimMinutes=%d\r\n\r\n",
+        g_resourceSettings.maxIcons, g_resourceSettings.maxWindows, g_resourceSettings.idleTrimMinutes);
+    text += line;
+    for (char c : g_resourceAccountant.FormatReport())
+    {
+        if (c == '\n') text += '\r';
+        text += c;
+    }
+    text += "\r\nBackground tasks (latencies in microseconds)\r\n";
+    for (char c : g_taskExecutor.FormatReport())
+    {
+        if (c == '\n') text += '\r';
+        text += c;
+    }
+    if (std::shared_ptr<const ProgramIndex> index = g_programIndexer.GetIndex())
+    {
+        snprintf(line, sizeof(line), "\r\nProgram index: %zu programs in %zu directories, %zu KB\r\n",
+            index->GetEntryCount(), index->GetDirectories().size(), index->GetByteSize() / 1024);
+        text += line;
+    }
+
+    // What Windows counts, including objects created by common controls and the shell
+    HANDLE hProcess = GetCurrentProcess();
+    snprintf(line, sizeof(line), "\r\nGDI objects: %lu (peak %lu)\r\nUSER objects: %lu (peak %lu)\r\n",
+        GetGuiResources(hProcess, GR_GDIOBJECTS), GetGuiResources(hProcess, GR_GDIOBJECTS_PEAK),
+        GetGuiResources(hProcess, GR_USEROBJECTS), GetGuiResources(hProcess, GR_USEROBJECTS_PEAK));
+    text += line;
+    PROCESS_MEMORY_COUNTERS memory = {};
+    if (GetProcessMemoryInfo(hProcess, &memory, sizeof(memory)))
+    {
+        snprintf(line, sizeof(line), "Working set: %zu KB (peak %zu KB)\r\nPrivate bytes: %zu KB\r\n",
+            static_cast<size_t>(memory.WorkingSetSize / 1024), static_cast<size_t>(memory.PeakWorkingSetSize / 1024),
+            static_cast<size_t>(memory.PagefileUsage / 1024));
+        text += line;
+    }
+
+    std::filesystem::path diagnosticsPath = std::filesystem::path(g_executableDirectory) / L"MultiTabLauncher.diagnostics.txt";
+    std::ofstream file(diagnosticsPath, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file.write(text.data(), text.size());
+    file.close();
+    if (!file)
+    {
+        return false;
+    }
+    ShellExecuteW(NULL, L"open", diagnosticsPath.c_str(), NULL, NULL, SW_SHOWNORMAL);
+    return true;
+}
+
 // --- String Trimming Utilities ---
 inline void ltrim(std::wstring& s)
 {
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](wchar_t ch)
-        {
-            return !std::iswspace(ch);
-        }));
+    size_t first = 0;
+    while (first < s.length() && IsBlank(s[first])) ++first;
+    s.erase(0, first);
 }
 
 inline void rtrim(std::wstring& s)
 {
-    s.erase(std::find_if(s.rbegin(), s.rend(), [](wchar_t ch)
-        {
-            return !std::iswspace(ch);
-        }).base(), s.end());
+    size_t last = s.length();
+    while (last > 0 && IsBlank(s[last - 1])) --last;
+    s.erase(last);
 }
 
 inline void trim(std::wstring& s)
 {
-    ltrim(s);
-    rtrim(s);
+    std::wstring_view trimmed = TrimBlanks(s);
+    size_t first = trimmed.data() - s.data();
+    size_t length = trimmed.length();
+    s.erase(first + length);
+    s.erase(0, first);
 }
 
 // =============================================================
@@ -930,7 +4175,7 @@ int DisplayButtonSettingsDialog(int tabIdx, int btnIdx)
 {
     return (int)DialogBoxParam(
         GetModuleHandle(NULL), MAKEINTRESOURCE(IDD_BUTTONINFO), g_hMainWindow,
-        ButtonSettingsDialogProcedure, (LPARAM)&g_tabButtonData[tabIdx][btnIdx]
+        ButtonSettingsDialogProcedure, (LPARAM)&g_tabs[tabIdx].buttons[btnIdx]
     );
 }
 
@@ -952,19 +4197,59 @@ INT_PTR CALLBACK ButtonSettingsDialogProcedure(HWND hDlg, UINT message, WPARAM w
             SetDlgItemTextW(hDlg, IDC_EDIT_PATH, pInfo->path.c_str());
             SetDlgItemTextW(hDlg, IDC_EDIT_PARAMS, pInfo->parameters.c_str());
             CheckDlgButton(hDlg, IDC_CHECK_ADMIN, pInfo->adminMode ? BST_CHECKED : BST_UNCHECKED);
+            CheckDlgButton(hDlg, IDC_CHECK_SINGLEINSTANCE, pInfo->singleInstance ? BST_CHECKED : BST_UNCHECKED);
         }
 
         // Subclass edit controls to handle Ctrl+A for selecting all text
         SetWindowSubclass(GetDlgItem(hDlg, IDC_EDIT_NAME), SelectAllEditSubclassProcedure, 1, 0);
         SetWindowSubclass(GetDlgItem(hDlg, IDC_EDIT_PATH), SelectAllEditSubclassProcedure, 1, 0);
         SetWindowSubclass(GetDlgItem(hDlg, IDC_EDIT_PARAMS), SelectAllEditSubclassProcedure, 1, 0);
+
+        // Programs matching the path field are listed under it as it is typed. The list never
+        // takes the focus, so typing goes on while it is shown.
+        SetWindowSubclass(GetDlgItem(hDlg, IDC_EDIT_PATH), PathEditSubclassProcedure, 2, 0);
+        g_hPathSuggestionList = CreateWindowExW(WS_EX_NOACTIVATE | WS_EX_TOOLWINDOW, L"LISTBOX", NULL,
+            WS_POPUP | WS_BORDER | LBS_NOINTEGRALHEIGHT, 0, 0, 0, 0, hDlg, NULL, GetModuleHandle(NULL), NULL);
+        if (g_hPathSuggestionList)
+        {
+            SendMessageW(g_hPathSuggestionList, WM_SETFONT, SendMessageW(hDlg, WM_GETFONT, 0, 0), FALSE);
+            SetWindowSubclass(g_hPathSuggestionList, PathSuggestionListSubclassProcedure, 1, 0);
+        }
         return TRUE;
     }
 
+    case WM_MOVE:
+    {
+        HidePathSuggestions();
+        break;
+    }
+
+    case WM_DESTROY:
+    {
+        if (g_hPathSuggestionList)
+        {
+            DestroyWindow(g_hPathSuggestionList);
+            g_hPathSuggestionList = NULL;
+        }
+        break;
+    }
+
     case WM_COMMAND:
     {
         switch (LOWORD(wParam))
         {
+        case IDC_EDIT_PATH:
+        {
+            if (HIWORD(wParam) == EN_CHANGE && !g_isSettingPathText)
+            {
+                UpdatePathSuggestions(hDlg);
+            }
+            else if (HIWORD(wParam) == EN_KILLFOCUS)
+            {
+                HidePathSuggestions();
+            }
+            break;
+        }
         case IDC_BUTTON_BROWSE:
         {
             // Open a file dialog to browse for an executable
@@ -998,6 +4283,7 @@ INT_PTR CALLBACK ButtonSettingsDialogProcedure(HWND hDlg, UINT message, WPARAM w
                 pInfo->parameters = GetTextFromDialogControl(hDlg, IDC_EDIT_PARAMS);
                 trim(pInfo->parameters);
                 pInfo->adminMode = (IsDlgButtonChecked(hDlg, IDC_CHECK_ADMIN) == BST_CHECKED);
+                pInfo->singleInstance = (IsDlgButtonChecked(hDlg, IDC_CHECK_SINGLEINSTANCE) == BST_CHECKED);
             }
             EndDialog(hDlg, IDOK);
             break;
@@ -1014,6 +4300,76 @@ INT_PTR CALLBACK ButtonSettingsDialogProcedure(HWND hDlg, UINT message, WPARAM w
     return FALSE;
 }
 
+/**
+ * @brief Lists the programs that complete the path field under it, or hides the list if
+ *        none do. Nothing is listed until the program index has been built.
+ */
+void UpdatePathSuggestions(HWND hDlg)
+{
+    HWND hEdit = GetDlgItem(hDlg, IDC_EDIT_PATH);
+    std::shared_ptr<const ProgramIndex> index = g_programIndexer.GetIndex();
+    if (!g_hPathSuggestionList || !index || GetFocus() != hEdit)
+    {
+        HidePathSuggestions();
+        return;
+    }
+
+    std::wstring query = GetTextFromDialogControl(hDlg, IDC_EDIT_PATH);
+    trim(query);
+    std::vector<ProgramMatch> matches = index->Complete(query, MAX_PATH_SUGGESTIONS);
+    if (matches.empty())
+    {
+        HidePathSuggestions();
+        return;
+    }
+
+    SendMessageW(g_hPathSuggestionList, WM_SETREDRAW, FALSE, 0);
+    SendMessageW(g_hPathSuggestionList, LB_RESETCONTENT, 0, 0);
+    for (const ProgramMatch& match : matches)
+    {
+        SendMessageW(g_hPathSuggestionList, LB_ADDSTRING, 0, (LPARAM)match.path.c_str());
+    }
+    SendMessageW(g_hPathSuggestionList, WM_SETREDRAW, TRUE, 0);
+
+    RECT editRect;
+    GetWindowRect(hEdit, &editRect);
+    int itemHeight = static_cast<int>(SendMessageW(g_hPathSuggestionList, LB_GETITEMHEIGHT, 0, 0));
+    int height = itemHeight * static_cast<int>(matches.size()) + 2 * GetSystemMetrics(SM_CYBORDER);
+    SetWindowPos(g_hPathSuggestionList, HWND_TOP, editRect.left, editRect.bottom, editRect.right - editRect.left, height,
+        SWP_NOACTIVATE | SWP_SHOWWINDOW);
+    InvalidateRect(g_hPathSuggestionList, NULL, TRUE);
+}
+
+/**
+ * @brief Puts a listed program into the path field and hides the list.
+ */
+void AcceptPathSuggestion(HWND hDlg, int item)
+{
+    int length = static_cast<int>(SendMessageW(g_hPathSuggestionList, LB_GETTEXTLEN, item, 0));
+    if (length == LB_ERR)
+    {
+        return;
+    }
+    std::wstring path(length + 1, L'\0');
+    SendMessageW(g_hPathSuggestionList, LB_GETTEXT, item, (LPARAM)path.data());
+    path.resize(length);
+
+    g_isSettingPathText = true;
+    SetDlgItemTextW(hDlg, IDC_EDIT_PATH, path.c_str());
+    g_isSettingPathText = false;
+    SendDlgItemMessageW(hDlg, IDC_EDIT_PATH, EM_SETSEL, length, length);
+    HidePathSuggestions();
+}
+
+void HidePathSuggestions()
+{
+    if (g_hPathSuggestionList && IsWindowVisible(g_hPathSuggestionList))
+    {
+        ShowWindow(g_hPathSuggestionList, SW_HIDE);
+        SendMessageW(g_hPathSuggestionList, LB_SETCURSEL, (WPARAM)-1, 0);
+    }
+}
+
 /**
  * @brief Safely retrieves text from a dialog control, handling buffer allocation.
  * @param hDlg Handle to the dialog box.
@@ -1046,136 +4402,84 @@ LRESULT CALLBACK SelectAllEditSubclassProcedure(HWND hEdit, UINT msg, WPARAM wPa
     return DefSubclassProc(hEdit, msg, wParam, lParam);
 }
 
+/**
+ * @brief Subclass procedure for the path field: Up and Down move through the listed
+ *        programs, Enter takes the selected one and Escape hides the list. Without the
+ *        list the keys do what they do in the dialog.
+ */
+LRESULT CALLBACK PathEditSubclassProcedure(HWND hEdit, UINT msg, WPARAM wParam, LPARAM lParam, UINT_PTR, DWORD_PTR)
+{
+    bool isListVisible = g_hPathSuggestionList && IsWindowVisible(g_hPathSuggestionList);
+    int selected = isListVisible ? static_cast<int>(SendMessageW(g_hPathSuggestionList, LB_GETCURSEL, 0, 0)) : LB_ERR;
+    switch (msg)
+    {
+    case WM_GETDLGCODE:
+        // Keep Enter and Escape from closing the dialog while they act on the list
+        if ((wParam == VK_ESCAPE && isListVisible) || (wParam == VK_RETURN && selected != LB_ERR))
+        {
+            return DLGC_WANTALLKEYS | DefSubclassProc(hEdit, msg, wParam, lParam);
+        }
+        break;
+
+    case WM_KEYDOWN:
+        if (!isListVisible) break;
+        if (wParam == VK_DOWN || wParam == VK_UP)
+        {
+            int count = static_cast<int>(SendMessageW(g_hPathSuggestionList, LB_GETCOUNT, 0, 0));
+            int next = (wParam == VK_DOWN) ? (selected + 1) % count : (selected <= 0 ? count - 1 : selected - 1);
+            SendMessageW(g_hPathSuggestionList, LB_SETCURSEL, next, 0);
+            return 0;
+        }
+        if (wParam == VK_RETURN && selected != LB_ERR)
+        {
+            AcceptPathSuggestion(GetParent(hEdit), selected);
+            return 0;
+        }
+        if (wParam == VK_ESCAPE)
+        {
+            HidePathSuggestions();
+            return 0;
+        }
+        break;
 
-// =============================================================
-//                 Default INI Configuration
-// =============================================================
+    case WM_CHAR:
+        if (wParam == L'\r' || wParam == 0x1B)
+        {
+            return 0; // Handled on key down; a single-line edit would only beep
+        }
+        break;
+    }
+    return DefSubclassProc(hEdit, msg, wParam, lParam);
+}
 
 /**
- * @brief Provides the default string content for the INI file.
- * @return A wstring containing the default configuration.
- */
-std::wstring GetDefaultConfigString()
-{
-    return LR"([Tabs]
-Count=10
-ButtonRows=3
-ButtonCols=8
-Tab0=Home
-Tab1=System
-Tab2=Dev
-Tab3=Tab4
-Tab4=Tab5
-Tab5=Tab6
-Tab6=Tab7
-Tab7=Tab8
-Tab8=Tab9
-Tab9=Tab10
-
-[Tab0]
-Button0_Name=Explorer
-Button0_Path=explorer.exe
-Button0_Params=
-Button0_Admin=0
-Button1_Name=Notepad
-Button1_Path=notepad.exe
-Button1_Params=
-Button1_Admin=0
-Button2_Name=Snipping Tool
-Button2_Path=snippingtool.exe
-Button2_Params=
-Button2_Admin=0
-Button3_Name=Paint
-Button3_Path=mspaint.exe
-Button3_Params=
-Button3_Admin=0
-Button4_Name=Calculator
-Button4_Path=calc.exe
-Button4_Params=
-Button4_Admin=0
-Button5_Name=Chrome
-Button5_Path=C:\Program Files\Google\Chrome\Application\chrome.exe
-Button5_Params=
-Button5_Admin=0
-Button6_Name=
-Button6_Path=
-Button6_Params=
-Button6_Admin=0
-Button7_Name=
-Button7_Path=
-Button7_Params=
-Button7_Admin=0
-Button8_Name=Task Manager
-Button8_Path=Taskmgr.exe
-Button8_Params=
-Button8_Admin=0
-Button9_Name=Command Prompt
-Button9_Path=cmd.exe
-Button9_Params=
-Button9_Admin=0
-Button10_Name=Remote Desktop
-Button10_Path=mstsc.exe
-Button10_Params=
-Button10_Admin=0
-Button11_Name=Sandbox
-Button11_Path=WindowsSandbox.exe
-Button11_Params=
-Button11_Admin=0
-Button12_Name=
-Button12_Path=
-Button12_Params=
-Button12_Admin=0
-Button13_Name=Desktop
-Button13_Path=explorer.exe
-Button13_Params=%USERPROFILE%\Desktop
-Button13_Admin=0
-Button14_Name=Downloads
-Button14_Path=explorer.exe
-Button14_Params=%USERPROFILE%\Downloads
-Button14_Admin=0
-Button15_Name=
-Button15_Path=
-Button15_Params=
-Button15_Admin=0
-
-[Tab1]
-Button0_Name=Device Manager
-Button0_Path=devmgmt.msc
-Button0_Params=
-Button0_Admin=0
-Button1_Name=Control Panel
-Button1_Path=control.exe
-Button1_Params=
-Button1_Admin=0
-Button2_Name=Disk Management
-Button2_Path=diskmgmt.msc
-Button2_Params=
-Button2_Admin=0
-Button3_Name=Computer Mgmt
-Button3_Path=compmgmt.msc
-Button3_Params=
-Button3_Admin=0
-Button4_Name=Programs
-Button4_Path=appwiz.cpl
-Button4_Params=
-Button4_Admin=0
-Button5_Name=System Info
-Button5_Path=msinfo32.exe
-Button5_Params=
-Button5_Admin=0
-
-[Tab2]
-Button0_Name=VS Code
-Button0_Path=code.exe
-Button0_Params=
-Button0_Admin=0
-Button1_Name=VS 2022
-Button1_Path=devenv.exe
-Button1_Params=
-Button1_Admin=0
-Button2_Name=VS Installer
-Button2_Path=C:\Program Files (x86)\Microsoft Visual Studio\Installer\setup.exe
-Button2_Params=
-Button2_Admin=0
-)";
-}
\ No newline at end of file
+ * @brief Subclass procedure for the list of programs under the path field. Clicking takes
+ *        a program without taking the focus from the field.
+ */
+LRESULT CALLBACK PathSuggestionListSubclassProcedure(HWND hList, UINT msg, WPARAM wParam, LPARAM lParam, UINT_PTR, DWORD_PTR)
+{
+    switch (msg)
+    {
+    case WM_MOUSEACTIVATE:
+        return MA_NOACTIVATE;
+
+    case WM_MOUSEMOVE:
+    case WM_LBUTTONDOWN:
+    {
+        LRESULT hit = SendMessageW(hList, LB_ITEMFROMPOINT, 0, lParam);
+        if (HIWORD(hit) == 0)
+        {
+            if (msg == WM_LBUTTONDOWN)
+            {
+                AcceptPathSuggestion(GetWindow(hList, GW_OWNER), LOWORD(hit));
+            }
+            else if (SendMessageW(hList, LB_GETCURSEL, 0, 0) != LOWORD(hit))
+            {
+                SendMessageW(hList, LB_SETCURSEL, LOWORD(hit), 0);
+            }
+        }
+        return 0;
+    }
+    }
+    return DefSubclassProc(hList, msg, wParam, lParam);
+}
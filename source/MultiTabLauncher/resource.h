@@ -8,6 +8,7 @@
 #define IDC_EDIT_PARAMS                 1003
 #define IDC_CHECK_ADMIN                 1004
 #define IDC_BUTTON_BROWSE               1005
+#define IDC_CHECK_SINGLEINSTANCE        1006
 #define IDD_TABMANAGER                  1100
 #define IDC_COMBO_TABCOUNT              1201
 #define IDC_TABNAME_BASE                1300
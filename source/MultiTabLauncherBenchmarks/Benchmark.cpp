@@ -0,0 +1,152 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+namespace
+{
+    thread_local uint64_t t_allocationCount = 0;
+    thread_local uint64_t t_allocatedBytes = 0;
+
+    double Percentile(const std::vector<double>& sorted, double fraction)
+    {
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[(std::min)(index, sorted.size() - 1)];
+    }
+}
+
+#if MTL_ENABLE_BENCHMARKS
+// Counting replacements of the global allocation functions; the array and
+// aligned-free forms forward to these by default.
+void* operator new(size_t size)
+{
+    ++t_allocationCount;
+    t_allocatedBytes += size;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    ++t_allocationCount;
+    t_allocatedBytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+#endif
+
+namespace Benchmark
+{
+    uint64_t GetThreadAllocationCount()
+    {
+        return t_allocationCount;
+    }
+
+    uint64_t GetThreadAllocatedBytes()
+    {
+        return t_allocatedBytes;
+    }
+
+    /**
+     * @brief Times an operation and appends the result to the suite.
+     * @param name The benchmark name, a string literal.
+     * @param samples The number of timed batches; percentiles are taken over these.
+     * @param callsPerSample How often the operation is called per batch.
+     * @param operation The operation to measure.
+     */
+    void Suite::Run(const char* name, size_t samples, size_t callsPerSample, const std::function<void()>& operation)
+    {
+        samples = (std::max)(samples, size_t(1));
+        callsPerSample = (std::max)(callsPerSample, size_t(1));
+
+        // One untimed call to warm up caches and lazily initialized state
+        operation();
+
+        // Reserved up front so that the suite itself allocates nothing while counting
+        std::vector<double> perCall;
+        perCall.reserve(samples);
+        uint64_t allocationsBefore = t_allocationCount;
+        uint64_t bytesBefore = t_allocatedBytes;
+        double totalNanoseconds = 0;
+
+        for (size_t sample = 0; sample < samples; ++sample)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t call = 0; call < callsPerSample; ++call)
+            {
+                operation();
+            }
+            double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            totalNanoseconds += elapsed;
+            perCall.push_back(elapsed / static_cast<double>(callsPerSample));
+        }
+
+        double totalCalls = static_cast<double>(samples * callsPerSample);
+        Result result;
+        result.name = name;
+        result.samples = samples;
+        result.callsPerSample = callsPerSample;
+        result.meanNanoseconds = totalNanoseconds / totalCalls;
+        result.callsPerSecond = totalNanoseconds > 0 ? totalCalls * 1e9 / totalNanoseconds : 0;
+        result.allocationsPerCall = static_cast<double>(t_allocationCount - allocationsBefore) / totalCalls;
+        result.bytesAllocatedPerCall = static_cast<double>(t_allocatedBytes - bytesBefore) / totalCalls;
+
+        std::sort(perCall.begin(), perCall.end());
+        result.minNanoseconds = perCall.front();
+        result.p50Nanoseconds = Percentile(perCall, 0.50);
+        result.p90Nanoseconds = Percentile(perCall, 0.90);
+        result.p99Nanoseconds = Percentile(perCall, 0.99);
+        result.maxNanoseconds = perCall.back();
+        m_results.push_back(result);
+    }
+
+    /**
+     * @brief Writes all results as a JSON document.
+     * @param filePath The file to create or overwrite.
+     * @return True on success, false on failure.
+     */
+    bool Suite::WriteJson(const std::filesystem::path& filePath) const
+    {
+        std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        out << "{\"allocationsCounted\":" << (MTL_ENABLE_BENCHMARKS ? "true" : "false") << ",\"benchmarks\":[";
+        for (size_t i = 0; i < m_results.size(); ++i)
+        {
+            const Result& r = m_results[i];
+            out << (i == 0 ? "\n" : ",\n")
+                << "{\"name\":\"" << r.name << "\""
+                << ",\"samples\":" << r.samples
+                << ",\"callsPerSample\":" << r.callsPerSample
+                << ",\"meanNs\":" << r.meanNanoseconds
+                << ",\"minNs\":" << r.minNanoseconds
+                << ",\"p50Ns\":" << r.p50Nanoseconds
+                << ",\"p90Ns\":" << r.p90Nanoseconds
+                << ",\"p99Ns\":" << r.p99Nanoseconds
+                << ",\"maxNs\":" << r.maxNanoseconds
+                << ",\"callsPerSecond\":" << r.callsPerSecond
+                << ",\"allocationsPerCall\":" << r.allocationsPerCall
+                << ",\"bytesPerCall\":" << r.bytesAllocatedPerCall
+                << "}";
+        }
+        out << "\n]}\n";
+        return out.good();
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+// Counts allocations by replacing the global operator new, so only benchmark builds may set
+// it: MultiTabLauncherBenchmarks.vcxproj and the LauncherBenchmarks CMake target define it
+// as 1. The launcher never links this file.
+#ifndef MTL_ENABLE_BENCHMARKS
+#define MTL_ENABLE_BENCHMARKS 0
+#endif
+
+/**
+ * @brief Repeatable timing of small operations, reported as machine-readable JSON.
+ *
+ * Each benchmark is run for a number of samples; a sample times a batch of calls so
+ * that operations far below the clock resolution can still be measured. Per-call
+ * times, throughput and heap allocations made by the calling thread are recorded
+ * and written with WriteJson(), so results from different builds can be compared.
+ */
+namespace Benchmark
+{
+    struct Result
+    {
+        const char* name{ nullptr }; // Must outlive the suite, as for trace events
+        size_t samples{ 0 };
+        size_t callsPerSample{ 0 };
+        double meanNanoseconds{ 0 };
+        double minNanoseconds{ 0 };
+        double p50Nanoseconds{ 0 };
+        double p90Nanoseconds{ 0 };
+        double p99Nanoseconds{ 0 };
+        double maxNanoseconds{ 0 };
+        double callsPerSecond{ 0 };
+        double allocationsPerCall{ 0 };
+        double bytesAllocatedPerCall{ 0 };
+    };
+
+    class Suite
+    {
+    public:
+        void Run(const char* name, size_t samples, size_t callsPerSample, const std::function<void()>& operation);
+        const std::vector<Result>& GetResults() const { return m_results; }
+        bool WriteJson(const std::filesystem::path& filePath) const;
+
+    private:
+        std::vector<Result> m_results;
+    };
+
+    // Heap allocations made by the calling thread so far; zero when MTL_ENABLE_BENCHMARKS is 0.
+    uint64_t GetThreadAllocationCount();
+    uint64_t GetThreadAllocatedBytes();
+}
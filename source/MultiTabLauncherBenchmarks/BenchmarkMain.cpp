@@ -0,0 +1,80 @@
+#include "PortableBenchmarks.h"
+#include "ConfigJson.h"
+#include "DefaultConfig.h"
+#include "InteractionReplay.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+    /**
+     * @brief Replays a session recorded with /record against a configuration in the JSON form
+     *        /convert writes, or the default one, and prints the report /replay writes.
+     * @return The exit code: 0 on success, 1 if the trace or configuration cannot be read.
+     */
+    int ReplayTrace(const char* tracePath, const char* configPath)
+    {
+        const int REPLAY_REPETITIONS = 10;
+
+        std::ifstream file(tracePath, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        InteractionTrace trace;
+        if (!file.is_open() || !trace.Parse(data))
+        {
+            std::fprintf(stderr, "Cannot read the interaction trace %s\n", tracePath);
+            return 1;
+        }
+
+        LauncherConfig config = GetDefaultLauncherConfig();
+        if (configPath)
+        {
+            std::ifstream configFile(configPath, std::ios::binary);
+            std::string error;
+            if (!configFile.is_open() || !ReadLauncherConfigJson(configFile, config, error))
+            {
+                std::fprintf(stderr, "Cannot read the configuration %s: %s\n", configPath, error.c_str());
+                return 1;
+            }
+        }
+        std::fputs(ReplayInteractions(config, trace, REPLAY_REPETITIONS).Format().c_str(), stdout);
+        return 0;
+    }
+}
+
+/**
+ * @brief Entry point of the LauncherBenchmarks CMake target: runs the portable benchmarks
+ *        and writes the results to the file given as the first argument, or to
+ *        MultiTabLauncher.bench.json in the current directory. With
+ *        "--replay <trace> [config.json]" it replays a recorded session instead.
+ */
+int main(int argc, char** argv)
+{
+    if (argc > 2 && std::strcmp(argv[1], "--replay") == 0)
+    {
+        return ReplayTrace(argv[2], argc > 3 ? argv[3] : nullptr);
+    }
+
+    std::filesystem::path resultPath = argc > 1 ? argv[1] : "MultiTabLauncher.bench.json";
+    std::error_code ec;
+    std::filesystem::path workDirectory = std::filesystem::temp_directory_path(ec);
+    if (ec) workDirectory = std::filesystem::current_path();
+
+    Benchmark::Suite suite;
+    RunPortableBenchmarks(suite, BenchmarkConfigurations(), workDirectory);
+    for (const Benchmark::Result& result : suite.GetResults())
+    {
+        std::printf("%-56s %14.1f ns %12.0f calls/s %8.1f allocs\n",
+            result.name, result.p50Nanoseconds, result.callsPerSecond, result.allocationsPerCall);
+    }
+    if (!suite.WriteJson(resultPath))
+    {
+        std::fprintf(stderr, "Cannot write %s\n", resultPath.string().c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "ConfigGenerator.h"
+
+#include <random>
+
+namespace
+{
+    const wchar_t* const PROGRAM_NAMES[] = {
+        L"notepad.exe", L"calc.exe", L"mspaint.exe", L"cmd.exe", L"explorer.exe",
+        L"devmgmt.msc", L"control.exe", L"code.exe", L"mstsc.exe", L"Taskmgr.exe"
+    };
+
+    const wchar_t* const LATIN_WORDS[] = {
+        L"Tools", L"Editor", L"Build", L"Server", L"Remote", L"Docs", L"Admin", L"Media"
+    };
+
+    const wchar_t* const UNICODE_WORDS[] = {
+        L"\uB3C4\uAD6C", L"\uD3B8\uC9D1\uAE30", L"\u5DE5\u5177", L"\u7DE8\u96C6",
+        L"Caf\u00E9", L"\u00DCbersicht", L"\u0421\u0435\u0440\u0432\u0435\u0440", L"\u6587\u66F8"
+    };
+
+    const wchar_t* const DIRECTORY_NAMES[] = {
+        L"Program Files", L"Vendor", L"Application Suite", L"bin", L"x64", L"Release", L"Tools"
+    };
+
+    template <typename T, size_t N>
+    const T& Pick(std::mt19937& random, const T(&items)[N])
+    {
+        return items[random() % N];
+    }
+
+    std::wstring MakeName(std::mt19937& random, bool unicode, int number)
+    {
+        std::wstring name = unicode && random() % 2 ? Pick(random, UNICODE_WORDS) : Pick(random, LATIN_WORDS);
+        return name + L" " + std::to_wstring(number);
+    }
+
+    std::wstring MakePath(std::mt19937& random, bool unicode, int minLength)
+    {
+        const wchar_t* program = Pick(random, PROGRAM_NAMES);
+        if (minLength <= 0) return program;
+
+        std::wstring path = L"C:";
+        while (static_cast<int>(path.length()) < minLength)
+        {
+            path += L'\\';
+            path += unicode && random() % 3 == 0 ? Pick(random, UNICODE_WORDS) : Pick(random, DIRECTORY_NAMES);
+        }
+        return path + L'\\' + program;
+    }
+}
+
+/**
+ * @brief Generates a configuration with the given number of tabs and grid size.
+ * @param options The shape of the configuration.
+ * @return The INI file contents.
+ */
+std::wstring GenerateSyntheticConfig(const GeneratorOptions& options)
+{
+    std::mt19937 random(options.seed);
+
+    std::wstring text;
+    text.reserve(static_cast<size_t>(options.tabCount) * options.buttonRows * options.buttonCols * (96 + options.pathLength));
+
+    text += L"[Tabs]\r\n";
+    text += L"Count=" + std::to_wstring(options.tabCount) + L"\r\n";
+    text += L"ButtonRows=" + std::to_wstring(options.buttonRows) + L"\r\n";
+    text += L"ButtonCols=" + std::to_wstring(options.buttonCols) + L"\r\n";
+    for (int tab = 0; tab < options.tabCount; ++tab)
+    {
+        text += L"Tab" + std::to_wstring(tab) + L"=" + MakeName(random, options.unicodeNames, tab + 1) + L"\r\n";
+    }
+
+    for (int tab = 0; tab < options.tabCount; ++tab)
+    {
+        text += L"\r\n[Tab" + std::to_wstring(tab) + L"]\r\n";
+
+        int buttonCount = options.buttonRows * options.buttonCols;
+        if (static_cast<int>(random() % 100) < options.tabGridPercent)
+        {
+            int rows = 1 + static_cast<int>(random() % 8);
+            int cols = 1 + static_cast<int>(random() % 12);
+            text += L"Rows=" + std::to_wstring(rows) + L"\r\nCols=" + std::to_wstring(cols) + L"\r\n";
+            buttonCount = rows * cols;
+        }
+
+        for (int btn = 0; btn < buttonCount; ++btn)
+        {
+            if (static_cast<int>(random() % 100) >= options.fillPercent) continue;
+
+            std::wstring keyBase = L"Button" + std::to_wstring(btn);
+            text += keyBase + L"_Name=" + MakeName(random, options.unicodeNames, btn + 1) + L"\r\n";
+            text += keyBase + L"_Path=" + MakePath(random, options.unicodeNames, options.pathLength) + L"\r\n";
+            text += keyBase + L"_Params=" + (random() % 4 == 0 ? L"%USERPROFILE%\\Documents" : L"") + L"\r\n";
+            text += keyBase + L"_Admin=" + (random() % 10 == 0 ? L"1" : L"0") + L"\r\n";
+        }
+    }
+    return text;
+}
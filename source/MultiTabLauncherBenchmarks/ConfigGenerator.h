@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Shape of a synthetic configuration produced by GenerateSyntheticConfig().
+struct GeneratorOptions
+{
+    int tabCount{ 10 };
+    int buttonRows{ 3 };
+    int buttonCols{ 8 };
+    int fillPercent{ 100 };     // Share of buttons that get a target; the rest are left empty
+    bool unicodeNames{ false }; // Mix Hangul, CJK and accented Latin into tab and button names
+    int pathLength{ 0 };        // Minimum length of generated paths; 0 for short program names
+    int tabGridPercent{ 0 };    // Share of tabs with their own Rows=/Cols= grid
+    uint32_t seed{ 1 };
+};
+
+/**
+ * @brief Builds the text of an INI file in the launcher's format from generated data.
+ *
+ * The output only depends on the options, so the same seed produces the same file on
+ * every platform and run. The result is meant for measurements and stress tests; it is
+ * written with WriteUtf16LeFile() like the default configuration.
+ */
+std::wstring GenerateSyntheticConfig(const GeneratorOptions& options);
@@ -0,0 +1,204 @@
+#include <windows.h>
+#include <filesystem>
+#include <string>
+#include "Benchmark.h"
+#include "ConfigGenerator.h"
+#include "ConfigModel.h"
+#include "IniDocument.h"
+#include "PortableBenchmarks.h"
+#include "SharedCatalog.h"
+
+// =============================================================
+//          Launcher Internals Measured Here (main.cpp)
+// =============================================================
+
+extern std::wstring g_executableDirectory;
+extern std::wstring g_configFilePath;
+extern LPCWSTR g_tabPageClassName;
+
+bool RegisterTabPageClass(HINSTANCE hInstance);
+void ShowTabPage(HWND hOldPage, HWND hNewPage);
+RECT GetButtonRect(const RECT& area, int rows, int cols, int buttonIndex);
+LauncherConfig ReadConfigurationModel(const std::wstring& filePath);
+bool SaveButtonConfigurationToFile(int tabIndex, int buttonIndex, const ButtonConfig& info);
+IniDocument ReadIniFile(const std::wstring& filePath);
+std::wstring DecodeIniText(const std::string& bytes);
+bool WriteUtf16LeFile(const wchar_t* filename, const std::wstring& text);
+std::wstring ResolveExecutablePath(const wchar_t* targetFile);
+std::wstring ExpandEnvironmentVariables(const std::wstring& str);
+
+namespace
+{
+    /**
+     * @brief Times switching between two tab pages of the given grid size.
+     */
+    void BenchmarkTabSwitch(Benchmark::Suite& suite, const char* name, int rows, int cols)
+    {
+        HINSTANCE hInstance = GetModuleHandle(NULL);
+        const RECT area = { 0, 0, 800, 600 };
+        HWND hHost = CreateWindowEx(0, g_tabPageClassName, L"", WS_POPUP | WS_CLIPCHILDREN,
+            area.left, area.top, area.right, area.bottom, NULL, NULL, hInstance, NULL);
+        if (!hHost)
+        {
+            return;
+        }
+
+        HWND hPages[2] = {};
+        for (HWND& hPage : hPages)
+        {
+            hPage = CreateWindowEx(0, g_tabPageClassName, L"", WS_CHILD | WS_CLIPCHILDREN,
+                area.left, area.top, area.right, area.bottom, hHost, NULL, hInstance, NULL);
+            for (int i = 0; i < rows * cols; ++i)
+            {
+                RECT rc = GetButtonRect(area, rows, cols, i);
+                CreateWindowEx(0, L"BUTTON", L"", WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
+                    rc.left, rc.top, rc.right - rc.left, rc.bottom - rc.top,
+                    hPage, (HMENU)(INT_PTR)(i + 1), hInstance, NULL);
+            }
+        }
+        ShowWindow(hPages[0], SW_SHOW);
+
+        int shown = 0;
+        suite.Run(name, 20, 10, [&]()
+            {
+                ShowTabPage(hPages[shown], hPages[1 - shown]);
+                shown = 1 - shown;
+            });
+
+        DestroyWindow(hHost);
+    }
+}
+
+/**
+ * @brief Runs the portable benchmarks, then measures configuration files, path helpers,
+ *        the button layout and tab switching with growing grids, and writes the results to
+ *        MultiTabLauncher.bench.json next to the executable. Runs without showing any
+ *        window; the INI next to the executable is not touched.
+ * @return True if all generated files could be written, false otherwise.
+ */
+bool RunBenchmarks()
+{
+    std::error_code ec;
+    std::filesystem::path tempDirectory = std::filesystem::temp_directory_path(ec);
+    if (ec) tempDirectory = g_executableDirectory;
+    std::wstring smallConfigPath = (tempDirectory / L"MultiTabLauncher.bench.small.ini").wstring();
+    std::wstring largeConfigPath = (tempDirectory / L"MultiTabLauncher.bench.large.ini").wstring();
+    std::wstring hugeConfigPath = (tempDirectory / L"MultiTabLauncher.bench.huge.ini").wstring();
+
+    BenchmarkConfigurations configurations;
+    if (!WriteUtf16LeFile(smallConfigPath.c_str(), GenerateSyntheticConfig(configurations.small)) ||
+        !WriteUtf16LeFile(largeConfigPath.c_str(), GenerateSyntheticConfig(configurations.large)) ||
+        !WriteUtf16LeFile(hugeConfigPath.c_str(), GenerateSyntheticConfig(configurations.huge)))
+    {
+        return false;
+    }
+
+    Benchmark::Suite suite;
+    RunPortableBenchmarks(suite, configurations, tempDirectory);
+
+    suite.Run("ReadConfigurationModel/small", 20, 1, [&]()
+        {
+            ReadConfigurationModel(smallConfigPath);
+        });
+    suite.Run("ReadConfigurationModel/large", 5, 1, [&]()
+        {
+            ReadConfigurationModel(largeConfigPath);
+        });
+    suite.Run("ReadConfigurationModel/10k tabs", 3, 1, [&]()
+        {
+            ReadConfigurationModel(hugeConfigPath);
+        });
+
+    // Decoding of the multi-megabyte catalog as UTF-8 with Unicode names and as plain ASCII
+    GeneratorOptions hugeUnicodeOptions = configurations.huge;
+    hugeUnicodeOptions.unicodeNames = true;
+    std::wstring hugeUnicodeText = GenerateSyntheticConfig(hugeUnicodeOptions);
+    int utf8Length = WideCharToMultiByte(CP_UTF8, 0, hugeUnicodeText.data(), static_cast<int>(hugeUnicodeText.size()), NULL, 0, NULL, NULL);
+    std::string hugeUtf8Bytes(utf8Length, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, hugeUnicodeText.data(), static_cast<int>(hugeUnicodeText.size()), hugeUtf8Bytes.data(), utf8Length, NULL, NULL);
+    hugeUtf8Bytes.insert(0, "\xEF\xBB\xBF");
+    std::wstring hugeAsciiText = GenerateSyntheticConfig(configurations.huge);
+    std::string hugeAsciiBytes(hugeAsciiText.begin(), hugeAsciiText.end());
+    suite.Run("DecodeIniText/10k tabs UTF-8", 10, 1, [&]()
+        {
+            DecodeIniText(hugeUtf8Bytes);
+        });
+    suite.Run("DecodeIniText/10k tabs ASCII", 10, 1, [&]()
+        {
+            DecodeIniText(hugeAsciiBytes);
+        });
+
+    // The same catalog mapped from a snapshot, as sessions on a shared host read it
+    std::wstring hugeSnapshotPath = (tempDirectory / L"MultiTabLauncher.bench.huge.catalog").wstring();
+    SharedCatalog hugeCatalog;
+    if (SharedCatalog::Publish(ReadIniFile(hugeConfigPath), hugeSnapshotPath) && hugeCatalog.Open(hugeSnapshotPath))
+    {
+        IniDocument emptyOverlay;
+        suite.Run("ParseLauncherConfig/10k tabs snapshot", 3, 1, [&]()
+            {
+                ParseLauncherConfig(hugeCatalog.GetDocument(), emptyOverlay);
+            });
+        suite.Run("SharedCatalog::Open/10k tabs", 5, 1, [&]()
+            {
+                hugeCatalog.Open(hugeSnapshotPath);
+            });
+    }
+
+    // Saving writes to g_configFilePath, so point it at the generated file meanwhile
+    LauncherConfig largeConfig = ReadConfigurationModel(largeConfigPath);
+    std::wstring configFilePath = g_configFilePath;
+    g_configFilePath = largeConfigPath;
+    int saveIndex = 0;
+    suite.Run("SaveButtonConfigurationToFile/large", 20, 5, [&]()
+        {
+            int tab = saveIndex % largeConfig.GetTabCount();
+            const std::vector<ButtonConfig>& buttons = largeConfig.tabs[tab].buttons;
+            int btn = (saveIndex / largeConfig.GetTabCount()) % static_cast<int>(buttons.size());
+            SaveButtonConfigurationToFile(tab, btn, buttons[btn]);
+            ++saveIndex;
+        });
+    g_configFilePath = configFilePath;
+
+    suite.Run("ResolveExecutablePath/found", 20, 10, []()
+        {
+            ResolveExecutablePath(L"notepad.exe");
+        });
+    suite.Run("ResolveExecutablePath/missing", 20, 10, []()
+        {
+            ResolveExecutablePath(L"MultiTabLauncher.missing.exe");
+        });
+    suite.Run("ExpandEnvironmentVariables/variable", 50, 100, []()
+        {
+            ExpandEnvironmentVariables(L"%USERPROFILE%\\Documents");
+        });
+    suite.Run("ExpandEnvironmentVariables/plain", 50, 100, []()
+        {
+            ExpandEnvironmentVariables(L"C:\\Windows\\System32\\notepad.exe");
+        });
+
+    const RECT area = { 0, 0, 1920, 1080 };
+    volatile LONG layoutSink = 0; // Keeps the layout loop from being optimized away
+    suite.Run("GetButtonRect/grid", 50, 100, [&]()
+        {
+            int count = configurations.large.buttonRows * configurations.large.buttonCols;
+            for (int i = 0; i < count; ++i)
+            {
+                layoutSink = GetButtonRect(area, configurations.large.buttonRows, configurations.large.buttonCols, i).right;
+            }
+        });
+
+    // Switching should cost the same for every grid size
+    if (RegisterTabPageClass(GetModuleHandle(NULL)))
+    {
+        BenchmarkTabSwitch(suite, "SwitchTab/3x8", 3, 8);
+        BenchmarkTabSwitch(suite, "SwitchTab/16x16", 16, 16);
+        BenchmarkTabSwitch(suite, "SwitchTab/64x64", MAX_GRID_DIMENSION, MAX_GRID_DIMENSION);
+    }
+
+    DeleteFileW(smallConfigPath.c_str());
+    DeleteFileW(largeConfigPath.c_str());
+    DeleteFileW(hugeConfigPath.c_str());
+    hugeCatalog.Close();
+    DeleteFileW(hugeSnapshotPath.c_str());
+    return suite.WriteJson(std::filesystem::path(g_executableDirectory) / L"MultiTabLauncher.bench.json");
+}
@@ -0,0 +1,432 @@
+#include "PortableBenchmarks.h"
+#include "BgraImage.h"
+#include "CatalogSync.h"
+#include "CompletionQueue.h"
+#include "ConfigJson.h"
+#include "ConfigModel.h"
+#include "DefaultConfig.h"
+#include "IniDocument.h"
+#include "InteractionReplay.h"
+#include "InteractionTrace.h"
+#include "LatencyHistogram.h"
+#include "ProgramIndex.h"
+#include "ResourceAccountant.h"
+#include "SimdLevel.h"
+#include "TargetChecker.h"
+#include "TaskExecutor.h"
+#include "TextKernels.h"
+#include "Trace.h"
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // As many completions as the path box of the button dialog shows
+    const size_t MAX_PATH_SUGGESTIONS = 8;
+}
+
+BenchmarkConfigurations::BenchmarkConfigurations()
+{
+    large.tabCount = 50;
+    large.buttonRows = 6;
+    large.buttonCols = 12;
+    large.fillPercent = 30;
+    large.unicodeNames = true;
+    large.pathLength = 200;
+    huge.tabCount = 10000;
+    huge.fillPercent = 30;
+    huge.tabGridPercent = 20;
+}
+
+void RunPortableBenchmarks(Benchmark::Suite& suite, const BenchmarkConfigurations& configurations,
+                           const std::filesystem::path& workDirectory)
+{
+    std::error_code ec;
+
+    suite.Run("GenerateSyntheticConfig/large", 10, 1, [&]()
+        {
+            GenerateSyntheticConfig(configurations.large);
+        });
+
+    // A first run without an INI file, from the built-in table and by parsing the default text
+    suite.Run("GetDefaultLauncherConfig", 50, 10, [&]()
+        {
+            GetDefaultLauncherConfig();
+        });
+    suite.Run("ParseLauncherConfig/default text", 50, 10, [&]()
+        {
+            IniDocument document;
+            document.Parse(GetDefaultConfigString());
+            ParseLauncherConfig(document, IniDocument());
+        });
+
+    std::wstring hugeAsciiText = GenerateSyntheticConfig(configurations.huge);
+    std::string hugeAsciiBytes(hugeAsciiText.begin(), hugeAsciiText.end());
+    suite.Run("IniDocument::Parse/10k tabs", 5, 1, [&]()
+        {
+            IniDocument document;
+            document.Parse(hugeAsciiText);
+        });
+
+    // The catalog with Unicode names as JSON, read from memory and streamed from a file
+    GeneratorOptions hugeUnicodeOptions = configurations.huge;
+    hugeUnicodeOptions.unicodeNames = true;
+    IniDocument hugeUnicodeDocument;
+    hugeUnicodeDocument.Parse(GenerateSyntheticConfig(hugeUnicodeOptions));
+    LauncherConfig hugeUnicodeConfig = ParseLauncherConfig(IniDocument(), hugeUnicodeDocument);
+    std::ostringstream hugeJsonStream;
+    WriteLauncherConfigJson(hugeUnicodeConfig, hugeJsonStream);
+    std::string hugeJson = hugeJsonStream.str();
+    std::filesystem::path hugeJsonPath = workDirectory / L"MultiTabLauncher.bench.huge.json";
+    {
+        std::ofstream hugeJsonFile(hugeJsonPath, std::ios::binary);
+        hugeJsonFile.write(hugeJson.data(), hugeJson.size());
+    }
+    std::string jsonError;
+    suite.Run("ReadLauncherConfigJson/10k tabs", 5, 1, [&]()
+        {
+            LauncherConfig config;
+            ReadLauncherConfigJson(hugeJson, config, jsonError);
+        });
+    suite.Run("ReadLauncherConfigJson/10k tabs file", 5, 1, [&]()
+        {
+            LauncherConfig config;
+            std::ifstream file(hugeJsonPath, std::ios::binary);
+            ReadLauncherConfigJson(file, config, jsonError);
+        });
+    suite.Run("WriteLauncherConfigJson/10k tabs", 5, 1, [&]()
+        {
+            std::ostringstream stream;
+            WriteLauncherConfigJson(hugeUnicodeConfig, stream);
+        });
+    suite.Run("FormatLauncherConfig/10k tabs", 5, 1, [&]()
+        {
+            FormatLauncherConfig(hugeUnicodeConfig);
+        });
+
+    // Syncing the catalog from a pack after one tab in the middle was edited, alternating
+    // between the two versions so every sync fetches the changed chunk
+    std::filesystem::path syncDirectory = workDirectory / L"MultiTabLauncher.bench.sync";
+    std::string editedAsciiBytes = hugeAsciiBytes;
+    size_t editedTab = editedAsciiBytes.find("[Tab5000]");
+    if (editedTab != std::string::npos)
+    {
+        editedAsciiBytes.insert(editedAsciiBytes.find('\n', editedTab) + 1, "; Edited\r\n");
+    }
+    if (CatalogSync::PublishPack(hugeAsciiBytes, syncDirectory / L"original") &&
+        CatalogSync::PublishPack(editedAsciiBytes, syncDirectory / L"edited"))
+    {
+        DirectoryCatalogStore originalPack(syncDirectory / L"original");
+        DirectoryCatalogStore editedPack(syncDirectory / L"edited");
+        std::string syncedText;
+        CatalogSync(originalPack, syncDirectory / L"cache").Sync(syncedText);
+        int syncIndex = 0;
+        suite.Run("CatalogSync::Sync/10k tabs one tab edited", 5, 1, [&]()
+            {
+                CatalogSync sync(++syncIndex % 2 ? editedPack : originalPack, syncDirectory / L"cache");
+                sync.Sync(syncedText);
+            });
+    }
+    suite.Run("SplitCatalogChunks/10k tabs", 10, 1, [&]()
+        {
+            SplitCatalogChunks(hugeAsciiBytes);
+        });
+
+    const std::wstring paddedName = L"  \t Command Prompt  \t ";
+    volatile size_t trimSink = 0;
+    suite.Run("TrimBlanks", 50, 1000, [&]()
+        {
+            trimSink = TrimBlanks(paddedName).size();
+        });
+
+    // Launch latency histograms after a year of daily launches, as kept in the usage file
+    LatencyHistogram latency;
+    uint32_t latencySeed = 1;
+    auto nextLatency = [&]()
+        {
+            // Mostly 100-400 ms with a tail up to a few seconds
+            latencySeed = latencySeed * 1664525 + 1013904223;
+            uint64_t value = 100000 + (latencySeed >> 8) % 300000;
+            return (latencySeed & 0xF) == 0 ? value * 10 : value;
+        };
+    for (int i = 0; i < 365; ++i)
+    {
+        latency.Record(nextLatency());
+    }
+    std::wstring latencyText = latency.Serialize();
+    suite.Run("LatencyHistogram::Record", 50, 1000, [&]()
+        {
+            latency.Record(nextLatency());
+        });
+    suite.Run("LatencyHistogram::GetPercentile", 50, 100, [&]()
+        {
+            latency.GetPercentile(99);
+        });
+    suite.Run("LatencyHistogram::Serialize", 50, 10, [&]()
+        {
+            latency.Serialize();
+        });
+    suite.Run("LatencyHistogram::Parse", 50, 10, [&]()
+        {
+            LatencyHistogram parsed;
+            parsed.Parse(latencyText);
+        });
+
+    // Instrumentation left in hot paths: compiled in and off, as in a normal run, and on
+    bool wasTracing = Trace::IsEnabled();
+    Trace::SetEnabled(false);
+    suite.Run("TRACE_SCOPE/disabled", 50, 10000, [&]()
+        {
+            TRACE_SCOPE("Benchmark");
+        });
+    Trace::SetEnabled(true);
+    suite.Run("TRACE_SCOPE/enabled", 50, 10000, [&]()
+        {
+            TRACE_SCOPE("Benchmark");
+        });
+    Trace::SetEnabled(wasTracing);
+
+    // Choosing pages to release when 1,000 loaded tabs of 64 buttons exceed the icon budget
+    std::vector<PageUsage> loadedPages(1000);
+    for (int i = 0; i < static_cast<int>(loadedPages.size()); ++i)
+    {
+        loadedPages[i] = { i, 64, 65, static_cast<uint64_t>(i) * 2654435761u % 100000 };
+    }
+    ResourceLimits pageLimits;
+    pageLimits.maxIcons = 3000;
+    suite.Run("ResourceAccountant::SelectPagesOverLimits/1000 pages", 50, 10, [&]()
+        {
+            ResourceAccountant::SelectPagesOverLimits(loadedPages, pageLimits, 64000, 65000, 0);
+        });
+
+    // Icon scaling from the common extraction sizes to the sizes of 100% to 200% displays
+    BgraImage jumboIcon;
+    jumboIcon.width = 256;
+    jumboIcon.height = 256;
+    jumboIcon.pixels.resize(256 * 256);
+    for (size_t i = 0; i < jumboIcon.pixels.size(); ++i)
+    {
+        jumboIcon.pixels[i] = static_cast<uint32_t>(i * 2654435761u) | (i % 7 == 0 ? 0 : 0xFF000000);
+    }
+    BgraImage largeIcon = ResizeBgra(jumboIcon, 48, 48);
+    suite.Run("ResizeBgra/256 to 64", 20, 10, [&]()
+        {
+            ResizeBgra(jumboIcon, 64, 64);
+        });
+    suite.Run("ResizeBgra/48 to 40", 20, 100, [&]()
+        {
+            ResizeBgra(largeIcon, 40, 40);
+        });
+
+    // The vector kernels at every instruction set the processor has
+    std::string hugeUtf8Bytes;
+    AppendUtf8(GenerateSyntheticConfig(hugeUnicodeOptions), hugeUtf8Bytes);
+    std::wstring decodedText;
+    std::string encodedBytes;
+    // Result names must outlive the suite, hence one literal per level
+    struct SimdCase
+    {
+        SimdLevel level;
+        const char* decodeName;
+        const char* findName;
+        const char* encodeName;
+        const char* resizeName;
+    };
+    const SimdCase simdCases[] = {
+        { SimdLevel::Scalar, "DecodeUtf8/10k tabs/scalar", "FindChar/10k tabs line ends/scalar", "AppendUtf8/10k tabs/scalar", "ResizeBgra/256 to 48/scalar" },
+        { SimdLevel::Sse2, "DecodeUtf8/10k tabs/SSE2", "FindChar/10k tabs line ends/SSE2", "AppendUtf8/10k tabs/SSE2", "ResizeBgra/256 to 48/SSE2" },
+        { SimdLevel::Avx2, "DecodeUtf8/10k tabs/AVX2", "FindChar/10k tabs line ends/AVX2", "AppendUtf8/10k tabs/AVX2", "ResizeBgra/256 to 48/AVX2" },
+    };
+    for (const SimdCase& simdCase : simdCases)
+    {
+        LimitSimdLevel(simdCase.level);
+        if (GetSimdLevel() != simdCase.level)
+        {
+            continue;
+        }
+        suite.Run(simdCase.decodeName, 10, 1, [&]()
+            {
+                DecodeUtf8(hugeUtf8Bytes, decodedText);
+            });
+        suite.Run(simdCase.findName, 10, 1, [&]()
+            {
+                const wchar_t* last = hugeAsciiText.data() + hugeAsciiText.size();
+                for (const wchar_t* line = hugeAsciiText.data(); line != last; ++line)
+                {
+                    line = FindChar(line, last, L'\n');
+                    if (line == last) break;
+                }
+            });
+        suite.Run(simdCase.encodeName, 10, 1, [&]()
+            {
+                encodedBytes.clear();
+                AppendUtf8(decodedText, encodedBytes);
+            });
+        suite.Run(simdCase.resizeName, 20, 10, [&]()
+            {
+                ResizeBgra(jumboIcon, 48, 48);
+            });
+    }
+    LimitSimdLevel(SimdLevel::Avx2);
+
+    // A whole session end to end: every tab visited, a drag resize, launches and edits
+    IniDocument largeDocument;
+    largeDocument.Parse(GenerateSyntheticConfig(configurations.large));
+    LauncherConfig largeConfig = ParseLauncherConfig(IniDocument(), largeDocument);
+    InteractionTrace session = GenerateSyntheticSession(largeConfig, 1);
+    volatile size_t replaySink = 0;
+    suite.Run("ReplayInteractions/50 tabs session", 10, 1, [&]()
+        {
+            replaySink = ReplayInteractions(largeConfig, session, 1).replayed;
+        });
+
+    // Dispatch overhead of the shared executor, with tasks too small to hide it
+    {
+        TaskExecutor executor;
+        if (executor.Start())
+        {
+            std::atomic<int> taskSink{ 0 };
+            suite.Run("TaskExecutor/1000 tasks", 50, 1, [&]()
+                {
+                    for (int i = 0; i < 1000; ++i)
+                    {
+                        executor.Submit(TaskPriority::Background, [&taskSink]() { taskSink++; });
+                    }
+                    executor.WaitUntilIdle();
+                });
+            suite.Run("TaskExecutor/1000 tasks from a worker", 50, 1, [&]()
+                {
+                    // Nested submissions stay on the submitting worker until others steal them
+                    executor.Submit(TaskPriority::Visible, [&executor, &taskSink]()
+                        {
+                            for (int i = 0; i < 1000; ++i)
+                            {
+                                executor.Submit(TaskPriority::Background, [&taskSink]() { taskSink++; });
+                            }
+                        });
+                    executor.WaitUntilIdle();
+                });
+            // What a part of the launcher pays to stop with its work still queued
+            TaskGroup group;
+            suite.Run("TaskGroup/stop with 1000 tasks queued", 50, 1, [&]()
+                {
+                    group.Start(executor);
+                    for (int i = 0; i < 1000; ++i)
+                    {
+                        group.Submit(TaskPriority::Background, [&taskSink]() { taskSink++; });
+                    }
+                    group.Stop();
+                });
+        }
+    }
+
+    // Handing results back to the UI thread: producers must not contend, and a drain must
+    // stop at its budget however much is queued
+    {
+        CompletionQueue completions;
+        suite.Run("CompletionQueue/10k completions from 4 threads", 20, 1, [&]()
+            {
+                int completed = 0;
+                std::vector<std::thread> producers;
+                for (int producer = 0; producer < 4; ++producer)
+                {
+                    producers.emplace_back([&completions, &completed]()
+                        {
+                            for (int i = 0; i < 2500; ++i)
+                            {
+                                completions.Push([&completed]() { completed++; });
+                            }
+                        });
+                }
+                while (completed < 10000)
+                {
+                    completions.Drain(std::chrono::milliseconds(4));
+                }
+                for (std::thread& producer : producers) producer.join();
+            });
+        suite.Run("CompletionQueue/drain 10k in 1 ms slices", 20, 1, [&]()
+            {
+                for (int i = 0; i < 10000; ++i)
+                {
+                    completions.Push([]() {});
+                }
+                while (completions.Drain(std::chrono::milliseconds(1)).hasMore)
+                {
+                }
+            });
+    }
+
+    // Indexing a PATH of 100 directories with 1000 programs each, and completing against
+    // it; the index's own memory shows in the allocations of the build
+    std::filesystem::path programDirectory = workDirectory / L"MultiTabLauncher.bench.programs";
+    std::vector<ProgramIndexDirectory> programDirectories;
+    for (int directory = 0; directory < 100; ++directory)
+    {
+        std::filesystem::path path = programDirectory / (L"bin" + std::to_wstring(directory));
+        std::filesystem::create_directories(path, ec);
+        for (int file = 0; file < 1000; ++file)
+        {
+            std::wstring name = (file % 2 ? L"Tool" : L"app") + std::to_wstring(directory) + L"_" + std::to_wstring(file) + L".exe";
+            std::ofstream program(path / name, std::ios::binary);
+        }
+        programDirectories.push_back({ path.wstring(), false });
+    }
+    const std::vector<std::wstring> programExtensions = { L".exe", L".lnk" };
+    ProgramIndex programIndex;
+    suite.Run("ProgramIndex::Build/100k files", 3, 1, [&]()
+        {
+            programIndex = ProgramIndex();
+            programIndex.Build(programDirectories, programExtensions);
+        });
+    volatile size_t completionSink = 0;
+    suite.Run("ProgramIndex::Complete/prefix", 50, 10, [&]()
+        {
+            completionSink = programIndex.Complete(L"tool77_", MAX_PATH_SUGGESTIONS).size();
+        });
+    suite.Run("ProgramIndex::Complete/fuzzy", 20, 1, [&]()
+        {
+            completionSink = programIndex.Complete(L"tl42", MAX_PATH_SUGGESTIONS).size();
+        });
+    suite.Run("ProgramIndex::RescanDirectory/1000 files", 10, 1, [&]()
+        {
+            programIndex.RescanDirectory(50);
+        });
+
+    // Checking 5000 button targets spread over a tree of 100 directories, a tenth of them
+    // missing: every directory listed afresh, and a pass within the listings' time-to-live
+    std::filesystem::path targetDirectory = workDirectory / L"MultiTabLauncher.bench.targets";
+    std::vector<TargetCheck> targets(5000);
+    for (int i = 0; i < static_cast<int>(targets.size()); ++i)
+    {
+        std::filesystem::path path = targetDirectory / (L"vendor" + std::to_wstring(i % 10)) /
+            (L"product" + std::to_wstring(i % 100)) / (L"tool" + std::to_wstring(i) + L".exe");
+        if (i % 10 != 3)
+        {
+            std::filesystem::create_directories(path.parent_path(), ec);
+            std::ofstream target(path, std::ios::binary);
+        }
+        targets[i].expandedPath = path.wstring();
+    }
+    FileSystemDirectoryLister targetLister;
+    suite.Run("TargetValidator/5000 paths over 100 dirs", 10, 1, [&]()
+        {
+            TargetChecker checker;
+            checker.CheckAll(targetLister, targets, L"", {}, 0, CancellationToken());
+        });
+    TargetChecker cachedChecker;
+    cachedChecker.CheckAll(targetLister, targets, L"", {}, 0, CancellationToken());
+    suite.Run("TargetValidator/5000 paths over 100 dirs cached", 20, 1, [&]()
+        {
+            cachedChecker.CheckAll(targetLister, targets, L"", {}, 1000, CancellationToken());
+        });
+
+    std::filesystem::remove(hugeJsonPath, ec);
+    std::filesystem::remove_all(syncDirectory, ec);
+    std::filesystem::remove_all(programDirectory, ec);
+    std::filesystem::remove_all(targetDirectory, ec);
+}
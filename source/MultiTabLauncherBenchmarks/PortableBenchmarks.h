@@ -0,0 +1,27 @@
+#pragma once
+
+#include <filesystem>
+#include "Benchmark.h"
+#include "ConfigGenerator.h"
+
+// The generated configurations the benchmarks run against
+struct BenchmarkConfigurations
+{
+    GeneratorOptions small;     // The default grid
+    GeneratorOptions large;     // 50 tabs of 6x12 buttons with Unicode names and long paths
+    GeneratorOptions huge;      // 10,000 tabs, some with their own grid size
+
+    BenchmarkConfigurations();
+};
+
+/**
+ * @brief Measures the launcher modules that are standard C++: configuration parsing and
+ *        JSON, catalog sync, histograms, resource accounting, icon scaling, replay, the
+ *        task executor, the completion queue and the program index.
+ *
+ * Shared by MultiTabLauncherBenchmarks.exe, which adds the Win32 cases, and the
+ * LauncherBenchmarks CMake target. Generated files go to workDirectory and are removed
+ * afterwards.
+ */
+void RunPortableBenchmarks(Benchmark::Suite& suite, const BenchmarkConfigurations& configurations,
+                           const std::filesystem::path& workDirectory);
@@ -0,0 +1,135 @@
+#include "TestHarness.h"
+#include "BgraImage.h"
+#include "SimdLevel.h"
+
+#include <random>
+
+namespace
+{
+    BgraImage MakeImage(int width, int height, uint32_t pixel)
+    {
+        BgraImage image;
+        image.width = width;
+        image.height = height;
+        image.pixels.assign(static_cast<size_t>(width) * height, pixel);
+        return image;
+    }
+
+    // Random colors, with a share of fully transparent and fully opaque pixels as icons have
+    BgraImage MakeNoise(int width, int height, unsigned seed)
+    {
+        std::mt19937 random(seed);
+        BgraImage image = MakeImage(width, height, 0);
+        for (uint32_t& pixel : image.pixels)
+        {
+            uint32_t alpha = random() % 4 == 0 ? 0 : random() % 2 == 0 ? 255 : random() % 256;
+            pixel = (alpha << 24) | (random() & 0xFFFFFF);
+        }
+        return image;
+    }
+
+    BgraImage ResizeWith(SimdLevel level, const BgraImage& source, int width, int height)
+    {
+        LimitSimdLevel(level);
+        BgraImage result = ResizeBgra(source, width, height);
+        LimitSimdLevel(SimdLevel::Avx2);
+        return result;
+    }
+}
+
+TEST_CASE(UniformImagesStayUniform)
+{
+    const BgraImage source = MakeImage(48, 48, 0xFF336699u);
+    for (int size : { 16, 17, 36, 40, 48, 64, 97 })
+    {
+        BgraImage result = ResizeBgra(source, size, size);
+        REQUIRE(result.width == size && result.height == size);
+        for (uint32_t pixel : result.pixels)
+        {
+            CHECK(pixel == 0xFF336699u);
+        }
+    }
+}
+
+TEST_CASE(TransparentPixelsDoNotBleed)
+{
+    // Opaque blue on the left, transparent green on the right
+    BgraImage source = MakeImage(256, 256, 0);
+    for (int y = 0; y < 256; ++y)
+    {
+        for (int x = 0; x < 128; ++x)
+        {
+            source.pixels[y * 256 + x] = 0xFF0000FFu;
+        }
+        for (int x = 128; x < 256; ++x)
+        {
+            source.pixels[y * 256 + x] = 0x0000FF00u;
+        }
+    }
+
+    BgraImage result = ResizeBgra(source, 48, 48);
+    for (int x = 0; x < 48; ++x)
+    {
+        uint32_t pixel = result.pixels[24 * 48 + x];
+        // Wherever the edge leaves any alpha, the color is pure blue
+        if (pixel >> 24)
+        {
+            CHECK((pixel & 0xFFFFFF) == 0x0000FF);
+        }
+    }
+    CHECK(result.pixels[24 * 48] == 0xFF0000FFu);
+    CHECK(result.pixels[24 * 48 + 47] == 0);
+}
+
+TEST_CASE(EmptySizesGiveEmptyImages)
+{
+    CHECK(ResizeBgra(BgraImage(), 32, 32).IsEmpty());
+    CHECK(ResizeBgra(MakeImage(4, 4, 0xFFFFFFFFu), 0, 32).IsEmpty());
+}
+
+TEST_CASE(VectorAndScalarPathsGiveIdenticalPixels)
+{
+    if (GetSimdLevel() < SimdLevel::Sse2)
+    {
+        TestHarness::Report("No SSE2 path in this build", 0, "");
+        return;
+    }
+
+    struct Size { int sourceWidth, sourceHeight, width, height; };
+    const Size sizes[] = {
+        { 256, 256, 48, 48 }, { 256, 256, 20, 20 }, { 48, 48, 40, 40 }, { 32, 32, 96, 96 },
+        { 1, 1, 7, 3 }, { 37, 11, 5, 29 }, { 64, 64, 64, 64 },
+    };
+    unsigned seed = 1;
+    for (const Size& size : sizes)
+    {
+        BgraImage source = MakeNoise(size.sourceWidth, size.sourceHeight, seed++);
+        BgraImage scalar = ResizeWith(SimdLevel::Scalar, source, size.width, size.height);
+        BgraImage vector = ResizeWith(SimdLevel::Sse2, source, size.width, size.height);
+        REQUIRE(scalar.pixels.size() == vector.pixels.size());
+        CHECK(scalar.pixels == vector.pixels);
+    }
+}
+
+TEST_CASE(BothPathsAreTimed)
+{
+    const BgraImage source = MakeNoise(256, 256, 7);
+    double elapsed[2] = {};
+    for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::Sse2 })
+    {
+        LimitSimdLevel(level);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 50; ++i)
+        {
+            ResizeBgra(source, 48, 48);
+        }
+        elapsed[static_cast<int>(level)] = TestHarness::ElapsedMs(start) * 1000.0 / 50;
+    }
+    LimitSimdLevel(SimdLevel::Avx2);
+
+    TestHarness::Report("256 to 48 pixels, scalar", elapsed[0], "us");
+    if (GetSimdLevel() >= SimdLevel::Sse2)
+    {
+        TestHarness::Report("256 to 48 pixels, SSE2", elapsed[1], "us");
+    }
+}
@@ -0,0 +1,311 @@
+#include "TestHarness.h"
+#include "BrokerDispatcher.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace
+{
+    /**
+     * @brief A connection to a dispatcher over a socket pair, standing in for the broker's
+     *        pipe: a thread feeds what arrives to the dispatcher and writes back its output,
+     *        and closes its end when the dispatcher ends the connection.
+     */
+    class BrokerConnection
+    {
+    public:
+        explicit BrokerConnection(BrokerDispatcher& dispatcher)
+        {
+            int sockets[2] = { -1, -1 };
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) return;
+            m_socket = sockets[0];
+            m_server = std::thread([&dispatcher, serverSocket = sockets[1]]()
+                {
+                    char buffer[4096];
+                    ssize_t length;
+                    while ((length = read(serverSocket, buffer, sizeof(buffer))) > 0)
+                    {
+                        std::string output;
+                        bool isOpen = dispatcher.OnBytes(buffer, static_cast<size_t>(length), output);
+                        if (!output.empty() && write(serverSocket, output.data(), output.size()) < 0) break;
+                        if (!isOpen) break;
+                    }
+                    close(serverSocket);
+                });
+        }
+
+        ~BrokerConnection() { Close(); }
+
+        BrokerConnection(const BrokerConnection&) = delete;
+        BrokerConnection& operator=(const BrokerConnection&) = delete;
+
+        bool IsOpen() const { return m_socket >= 0; }
+
+        // Sends the bytes at once, or one write per byte to split every frame. Bytes sent
+        // after the dispatcher closed the connection are lost, as on a broken pipe.
+        void Send(const std::string& bytes, bool isSplit = false)
+        {
+            size_t chunk = isSplit ? 1 : bytes.size();
+            for (size_t offset = 0; offset < bytes.size(); offset += chunk)
+            {
+                if (send(m_socket, bytes.data() + offset, chunk, MSG_NOSIGNAL) < 0) return;
+            }
+        }
+
+        // Returns false once the dispatcher closed the connection
+        bool Receive(BrokerReply& reply)
+        {
+            std::string payload;
+            while (!m_reader.Next(payload))
+            {
+                char buffer[256];
+                ssize_t length = read(m_socket, buffer, sizeof(buffer));
+                if (length <= 0) return false;
+                m_reader.Append(buffer, static_cast<size_t>(length));
+            }
+            return DecodeBrokerReply(payload, reply);
+        }
+
+        // Closes the launcher's end and waits for the dispatcher's thread
+        void Close()
+        {
+            if (m_socket >= 0) close(m_socket);
+            m_socket = -1;
+            if (m_server.joinable()) m_server.join();
+        }
+
+    private:
+        int m_socket{ -1 };
+        std::thread m_server;
+        BrokerFrameReader m_reader;
+    };
+
+    // Two tabs: regedit and cmd run as administrator, notepad does not
+    LauncherConfig MakeConfig()
+    {
+        LauncherConfig config;
+        config.tabs.resize(2);
+        config.tabs[0].buttons.resize(3);
+        config.tabs[0].buttons[0].path = L"C:\\Tools\\regedit.exe";
+        config.tabs[0].buttons[0].adminMode = true;
+        config.tabs[0].buttons[1].path = L"notepad.exe";
+        config.tabs[1].buttons.resize(1);
+        config.tabs[1].buttons[0].path = L"cmd.exe";
+        config.tabs[1].buttons[0].parameters = L"/k \u00E9cho \u00FCn\u00EFcode";
+        config.tabs[1].buttons[0].adminMode = true;
+        return config;
+    }
+
+    std::string MakeToken()
+    {
+        std::string token(BROKER_TOKEN_SIZE, '\0');
+        for (size_t i = 0; i < token.size(); ++i) token[i] = static_cast<char>(i * 37 + 11);
+        return token;
+    }
+
+    BrokerHello MakeHello(const std::string& token)
+    {
+        BrokerHello hello;
+        hello.token = token;
+        return hello;
+    }
+
+    BrokerLaunchRequest MakeRequest(uint32_t requestId, int32_t tab, int32_t button, const wchar_t* path,
+                                    const wchar_t* parameters = L"")
+    {
+        BrokerLaunchRequest request;
+        request.requestId = requestId;
+        request.tab = tab;
+        request.button = button;
+        request.path = path;
+        request.parameters = parameters;
+        return request;
+    }
+
+    // Counts the launches it is asked for, from the dispatcher's thread
+    struct LaunchCounter
+    {
+        std::atomic<uint32_t> launches{ 0 };
+
+        BrokerLaunchFunction GetFunction()
+        {
+            return [this](const ButtonConfig&)
+                {
+                    BrokerReply reply;
+                    reply.status = BrokerStatus::Launched;
+                    reply.processId = 1000 + launches++;
+                    reply.processHandle = 0x1234;
+                    return reply;
+                };
+        }
+    };
+}
+
+TEST_CASE(TokensRoundTripAsText)
+{
+    std::string token = MakeToken();
+    std::string parsed;
+    CHECK(ParseBrokerToken(FormatBrokerToken(token), parsed) && parsed == token);
+    CHECK(!ParseBrokerToken(L"00", parsed));
+}
+
+TEST_CASE(OnlyAdministratorButtonsAsConfiguredAreLaunched)
+{
+    LaunchCounter counter;
+    BrokerDispatcher dispatcher(MakeConfig(), MakeToken(), counter.GetFunction());
+    BrokerConnection connection(dispatcher);
+    REQUIRE(connection.IsOpen());
+
+    // Split into single bytes, as a pipe may deliver them
+    connection.Send(EncodeBrokerHello(MakeHello(MakeToken())), true);
+    connection.Send(EncodeBrokerLaunchRequest(MakeRequest(7, 0, 0, L"C:\\Tools\\regedit.exe")), true);
+    BrokerReply reply;
+    REQUIRE(connection.Receive(reply));
+    CHECK(reply.requestId == 7 && reply.status == BrokerStatus::Launched);
+    CHECK(reply.processId == 1000 && reply.processHandle == 0x1234);
+
+    connection.Send(EncodeBrokerLaunchRequest(MakeRequest(10, 1, 0, L"cmd.exe", L"/k \u00E9cho \u00FCn\u00EFcode")));
+    REQUIRE(connection.Receive(reply));
+    CHECK(reply.requestId == 10 && reply.status == BrokerStatus::Launched);
+
+    // Not an administrator button, a changed path, and buttons that do not exist
+    const BrokerLaunchRequest rejected[] = {
+        MakeRequest(8, 0, 1, L"notepad.exe"),
+        MakeRequest(9, 0, 0, L"C:\\Tools\\evil.exe"),
+        MakeRequest(11, -1, 0, L"cmd.exe"),
+        MakeRequest(12, 5, 99, L"cmd.exe"),
+    };
+    for (const BrokerLaunchRequest& request : rejected)
+    {
+        connection.Send(EncodeBrokerLaunchRequest(request));
+        REQUIRE(connection.Receive(reply));
+        CHECK(reply.requestId == request.requestId && reply.status == BrokerStatus::Rejected);
+    }
+
+    // Requests sent back to back are answered in order
+    connection.Send(EncodeBrokerLaunchRequest(MakeRequest(20, 0, 0, L"C:\\Tools\\regedit.exe")) +
+                    EncodeBrokerLaunchRequest(MakeRequest(21, 1, 0, L"cmd.exe", L"/k \u00E9cho \u00FCn\u00EFcode")));
+    CHECK(connection.Receive(reply) && reply.requestId == 20);
+    CHECK(connection.Receive(reply) && reply.requestId == 21);
+
+    // A second hello ends the connection
+    connection.Send(EncodeBrokerHello(MakeHello(MakeToken())));
+    CHECK(!connection.Receive(reply));
+    connection.Close();
+    CHECK(dispatcher.GetLaunchCount() == 4);
+    CHECK(dispatcher.GetRejectedCount() == 4);
+    CHECK(counter.launches == 4);
+}
+
+TEST_CASE(ConnectionsWithoutAValidHelloAreClosed)
+{
+    std::string token = MakeToken();
+    std::string wrongToken = token;
+    wrongToken[5] ^= 1;
+    BrokerHello wrongVersion = MakeHello(token);
+    wrongVersion.version = BROKER_PROTOCOL_VERSION + 1;
+    const std::string launch = EncodeBrokerLaunchRequest(MakeRequest(1, 0, 0, L"C:\\Tools\\regedit.exe"));
+
+    const std::string openings[] = {
+        EncodeBrokerHello(MakeHello(wrongToken)) + launch,
+        launch,
+        EncodeBrokerHello(wrongVersion) + launch,
+    };
+    for (const std::string& opening : openings)
+    {
+        LaunchCounter counter;
+        BrokerDispatcher dispatcher(MakeConfig(), token, counter.GetFunction());
+        BrokerConnection connection(dispatcher);
+        connection.Send(opening);
+        BrokerReply reply;
+        CHECK(!connection.Receive(reply));
+        connection.Close();
+        CHECK(!dispatcher.IsAuthenticated());
+        CHECK(counter.launches == 0);
+    }
+
+    // A broker without a token never accepts a connection
+    LaunchCounter counter;
+    BrokerDispatcher dispatcher(MakeConfig(), "", counter.GetFunction());
+    BrokerConnection connection(dispatcher);
+    connection.Send(EncodeBrokerHello(MakeHello("")));
+    BrokerReply reply;
+    CHECK(!connection.Receive(reply));
+}
+
+TEST_CASE(MalformedFramesCloseTheConnection)
+{
+    std::string hello = EncodeBrokerHello(MakeHello(MakeToken()));
+    std::string trailingByte = EncodeBrokerLaunchRequest(MakeRequest(1, 0, 0, L"C:\\Tools\\regedit.exe"));
+    trailingByte += 'x';
+    trailingByte[0]++;
+
+    const std::string frames[] = {
+        std::string("\xff\xff\xff\x7f", 4),     // Longer than BROKER_MAX_FRAME_SIZE
+        trailingByte,
+    };
+    for (const std::string& frame : frames)
+    {
+        LaunchCounter counter;
+        BrokerDispatcher dispatcher(MakeConfig(), MakeToken(), counter.GetFunction());
+        BrokerConnection connection(dispatcher);
+        connection.Send(hello + frame);
+        BrokerReply reply;
+        CHECK(!connection.Receive(reply));
+        connection.Close();
+        CHECK(counter.launches == 0);
+    }
+}
+
+TEST_CASE(RandomPayloadsAreRejectedSafely)
+{
+    std::mt19937 random(1);
+    LauncherConfig config = MakeConfig();
+    std::string token = MakeToken();
+    LaunchCounter counter;
+    for (int i = 0; i < 200000; ++i)
+    {
+        std::string payload(random() % 40, '\0');
+        for (char& byte : payload) byte = static_cast<char>(random());
+        if (!payload.empty()) payload[0] = static_cast<char>(1 + random() % 3);
+
+        BrokerHello hello;
+        BrokerLaunchRequest request;
+        BrokerReply reply;
+        DecodeBrokerHello(payload, hello);
+        DecodeBrokerLaunchRequest(payload, request);
+        DecodeBrokerReply(payload, reply);
+        BrokerDispatcher dispatcher(config, token, counter.GetFunction());
+        std::string output;
+        dispatcher.OnBytes(payload.data(), payload.size(), output);
+    }
+    CHECK(counter.launches == 0);
+}
+
+TEST_CASE(RequestRoundTripsAreTimed)
+{
+    BrokerDispatcher dispatcher(MakeConfig(), MakeToken(), [](const ButtonConfig&)
+        {
+            BrokerReply reply;
+            reply.status = BrokerStatus::Launched;
+            return reply;
+        });
+    BrokerConnection connection(dispatcher);
+    connection.Send(EncodeBrokerHello(MakeHello(MakeToken())));
+
+    const int requestCount = 20000;
+    int launched = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < requestCount; ++i)
+    {
+        connection.Send(EncodeBrokerLaunchRequest(MakeRequest(static_cast<uint32_t>(i), 0, 0, L"C:\\Tools\\regedit.exe")));
+        BrokerReply reply;
+        if (connection.Receive(reply) && reply.status == BrokerStatus::Launched) launched++;
+    }
+    TestHarness::Report("Launch request round trip", TestHarness::ElapsedMs(start) * 1000 / requestCount, "us");
+    CHECK(launched == requestCount);
+}
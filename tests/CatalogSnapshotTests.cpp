@@ -0,0 +1,246 @@
+#include "TestHarness.h"
+#include "ConfigGenerator.h"
+#include "ConfigModel.h"
+#include "IniDocument.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    bool WriteFile(const std::filesystem::path& path, const std::vector<char>& bytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(file);
+    }
+
+    // A snapshot file mapped read-only and shared, as SharedCatalog maps it on Windows
+    class MappedSnapshot
+    {
+    public:
+        explicit MappedSnapshot(const std::filesystem::path& path)
+        {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            struct stat status;
+            if (fstat(fd, &status) == 0 && status.st_size > 0)
+            {
+                void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+                if (view != MAP_FAILED)
+                {
+                    m_view = view;
+                    m_size = static_cast<size_t>(status.st_size);
+                }
+            }
+            // The mapping keeps the file alive
+            close(fd);
+            if (m_view && !m_document.AttachSnapshot(m_view, m_size))
+            {
+                m_document = IniDocument();
+            }
+        }
+
+        ~MappedSnapshot()
+        {
+            m_document = IniDocument();
+            if (m_view) munmap(m_view, m_size);
+        }
+
+        MappedSnapshot(const MappedSnapshot&) = delete;
+        MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+        const IniDocument& GetDocument() const { return m_document; }
+        const void* GetView() const { return m_view; }
+
+    private:
+        IniDocument m_document;
+        void* m_view{ nullptr };
+        size_t m_size{ 0 };
+    };
+
+    // Resident and proportional set size, in kB, of the mapping that starts at view
+    struct MappingUsage
+    {
+        uint64_t rssKb{ 0 };
+        uint64_t pssKb{ 0 };
+    };
+
+    MappingUsage GetMappingUsage(const void* view)
+    {
+        MappingUsage usage;
+        std::ifstream smaps("/proc/self/smaps");
+        std::string line;
+        bool inMapping = false;
+        while (std::getline(smaps, line))
+        {
+            size_t dash = line.find('-');
+            if (dash != std::string::npos && dash > 0 && line.find(':') > dash && std::isxdigit(static_cast<unsigned char>(line[0])))
+            {
+                inMapping = std::stoull(line.substr(0, dash), nullptr, 16) == reinterpret_cast<uintptr_t>(view);
+                continue;
+            }
+            if (!inMapping) continue;
+            std::istringstream fields(line);
+            std::string name;
+            uint64_t value = 0;
+            fields >> name >> value;
+            if (name == "Rss:") usage.rssKb = value;
+            if (name == "Pss:") usage.pssKb = value;
+        }
+        return usage;
+    }
+
+    LauncherConfig ParseSnapshot(const IniDocument& snapshot)
+    {
+        return ParseLauncherConfig(snapshot, IniDocument());
+    }
+}
+
+TEST_CASE(SnapshotsAnswerLikeTheParsedDocument)
+{
+    IniDocument document;
+    document.Parse(L"[Tabs]\nCount=3\n[tab1]\nName = \"Hello\"\nRows=-5x\n[TAB1]\nName=dup\n");
+    std::vector<char> snapshot = document.SaveSnapshot();
+
+    IniDocument attached;
+    REQUIRE(attached.AttachSnapshot(snapshot.data(), snapshot.size()));
+    CHECK(attached.GetString(L"TAB1", L"name", L"") == L"Hello");
+    CHECK(attached.GetInt(L"tabs", L"count", 0) == 3);
+    CHECK(attached.GetInt(L"tab1", L"rows", 0) == -5);
+    CHECK(!attached.HasSection(L"Tab2"));
+
+    // Truncated snapshots are refused rather than read past their end
+    IniDocument truncated;
+    CHECK(!truncated.AttachSnapshot(snapshot.data(), snapshot.size() - 1));
+    CHECK(!truncated.AttachSnapshot(snapshot.data(), 3));
+}
+
+TEST_CASE(UserFilesLayerOverTheSnapshot)
+{
+    IniDocument catalog;
+    catalog.Parse(L"[Tabs]\nCount=2\nTab0=Shared\n[Tab0]\nButton0_Name=Editor\nButton0_Path=edit.exe\n");
+    std::vector<char> snapshot = catalog.SaveSnapshot();
+    IniDocument attached;
+    REQUIRE(attached.AttachSnapshot(snapshot.data(), snapshot.size()));
+
+    IniDocument user;
+    user.Parse(L"[tab0]\nButton0_Path=myedit.exe\n[Tab1]\nButton0_Name=Mine\n");
+    LayeredIni layered(attached, user);
+    CHECK(layered.GetString(L"Tab0", L"Button0_Name", L"") == L"Editor");
+    CHECK(layered.GetString(L"Tab0", L"Button0_Path", L"") == L"myedit.exe");
+    CHECK(layered.GetString(L"Tab1", L"Button0_Name", L"") == L"Mine");
+    CHECK(layered.GetInt(L"Tabs", L"Count", 0) == 2);
+    CHECK(!layered.FindSection(L"Tab7").Exists());
+}
+
+TEST_CASE(ProcessesShareTheMappedSnapshotPages)
+{
+    TestHarness::TemporaryDirectory directory("snapshot");
+    const std::filesystem::path snapshotPath = directory.path / "catalog.snapshot";
+
+    GeneratorOptions options;
+    options.tabCount = 10000;
+    options.fillPercent = 30;
+    IniDocument catalog;
+    catalog.Parse(GenerateSyntheticConfig(options));
+    std::vector<char> snapshot = catalog.SaveSnapshot();
+    REQUIRE(WriteFile(snapshotPath, snapshot));
+    TestHarness::Report("Snapshot", snapshot.size() / 1048576.0, "MB");
+
+    // Every session maps the file and builds its model from it. The sessions measure once
+    // all have done so, and exit once all have measured, so each sees the others' mappings.
+    const int sessionCount = 4;
+    int ready[2], go[2], results[2], done[2];
+    REQUIRE(pipe(ready) == 0 && pipe(go) == 0 && pipe(results) == 0 && pipe(done) == 0);
+    for (int i = 0; i < sessionCount; ++i)
+    {
+        if (fork() == 0)
+        {
+            close(go[1]);
+            close(done[1]);
+            MappedSnapshot mapped(snapshotPath);
+            LauncherConfig config = ParseSnapshot(mapped.GetDocument());
+            bool loaded = config.GetTabCount() == options.tabCount;
+
+            char byte = 0;
+            ssize_t written = write(ready[1], &byte, 1);
+            ssize_t released = read(go[0], &byte, 1);
+
+            MappingUsage usage = GetMappingUsage(mapped.GetView());
+            if (!loaded || written != 1 || released != 0) usage = MappingUsage();
+            bool reported = write(results[1], &usage, sizeof(usage)) == sizeof(usage);
+            _exit(reported && read(done[0], &byte, 1) == 0 ? 0 : 1);
+        }
+    }
+    close(go[0]);
+    close(ready[1]);
+    close(results[1]);
+    close(done[0]);
+
+    int readyCount = 0;
+    char byte;
+    while (readyCount < sessionCount && read(ready[0], &byte, 1) == 1) ++readyCount;
+    close(go[1]);
+
+    MappingUsage usage;
+    int reportCount = 0;
+    uint64_t largestRssKb = 0;
+    uint64_t largestPssKb = 0;
+    while (reportCount < sessionCount && read(results[0], &usage, sizeof(usage)) == sizeof(usage))
+    {
+        ++reportCount;
+        CHECK(usage.rssKb > 0);
+        // Pages mapped by all sessions are charged to each in equal parts
+        CHECK(usage.pssKb * 2 < usage.rssKb);
+        largestRssKb = (std::max)(largestRssKb, usage.rssKb);
+        largestPssKb = (std::max)(largestPssKb, usage.pssKb);
+    }
+    close(done[1]);
+    close(ready[0]);
+    close(results[0]);
+
+    int status = 0;
+    int exitedCount = 0;
+    while (wait(&status) > 0)
+    {
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) ++exitedCount;
+    }
+    CHECK(readyCount == sessionCount);
+    CHECK(reportCount == sessionCount);
+    CHECK(exitedCount == sessionCount);
+    TestHarness::Report("Snapshot resident per session", largestRssKb / 1024.0, "MB");
+    TestHarness::Report("Snapshot charged to each of 4 sessions", largestPssKb / 1024.0, "MB");
+}
+
+TEST_CASE(ReplacedSnapshotsStayReadableWhileMapped)
+{
+    TestHarness::TemporaryDirectory directory("replace");
+    const std::filesystem::path snapshotPath = directory.path / "catalog.snapshot";
+    const std::filesystem::path stagingPath = directory.path / "catalog.snapshot.new";
+
+    IniDocument first;
+    first.Parse(L"[Tabs]\nCount=1\nTab0=First\n");
+    REQUIRE(WriteFile(snapshotPath, first.SaveSnapshot()));
+    MappedSnapshot mapped(snapshotPath);
+    REQUIRE(mapped.GetView() != nullptr);
+
+    // Publishing writes the new snapshot next to the old one and renames it into place
+    IniDocument second;
+    second.Parse(L"[Tabs]\nCount=2\nTab0=Second\n");
+    REQUIRE(WriteFile(stagingPath, second.SaveSnapshot()));
+    std::filesystem::rename(stagingPath, snapshotPath);
+
+    CHECK(mapped.GetDocument().GetString(L"Tabs", L"Tab0", L"") == L"First");
+    MappedSnapshot reopened(snapshotPath);
+    CHECK(reopened.GetDocument().GetString(L"Tabs", L"Tab0", L"") == L"Second");
+    CHECK(reopened.GetDocument().GetInt(L"Tabs", L"Count", 0) == 2);
+}
@@ -0,0 +1,229 @@
+#include "TestHarness.h"
+#include "CatalogSync.h"
+#include "ConfigGenerator.h"
+
+#include <filesystem>
+#include <string>
+#include <thread>
+
+namespace
+{
+    /**
+     * @brief A pack directory behind a slow, unreliable link: every request waits, the
+     *        link goes down after a number of reads, and one chunk arrives damaged.
+     */
+    class FaultyCatalogStore : public CatalogStore
+    {
+    public:
+        explicit FaultyCatalogStore(const std::filesystem::path& directory) : m_store(directory) {}
+
+        std::chrono::microseconds delay{ 0 };
+        int readsBeforeOutage{ -1 };    // -1 for a link that stays up
+        std::string corruptedName;
+        int reads{ 0 };
+
+        CatalogStoreStatus GetStamp(const std::string& name, CatalogStamp& stamp) override
+        {
+            std::this_thread::sleep_for(delay);
+            if (readsBeforeOutage == 0) return CatalogStoreStatus::Unreachable;
+            return m_store.GetStamp(name, stamp);
+        }
+
+        CatalogStoreStatus Read(const std::string& name, std::string& contents) override
+        {
+            std::this_thread::sleep_for(delay);
+            reads++;
+            if (readsBeforeOutage == 0) return CatalogStoreStatus::Unreachable;
+            if (readsBeforeOutage > 0) readsBeforeOutage--;
+            CatalogStoreStatus status = m_store.Read(name, contents);
+            if (status == CatalogStoreStatus::Ok && name == corruptedName && !contents.empty())
+            {
+                contents[contents.size() / 2] ^= 1;
+            }
+            return status;
+        }
+
+    private:
+        DirectoryCatalogStore m_store;
+    };
+
+    // A catalog of 2000 tabs, a few hundred kilobytes and many chunks
+    std::string MakeCatalog()
+    {
+        GeneratorOptions options;
+        options.tabCount = 2000;
+        options.fillPercent = 30;
+        std::wstring text = GenerateSyntheticConfig(options);
+        return std::string(text.begin(), text.end());
+    }
+
+    // The same catalog with a comment added to each of the given tabs
+    std::string EditTabs(std::string text, std::initializer_list<int> tabs)
+    {
+        for (int tab : tabs)
+        {
+            size_t section = text.find("[Tab" + std::to_string(tab) + "]");
+            if (section != std::string::npos) text.insert(text.find('\n', section) + 1, "; Edited\r\n");
+        }
+        return text;
+    }
+
+    // Makes the next publish visible even on file systems with a coarse timestamp
+    void AgeManifest(const std::filesystem::path& packDirectory)
+    {
+        std::filesystem::path manifest = packDirectory / CatalogSync::MANIFEST_NAME;
+        std::filesystem::last_write_time(manifest, std::filesystem::last_write_time(manifest) - std::chrono::seconds(10));
+    }
+}
+
+TEST_CASE(AnEditedTabFetchesOneChunk)
+{
+    TestHarness::TemporaryDirectory directory("CatalogSyncTests.Edit");
+    std::string original = MakeCatalog();
+    std::string edited = EditTabs(original, { 1000 });
+    REQUIRE(SplitCatalogChunks(original).size() > 4);
+    REQUIRE(CatalogSync::PublishPack(original, directory.path / "pack"));
+
+    FaultyCatalogStore store(directory.path / "pack");
+    CatalogSync sync(store, directory.path / "cache");
+    std::string text;
+    REQUIRE(sync.Sync(text) == CatalogSyncResult::Updated);
+    CHECK(text == original);
+    CHECK(sync.GetLastStatistics().chunksFetched == SplitCatalogChunks(original).size());
+
+    AgeManifest(directory.path / "pack");
+    REQUIRE(CatalogSync::PublishPack(edited, directory.path / "pack"));
+    store.delay = std::chrono::milliseconds(2);
+    store.reads = 0;
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE(sync.Sync(text) == CatalogSyncResult::Updated);
+    TestHarness::Report("Sync one edited tab at 2 ms per request", TestHarness::ElapsedMs(start), "ms");
+    CHECK(text == edited);
+    CHECK(sync.GetLastStatistics().chunksFetched == 1);
+    CHECK(sync.GetLastStatistics().chunksReused == SplitCatalogChunks(edited).size() - 1);
+    CHECK(store.reads == 2);
+
+    // A new instance finds the same catalog in the cache
+    std::string cached;
+    CHECK(CatalogSync(store, directory.path / "cache").ReadCache(cached) && cached == edited);
+}
+
+TEST_CASE(AnOutageMidSyncKeepsTheCache)
+{
+    TestHarness::TemporaryDirectory directory("CatalogSyncTests.Outage");
+    std::string original = MakeCatalog();
+    std::string edited = EditTabs(original, { 100, 1000, 1900 });
+    REQUIRE(CatalogSync::PublishPack(original, directory.path / "pack"));
+    FaultyCatalogStore store(directory.path / "pack");
+    CatalogSync sync(store, directory.path / "cache");
+    std::string text;
+    REQUIRE(sync.Sync(text) == CatalogSyncResult::Updated);
+
+    // The manifest and the first changed chunk arrive, then the link goes down
+    AgeManifest(directory.path / "pack");
+    REQUIRE(CatalogSync::PublishPack(edited, directory.path / "pack"));
+    store.readsBeforeOutage = 2;
+    CHECK(sync.Sync(text) == CatalogSyncResult::Unreachable);
+    std::string cached;
+    CHECK(sync.ReadCache(cached) && cached == original);
+
+    // Once it is back the sync completes
+    store.readsBeforeOutage = -1;
+    CHECK(sync.Sync(text) == CatalogSyncResult::Updated);
+    CHECK(text == edited);
+    CHECK(sync.ReadCache(cached) && cached == edited);
+}
+
+TEST_CASE(ACorruptedChunkFails)
+{
+    TestHarness::TemporaryDirectory directory("CatalogSyncTests.Corrupt");
+    std::string original = MakeCatalog();
+    REQUIRE(CatalogSync::PublishPack(original, directory.path / "pack"));
+    FaultyCatalogStore store(directory.path / "pack");
+    store.corruptedName = FormatChunkName(HashCatalogBytes(SplitCatalogChunks(original)[2]));
+    CatalogSync sync(store, directory.path / "cache");
+    std::string text;
+    CHECK(sync.Sync(text) == CatalogSyncResult::Failed);
+    CHECK(!sync.ReadCache(text));
+}
+
+TEST_CASE(AMissingPackIsUnreachableAndAMissingManifestUnavailable)
+{
+    TestHarness::TemporaryDirectory directory("CatalogSyncTests.Missing");
+    std::string text;
+    FaultyCatalogStore missingDirectory(directory.path / "pack");
+    CHECK(CatalogSync(missingDirectory, directory.path / "cache").Sync(text) == CatalogSyncResult::Unreachable);
+
+    std::filesystem::create_directories(directory.path / "pack");
+    FaultyCatalogStore missingManifest(directory.path / "pack");
+    CHECK(CatalogSync(missingManifest, directory.path / "cache").Sync(text) == CatalogSyncResult::Unavailable);
+}
+
+TEST_CASE(AMatchingStampReadsNothing)
+{
+    TestHarness::TemporaryDirectory directory("CatalogSyncTests.Stamp");
+    REQUIRE(CatalogSync::PublishPack(MakeCatalog(), directory.path / "pack"));
+    FaultyCatalogStore store(directory.path / "pack");
+    std::string text;
+    REQUIRE(CatalogSync(store, directory.path / "cache").Sync(text) == CatalogSyncResult::Updated);
+
+    store.reads = 0;
+    CatalogSync sync(store, directory.path / "cache");
+    CHECK(sync.Sync(text) == CatalogSyncResult::Unchanged);
+    CHECK(store.reads == 0);
+    CHECK(sync.GetLastStatistics().chunksFetched == 0);
+}
+
+TEST_CASE(RepublishingTheSameContentsOnlyUpdatesTheStamp)
+{
+    TestHarness::TemporaryDirectory directory("CatalogSyncTests.Republish");
+    std::string original = MakeCatalog();
+    REQUIRE(CatalogSync::PublishPack(original, directory.path / "pack"));
+    FaultyCatalogStore store(directory.path / "pack");
+    CatalogSync sync(store, directory.path / "cache");
+    std::string text;
+    REQUIRE(sync.Sync(text) == CatalogSyncResult::Updated);
+
+    // Only the manifest is read, and the next sync goes by the stamp alone
+    AgeManifest(directory.path / "pack");
+    REQUIRE(CatalogSync::PublishPack(original, directory.path / "pack"));
+    store.reads = 0;
+    CHECK(sync.Sync(text) == CatalogSyncResult::Unchanged);
+    CHECK(store.reads == 1);
+    CHECK(sync.GetLastStatistics().chunksFetched == 0);
+    store.reads = 0;
+    CHECK(CatalogSync(store, directory.path / "cache").Sync(text) == CatalogSyncResult::Unchanged);
+    CHECK(store.reads == 0);
+    std::string cached;
+    CHECK(sync.ReadCache(cached) && cached == original);
+}
+
+TEST_CASE(AFailedManifestWriteKeepsThePreviousCatalog)
+{
+    TestHarness::TemporaryDirectory directory("CatalogSyncTests.WriteCache");
+    std::string original = MakeCatalog();
+    std::string edited = EditTabs(original, { 1000 });
+    REQUIRE(CatalogSync::PublishPack(original, directory.path / "pack"));
+    FaultyCatalogStore store(directory.path / "pack");
+    std::string text;
+    REQUIRE(CatalogSync(store, directory.path / "cache").Sync(text) == CatalogSyncResult::Updated);
+
+    // A directory in the way of the manifest's temporary file makes its write fail
+    std::filesystem::path blocker = directory.path / "cache" / "catalog.manifest.tmp";
+    std::filesystem::create_directories(blocker);
+    AgeManifest(directory.path / "pack");
+    REQUIRE(CatalogSync::PublishPack(edited, directory.path / "pack"));
+    CHECK(CatalogSync(store, directory.path / "cache").Sync(text) == CatalogSyncResult::Failed);
+    std::string cached;
+    CHECK(CatalogSync(store, directory.path / "cache").ReadCache(cached) && cached == original);
+
+    std::filesystem::remove(blocker);
+    CHECK(CatalogSync(store, directory.path / "cache").Sync(text) == CatalogSyncResult::Updated);
+    CHECK(CatalogSync(store, directory.path / "cache").ReadCache(cached) && cached == edited);
+    int cachedTexts = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory.path / "cache"))
+    {
+        if (entry.path().extension() == ".utf8") cachedTexts++;
+    }
+    CHECK(cachedTexts == 1);
+}
@@ -0,0 +1,128 @@
+#include "TestHarness.h"
+#include "CompletionQueue.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST_CASE(CompletionsRunInOrderPerProducer)
+{
+    // Four workers pushing at once, drained in slices as the message loop does
+    CompletionQueue queue;
+    std::mutex mutex;
+    std::condition_variable woken;
+    int wakes = 0;
+    queue.SetWakeHandler([&]()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            wakes++;
+            woken.notify_one();
+        });
+
+    const int producerCount = 4;
+    const int completionsPerProducer = 100000;
+    std::vector<int> lastRun(producerCount, -1);
+    int outOfOrder = 0;
+    long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < producerCount; ++producer)
+    {
+        producers.emplace_back([&, producer]()
+            {
+                for (int i = 0; i < completionsPerProducer; ++i)
+                {
+                    queue.Push([&, producer, i]()
+                        {
+                            if (lastRun[producer] != i - 1) outOfOrder++;
+                            lastRun[producer] = i;
+                            total++;
+                        });
+                }
+            });
+    }
+    while (total < static_cast<long>(producerCount) * completionsPerProducer)
+    {
+        if (!queue.Drain(std::chrono::microseconds(500)).hasMore)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            woken.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+    for (std::thread& producer : producers) producer.join();
+    double elapsedMs = TestHarness::ElapsedMs(start);
+
+    CHECK(outOfOrder == 0);
+    CHECK(queue.IsEmpty());
+    CHECK(queue.GetPendingCount() == 0);
+    std::lock_guard<std::mutex> lock(mutex);
+    CHECK(wakes >= 1);
+    CHECK(wakes <= total);
+    TestHarness::Report("Push and drain a completion from 4 threads", elapsedMs * 1e6 / total, "ns");
+    TestHarness::Report("Wakes for 400,000 completions", wakes, "wakes");
+}
+
+TEST_CASE(TheConsumerIsWokenOncePerBatch)
+{
+    CompletionQueue queue;
+    int wakes = 0;
+    queue.SetWakeHandler([&wakes]() { wakes++; });
+    CHECK(queue.Drain(std::chrono::milliseconds(1)).completed == 0);
+
+    int runs = 0;
+    for (int i = 0; i < 10; ++i) queue.Push([&runs]() { runs++; });
+    CHECK(wakes == 1);
+    CHECK(queue.GetPendingCount() == 10);
+
+    // A completion that pushes another: the queue was not empty, so no further wake
+    queue.Push([&]() { queue.Push([&runs]() { runs += 100; }); });
+    CompletionDrainResult result = queue.Drain(std::chrono::seconds(10));
+    CHECK(wakes == 1);
+    CHECK(result.completed == 12);
+    CHECK(!result.hasMore);
+    CHECK(runs == 110);
+
+    queue.Push([]() {});
+    CHECK(wakes == 2);
+    queue.Drain(std::chrono::seconds(10));
+    CHECK(queue.IsEmpty());
+}
+
+TEST_CASE(DrainStopsWhenTheBudgetIsSpent)
+{
+    CompletionQueue queue;
+    for (int i = 0; i < 1000; ++i)
+    {
+        queue.Push([]() { std::this_thread::sleep_for(std::chrono::microseconds(100)); });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    CompletionDrainResult result = queue.Drain(std::chrono::milliseconds(2));
+    double elapsedMs = TestHarness::ElapsedMs(start);
+    CHECK(result.completed >= 1);
+    CHECK(result.completed < 1000);
+    CHECK(result.hasMore);
+    CHECK(queue.GetPendingCount() == 1000 - result.completed);
+    TestHarness::Report("Drain with a 2 ms budget", elapsedMs, "ms");
+
+    // A budget of zero still runs one completion, so the queue always moves
+    result = queue.Drain(std::chrono::nanoseconds(0));
+    CHECK(result.completed == 1);
+    CHECK(result.hasMore);
+}
+
+TEST_CASE(PendingCompletionsAreDroppedWithTheQueue)
+{
+    auto resource = std::make_shared<int>(0);
+    bool ran = false;
+    {
+        CompletionQueue queue;
+        queue.Push([resource, &ran]() { ran = true; });
+        queue.Push([resource, &ran]() { ran = true; });
+        CHECK(resource.use_count() == 3);
+    }
+    CHECK(!ran);
+    CHECK(resource.use_count() == 1);
+}
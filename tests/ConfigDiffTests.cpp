@@ -0,0 +1,119 @@
+#include "TestHarness.h"
+#include "ConfigGenerator.h"
+#include "ConfigModel.h"
+#include "IniDocument.h"
+
+#include <algorithm>
+
+namespace
+{
+    LauncherConfig ParseText(const std::wstring& text)
+    {
+        IniDocument base;
+        IniDocument overlay;
+        overlay.Parse(text);
+        return ParseLauncherConfig(base, overlay);
+    }
+
+    LauncherConfig MakeConfig(int tabCount, int rows, int cols)
+    {
+        GeneratorOptions options;
+        options.tabCount = tabCount;
+        options.buttonRows = rows;
+        options.buttonCols = cols;
+        options.seed = 27;
+        return ParseText(GenerateSyntheticConfig(options));
+    }
+
+    bool HasButton(const std::vector<ButtonKey>& keys, ButtonKey key)
+    {
+        return std::find(keys.begin(), keys.end(), key) != keys.end();
+    }
+}
+
+TEST_CASE(IdenticalConfigurationsHaveNoDifferences)
+{
+    LauncherConfig config = MakeConfig(5, 3, 4);
+    CHECK(DiffConfigs(config, config).IsEmpty());
+    CHECK(DiffConfigs(config, ParseText(FormatLauncherConfig(config))).IsEmpty());
+}
+
+TEST_CASE(ChangedButtonsAreFlaggedWhenTheirPathChanged)
+{
+    LauncherConfig current = MakeConfig(3, 2, 2);
+    LauncherConfig updated = current;
+    updated.tabs[0].name += L" renamed";
+    updated.tabs[1].buttons[2].name = L"Renamed only";
+    updated.tabs[2].buttons[3].path = L"C:\\Tools\\other.exe";
+
+    ConfigDiff diff = DiffConfigs(current, updated);
+    CHECK(!diff.IsEmpty());
+    CHECK((diff.renamedTabs == std::vector<int>{ 0 }));
+    CHECK(diff.resizedTabs.empty());
+    CHECK(diff.removedButtons.empty());
+    REQUIRE(diff.changedButtons.size() == 2);
+    CHECK(diff.changedButtons[0].tab == 1 && diff.changedButtons[0].button == 2 && !diff.changedButtons[0].pathChanged);
+    CHECK(diff.changedButtons[1].tab == 2 && diff.changedButtons[1].button == 3 && diff.changedButtons[1].pathChanged);
+}
+
+TEST_CASE(ShrunkGridsAndRemovedTabsListTheirButtons)
+{
+    LauncherConfig current = MakeConfig(4, 2, 3);
+    LauncherConfig updated = current;
+    updated.tabs.resize(2);
+    updated.tabs[1].buttonCols = 2;
+    updated.tabs[1].buttons.resize(4);
+
+    ConfigDiff diff = DiffConfigs(current, updated);
+    CHECK(diff.oldTabCount == 4 && diff.newTabCount == 2);
+    CHECK((diff.resizedTabs == std::vector<int>{ 1 }));
+    CHECK(diff.removedButtons.size() == 2 + 2 * 6);
+    CHECK(HasButton(diff.removedButtons, { 1, 4 }));
+    CHECK(HasButton(diff.removedButtons, { 1, 5 }));
+    CHECK(!HasButton(diff.removedButtons, { 1, 3 }));
+    CHECK(HasButton(diff.removedButtons, { 2, 0 }));
+    CHECK(HasButton(diff.removedButtons, { 3, 5 }));
+
+    // Growing removes nothing
+    ConfigDiff grown = DiffConfigs(updated, current);
+    CHECK(grown.removedButtons.empty());
+    CHECK(grown.newTabCount == 4);
+}
+
+TEST_CASE(LargeConfigurationsAreReloadedAndDiffedQuickly)
+{
+    GeneratorOptions options;
+    options.tabCount = 1000;
+    options.buttonRows = 6;
+    options.buttonCols = 16;
+    options.unicodeNames = true;
+    options.pathLength = 120;
+    options.seed = 27;
+    std::wstring text = GenerateSyntheticConfig(options);
+
+    auto start = std::chrono::steady_clock::now();
+    LauncherConfig current = ParseText(text);
+    TestHarness::Report("Parse 1000 tabs x 96 buttons", TestHarness::ElapsedMs(start), "ms");
+    REQUIRE(current.GetTabCount() == 1000);
+
+    // An edit of one button, as the watcher would see it after a save
+    LauncherConfig edited = current;
+    edited.tabs[777].buttons[42].path = L"D:\\Edited\\tool.exe";
+    std::wstring editedText = FormatLauncherConfig(edited);
+    start = std::chrono::steady_clock::now();
+    LauncherConfig reloaded = ParseText(editedText);
+    ConfigDiff diff = DiffConfigs(current, reloaded);
+    TestHarness::Report("Reload and diff after one edit", TestHarness::ElapsedMs(start), "ms");
+
+    REQUIRE(diff.changedButtons.size() == 1);
+    CHECK(diff.changedButtons[0].tab == 777 && diff.changedButtons[0].button == 42 && diff.changedButtons[0].pathChanged);
+    CHECK(diff.renamedTabs.empty() && diff.resizedTabs.empty() && diff.removedButtons.empty());
+
+    const int DIFF_REPETITIONS = 20;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < DIFF_REPETITIONS; ++i)
+    {
+        diff = DiffConfigs(current, reloaded);
+    }
+    TestHarness::Report("Diff alone", TestHarness::ElapsedMs(start) / DIFF_REPETITIONS, "ms");
+}
@@ -0,0 +1,232 @@
+#include "TestHarness.h"
+#include "ConfigGenerator.h"
+#include "ConfigJson.h"
+#include "ConfigModel.h"
+#include "GridLayout.h"
+#include "IniDocument.h"
+
+#include <sstream>
+
+namespace
+{
+    LauncherConfig ParseText(const std::wstring& text)
+    {
+        IniDocument overlay;
+        overlay.Parse(text);
+        return ParseLauncherConfig(IniDocument(), overlay);
+    }
+
+    // Heap bytes held by the strings and vectors of a configuration
+    uint64_t GetModelBytes(const LauncherConfig& config)
+    {
+        auto stringBytes = [](const std::wstring& text)
+            {
+                // Short strings live inside the object
+                return text.capacity() * sizeof(wchar_t) > sizeof(std::wstring) ? (text.capacity() + 1) * sizeof(wchar_t) : 0;
+            };
+
+        uint64_t bytes = config.tabs.capacity() * sizeof(TabConfig);
+        for (const TabConfig& tab : config.tabs)
+        {
+            bytes += stringBytes(tab.name) + tab.buttons.capacity() * sizeof(ButtonConfig);
+            for (const ButtonConfig& button : tab.buttons)
+            {
+                bytes += stringBytes(button.name) + stringBytes(button.path) + stringBytes(button.parameters) +
+                    stringBytes(button.prefetchFiles) + stringBytes(button.profile.workingDirectory) +
+                    stringBytes(button.profile.environment);
+            }
+        }
+        return bytes;
+    }
+}
+
+TEST_CASE(LookupsFollowTheProfileApi)
+{
+    IniDocument document;
+    document.Parse(L"\xFEFF; comment\r\n[Tabs]\r\nCount = 3\r\nTab0= \"Home\" \r\ncount=9\r\n"
+                   L"[tab1]\r\nButton0_Name=A\r\n[TAB1]\r\nButton1_Name=B\r\n");
+
+    CHECK(document.GetInt(L"tabs", L"COUNT", 0) == 3);
+    CHECK(document.GetString(L"Tabs", L"Tab0", L"") == L"Home");
+    CHECK(document.GetString(L"Tab1", L"button0_name", L"") == L"A");
+    // As with GetPrivateProfileString, the first of two equal sections wins
+    CHECK(document.GetString(L"Tab1", L"Button1_Name", L"") == L"");
+    CHECK(document.GetString(L"Tab2", L"Button0_Name", L"none") == L"none");
+}
+
+TEST_CASE(TabsHaveTheirOwnGridsWithinLimits)
+{
+    LauncherConfig config = ParseText(
+        L"[Tabs]\r\nCount=4\r\nButtonRows=2\r\nButtonCols=5\r\nTab0=Home\r\n"
+        L"[Tab1]\r\nRows=4\r\nCols=16\r\nButton0_Name=A\r\nButton0_Path=a.exe\r\nButton63_Path=last.exe\r\n"
+        L"[Tab2]\r\nRows=0\r\nCols=99\r\n"
+        L"[Tab3]\r\nRows=64\r\nCols=64\r\n");
+
+    REQUIRE(config.GetTabCount() == 4);
+    CHECK(config.tabs[0].name == L"Home");
+    CHECK(config.tabs[2].name == L"Tab3");
+    CHECK(config.tabs[0].buttonRows == 2 && config.tabs[0].buttonCols == 5);
+    CHECK(config.tabs[1].buttonRows == 4 && config.tabs[1].buttonCols == 16);
+    CHECK(config.tabs[1].buttons[0].path == L"a.exe" && config.tabs[1].buttons[63].path == L"last.exe");
+    // Values out of range fall back to the default grid
+    CHECK(config.tabs[2].buttonRows == 2 && config.tabs[2].buttonCols == 5);
+    CHECK(config.tabs[3].GetButtonCount() == MAX_GRID_DIMENSION * MAX_GRID_DIMENSION);
+    for (const TabConfig& tab : config.tabs)
+    {
+        CHECK(static_cast<int>(tab.buttons.size()) == tab.GetButtonCount());
+    }
+}
+
+TEST_CASE(OverlayOverridesTheBase)
+{
+    IniDocument base;
+    base.Parse(L"[Tabs]\r\nCount=2\r\nTab0=Shared\r\n[Tab0]\r\nButton0_Name=Editor\r\nButton0_Path=edit.exe\r\n");
+    IniDocument overlay;
+    overlay.Parse(L"[Tab0]\r\nButton0_Path=myedit.exe\r\nButton1_Name=Mine\r\n");
+
+    LauncherConfig config = ParseLauncherConfig(base, overlay);
+    REQUIRE(config.GetTabCount() == 2);
+    CHECK(config.tabs[0].name == L"Shared");
+    CHECK(config.tabs[0].buttons[0].name == L"Editor");
+    CHECK(config.tabs[0].buttons[0].path == L"myedit.exe");
+    CHECK(config.tabs[0].buttons[1].name == L"Mine");
+}
+
+TEST_CASE(FormattedConfigurationsParseToTheSameModel)
+{
+    GeneratorOptions options;
+    options.tabCount = 40;
+    options.unicodeNames = true;
+    options.pathLength = 80;
+    options.tabGridPercent = 50;
+    LauncherConfig config = ParseText(GenerateSyntheticConfig(options));
+    LauncherConfig reparsed = ParseText(FormatLauncherConfig(config));
+
+    REQUIRE(reparsed.GetTabCount() == config.GetTabCount());
+    for (int tab = 0; tab < config.GetTabCount(); ++tab)
+    {
+        CHECK(reparsed.tabs[tab].name == config.tabs[tab].name);
+        CHECK(reparsed.tabs[tab].buttonRows == config.tabs[tab].buttonRows);
+        CHECK(reparsed.tabs[tab].buttonCols == config.tabs[tab].buttonCols);
+        CHECK(reparsed.tabs[tab].buttons == config.tabs[tab].buttons);
+    }
+}
+
+TEST_CASE(ElevationAndDiagnosticsComeFromTheCatalogAndRoundTrip)
+{
+    // The shared catalog turns the broker on; the user's file adds tracing
+    IniDocument base;
+    base.Parse(L"[Elevation]\r\nBroker=1\r\n");
+    IniDocument overlay;
+    overlay.Parse(L"[Diagnostics]\r\nTrace=1\r\n");
+    LauncherConfig config = ParseLauncherConfig(base, overlay);
+    CHECK(config.elevation.broker);
+    CHECK(config.diagnostics.trace);
+    CHECK(!ParseText(L"").elevation.broker && !ParseText(L"").diagnostics.trace);
+
+    LauncherConfig reparsed = ParseText(FormatLauncherConfig(config));
+    CHECK(reparsed.elevation == config.elevation);
+    CHECK(reparsed.diagnostics == config.diagnostics);
+
+    std::ostringstream json;
+    REQUIRE(WriteLauncherConfigJson(config, json));
+    LauncherConfig read;
+    std::string error;
+    REQUIRE(ReadLauncherConfigJson(json.str(), read, error));
+    CHECK(read.elevation.broker && read.diagnostics.trace);
+    CHECK(ReadLauncherConfigJson(std::string_view("{ \"version\": 1, \"elevation\": { \"broker\": false } }"), read, error));
+    CHECK(!read.elevation.broker);
+    CHECK(ReadLauncherConfigJson(std::string_view("{ \"version\": 1, \"diagnostics\": { \"trace\": 0 } }"), read, error));
+    CHECK(!read.diagnostics.trace);
+    CHECK(!ReadLauncherConfigJson(std::string_view("{ \"version\": 1, \"diagnostics\": { \"trace\": \"on\" } }"), read, error));
+}
+
+TEST_CASE(ProgramIndexSettingsRoundTripThroughJson)
+{
+    CHECK(ParseText(L"").programIndex == ProgramIndexSettings());
+    CHECK(ParseText(L"[ProgramIndex]\r\nDirectories=\r\n").programIndex.directories.empty());
+
+    // INI to JSON and back gives the same file
+    LauncherConfig config = ParseText(
+        L"[ProgramIndex]\r\nEnabled=0\r\nDirectories=\"D:\\Tools \u00E9\";%USERPROFILE%\\bin\r\n"
+        L"[Tabs]\r\nCount=1\r\n");
+    CHECK(!config.programIndex.enabled);
+    CHECK(config.programIndex.directories == L"\"D:\\Tools \u00E9\";%USERPROFILE%\\bin");
+    std::ostringstream json;
+    REQUIRE(WriteLauncherConfigJson(config, json));
+    LauncherConfig read;
+    std::string error;
+    REQUIRE(ReadLauncherConfigJson(json.str(), read, error));
+    CHECK(read.programIndex == config.programIndex);
+    std::wstring text = FormatLauncherConfig(read);
+    CHECK(text == FormatLauncherConfig(config));
+    CHECK(ParseText(text).programIndex == config.programIndex);
+
+    // Settings left out of the JSON keep their defaults
+    REQUIRE(ReadLauncherConfigJson(std::string_view("{ \"version\": 1, \"programIndex\": { \"enabled\": false } }"), read, error));
+    CHECK(!read.programIndex.enabled);
+    CHECK(read.programIndex.directories == ProgramIndexSettings().directories);
+    CHECK(!ReadLauncherConfigJson(std::string_view("{ \"version\": 1, \"programIndex\": { \"directories\": 1 } }"), read, error));
+}
+
+TEST_CASE(GridCellsTileTheArea)
+{
+    const GridRect area = { 10, 20, 810, 620 };
+    for (int rows : { 1, 3, 16, MAX_GRID_DIMENSION })
+    {
+        for (int cols : { 1, 8, 13, MAX_GRID_DIMENSION })
+        {
+            GridRect first = GetGridCell(area, rows, cols, 0);
+            GridRect last = GetGridCell(area, rows, cols, rows * cols - 1);
+            CHECK(first.left == area.left && first.top == area.top);
+            CHECK(last.right <= area.right && last.bottom <= area.bottom);
+            CHECK(area.right - last.right < cols && area.bottom - last.bottom < rows);
+            // Neighbours touch without overlapping
+            if (cols > 1) CHECK(GetGridCell(area, rows, cols, 1).left == first.right);
+            if (rows > 1) CHECK(GetGridCell(area, rows, cols, cols).top == first.bottom);
+        }
+    }
+}
+
+TEST_CASE(TenThousandTabsLoadQuicklyAndCompactly)
+{
+    GeneratorOptions options;
+    options.tabCount = 10000;
+    options.fillPercent = 30;
+    options.tabGridPercent = 20;
+    std::wstring text = GenerateSyntheticConfig(options);
+    TestHarness::Report("Configuration text", text.size() * sizeof(wchar_t) / 1048576.0, "MB");
+
+    uint64_t residentBefore = TestHarness::GetResidentBytes();
+    auto start = std::chrono::steady_clock::now();
+    IniDocument document;
+    document.Parse(std::move(text));
+    TestHarness::Report("Parse the INI text", TestHarness::ElapsedMs(start), "ms");
+
+    start = std::chrono::steady_clock::now();
+    LauncherConfig config = ParseLauncherConfig(IniDocument(), document);
+    TestHarness::Report("Build the model", TestHarness::ElapsedMs(start), "ms");
+    uint64_t residentAfter = TestHarness::GetResidentBytes();
+
+    REQUIRE(config.GetTabCount() == 10000);
+    int ownGrids = 0;
+    size_t buttonCount = 0;
+    for (const TabConfig& tab : config.tabs)
+    {
+        if (tab.buttonRows != config.buttonRows || tab.buttonCols != config.buttonCols) ++ownGrids;
+        CHECK(static_cast<int>(tab.buttons.size()) == tab.GetButtonCount());
+        buttonCount += tab.buttons.size();
+    }
+    CHECK(ownGrids > 1000 && ownGrids < 3000);
+
+    uint64_t modelBytes = GetModelBytes(config);
+    TestHarness::Report("Buttons", static_cast<double>(buttonCount), "");
+    TestHarness::Report("Model heap", modelBytes / 1048576.0, "MB");
+    TestHarness::Report("Model heap per tab", modelBytes / 10000.0, "bytes");
+    if (residentBefore && residentAfter > residentBefore)
+    {
+        TestHarness::Report("Resident growth, document and model", (residentAfter - residentBefore) / 1048576.0, "MB");
+    }
+    // Every button costs its fixed size plus its strings; no per-tab overhead beyond that
+    CHECK(modelBytes < buttonCount * (sizeof(ButtonConfig) + 256) + 10000 * (sizeof(TabConfig) + 64));
+}
@@ -0,0 +1,112 @@
+#include "TestHarness.h"
+#include "FileChangeFilter.h"
+#include "InotifyConfigWatcher.h"
+
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace
+{
+    void WriteFile(const std::filesystem::path& path, const std::string& text)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << text;
+    }
+
+    // Counts the change notifications of a watcher
+    struct ChangeLog
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+        int count{ 0 };
+
+        void Add()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++count;
+            changed.notify_all();
+        }
+
+        // Waits until at least the given number of notifications came in, or for the time
+        bool WaitFor(int expected, std::chrono::milliseconds timeout)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            return changed.wait_for(lock, timeout, [&] { return count >= expected; });
+        }
+
+        int Get()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return count;
+        }
+    };
+
+    const std::chrono::milliseconds NOTIFICATION_TIMEOUT(5000);
+    const std::chrono::milliseconds QUIET_PERIOD(200);
+}
+
+TEST_CASE(FilterReportsOnlyChangesOfAnExistingFile)
+{
+    FileChangeFilter filter(FileStamp{ true, 100, 10 });
+    CHECK(!filter.OnDirectoryChanged(FileStamp{ true, 100, 10 }));     // Another file changed
+    CHECK(filter.OnDirectoryChanged(FileStamp{ true, 101, 10 }));
+    CHECK(!filter.OnDirectoryChanged(FileStamp{ true, 101, 10 }));
+    CHECK(filter.OnDirectoryChanged(FileStamp{ true, 101, 12 }));      // Same time, new size
+    CHECK(!filter.OnDirectoryChanged(FileStamp{}));                     // Deleted while being replaced
+    CHECK(!filter.OnDirectoryChanged(FileStamp{}));
+    CHECK(filter.OnDirectoryChanged(FileStamp{ true, 101, 12 }));      // Back, even unchanged
+}
+
+TEST_CASE(FilterStartingWithoutAFileReportsItsCreation)
+{
+    FileChangeFilter filter;
+    CHECK(!filter.OnDirectoryChanged(FileStamp{}));
+    CHECK(filter.OnDirectoryChanged(FileStamp{ true, 1, 0 }));
+}
+
+TEST_CASE(InotifyWatcherReportsEditsOfTheWatchedFileOnly)
+{
+    TestHarness::TemporaryDirectory directory("watch");
+    std::filesystem::path configPath = directory.path / "MultiTabLauncher.ini";
+    WriteFile(configPath, "[General]\n");
+
+    ChangeLog changes;
+    InotifyConfigWatcher watcher;
+    REQUIRE(watcher.Start(configPath.string(), [&] { changes.Add(); }));
+
+    // Other files in the directory do not count
+    WriteFile(directory.path / "MultiTabLauncher.usage.ini", "[Tab0]\nButton0_Launches=1\n");
+    CHECK(!changes.WaitFor(1, QUIET_PERIOD));
+
+    // Written in place
+    WriteFile(configPath, "[General]\nTabCount=2\n");
+    CHECK(changes.WaitFor(1, NOTIFICATION_TIMEOUT));
+
+    // Saved the way most editors do: written next to it and renamed over it
+    std::filesystem::path temporaryPath = directory.path / "MultiTabLauncher.ini.tmp";
+    WriteFile(temporaryPath, "[General]\nTabCount=3\nButtonRows=4\n");
+    int before = changes.Get();
+    std::filesystem::rename(temporaryPath, configPath);
+    CHECK(changes.WaitFor(before + 1, NOTIFICATION_TIMEOUT));
+
+    // Deleting is not reported; the file coming back is
+    std::this_thread::sleep_for(QUIET_PERIOD);
+    before = changes.Get();
+    std::filesystem::remove(configPath);
+    CHECK(!changes.WaitFor(before + 1, QUIET_PERIOD));
+    WriteFile(configPath, "[General]\nTabCount=1\n");
+    CHECK(changes.WaitFor(before + 1, NOTIFICATION_TIMEOUT));
+
+    watcher.Stop();
+}
+
+TEST_CASE(InotifyWatcherStopsWithoutAnyChange)
+{
+    TestHarness::TemporaryDirectory directory("watch");
+    InotifyConfigWatcher watcher;
+    REQUIRE(watcher.Start((directory.path / "MultiTabLauncher.ini").string(), [] {}));
+    watcher.Stop();
+    watcher.Stop();
+}
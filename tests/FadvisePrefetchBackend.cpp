@@ -0,0 +1,98 @@
+#include "FadvisePrefetchBackend.h"
+#include "TextKernels.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <thread>
+
+FadvisePrefetchBackend::~FadvisePrefetchBackend()
+{
+    CloseFile();
+}
+
+bool FadvisePrefetchBackend::OpenFile(const std::wstring& filePath, uint64_t& lastWriteTime)
+{
+    std::string path;
+    AppendUtf8(filePath, path);
+    m_file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_file < 0) return false;
+
+    struct stat status = {};
+    if (fstat(m_file, &status) != 0)
+    {
+        CloseFile();
+        return false;
+    }
+    posix_fadvise(m_file, 0, 0, POSIX_FADV_SEQUENTIAL);
+    lastWriteTime = static_cast<uint64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+    m_fileSize = status.st_size;
+    m_offset = 0;
+    return true;
+}
+
+uint64_t FadvisePrefetchBackend::PrefetchChunk(uint64_t maxBytes)
+{
+    if (m_offset >= m_fileSize) return 0;
+
+    size_t chunkSize = static_cast<size_t>((std::min)({ maxBytes, static_cast<uint64_t>(m_buffer.size()),
+                                                        static_cast<uint64_t>(m_fileSize - m_offset) }));
+    posix_fadvise(m_file, m_offset + chunkSize, m_buffer.size(), POSIX_FADV_WILLNEED);
+    ssize_t chunkRead = pread(m_file, m_buffer.data(), chunkSize, m_offset);
+    if (chunkRead <= 0) return 0;
+    m_offset += chunkRead;
+    return static_cast<uint64_t>(chunkRead);
+}
+
+void FadvisePrefetchBackend::CloseFile()
+{
+    if (m_file >= 0)
+    {
+        close(m_file);
+        m_file = -1;
+    }
+}
+
+void FadvisePrefetchBackend::PauseBetweenChunks()
+{
+    if (m_chunkPause.count() > 0) std::this_thread::sleep_for(m_chunkPause);
+}
+
+bool FadvisePrefetchBackend::EvictFromCache(const std::string& filePath)
+{
+    int file = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) return false;
+
+    // Only clean pages are dropped, so anything still being written back is written first
+    bool evicted = fdatasync(file) == 0 && posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(file);
+    return evicted;
+}
+
+double FadvisePrefetchBackend::GetCachedFraction(const std::string& filePath)
+{
+    int file = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) return 0.0;
+
+    double fraction = 0.0;
+    struct stat status = {};
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        void* mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+        if (mapping != MAP_FAILED)
+        {
+            size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            std::vector<unsigned char> pages((status.st_size + pageSize - 1) / pageSize);
+            if (mincore(mapping, status.st_size, pages.data()) == 0)
+            {
+                size_t cachedPages = std::count_if(pages.begin(), pages.end(), [](unsigned char page) { return (page & 1) != 0; });
+                fraction = static_cast<double>(cachedPages) / pages.size();
+            }
+            munmap(mapping, status.st_size);
+        }
+    }
+    close(file);
+    return fraction;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <sys/types.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PrefetchScheduler.h"
+
+/**
+ * @brief The Linux stand-in for the ReadFile backend of Prefetcher.
+ *
+ * Each chunk is read with pread(), so a pass ends only once its data is cached, as with
+ * ReadFile; readahead() alone returns before the I/O is done. While a chunk is read, the
+ * next one is requested with POSIX_FADV_WILLNEED. Files are opened with
+ * POSIX_FADV_SEQUENTIAL, the counterpart of FILE_FLAG_SEQUENTIAL_SCAN. The last write
+ * time is st_mtim in nanoseconds.
+ */
+class FadvisePrefetchBackend : public PrefetchBackend
+{
+public:
+    explicit FadvisePrefetchBackend(std::chrono::milliseconds chunkPause = std::chrono::milliseconds(0))
+        : m_chunkPause(chunkPause), m_buffer(PrefetchScheduler::CHUNK_SIZE) {}
+    ~FadvisePrefetchBackend() override;
+
+    bool OpenFile(const std::wstring& filePath, uint64_t& lastWriteTime) override;
+    uint64_t PrefetchChunk(uint64_t maxBytes) override;
+    void CloseFile() override;
+    void PauseBetweenChunks() override;
+
+    // Drops a file from the page cache, so the next read of it is cold
+    static bool EvictFromCache(const std::string& filePath);
+    // The share of a file's pages that are in the page cache, from 0 to 1
+    static double GetCachedFraction(const std::string& filePath);
+
+private:
+    std::chrono::milliseconds m_chunkPause;
+    std::vector<char> m_buffer;
+    int m_file{ -1 };
+    off_t m_fileSize{ 0 };
+    off_t m_offset{ 0 };
+};
@@ -0,0 +1,81 @@
+#include "InotifyConfigWatcher.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+#include <filesystem>
+
+InotifyConfigWatcher::~InotifyConfigWatcher()
+{
+    Stop();
+}
+
+bool InotifyConfigWatcher::Start(const std::string& filePath, ChangeCallback onChange)
+{
+    if (m_watchThread.joinable()) return true;
+
+    m_filePath = filePath;
+    m_onChange = std::move(onChange);
+    m_filter = FileChangeFilter(ReadFileStamp());
+
+    // The same events FindFirstChangeNotification reports: names, sizes and write times
+    std::string directory = std::filesystem::path(filePath).parent_path().string();
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_stopEvent = eventfd(0, EFD_CLOEXEC);
+    if (m_inotify < 0 || m_stopEvent < 0 ||
+        inotify_add_watch(m_inotify, directory.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY | IN_CLOSE_WRITE) < 0)
+    {
+        Stop();
+        return false;
+    }
+    m_watchThread = std::thread(&InotifyConfigWatcher::RunWatchLoop, this);
+    return true;
+}
+
+void InotifyConfigWatcher::Stop()
+{
+    if (m_watchThread.joinable())
+    {
+        uint64_t one = 1;
+        ssize_t written = write(m_stopEvent, &one, sizeof(one));
+        (void)written;
+        m_watchThread.join();
+    }
+    if (m_inotify >= 0) close(m_inotify);
+    if (m_stopEvent >= 0) close(m_stopEvent);
+    m_inotify = -1;
+    m_stopEvent = -1;
+}
+
+void InotifyConfigWatcher::RunWatchLoop()
+{
+    alignas(inotify_event) char buffer[4096];
+    pollfd fds[] = { { m_stopEvent, POLLIN, 0 }, { m_inotify, POLLIN, 0 } };
+    while (poll(fds, 2, -1) >= 0 && !(fds[0].revents & POLLIN))
+    {
+        // Like a change notification handle, the events only say that something changed
+        while (read(m_inotify, buffer, sizeof(buffer)) > 0)
+        {
+        }
+        if (m_filter.OnDirectoryChanged(ReadFileStamp()))
+        {
+            m_onChange();
+        }
+    }
+}
+
+FileStamp InotifyConfigWatcher::ReadFileStamp() const
+{
+    FileStamp stamp;
+    struct stat status;
+    if (stat(m_filePath.c_str(), &status) == 0)
+    {
+        stamp.exists = true;
+        stamp.lastWriteTime = static_cast<uint64_t>(status.st_mtim.tv_sec) * 1000000000 + static_cast<uint64_t>(status.st_mtim.tv_nsec);
+        stamp.size = static_cast<uint64_t>(status.st_size);
+    }
+    return stamp;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <thread>
+#include "FileChangeFilter.h"
+
+/**
+ * @brief The Linux stand-in for ConfigWatcher: watches the directory of a file with inotify
+ *        and reports changes of the file that pass the same FileChangeFilter.
+ *
+ * The callback runs on the watch thread.
+ */
+class InotifyConfigWatcher
+{
+public:
+    using ChangeCallback = std::function<void()>;
+
+    InotifyConfigWatcher() = default;
+    ~InotifyConfigWatcher();
+
+    InotifyConfigWatcher(const InotifyConfigWatcher&) = delete;
+    InotifyConfigWatcher& operator=(const InotifyConfigWatcher&) = delete;
+
+    bool Start(const std::string& filePath, ChangeCallback onChange);
+    void Stop();
+
+private:
+    void RunWatchLoop();
+    FileStamp ReadFileStamp() const;
+
+    std::string m_filePath;
+    FileChangeFilter m_filter;
+    ChangeCallback m_onChange;
+
+    int m_inotify{ -1 };
+    int m_stopEvent{ -1 };
+    std::thread m_watchThread;
+};
@@ -0,0 +1,157 @@
+#include "TestHarness.h"
+#include "ConfigGenerator.h"
+#include "ConfigModel.h"
+#include "IniDocument.h"
+#include "InteractionReplay.h"
+
+#include <string>
+
+namespace
+{
+    // 50 tabs of 6x12 buttons, a third of them with long Unicode targets
+    LauncherConfig MakeConfig()
+    {
+        GeneratorOptions options;
+        options.tabCount = 50;
+        options.buttonRows = 6;
+        options.buttonCols = 12;
+        options.fillPercent = 30;
+        options.unicodeNames = true;
+        options.pathLength = 200;
+        IniDocument base;
+        IniDocument overlay;
+        overlay.Parse(GenerateSyntheticConfig(options));
+        return ParseLauncherConfig(base, overlay);
+    }
+}
+
+TEST_CASE(TracesRoundTripAtAboutFiveBytesPerEvent)
+{
+    LauncherConfig config = MakeConfig();
+    InteractionTrace trace = GenerateSyntheticSession(config, 7);
+    REQUIRE(!trace.events.empty());
+
+    std::string data = trace.Serialize();
+    InteractionTrace parsed;
+    REQUIRE(parsed.Parse(data));
+    CHECK(parsed.tabStripHeight == trace.tabStripHeight);
+    CHECK(parsed.events == trace.events);
+    double bytesPerEvent = static_cast<double>(data.size()) / trace.events.size();
+    CHECK(bytesPerEvent < 8);
+    TestHarness::Report("Trace size", bytesPerEvent, "bytes/event");
+
+    // The same seed gives the same session
+    CHECK(GenerateSyntheticSession(config, 7).events == trace.events);
+}
+
+TEST_CASE(DamagedTracesDoNotParse)
+{
+    InteractionTrace trace = GenerateSyntheticSession(MakeConfig(), 3);
+    std::string data = trace.Serialize();
+
+    InteractionTrace parsed;
+    CHECK(!parsed.Parse(std::string_view(data).substr(0, data.size() - 1)));
+    CHECK(!parsed.Parse(""));
+    CHECK(!parsed.Parse("not a trace"));
+}
+
+TEST_CASE(HeadlessLauncherLaysOutTheShownPage)
+{
+    LauncherConfig config = MakeConfig();
+    HeadlessLauncher launcher(config, 32);
+    CHECK(launcher.GetCurrentTab() == -1);
+    CHECK(launcher.GetLoadedPageCount() == 0);
+
+    // The buttons share the client area below the tab strip: 800x600 over 6x12 cells
+    launcher.Resize(800, 632);
+    REQUIRE(launcher.SelectTab(3));
+    CHECK(launcher.GetCurrentTab() == 3);
+    CHECK(launcher.GetLoadedPageCount() == 1);
+    const std::vector<GridRect>* cells = launcher.GetPageLayout(3);
+    REQUIRE(cells && cells->size() == config.tabs[3].buttons.size());
+    CHECK(cells->front() == (GridRect{ 0, 0, 66, 100 }));
+    CHECK(cells->back() == (GridRect{ 726, 500, 792, 600 }));
+    CHECK(launcher.GetPageLayout(4) == nullptr);
+
+    // Only the shown page follows a resize; another is laid out when shown
+    REQUIRE(launcher.SelectTab(4));
+    launcher.Resize(1200, 632);
+    CHECK(launcher.GetPageLayout(4)->front() == (GridRect{ 0, 0, 100, 100 }));
+    CHECK(launcher.GetPageLayout(3)->front() == (GridRect{ 0, 0, 66, 100 }));
+    REQUIRE(launcher.SelectTab(3));
+    CHECK(launcher.GetPageLayout(3)->front() == (GridRect{ 0, 0, 100, 100 }));
+
+    CHECK(!launcher.SelectTab(50));
+    CHECK(!launcher.SelectTab(-1));
+    CHECK(launcher.GetCurrentTab() == 3);
+}
+
+TEST_CASE(HeadlessLauncherKeepsToTheResourceBudget)
+{
+    LauncherConfig config = MakeConfig();
+    config.resources.maxWindows = 3 * (1 + 6 * 12);
+    HeadlessLauncher launcher(config, 32);
+    launcher.Resize(800, 632);
+    for (int tab = 0; tab < config.GetTabCount(); ++tab)
+    {
+        REQUIRE(launcher.SelectTab(tab));
+        CHECK(launcher.GetLoadedPageCount() <= 3);
+    }
+    CHECK(launcher.GetLoadedPageCount() == 3);
+    CHECK(launcher.GetPageLayout(config.GetTabCount() - 1) != nullptr);
+    CHECK(launcher.GetPageLayout(0) == nullptr);
+}
+
+TEST_CASE(LaunchesAndEditsNeedAnExistingButton)
+{
+    LauncherConfig config = MakeConfig();
+    int withTarget = -1;
+    int withoutTarget = -1;
+    for (int button = 0; button < static_cast<int>(config.tabs[0].buttons.size()); ++button)
+    {
+        int& index = config.tabs[0].buttons[button].path.empty() ? withoutTarget : withTarget;
+        if (index < 0) index = button;
+    }
+    REQUIRE(withTarget >= 0 && withoutTarget >= 0);
+
+    HeadlessLauncher launcher(config, 32);
+    CHECK(launcher.Launch(0, withTarget));
+    CHECK(!launcher.Launch(0, withoutTarget));
+    CHECK(!launcher.Launch(0, 6 * 12));
+    CHECK(!launcher.Launch(50, 0));
+    CHECK(launcher.EditButton(0, withoutTarget));
+    CHECK(!launcher.EditButton(-1, 0));
+}
+
+TEST_CASE(ReplaysCountEveryEventAndSkipMissingTargets)
+{
+    LauncherConfig config = MakeConfig();
+    InteractionTrace trace = GenerateSyntheticSession(config, 7);
+
+    auto start = std::chrono::steady_clock::now();
+    InteractionReplayReport report = ReplayInteractions(config, trace, 20);
+    double elapsedMs = TestHarness::ElapsedMs(start);
+    CHECK(report.replayed + report.skipped == 20 * trace.events.size());
+    CHECK(report.sessionMs == trace.events.back().timeMs);
+    uint64_t timed = 0;
+    for (const LatencyHistogram& histogram : report.latency) timed += histogram.GetCount();
+    CHECK(timed == report.replayed);
+    CHECK(report.Format().find("SelectTab") != std::string::npos);
+    TestHarness::Report("Replay a session 20 times", elapsedMs, "ms");
+    TestHarness::Report("Events replayed", static_cast<double>(report.replayed), "events");
+
+    // A session recorded with tabs the configuration no longer has
+    InteractionTrace stale;
+    stale.tabStripHeight = 32;
+    stale.events = {
+        { 0, InteractionKind::Resize, 800, 632 },
+        { 10, InteractionKind::SelectTab, 1, 0 },
+        { 20, InteractionKind::SelectTab, 80, 0 },
+        { 30, InteractionKind::EditButton, 80, 2 },
+        { 40, InteractionKind::EditButton, 1, 2 },
+    };
+    report = ReplayInteractions(config, stale, 2);
+    CHECK(report.replayed == 6);
+    CHECK(report.skipped == 4);
+    CHECK(report.sessionMs == 40);
+}
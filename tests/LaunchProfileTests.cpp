@@ -0,0 +1,187 @@
+#include "TestHarness.h"
+#include "LaunchProfile.h"
+#include "PosixSpawnLauncher.h"
+#include "TextKernels.h"
+
+#include <sched.h>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // The output of SpawnStub in profile mode, by key; environment entries are kept apart
+    struct ProfileReport
+    {
+        std::string directory;
+        int nice{ 0 };
+        unsigned long long affinity{ 0 };
+        long ioPriority{ -1 };
+        std::vector<std::string> environment;
+
+        bool HasVariable(const std::string& entry) const
+        {
+            for (const std::string& variable : environment)
+            {
+                if (variable == entry) return true;
+            }
+            return false;
+        }
+
+        bool HasName(const std::string& name) const
+        {
+            for (const std::string& variable : environment)
+            {
+                if (variable.compare(0, name.size() + 1, name + "=") == 0) return true;
+            }
+            return false;
+        }
+    };
+
+    // Starts SpawnStub with the profile and returns what it saw
+    bool RunStub(const LaunchProfile& profile, const std::wstring& baseDirectory,
+                 const wchar_t* environmentBlock, ProfileReport& report)
+    {
+        SpawnedProcess process;
+        if (!SpawnWithProfile(DecodeUtf8(SPAWN_STUB_PATH), { L"profile" }, baseDirectory, profile,
+                              environmentBlock, process))
+        {
+            return false;
+        }
+        std::string output;
+        if (FinishSpawnedProcess(process, output) != 0) return false;
+
+        std::istringstream lines(output);
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            if (line.rfind("cwd=", 0) == 0) report.directory = line.substr(4);
+            else if (line.rfind("nice=", 0) == 0) report.nice = std::stoi(line.substr(5));
+            else if (line.rfind("affinity=", 0) == 0) report.affinity = std::stoull(line.substr(9), nullptr, 16);
+            else if (line.rfind("ioprio=", 0) == 0) report.ioPriority = std::stol(line.substr(7));
+            else if (line.rfind("env:", 0) == 0) report.environment.push_back(line.substr(4));
+        }
+        return true;
+    }
+
+    // The lowest processor this process may run on
+    int GetFirstProcessor()
+    {
+        cpu_set_t processors;
+        if (sched_getaffinity(0, sizeof(processors), &processors) != 0) return -1;
+        for (int processor = 0; processor < 64; ++processor)
+        {
+            if (CPU_ISSET(processor, &processors)) return processor;
+        }
+        return -1;
+    }
+}
+
+TEST_CASE(AffinityMasksRoundTripAsProcessorLists)
+{
+    uint64_t mask = 5;
+    CHECK(ParseAffinityMask(L"0-3, 8", mask) && mask == 0x10F);
+    CHECK(FormatAffinityMask(mask) == L"0-3,8");
+    CHECK(ParseAffinityMask(L"", mask) && mask == 0);
+    CHECK(FormatAffinityMask(0).empty());
+    CHECK(ParseAffinityMask(L"63", mask) && mask == 1ull << 63 && FormatAffinityMask(mask) == L"63");
+    CHECK(ParseAffinityMask(L"0-63", mask) && mask == ~0ull && FormatAffinityMask(mask) == L"0-63");
+
+    // A list that does not parse leaves the mask as it was
+    mask = 7;
+    CHECK(!ParseAffinityMask(L"3-1", mask) && mask == 7);
+    CHECK(!ParseAffinityMask(L"64", mask) && mask == 7);
+    CHECK(!ParseAffinityMask(L"1,,2", mask) && mask == 7);
+}
+
+TEST_CASE(PrioritiesParseByName)
+{
+    LaunchPriority priority = LaunchPriority::High;
+    CHECK(ParseLaunchPriority(L" belownormal ", priority) && priority == LaunchPriority::BelowNormal);
+    CHECK(!ParseLaunchPriority(L"realtime", priority) && priority == LaunchPriority::BelowNormal);
+    CHECK(std::wstring(GetLaunchPriorityName(LaunchPriority::AboveNormal)) == L"AboveNormal");
+
+    LaunchProfile profile;
+    CHECK(profile.IsDefault());
+    profile.lowIoPriority = true;
+    CHECK(!profile.IsDefault());
+}
+
+TEST_CASE(EnvironmentBlocksAreSortedLikeWindows)
+{
+    // Drive-letter entries first, then by name without regard to case
+    std::wstring block = BuildEnvironmentBlock(L"b=1\0A=2\0=C:=C:\\x\0\0", L"c=3|Path=p|a=9");
+    CHECK(block == std::wstring(L"=C:=C:\\x\0A=9\0b=1\0c=3\0Path=p\0\0", 29));
+    CHECK(BuildEnvironmentBlock(nullptr, L"") == std::wstring(L"\0\0", 2));
+    CHECK(BuildEnvironmentBlock(nullptr, L"X=%%Y%") == std::wstring(L"X=%%Y%\0\0", 8));
+}
+
+TEST_CASE(SpawnedProgramsGetTheEnvironmentBlock)
+{
+    setenv("MTL_BASE", "base", 1);
+    setenv("MTL_GONE", "x", 1);
+    std::wstring parent = GetOwnEnvironmentBlock();
+    std::wstring block = BuildEnvironmentBlock(parent.c_str(),
+        L"MTL_NEW=hello | MTL_BASE=%MTL_BASE%;more|MTL_GONE=|MTL_REF=%MTL_NEW%-%UNDEFINED_X%|bogus|=x");
+
+    LaunchProfile profile;
+    ProfileReport report;
+    REQUIRE(RunStub(profile, L"/", block.c_str(), report));
+    CHECK(report.HasVariable("MTL_NEW=hello"));
+    CHECK(report.HasVariable("MTL_BASE=base;more"));
+    CHECK(!report.HasName("MTL_GONE"));
+    CHECK(report.HasVariable("MTL_REF=hello-%UNDEFINED_X%"));
+    CHECK(report.HasName("PATH"));
+    unsetenv("MTL_BASE");
+    unsetenv("MTL_GONE");
+}
+
+TEST_CASE(SpawnedProgramsStartInTheWorkingDirectory)
+{
+    TestHarness::TemporaryDirectory directory("LaunchProfileTests");
+    std::filesystem::create_directories(directory.path / "tools" / "bin");
+    std::wstring base = directory.path.wstring();
+
+    LaunchProfile profile;
+    ProfileReport report;
+    REQUIRE(RunStub(profile, base, nullptr, report));
+    CHECK(std::filesystem::equivalent(report.directory, directory.path));
+
+    profile.workingDirectory = L"tools/bin";
+    report = ProfileReport();
+    REQUIRE(RunStub(profile, base, nullptr, report));
+    CHECK(std::filesystem::equivalent(report.directory, directory.path / "tools" / "bin"));
+
+    // A directory that does not exist keeps the program from starting, as on Windows
+    profile.workingDirectory = L"missing";
+    report = ProfileReport();
+    CHECK(!RunStub(profile, base, nullptr, report));
+}
+
+TEST_CASE(SpawnedProgramsGetThePriorityAffinityAndIoClass)
+{
+    ProfileReport defaults;
+    REQUIRE(RunStub(LaunchProfile(), L"/", nullptr, defaults));
+
+    int processor = GetFirstProcessor();
+    REQUIRE(processor >= 0);
+    LaunchProfile profile;
+    profile.priority = LaunchPriority::BelowNormal;
+    profile.affinityMask = 1ull << processor;
+    profile.lowIoPriority = true;
+    ProfileReport report;
+    REQUIRE(RunStub(profile, L"/", nullptr, report));
+    CHECK(report.nice == GetNiceValue(LaunchPriority::BelowNormal));
+    CHECK(report.affinity == 1ull << processor);
+    CHECK(report.ioPriority == (2 << 13 | 7));
+
+    // Processors the machine does not have are left out rather than failing the launch
+    profile = LaunchProfile();
+    profile.affinityMask = 1ull << 63 | 1ull << processor;
+    report = ProfileReport();
+    REQUIRE(RunStub(profile, L"/", nullptr, report));
+    CHECK((report.affinity & 1ull << processor) != 0);
+    CHECK(report.nice == defaults.nice);
+}
@@ -0,0 +1,140 @@
+#include "PidfdProcessTracker.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdint>
+
+PidfdProcessTracker::~PidfdProcessTracker()
+{
+    Stop();
+}
+
+bool PidfdProcessTracker::Start(ExitCallback onExit)
+{
+    if (m_waitThread.joinable()) return true;
+
+    m_onExit = std::move(onExit);
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = m_wakeEvent;
+    if (m_epoll < 0 || m_wakeEvent < 0 || epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeEvent, &event) != 0)
+    {
+        Stop();
+        return false;
+    }
+    m_waitThread = std::thread(&PidfdProcessTracker::RunWaitLoop, this);
+    return true;
+}
+
+/**
+ * @brief Stops the wait thread and closes the remaining pidfds. The processes keep running.
+ */
+void PidfdProcessTracker::Stop()
+{
+    if (m_waitThread.joinable())
+    {
+        uint64_t one = 1;
+        ssize_t written = write(m_wakeEvent, &one, sizeof(one));
+        (void)written;
+        m_waitThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (ProcessRegistry::ProcessRef pidfd : m_registry.TakeAll())
+    {
+        close(static_cast<int>(pidfd));
+    }
+    if (m_wakeEvent >= 0) close(m_wakeEvent);
+    if (m_epoll >= 0) close(m_epoll);
+    m_wakeEvent = -1;
+    m_epoll = -1;
+}
+
+/**
+ * @brief Starts tracking a process.
+ * @return False if the process is already gone or cannot be observed.
+ */
+bool PidfdProcessTracker::Track(ButtonKey key, pid_t processId)
+{
+    int pidfd = static_cast<int>(syscall(SYS_pidfd_open, processId, 0));
+    if (pidfd < 0) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = pidfd;
+    if (m_epoll < 0 || !m_registry.Add(key, static_cast<ProcessRegistry::ProcessRef>(pidfd), static_cast<uint32_t>(processId)))
+    {
+        close(pidfd);
+        return false;
+    }
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, pidfd, &event) != 0)
+    {
+        ButtonKey removedKey;
+        m_registry.Remove(static_cast<ProcessRegistry::ProcessRef>(pidfd), removedKey);
+        close(pidfd);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stops tracking the processes of a button; their exits are no longer reported.
+ */
+void PidfdProcessTracker::Forget(ButtonKey key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (ProcessRegistry::ProcessRef pidfd : m_registry.Forget(key))
+    {
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, static_cast<int>(pidfd), nullptr);
+        close(static_cast<int>(pidfd));
+    }
+}
+
+bool PidfdProcessTracker::IsRunning(ButtonKey key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_registry.IsRunning(key);
+}
+
+std::vector<uint32_t> PidfdProcessTracker::GetProcessIds(ButtonKey key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_registry.GetProcessIds(key);
+}
+
+size_t PidfdProcessTracker::GetTrackedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_registry.GetCount();
+}
+
+void PidfdProcessTracker::RunWaitLoop()
+{
+    epoll_event events[64];
+    while (true)
+    {
+        int count = epoll_wait(m_epoll, events, 64, -1);
+        for (int i = 0; i < count; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == m_wakeEvent)
+            {
+                return;
+            }
+
+            ButtonKey key;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_registry.Remove(static_cast<ProcessRegistry::ProcessRef>(fd), key)) continue;
+                epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+                close(fd);
+            }
+            if (m_onExit) m_onExit(key);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <sys/types.h>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ProcessRegistry.h"
+
+/**
+ * @brief The Linux stand-in for ProcessTracker: a pidfd per process, all waited on by one
+ *        thread through epoll, with the same ProcessRegistry bookkeeping.
+ *
+ * Processes are not reaped; as with a handle on Windows, the pidfd only observes the exit.
+ * The exit callback runs on the wait thread, after the process was forgotten.
+ */
+class PidfdProcessTracker
+{
+public:
+    using ExitCallback = std::function<void(ButtonKey key)>;
+
+    PidfdProcessTracker() = default;
+    ~PidfdProcessTracker();
+
+    PidfdProcessTracker(const PidfdProcessTracker&) = delete;
+    PidfdProcessTracker& operator=(const PidfdProcessTracker&) = delete;
+
+    bool Start(ExitCallback onExit);
+    void Stop();
+
+    bool Track(ButtonKey key, pid_t processId);
+    void Forget(ButtonKey key);
+    bool IsRunning(ButtonKey key) const;
+    std::vector<uint32_t> GetProcessIds(ButtonKey key) const;
+    size_t GetTrackedCount() const;
+
+private:
+    void RunWaitLoop();
+
+    mutable std::mutex m_mutex;
+    ProcessRegistry m_registry;
+    ExitCallback m_onExit;
+
+    int m_epoll{ -1 };
+    int m_wakeEvent{ -1 };
+    std::thread m_waitThread;
+};
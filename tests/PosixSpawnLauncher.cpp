@@ -0,0 +1,174 @@
+#include "PosixSpawnLauncher.h"
+#include "TextKernels.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cwchar>
+#include <filesystem>
+
+extern char** environ;
+
+namespace
+{
+    const int IOPRIO_WHO_PROCESS = 1;
+    const int IOPRIO_CLASS_BEST_EFFORT = 2;
+    const int IOPRIO_CLASS_SHIFT = 13;
+
+    std::string ToUtf8(std::wstring_view text)
+    {
+        std::string bytes;
+        AppendUtf8(text, bytes);
+        return bytes;
+    }
+
+    /**
+     * @brief Sets the priority, processor affinity and I/O priority of a started process.
+     *        Settings the process may not change, such as a raised priority without the
+     *        privilege, stay as they are; the same goes for ApplyLaunchProfile on Windows.
+     */
+    void ApplyLaunchProfile(pid_t processId, const LaunchProfile& profile)
+    {
+        if (profile.priority != LaunchPriority::Normal)
+        {
+            setpriority(PRIO_PROCESS, static_cast<id_t>(processId), GetNiceValue(profile.priority));
+        }
+
+        if (profile.affinityMask != 0)
+        {
+            // Processors the machine does not have are dropped from the mask
+            cpu_set_t available;
+            cpu_set_t processors;
+            CPU_ZERO(&processors);
+            if (sched_getaffinity(0, sizeof(available), &available) == 0)
+            {
+                for (int processor = 0; processor < 64; ++processor)
+                {
+                    if ((profile.affinityMask >> processor & 1) != 0 && CPU_ISSET(processor, &available))
+                    {
+                        CPU_SET(processor, &processors);
+                    }
+                }
+                if (CPU_COUNT(&processors) != 0) sched_setaffinity(processId, sizeof(processors), &processors);
+            }
+        }
+
+        if (profile.lowIoPriority)
+        {
+            // The lowest level of the default class, as IoPriorityLow is on Windows
+            syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, processId, IOPRIO_CLASS_BEST_EFFORT << IOPRIO_CLASS_SHIFT | 7);
+        }
+    }
+}
+
+/**
+ * @param executablePath The absolute path of the program.
+ * @param arguments Its arguments, without the program name.
+ * @param baseDirectory The directory a relative working directory is resolved against.
+ * @param profile The launch profile of the button.
+ * @param environmentBlock The environment of the program, or NULL for the process's own.
+ * @param process Receives the process and the pipes to it.
+ * @return True on success, false if the program could not be started.
+ */
+bool SpawnWithProfile(const std::wstring& executablePath, const std::vector<std::wstring>& arguments,
+                      const std::wstring& baseDirectory, const LaunchProfile& profile,
+                      const wchar_t* environmentBlock, SpawnedProcess& process)
+{
+    std::string path = ToUtf8(executablePath);
+    std::vector<std::string> argumentStrings = { path };
+    for (const std::wstring& argument : arguments) argumentStrings.push_back(ToUtf8(argument));
+    std::vector<char*> argv;
+    for (std::string& argument : argumentStrings) argv.push_back(argument.data());
+    argv.push_back(nullptr);
+
+    std::vector<std::string> environmentStrings;
+    for (const wchar_t* entry = environmentBlock; entry && *entry; entry += std::wcslen(entry) + 1)
+    {
+        environmentStrings.push_back(ToUtf8(entry));
+    }
+    std::vector<char*> envp;
+    for (std::string& entry : environmentStrings) envp.push_back(entry.data());
+    envp.push_back(nullptr);
+
+    std::filesystem::path workingDirectory(baseDirectory);
+    if (!profile.workingDirectory.empty()) workingDirectory /= profile.workingDirectory;
+
+    int input[2];
+    int output[2];
+    if (pipe2(input, O_CLOEXEC) != 0) return false;
+    if (pipe2(output, O_CLOEXEC) != 0)
+    {
+        close(input[0]);
+        close(input[1]);
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, input[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, output[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addchdir_np(&actions, workingDirectory.c_str());
+    pid_t processId = -1;
+    int result = posix_spawn(&processId, path.c_str(), &actions, nullptr, argv.data(),
+        environmentBlock ? envp.data() : environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(input[0]);
+    close(output[1]);
+    if (result != 0)
+    {
+        close(input[1]);
+        close(output[0]);
+        return false;
+    }
+
+    ApplyLaunchProfile(processId, profile);
+    process.processId = processId;
+    process.input = input[1];
+    process.output = output[0];
+    return true;
+}
+
+int FinishSpawnedProcess(SpawnedProcess& process, std::string& output)
+{
+    if (process.input >= 0) close(process.input);
+    char buffer[4096];
+    ssize_t length;
+    while (process.output >= 0 && (length = read(process.output, buffer, sizeof(buffer))) > 0)
+    {
+        output.append(buffer, static_cast<size_t>(length));
+    }
+    if (process.output >= 0) close(process.output);
+
+    int status = 0;
+    bool exited = process.processId > 0 && waitpid(process.processId, &status, 0) == process.processId;
+    process = SpawnedProcess();
+    return exited && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+std::wstring GetOwnEnvironmentBlock()
+{
+    std::wstring block;
+    for (char** entry = environ; *entry; ++entry)
+    {
+        block += DecodeUtf8(*entry);
+        block += L'\0';
+    }
+    block += L'\0';
+    return block;
+}
+
+int GetNiceValue(LaunchPriority priority)
+{
+    switch (priority)
+    {
+    case LaunchPriority::Idle: return 19;
+    case LaunchPriority::BelowNormal: return 10;
+    case LaunchPriority::AboveNormal: return -5;
+    case LaunchPriority::High: return -10;
+    default: return 0;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+#include "LaunchProfile.h"
+
+// A program started by SpawnWithProfile, with pipes to its standard input and output
+struct SpawnedProcess
+{
+    pid_t processId{ -1 };
+    int input{ -1 };
+    int output{ -1 };
+};
+
+/**
+ * @brief The Linux stand-in for CreateProcessWithProfile: starts a program with posix_spawn
+ *        in the working directory of its profile and with the environment block built by
+ *        BuildEnvironmentBlock, then sets its nice value, processor affinity and I/O class.
+ *
+ * posix_spawn cannot start a program suspended as CreateProcess can, so the settings apply
+ * just after it started; the programs of the tests wait for their input first. Wide
+ * strings are converted as UTF-8, and the working directory is not expanded.
+ */
+bool SpawnWithProfile(const std::wstring& executablePath, const std::vector<std::wstring>& arguments,
+                      const std::wstring& baseDirectory, const LaunchProfile& profile,
+                      const wchar_t* environmentBlock, SpawnedProcess& process);
+
+// Closes the input of the program, reads all of its output and reaps it; -1 if it failed
+int FinishSpawnedProcess(SpawnedProcess& process, std::string& output);
+
+// The process's own environment in the format of BuildEnvironmentBlock
+std::wstring GetOwnEnvironmentBlock();
+
+// The nice value that stands in for a priority class
+int GetNiceValue(LaunchPriority priority);
@@ -0,0 +1,236 @@
+#include "TestHarness.h"
+#include "FadvisePrefetchBackend.h"
+#include "PrefetchScheduler.h"
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <vector>
+
+extern char** environ;
+
+namespace
+{
+    const uint64_t MB = 1024 * 1024;
+
+    // Files that exist only in memory; records what the scheduler asked for
+    class MockPrefetchBackend : public PrefetchBackend
+    {
+    public:
+        struct File
+        {
+            uint64_t size;
+            uint64_t lastWriteTime;
+        };
+
+        std::map<std::wstring, File> files;
+        std::vector<std::wstring> openedFiles;
+        std::vector<uint64_t> chunkSizes;
+        CancellationToken cancelAfterChunks;
+        size_t cancelAfterChunkCount{ 0 };
+
+        bool OpenFile(const std::wstring& filePath, uint64_t& lastWriteTime) override
+        {
+            auto found = files.find(filePath);
+            if (found == files.end()) return false;
+            openedFiles.push_back(filePath);
+            m_file = &found->second;
+            m_offset = 0;
+            lastWriteTime = m_file->lastWriteTime;
+            return true;
+        }
+
+        uint64_t PrefetchChunk(uint64_t maxBytes) override
+        {
+            uint64_t chunkSize = (std::min)(maxBytes, m_file->size - m_offset);
+            m_offset += chunkSize;
+            if (chunkSize > 0) chunkSizes.push_back(chunkSize);
+            if (cancelAfterChunkCount > 0 && chunkSizes.size() == cancelAfterChunkCount)
+            {
+                cancelAfterChunks.Cancel();
+            }
+            return chunkSize;
+        }
+
+        void CloseFile() override { m_file = nullptr; }
+        void PauseBetweenChunks() override {}
+
+    private:
+        File* m_file{ nullptr };
+        uint64_t m_offset{ 0 };
+    };
+
+    void WriteFile(const std::filesystem::path& path, uint64_t size)
+    {
+        std::vector<char> block(MB);
+        for (size_t i = 0; i < block.size(); i++) block[i] = static_cast<char>(i * 131);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        for (uint64_t written = 0; written < size; written += block.size())
+        {
+            file.write(block.data(), static_cast<std::streamsize>((std::min)(static_cast<uint64_t>(block.size()), size - written)));
+        }
+    }
+
+    // Starts the stub on an image file and waits for it, as a launch of a program would
+    double LaunchStubMs(const std::string& imagePath)
+    {
+        char program[] = SPAWN_STUB_PATH;
+        char mode[] = "image";
+        std::string image = imagePath;
+        char* arguments[] = { program, mode, image.data(), nullptr };
+
+        auto start = std::chrono::steady_clock::now();
+        pid_t child = 0;
+        if (posix_spawn(&child, program, nullptr, nullptr, arguments, environ) != 0) return -1.0;
+        int status = 0;
+        waitpid(child, &status, 0);
+        double elapsedMs = TestHarness::ElapsedMs(start);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? elapsedMs : -1.0;
+    }
+
+    double Median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+}
+
+TEST_CASE(PassStopsWhenTheBudgetIsSpent)
+{
+    MockPrefetchBackend backend;
+    backend.files[L"a.exe"] = { 3 * MB, 1 };
+    backend.files[L"b.exe"] = { 3 * MB, 1 };
+    backend.files[L"c.exe"] = { 3 * MB, 1 };
+
+    PrefetchScheduler scheduler;
+    uint64_t prefetched = scheduler.RunPass(backend, { L"a.exe", L"b.exe", L"c.exe" }, 4 * MB + 1000, 0, CancellationToken());
+
+    CHECK(prefetched == 4 * MB + 1000);
+    CHECK(backend.openedFiles == std::vector<std::wstring>({ L"a.exe", L"b.exe" }));
+    CHECK(std::all_of(backend.chunkSizes.begin(), backend.chunkSizes.end(), [](uint64_t size) { return size <= PrefetchScheduler::CHUNK_SIZE; }));
+    CHECK(backend.chunkSizes.back() == 1000);
+    // Only the file that was read to its end is remembered
+    CHECK(scheduler.GetRememberedFileCount() == 1);
+}
+
+TEST_CASE(UnchangedFilesAreSkippedUntilTheRefreshInterval)
+{
+    MockPrefetchBackend backend;
+    backend.files[L"a.exe"] = { 2 * MB + 5, 7 };
+    PrefetchScheduler scheduler;
+
+    CHECK(scheduler.RunPass(backend, { L"a.exe" }, 100 * MB, 1000, CancellationToken()) == 2 * MB + 5);
+    CHECK(scheduler.RunPass(backend, { L"a.exe" }, 100 * MB, 2000, CancellationToken()) == 0);
+
+    uint64_t expired = 1000 + PrefetchScheduler::REFRESH_INTERVAL_MS;
+    CHECK(scheduler.RunPass(backend, { L"a.exe" }, 100 * MB, expired, CancellationToken()) == 2 * MB + 5);
+}
+
+TEST_CASE(ChangedFilesAreReadAgain)
+{
+    MockPrefetchBackend backend;
+    backend.files[L"a.exe"] = { MB, 7 };
+    PrefetchScheduler scheduler;
+
+    CHECK(scheduler.RunPass(backend, { L"a.exe" }, 100 * MB, 0, CancellationToken()) == MB);
+    backend.files[L"a.exe"].lastWriteTime = 8;
+    CHECK(scheduler.RunPass(backend, { L"a.exe" }, 100 * MB, 1, CancellationToken()) == MB);
+    CHECK(scheduler.RunPass(backend, { L"a.exe" }, 100 * MB, 2, CancellationToken()) == 0);
+}
+
+TEST_CASE(PartiallyReadFilesAreReadAgain)
+{
+    MockPrefetchBackend backend;
+    backend.files[L"a.exe"] = { 3 * MB, 1 };
+    PrefetchScheduler scheduler;
+
+    CHECK(scheduler.RunPass(backend, { L"a.exe" }, 2 * MB, 0, CancellationToken()) == 2 * MB);
+    CHECK(!scheduler.IsFresh(L"a.exe", 1, 1));
+    CHECK(scheduler.RunPass(backend, { L"a.exe" }, 100 * MB, 1, CancellationToken()) == 3 * MB);
+    CHECK(scheduler.IsFresh(L"a.exe", 1, 2));
+}
+
+TEST_CASE(MissingFilesAreSkipped)
+{
+    MockPrefetchBackend backend;
+    backend.files[L"b.exe"] = { MB, 1 };
+    PrefetchScheduler scheduler;
+
+    CHECK(scheduler.RunPass(backend, { L"missing.exe", L"b.exe" }, 100 * MB, 0, CancellationToken()) == MB);
+    CHECK(scheduler.GetRememberedFileCount() == 1);
+}
+
+TEST_CASE(CancellingStopsThePassBetweenChunks)
+{
+    MockPrefetchBackend backend;
+    backend.files[L"a.exe"] = { 10 * MB, 1 };
+    backend.files[L"b.exe"] = { 10 * MB, 1 };
+    backend.cancelAfterChunks = CancellationToken::Create();
+    backend.cancelAfterChunkCount = 3;
+    PrefetchScheduler scheduler;
+
+    uint64_t prefetched = scheduler.RunPass(backend, { L"a.exe", L"b.exe" }, 100 * MB, 0, backend.cancelAfterChunks);
+
+    CHECK(prefetched == 3 * MB);
+    CHECK(backend.openedFiles.size() == 1);
+    CHECK(scheduler.GetRememberedFileCount() == 0);
+}
+
+TEST_CASE(FadviseBackendBringsFilesIntoThePageCache)
+{
+    TestHarness::TemporaryDirectory directory("prefetch");
+    std::filesystem::path filePath = directory.path / "program.bin";
+    WriteFile(filePath, 16 * MB);
+
+    REQUIRE(FadvisePrefetchBackend::EvictFromCache(filePath.string()));
+    double cachedBefore = FadvisePrefetchBackend::GetCachedFraction(filePath.string());
+    TestHarness::Report("Cached before the pass", cachedBefore * 100.0, "%");
+
+    FadvisePrefetchBackend backend;
+    PrefetchScheduler scheduler;
+    uint64_t prefetched = scheduler.RunPass(backend, { filePath.wstring() }, 64 * MB, 0, CancellationToken());
+    double cachedAfter = FadvisePrefetchBackend::GetCachedFraction(filePath.string());
+    TestHarness::Report("Cached after the pass", cachedAfter * 100.0, "%");
+
+    CHECK(prefetched == 16 * MB);
+    CHECK(cachedAfter > 0.9);
+    CHECK(scheduler.GetRememberedFileCount() == 1);
+
+    // Touching the file changes its write time, so the next pass reads it again
+    std::filesystem::last_write_time(filePath, std::filesystem::last_write_time(filePath) + std::chrono::seconds(1));
+    CHECK(scheduler.RunPass(backend, { filePath.wstring() }, 64 * MB, 1, CancellationToken()) == 16 * MB);
+}
+
+TEST_CASE(LaunchLatencyColdAndAfterPrefetch)
+{
+    const int LAUNCH_COUNT = 5;
+    TestHarness::TemporaryDirectory directory("prefetch");
+    std::filesystem::path imagePath = directory.path / "image.bin";
+    WriteFile(imagePath, 64 * MB);
+
+    std::vector<double> coldMs;
+    std::vector<double> warmMs;
+    std::vector<double> passMs;
+    for (int i = 0; i < LAUNCH_COUNT; i++)
+    {
+        REQUIRE(FadvisePrefetchBackend::EvictFromCache(imagePath.string()));
+        coldMs.push_back(LaunchStubMs(imagePath.string()));
+
+        REQUIRE(FadvisePrefetchBackend::EvictFromCache(imagePath.string()));
+        FadvisePrefetchBackend backend;
+        PrefetchScheduler scheduler;
+        auto start = std::chrono::steady_clock::now();
+        scheduler.RunPass(backend, { imagePath.wstring() }, 256 * MB, 0, CancellationToken());
+        passMs.push_back(TestHarness::ElapsedMs(start));
+        warmMs.push_back(LaunchStubMs(imagePath.string()));
+    }
+    CHECK(std::none_of(coldMs.begin(), coldMs.end(), [](double ms) { return ms < 0; }));
+    CHECK(std::none_of(warmMs.begin(), warmMs.end(), [](double ms) { return ms < 0; }));
+
+    // Timings depend on the disk, so they are reported rather than checked
+    TestHarness::Report("Cold launch, 64 MB image (median)", Median(coldMs), "ms");
+    TestHarness::Report("Prefetch pass, 64 MB (median)", Median(passMs), "ms");
+    TestHarness::Report("Launch after prefetch (median)", Median(warmMs), "ms");
+}
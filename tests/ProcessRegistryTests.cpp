@@ -0,0 +1,242 @@
+#include "TestHarness.h"
+#include "PidfdProcessTracker.h"
+#include "ProcessRegistry.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <random>
+
+namespace
+{
+    // Children that block until the write end of a pipe is closed, then exit
+    class ChildProcesses
+    {
+    public:
+        ChildProcesses()
+        {
+            if (pipe(m_pipe) != 0) m_pipe[0] = m_pipe[1] = -1;
+        }
+
+        ~ChildProcesses()
+        {
+            Release();
+            for (pid_t child : m_children) waitpid(child, nullptr, 0);
+        }
+
+        pid_t Spawn()
+        {
+            pid_t child = fork();
+            if (child == 0)
+            {
+                char byte;
+                close(m_pipe[1]);
+                ssize_t result = read(m_pipe[0], &byte, 1);
+                _exit(result == 0 ? 0 : 1);
+            }
+            if (child > 0) m_children.push_back(child);
+            return child;
+        }
+
+        void Release()
+        {
+            if (m_pipe[1] >= 0) close(m_pipe[1]);
+            if (m_pipe[0] >= 0) close(m_pipe[0]);
+            m_pipe[0] = m_pipe[1] = -1;
+        }
+
+    private:
+        int m_pipe[2];
+        std::vector<pid_t> m_children;
+    };
+
+    // Exit notifications collected from the wait thread
+    struct ExitLog
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::map<std::pair<int, int>, int> exitsByButton;
+        size_t exitCount{ 0 };
+
+        void Add(ButtonKey key)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            exitsByButton[{ key.tab, key.button }]++;
+            exitCount++;
+            changed.notify_all();
+        }
+
+        bool WaitFor(size_t count)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            return changed.wait_for(lock, std::chrono::seconds(60), [&] { return exitCount >= count; });
+        }
+    };
+}
+
+TEST_CASE(RegistryKeepsProcessesOfAButtonInLaunchOrder)
+{
+    ProcessRegistry registry;
+    CHECK(registry.Add({ 0, 1 }, 100, 1000));
+    CHECK(registry.Add({ 0, 1 }, 101, 1001));
+    CHECK(registry.Add({ 2, 0 }, 102, 1002));
+    CHECK(!registry.Add({ 3, 3 }, 101, 1003));
+
+    CHECK(registry.GetCount() == 3);
+    CHECK(registry.IsRunning({ 0, 1 }));
+    CHECK(!registry.IsRunning({ 1, 0 }));
+    CHECK((registry.GetProcessIds({ 0, 1 }) == std::vector<uint32_t>{ 1001, 1000 }));
+
+    ButtonKey key;
+    CHECK(registry.Remove(101, key));
+    CHECK((key == ButtonKey{ 0, 1 }));
+    CHECK(!registry.Remove(101, key));
+    CHECK((registry.GetProcessIds({ 0, 1 }) == std::vector<uint32_t>{ 1000 }));
+    CHECK(registry.Remove(100, key));
+    CHECK(!registry.IsRunning({ 0, 1 }));
+
+    std::vector<ProcessRegistry::ProcessRef> remaining = registry.TakeAll();
+    CHECK((remaining == std::vector<ProcessRegistry::ProcessRef>{ 102 }));
+    CHECK(registry.GetCount() == 0);
+    CHECK(!registry.IsRunning({ 2, 0 }));
+}
+
+TEST_CASE(RegistryForgetsTheProcessesOfOneButton)
+{
+    ProcessRegistry registry;
+    registry.Add({ 1, 1 }, 10, 100);
+    registry.Add({ 1, 2 }, 11, 101);
+    registry.Add({ 1, 1 }, 12, 102);
+
+    std::vector<ProcessRegistry::ProcessRef> forgotten = registry.Forget({ 1, 1 });
+    CHECK((forgotten == std::vector<ProcessRegistry::ProcessRef>{ 10, 12 }));
+    CHECK(!registry.IsRunning({ 1, 1 }));
+    CHECK(registry.IsRunning({ 1, 2 }));
+    CHECK(registry.GetCount() == 1);
+    CHECK(registry.Forget({ 1, 1 }).empty());
+
+    // The exit of a forgotten process is not attributed to anything
+    ButtonKey key;
+    CHECK(!registry.Remove(12, key));
+}
+
+TEST_CASE(RegistryHandlesTenThousandProcesses)
+{
+    const int PROCESS_COUNT = 10000;
+    const int BUTTON_COUNT = 500;
+    ProcessRegistry registry;
+    std::vector<ProcessRegistry::ProcessRef> refs;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < PROCESS_COUNT; ++i)
+    {
+        ButtonKey key{ (i % BUTTON_COUNT) / 20, (i % BUTTON_COUNT) % 20 };
+        CHECK(registry.Add(key, static_cast<ProcessRegistry::ProcessRef>(i) * 4 + 8, static_cast<uint32_t>(i)));
+        refs.push_back(static_cast<ProcessRegistry::ProcessRef>(i) * 4 + 8);
+    }
+    TestHarness::Report("Add (us per process)", TestHarness::ElapsedMs(start) * 1000 / PROCESS_COUNT, "us");
+    CHECK(registry.GetCount() == PROCESS_COUNT);
+    CHECK(registry.GetProcessIds({ 0, 0 }).size() == PROCESS_COUNT / BUTTON_COUNT);
+    CHECK(registry.GetProcessIds({ 0, 0 }).front() == PROCESS_COUNT - BUTTON_COUNT);
+
+    std::shuffle(refs.begin(), refs.end(), std::mt19937(26));
+    start = std::chrono::steady_clock::now();
+    for (ProcessRegistry::ProcessRef ref : refs)
+    {
+        ButtonKey key;
+        CHECK(registry.Remove(ref, key));
+        int index = static_cast<int>((ref - 8) / 4);
+        CHECK((key == ButtonKey{ (index % BUTTON_COUNT) / 20, (index % BUTTON_COUNT) % 20 }));
+    }
+    TestHarness::Report("Remove (us per process)", TestHarness::ElapsedMs(start) * 1000 / PROCESS_COUNT, "us");
+    CHECK(registry.GetCount() == 0);
+    for (int button = 0; button < BUTTON_COUNT; ++button)
+    {
+        CHECK(!registry.IsRunning({ button / 20, button % 20 }));
+    }
+}
+
+TEST_CASE(PidfdTrackerReportsEveryExitOfThousandsOfChildren)
+{
+    const int CHILD_COUNT = 2000;
+    const int BUTTON_COUNT = 100;
+    ExitLog exits;
+    PidfdProcessTracker tracker;
+    REQUIRE(tracker.Start([&](ButtonKey key) { exits.Add(key); }));
+
+    ChildProcesses children;
+    for (int i = 0; i < CHILD_COUNT; ++i)
+    {
+        pid_t child = children.Spawn();
+        REQUIRE(child > 0);
+        CHECK(tracker.Track({ i % BUTTON_COUNT, 0 }, child));
+    }
+    CHECK(tracker.GetTrackedCount() == CHILD_COUNT);
+    CHECK(tracker.IsRunning({ 7, 0 }));
+    CHECK(tracker.GetProcessIds({ 7, 0 }).size() == CHILD_COUNT / BUTTON_COUNT);
+    CHECK(exits.exitCount == 0);
+
+    auto start = std::chrono::steady_clock::now();
+    children.Release();
+    REQUIRE(exits.WaitFor(CHILD_COUNT));
+    TestHarness::Report("Release to last exit reported", TestHarness::ElapsedMs(start), "ms");
+
+    CHECK(tracker.GetTrackedCount() == 0);
+    CHECK(!tracker.IsRunning({ 7, 0 }));
+    CHECK(exits.exitsByButton.size() == BUTTON_COUNT);
+    for (const auto& [button, count] : exits.exitsByButton)
+    {
+        CHECK(count == CHILD_COUNT / BUTTON_COUNT);
+    }
+    tracker.Stop();
+}
+
+TEST_CASE(PidfdTrackerDoesNotReportExitsOfForgottenButtons)
+{
+    ExitLog exits;
+    PidfdProcessTracker tracker;
+    REQUIRE(tracker.Start([&](ButtonKey key) { exits.Add(key); }));
+
+    ChildProcesses children;
+    for (int i = 0; i < 20; ++i)
+    {
+        pid_t child = children.Spawn();
+        REQUIRE(child > 0);
+        CHECK(tracker.Track({ 0, i % 2 }, child));
+    }
+    // The button now launches another program
+    tracker.Forget({ 0, 1 });
+    CHECK(tracker.GetTrackedCount() == 10);
+    CHECK(!tracker.IsRunning({ 0, 1 }));
+
+    children.Release();
+    REQUIRE(exits.WaitFor(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(exits.exitCount == 10);
+    CHECK((exits.exitsByButton == std::map<std::pair<int, int>, int>{ { { 0, 0 }, 10 } }));
+    tracker.Stop();
+}
+
+TEST_CASE(PidfdTrackerStopsWithProcessesStillRunning)
+{
+    ExitLog exits;
+    PidfdProcessTracker tracker;
+    REQUIRE(tracker.Start([&](ButtonKey key) { exits.Add(key); }));
+
+    ChildProcesses children;
+    for (int i = 0; i < 10; ++i)
+    {
+        pid_t child = children.Spawn();
+        REQUIRE(child > 0);
+        CHECK(tracker.Track({ 0, i }, child));
+    }
+    tracker.Stop();
+    CHECK(tracker.GetTrackedCount() == 0);
+    CHECK(!tracker.Track({ 0, 0 }, getpid()));
+
+    children.Release();
+    CHECK(exits.exitCount == 0);
+}
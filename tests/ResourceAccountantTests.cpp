@@ -0,0 +1,153 @@
+#include "TestHarness.h"
+#include "ResourceAccountant.h"
+
+#include <map>
+#include <vector>
+
+namespace
+{
+    // Tab pages that exist only as counts, loaded and released the way the launcher does:
+    // a visited page is created with a window per button, then pages over the limits go
+    class MockLauncher
+    {
+    public:
+        ResourceAccountant accountant;
+        ResourceLimits limits;
+        std::map<int, PageUsage> pages;
+        int releasedPages{ 0 };
+
+        void Visit(int tab, int64_t buttons)
+        {
+            auto current = pages.find(m_currentTab);
+            if (current != pages.end()) current->second.lastVisit = m_clock;
+            ++m_clock;
+
+            if (pages.find(tab) == pages.end())
+            {
+                pages[tab] = PageUsage{ tab, buttons, buttons + 1, m_clock };
+                accountant.Add(ResourceOwner::TabPages, ResourceKind::Windows, 1);
+                accountant.Add(ResourceOwner::Buttons, ResourceKind::Windows, buttons);
+                accountant.Add(ResourceOwner::Buttons, ResourceKind::Icons, buttons);
+            }
+            pages[tab].lastVisit = m_clock;
+            m_currentTab = tab;
+            ++m_clock;
+
+            std::vector<PageUsage> loaded;
+            for (const auto& [loadedTab, page] : pages) loaded.push_back(page);
+            for (int evicted : ResourceAccountant::SelectPagesOverLimits(loaded, limits,
+                accountant.GetTotal(ResourceKind::Icons), accountant.GetTotal(ResourceKind::Windows), tab))
+            {
+                Release(evicted);
+            }
+        }
+
+        void Release(int tab)
+        {
+            const PageUsage& page = pages.at(tab);
+            accountant.Add(ResourceOwner::TabPages, ResourceKind::Windows, -1);
+            accountant.Add(ResourceOwner::Buttons, ResourceKind::Windows, -(page.windows - 1));
+            accountant.Add(ResourceOwner::Buttons, ResourceKind::Icons, -page.icons);
+            pages.erase(tab);
+            ++releasedPages;
+        }
+
+        bool IsLoaded(int tab) const { return pages.find(tab) != pages.end(); }
+
+    private:
+        uint64_t m_clock{ 0 };
+        int m_currentTab{ -1 };
+    };
+}
+
+TEST_CASE(CountersAddUpPerOwnerAndKeepThePeak)
+{
+    ResourceAccountant accountant;
+    accountant.Add(ResourceOwner::Buttons, ResourceKind::Icons, 40);
+    accountant.Add(ResourceOwner::Tray, ResourceKind::Icons, 1);
+    accountant.Add(ResourceOwner::Buttons, ResourceKind::Icons, -10);
+    accountant.Set(ResourceOwner::Theme, ResourceKind::GdiObjects, 12);
+    CHECK(accountant.GetCount(ResourceOwner::Buttons, ResourceKind::Icons) == 30);
+    CHECK(accountant.GetTotal(ResourceKind::Icons) == 31);
+    CHECK(accountant.GetPeak(ResourceKind::Icons) == 41);
+    CHECK(accountant.GetTotal(ResourceKind::GdiObjects) == 12);
+    CHECK(accountant.GetTotal(ResourceKind::Windows) == 0);
+
+    std::string report = accountant.FormatReport();
+    CHECK(report.find("Buttons") != std::string::npos);
+    CHECK(report.find("Peak") != std::string::npos);
+}
+
+TEST_CASE(PagesOverTheIconLimitAreReleasedLeastRecentlyVisitedFirst)
+{
+    MockLauncher launcher;
+    launcher.limits.maxIcons = 100;
+    for (int tab = 0; tab < 10; ++tab) launcher.Visit(tab, 30);
+    CHECK(launcher.accountant.GetTotal(ResourceKind::Icons) <= 100);
+    CHECK(launcher.IsLoaded(9) && launcher.IsLoaded(8) && launcher.IsLoaded(7) && !launcher.IsLoaded(6));
+    // The fourth page is loaded before the first is released
+    CHECK(launcher.accountant.GetPeak(ResourceKind::Icons) == 120);
+
+    // Returning to a page makes it recent; a page loaded again pushes out the oldest
+    launcher.Visit(7, 30);
+    launcher.Visit(2, 30);
+    CHECK(!launcher.IsLoaded(8));
+    CHECK(launcher.IsLoaded(7) && launcher.IsLoaded(9) && launcher.IsLoaded(2));
+
+    // A single page larger than the limit stays, alone
+    launcher.Visit(5, 500);
+    CHECK(launcher.pages.size() == 1 && launcher.IsLoaded(5));
+}
+
+TEST_CASE(PagesOverTheWindowLimitAreReleased)
+{
+    MockLauncher launcher;
+    launcher.limits.maxWindows = 50;
+    for (int tab = 0; tab < 5; ++tab) launcher.Visit(tab, 20);
+    CHECK(launcher.accountant.GetTotal(ResourceKind::Windows) <= 50);
+    CHECK(launcher.pages.size() == 2);
+    CHECK(launcher.accountant.GetCount(ResourceOwner::TabPages, ResourceKind::Windows) == 2);
+}
+
+TEST_CASE(NoLimitsKeepEveryPage)
+{
+    MockLauncher launcher;
+    for (int tab = 0; tab < 50; ++tab) launcher.Visit(tab, 64);
+    CHECK(launcher.pages.size() == 50);
+    CHECK(launcher.releasedPages == 0);
+    CHECK(launcher.accountant.GetTotal(ResourceKind::Icons) == 50 * 64);
+}
+
+TEST_CASE(IdlePagesAreReleasedExceptThePinnedOne)
+{
+    std::vector<PageUsage> pages = { { 0, 1, 2, 0 }, { 1, 1, 2, 50 }, { 2, 1, 2, 95 }, { 3, 1, 2, 10 } };
+    std::vector<int> idle = ResourceAccountant::SelectIdlePages(pages, 100, 60, 3);
+    CHECK(idle == std::vector<int>{ 0 });
+    CHECK(ResourceAccountant::SelectIdlePages(pages, 100, 1000, -1).empty());
+}
+
+TEST_CASE(BrowsingTheCatalogStaysWithinTheBudget)
+{
+    // Every tab of the 10,000-tab catalog, with some pages revisited; the counters must
+    // return to zero once every page is gone
+    MockLauncher launcher;
+    launcher.limits.maxIcons = 2000;
+    launcher.limits.maxWindows = 2500;
+    auto start = std::chrono::steady_clock::now();
+    for (int tab = 0; tab < 10000; ++tab)
+    {
+        launcher.Visit(tab, 16 + tab % 48);
+        if (tab % 7 == 0 && tab >= 20) launcher.Visit(tab - 20, 16 + (tab - 20) % 48);
+        CHECK(launcher.accountant.GetTotal(ResourceKind::Icons) <= 2000);
+        CHECK(launcher.accountant.GetTotal(ResourceKind::Windows) <= 2500);
+    }
+    TestHarness::Report("Visit 10,000 tabs", TestHarness::ElapsedMs(start), "ms");
+    TestHarness::Report("Peak icons", static_cast<double>(launcher.accountant.GetPeak(ResourceKind::Icons)), "icons");
+    TestHarness::Report("Pages released", launcher.releasedPages, "pages");
+
+    std::vector<int> loaded;
+    for (const auto& [tab, page] : launcher.pages) loaded.push_back(tab);
+    for (int tab : loaded) launcher.Release(tab);
+    CHECK(launcher.accountant.GetTotal(ResourceKind::Icons) == 0);
+    CHECK(launcher.accountant.GetTotal(ResourceKind::Windows) == 0);
+}
@@ -0,0 +1,71 @@
+// A program for the tests to launch. With "image <file>" it touches every page of the file
+// through a mapping, the way the loader faults in the image of a program that starts. With
+// "profile" it waits for its input to close, then prints how it was started.
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+
+extern char** environ;
+
+namespace
+{
+    int TouchImage(const char* filePath)
+    {
+        int file = open(filePath, O_RDONLY | O_CLOEXEC);
+        if (file < 0) return 2;
+
+        struct stat status = {};
+        if (fstat(file, &status) != 0 || status.st_size == 0) return 2;
+        const volatile unsigned char* image = static_cast<const unsigned char*>(
+            mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0));
+        if (image == MAP_FAILED) return 2;
+
+        long pageSize = sysconf(_SC_PAGESIZE);
+        for (off_t offset = 0; offset < status.st_size; offset += pageSize)
+        {
+            (void)image[offset];
+        }
+        return 0;
+    }
+
+    // The settings of a launch profile, one per line, then the environment
+    int PrintProfile()
+    {
+        char byte;
+        while (read(STDIN_FILENO, &byte, 1) > 0) {}
+
+        char directory[4096];
+        if (!getcwd(directory, sizeof(directory))) return 2;
+        std::printf("cwd=%s\n", directory);
+        std::printf("nice=%d\n", getpriority(PRIO_PROCESS, 0));
+
+        cpu_set_t processors;
+        unsigned long long mask = 0;
+        if (sched_getaffinity(0, sizeof(processors), &processors) != 0) return 2;
+        for (int processor = 0; processor < 64; ++processor)
+        {
+            if (CPU_ISSET(processor, &processors)) mask |= 1ull << processor;
+        }
+        std::printf("affinity=%llx\n", mask);
+        std::printf("ioprio=%ld\n", syscall(SYS_ioprio_get, 1, 0));
+
+        for (char** entry = environ; *entry; ++entry)
+        {
+            std::printf("env:%s\n", *entry);
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 3 && std::strcmp(argv[1], "image") == 0) return TouchImage(argv[2]);
+    if (argc == 2 && std::strcmp(argv[1], "profile") == 0) return PrintProfile();
+    return 0;
+}
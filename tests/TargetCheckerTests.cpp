@@ -0,0 +1,199 @@
+#include "TestHarness.h"
+#include "TargetChecker.h"
+
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Real directories, with some of them marked as on a share, on a share that
+     *        does not respond, or not readable, and some program names registered.
+     */
+    class SimulatedLister : public DirectoryLister
+    {
+    public:
+        std::set<std::wstring> networkDirectories;
+        std::set<std::wstring> unreachableDirectories;
+        std::set<std::wstring> deniedDirectories;
+        std::set<std::wstring> registeredPrograms;
+        int listings{ 0 };
+
+        DirectoryListingStatus ListDirectory(const std::wstring& directory, std::vector<std::wstring>& names) override
+        {
+            listings++;
+            names.clear();
+            if (unreachableDirectories.count(directory)) return DirectoryListingStatus::Unreachable;
+            if (deniedDirectories.count(directory)) return DirectoryListingStatus::AccessDenied;
+            return m_lister.ListDirectory(directory, names);
+        }
+
+        bool IsNetworkDirectory(const std::wstring& directory) override
+        {
+            return networkDirectories.count(directory) || unreachableDirectories.count(directory);
+        }
+
+        bool IsRegisteredProgram(const std::wstring& fileName) override
+        {
+            return registeredPrograms.count(fileName) != 0;
+        }
+
+    private:
+        FileSystemDirectoryLister m_lister;
+    };
+
+    void TouchFile(const std::filesystem::path& path)
+    {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file(path, std::ios::binary);
+    }
+
+    std::vector<TargetCheck> MakeTargets(std::initializer_list<std::wstring> paths)
+    {
+        std::vector<TargetCheck> targets;
+        for (const std::wstring& path : paths)
+        {
+            TargetCheck target;
+            target.path = path;
+            target.expandedPath = path;
+            targets.push_back(target);
+        }
+        return targets;
+    }
+
+    TargetState Check(TargetChecker& checker, SimulatedLister& lister, const std::wstring& path, uint64_t nowMs,
+                      const std::vector<std::wstring>& searchDirectories = {})
+    {
+        std::vector<TargetCheck> targets = MakeTargets({ path });
+        checker.CheckAll(lister, targets, L"", searchDirectories, nowMs, CancellationToken());
+        return targets[0].state;
+    }
+}
+
+TEST_CASE(EachDirectoryIsListedOncePerPass)
+{
+    // 2000 targets over 20 directories, every tenth of them missing
+    TestHarness::TemporaryDirectory directory("TargetCheckerTests.Batch");
+    std::vector<TargetCheck> targets;
+    for (int i = 0; i < 2000; ++i)
+    {
+        std::filesystem::path path = directory.path / ("dir" + std::to_string(i % 20)) / ("tool" + std::to_string(i) + ".exe");
+        if (i % 10 != 3) TouchFile(path);
+        targets.push_back(MakeTargets({ path.wstring() })[0]);
+    }
+
+    SimulatedLister lister;
+    TargetChecker checker;
+    auto start = std::chrono::steady_clock::now();
+    checker.CheckAll(lister, targets, L"", {}, 0, CancellationToken());
+    TestHarness::Report("Check 2000 targets in 20 directories", TestHarness::ElapsedMs(start), "ms");
+    CHECK(lister.listings == 20);
+    int wrong = 0;
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        if (targets[i].state != (i % 10 == 3 ? TargetState::Missing : TargetState::Ok)) wrong++;
+    }
+    CHECK(wrong == 0);
+
+    // The next pass within the time-to-live lists nothing
+    checker.CheckAll(lister, targets, L"", {}, 1000, CancellationToken());
+    CHECK(lister.listings == 20);
+    CHECK(checker.GetCachedDirectoryCount() == 20);
+
+    // A cancelled pass leaves the targets unchecked
+    CancellationToken token = CancellationToken::Create();
+    token.Cancel();
+    checker.CheckAll(lister, targets, L"", {}, TargetChecker::LOCAL_LISTING_TTL_MS, token);
+    CHECK(targets[0].state == TargetState::Unknown);
+    CHECK(lister.listings == 20);
+}
+
+TEST_CASE(ListingsExpireAfterTheirTimeToLive)
+{
+    TestHarness::TemporaryDirectory directory("TargetCheckerTests.Ttl");
+    std::filesystem::create_directories(directory.path / "local");
+    std::filesystem::create_directories(directory.path / "share");
+    std::wstring localTarget = (directory.path / "local" / "new.exe").wstring();
+    std::wstring shareTarget = (directory.path / "share" / "new.exe").wstring();
+    SimulatedLister lister;
+    lister.networkDirectories.insert((directory.path / "share").wstring());
+    TargetChecker checker;
+
+    CHECK(Check(checker, lister, localTarget, 0) == TargetState::Missing);
+    CHECK(Check(checker, lister, shareTarget, 0) == TargetState::Missing);
+    TouchFile(localTarget);
+    TouchFile(shareTarget);
+
+    // Until its listing expires, a file added since is not seen
+    CHECK(Check(checker, lister, localTarget, TargetChecker::LOCAL_LISTING_TTL_MS - 1) == TargetState::Missing);
+    CHECK(Check(checker, lister, localTarget, TargetChecker::LOCAL_LISTING_TTL_MS) == TargetState::Ok);
+    CHECK(Check(checker, lister, shareTarget, TargetChecker::LOCAL_LISTING_TTL_MS) == TargetState::Missing);
+    CHECK(Check(checker, lister, shareTarget, TargetChecker::NETWORK_LISTING_TTL_MS - 1) == TargetState::Missing);
+    CHECK(Check(checker, lister, shareTarget, TargetChecker::NETWORK_LISTING_TTL_MS) == TargetState::Ok);
+    CHECK(lister.listings == 4);
+}
+
+TEST_CASE(MissingAndUnreachableAreToldApart)
+{
+    TestHarness::TemporaryDirectory directory("TargetCheckerTests.States");
+    TouchFile(directory.path / "present" / "app.exe");
+    std::filesystem::create_directories(directory.path / "offline");
+    std::filesystem::create_directories(directory.path / "denied");
+    std::wstring offline = (directory.path / "offline").wstring();
+    SimulatedLister lister;
+    lister.unreachableDirectories.insert(offline);
+    lister.deniedDirectories.insert((directory.path / "denied").wstring());
+    TargetChecker checker;
+
+    CHECK(Check(checker, lister, (directory.path / "present" / "APP.EXE").wstring(), 0) == TargetState::Ok);
+    CHECK(Check(checker, lister, (directory.path / "present" / "other.exe").wstring(), 0) == TargetState::Missing);
+    CHECK(Check(checker, lister, (directory.path / "gone" / "app.exe").wstring(), 0) == TargetState::Missing);
+    CHECK(Check(checker, lister, (directory.path / "offline" / "app.exe").wstring(), 0) == TargetState::Unreachable);
+    CHECK(Check(checker, lister, (directory.path / "denied" / "app.exe").wstring(), 0) == TargetState::Unknown);
+    CHECK(Check(checker, lister, (directory.path / "present").wstring() + L"/", 0) == TargetState::Ok);
+    CHECK(Check(checker, lister, L"https://example.com/tool", 0) == TargetState::Unknown);
+    CHECK(Check(checker, lister, L"shell:Downloads", 0) == TargetState::Unknown);
+    CHECK(Check(checker, lister, L"", 0) == TargetState::Unknown);
+
+    // The share is listed again once it had time to come back
+    lister.unreachableDirectories.clear();
+    TouchFile(directory.path / "offline" / "app.exe");
+    CHECK(Check(checker, lister, (directory.path / "offline" / "app.exe").wstring(),
+                TargetChecker::UNREACHABLE_LISTING_TTL_MS - 1) == TargetState::Unreachable);
+    CHECK(Check(checker, lister, (directory.path / "offline" / "app.exe").wstring(),
+                TargetChecker::UNREACHABLE_LISTING_TTL_MS) == TargetState::Ok);
+}
+
+TEST_CASE(BareNamesAreSearchedInOrder)
+{
+    TestHarness::TemporaryDirectory directory("TargetCheckerTests.Search");
+    TouchFile(directory.path / "second" / "tool.exe");
+    TouchFile(directory.path / "second" / "script.cmd");
+    std::filesystem::create_directories(directory.path / "first");
+    std::filesystem::create_directories(directory.path / "offline");
+    std::vector<std::wstring> searchDirectories = {
+        (directory.path / "first").wstring(),
+        (directory.path / "offline").wstring(),
+        (directory.path / "second").wstring(),
+    };
+    SimulatedLister lister;
+    lister.unreachableDirectories.insert(searchDirectories[1]);
+    lister.registeredPrograms.insert(L"registered.exe");
+    TargetChecker checker;
+
+    CHECK(Check(checker, lister, L"tool.exe", 0, searchDirectories) == TargetState::Ok);
+    CHECK(Check(checker, lister, L"tool", 0, searchDirectories) == TargetState::Ok);
+    CHECK(Check(checker, lister, L"script.cmd", 0, searchDirectories) == TargetState::Ok);
+    CHECK(Check(checker, lister, L"script", 0, searchDirectories) == TargetState::Unreachable);
+    CHECK(Check(checker, lister, L"registered", 0, searchDirectories) == TargetState::Ok);
+    searchDirectories.erase(searchDirectories.begin() + 1);
+    CHECK(Check(checker, lister, L"nowhere.exe", 0, searchDirectories) == TargetState::Missing);
+
+    // A path with a directory part starts from the application directory
+    std::vector<TargetCheck> targets = MakeTargets({ L"second/tool.exe", L"second/missing.exe" });
+    checker.CheckAll(lister, targets, directory.path.wstring(), searchDirectories, 0, CancellationToken());
+    CHECK(targets[0].state == TargetState::Ok);
+    CHECK(targets[1].state == TargetState::Missing);
+}
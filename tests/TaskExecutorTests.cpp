@@ -0,0 +1,331 @@
+#include "TestHarness.h"
+#include "TaskExecutor.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Holds a worker until Release(), so that tasks can be queued behind it
+    class Gate
+    {
+    public:
+        void Wait()
+        {
+            m_entered = true;
+            while (!m_open.load())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // Returns once a worker is held
+        void WaitUntilEntered() const
+        {
+            while (!m_entered.load())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        void Release() { m_open = true; }
+
+    private:
+        std::atomic<bool> m_entered{ false };
+        std::atomic<bool> m_open{ false };
+    };
+}
+
+TEST_CASE(EveryTaskRunsOnceUnderConcurrentSubmission)
+{
+    TaskExecutor executor;
+    REQUIRE(executor.Start(4));
+
+    // Four threads outside the executor, each also queuing nested tasks from the workers
+    const int threadCount = 4;
+    const int tasksPerThread = 25000;
+    std::vector<std::atomic<int>> runs(threadCount * tasksPerThread * 2);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < threadCount; ++producer)
+    {
+        producers.emplace_back([&, producer]()
+            {
+                for (int i = 0; i < tasksPerThread; ++i)
+                {
+                    size_t index = (static_cast<size_t>(producer) * tasksPerThread + i) * 2;
+                    TaskPriority lane = static_cast<TaskPriority>(i % TASK_PRIORITY_COUNT);
+                    executor.Submit(lane, [&executor, &runs, index]()
+                        {
+                            runs[index]++;
+                            executor.Submit(TaskPriority::Background, [&runs, index]() { runs[index + 1]++; });
+                        });
+                }
+            });
+    }
+    for (std::thread& producer : producers) producer.join();
+    executor.WaitUntilIdle();
+    TestHarness::Report("Run 200,000 tasks on 4 workers", TestHarness::ElapsedMs(start), "ms");
+
+    int wrongCounts = 0;
+    for (const std::atomic<int>& count : runs)
+    {
+        if (count != 1) wrongCounts++;
+    }
+    CHECK(wrongCounts == 0);
+
+    uint64_t completed = 0;
+    for (int lane = 0; lane < TASK_PRIORITY_COUNT; ++lane)
+    {
+        TaskLaneStatistics statistics = executor.GetStatistics(static_cast<TaskPriority>(lane));
+        CHECK(statistics.queued == 0);
+        CHECK(statistics.completed == statistics.submitted);
+        completed += statistics.completed;
+    }
+    CHECK(completed == runs.size());
+}
+
+TEST_CASE(UrgentLanesRunBeforeQueuedBackgroundWork)
+{
+    TaskExecutor executor;
+    REQUIRE(executor.Start(1));
+
+    Gate gate;
+    executor.Submit(TaskPriority::Background, [&gate]() { gate.Wait(); });
+    gate.WaitUntilEntered();
+
+    std::mutex mutex;
+    std::vector<TaskPriority> order;
+    auto record = [&](TaskPriority lane)
+        {
+            return [&, lane]()
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    order.push_back(lane);
+                };
+        };
+    executor.Submit(TaskPriority::Background, record(TaskPriority::Background));
+    executor.Submit(TaskPriority::Visible, record(TaskPriority::Visible));
+    executor.Submit(TaskPriority::Interactive, record(TaskPriority::Interactive));
+    gate.Release();
+    executor.WaitUntilIdle();
+
+    CHECK(order == (std::vector<TaskPriority>{ TaskPriority::Interactive, TaskPriority::Visible, TaskPriority::Background }));
+}
+
+TEST_CASE(CancelledTasksAreSkippedAndCounted)
+{
+    TaskExecutor executor;
+    REQUIRE(executor.Start(1));
+
+    Gate gate;
+    executor.Submit(TaskPriority::Interactive, [&gate]() { gate.Wait(); });
+    gate.WaitUntilEntered();
+    CancellationToken token = CancellationToken::Create();
+    std::atomic<int> ran{ 0 };
+    for (int i = 0; i < 100; ++i)
+    {
+        executor.Submit(TaskPriority::Background, token, [&ran]() { ran++; });
+    }
+    executor.Submit(TaskPriority::Background, [&ran]() { ran += 1000; });
+    token.Cancel();
+    gate.Release();
+    executor.WaitUntilIdle();
+
+    CHECK(ran == 1000);
+    CHECK(executor.GetStatistics(TaskPriority::Background).cancelled == 100);
+    CHECK(!CancellationToken().IsCancelled());
+}
+
+TEST_CASE(GroupStopWaitsForTheRunningTaskAndDropsTheRest)
+{
+    TaskExecutor executor;
+    REQUIRE(executor.Start(2));
+
+    TaskGroup group;
+    CHECK(!group.Submit(TaskPriority::Background, []() {}));
+    group.Start(executor);
+
+    // The running task sees the token cancelled and returns; the queued ones never start
+    std::atomic<bool> started{ false };
+    std::atomic<bool> returned{ false };
+    std::atomic<int> queuedRuns{ 0 };
+    group.Submit(TaskPriority::Background, [&]()
+        {
+            started = true;
+            while (!group.GetToken().IsCancelled())
+            {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            returned = true;
+        });
+    while (!started)
+    {
+        std::this_thread::yield();
+    }
+    Gate gate;
+    executor.Submit(TaskPriority::Interactive, [&gate]() { gate.Wait(); });
+    gate.WaitUntilEntered();
+    for (int i = 0; i < 50; ++i)
+    {
+        group.Submit(TaskPriority::Background, [&queuedRuns]() { queuedRuns++; });
+    }
+    CHECK(group.HasPendingTasks());
+
+    std::thread releaser([&gate, &group]()
+        {
+            while (!group.GetToken().IsCancelled())
+            {
+                std::this_thread::yield();
+            }
+            gate.Release();
+        });
+    group.Stop();
+    CHECK(returned);
+    CHECK(!group.HasPendingTasks());
+    CHECK(queuedRuns == 0);
+    CHECK(!group.Submit(TaskPriority::Background, []() {}));
+    releaser.join();
+
+    // A group can be started again with a fresh token
+    group.Start(executor);
+    CHECK(!group.GetToken().IsCancelled());
+    std::atomic<int> runs{ 0 };
+    group.Submit(TaskPriority::Visible, [&runs]() { runs++; });
+    executor.WaitUntilIdle();
+    CHECK(runs == 1);
+    group.Stop();
+}
+
+TEST_CASE(GroupStopReturnsWhenTheExecutorDroppedItsTasks)
+{
+    TaskExecutor executor;
+    REQUIRE(executor.Start(1));
+    TaskGroup group;
+    group.Start(executor);
+
+    Gate gate;
+    executor.Submit(TaskPriority::Interactive, [&gate]() { gate.Wait(); });
+    gate.WaitUntilEntered();
+    std::atomic<int> runs{ 0 };
+    for (int i = 0; i < 10; ++i)
+    {
+        group.Submit(TaskPriority::Background, [&runs]() { runs++; });
+    }
+    // Released once the executor refuses new tasks, so the group's are dropped, not run
+    std::thread releaser([&gate, &executor]()
+        {
+            while (executor.Submit(TaskPriority::Interactive, []() {}))
+            {
+                std::this_thread::yield();
+            }
+            gate.Release();
+        });
+    executor.Stop();
+    releaser.join();
+
+    CHECK(!group.HasPendingTasks());
+    group.Stop();
+    CHECK(runs == 0);
+}
+
+TEST_CASE(GroupsStartAndStopUnderLoad)
+{
+    // Parts of the launcher stopping while others keep the workers busy: no task of a group
+    // may run once its Stop() returned, and the data it uses is freed right after
+    TaskExecutor executor;
+    REQUIRE(executor.Start(4));
+    std::atomic<bool> loadRunning{ true };
+    std::atomic<int> loadTasksQueued{ 0 };
+    std::thread load([&]()
+        {
+            while (loadRunning)
+            {
+                if (loadTasksQueued > 256)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                loadTasksQueued++;
+                executor.Submit(TaskPriority::Visible, [&loadTasksQueued]() { loadTasksQueued--; });
+            }
+        });
+
+    std::atomic<int> lateRuns{ 0 };
+    std::atomic<int> groupRuns{ 0 };
+    auto start = std::chrono::steady_clock::now();
+    const int cycles = 300;
+    for (int cycle = 0; cycle < cycles; ++cycle)
+    {
+        auto data = std::make_unique<std::vector<int>>(64, cycle);
+        auto stopped = std::make_shared<std::atomic<bool>>(false);
+        TaskGroup group;
+        group.Start(executor);
+        for (int i = 0; i < 40; ++i)
+        {
+            group.Submit(TaskPriority::Background, [&group, &groupRuns, &lateRuns, values = data.get(), stopped, cycle]()
+                {
+                    if (stopped->load()) lateRuns++;
+                    int sum = 0;
+                    for (int value : *values)
+                    {
+                        if (group.GetToken().IsCancelled()) break;
+                        sum += value - cycle;
+                    }
+                    if (sum != 0) lateRuns++;
+                    groupRuns++;
+                });
+        }
+        if (cycle % 3 == 0) std::this_thread::yield();
+        group.Stop();
+        stopped->store(true);
+        data.reset();
+    }
+    double elapsedMs = TestHarness::ElapsedMs(start);
+    loadRunning = false;
+    load.join();
+    executor.WaitUntilIdle();
+
+    CHECK(lateRuns == 0);
+    TestHarness::Report("Start and stop a group of 40 tasks under load", elapsedMs / cycles, "ms");
+    TestHarness::Report("Group tasks run before their stop", groupRuns.load(), "tasks");
+}
+
+TEST_CASE(DispatchIsTimed)
+{
+    TaskExecutor executor;
+    REQUIRE(executor.Start(2));
+    std::atomic<int> sink{ 0 };
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < 20; ++round)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            executor.Submit(TaskPriority::Background, [&sink]() { sink++; });
+        }
+        executor.WaitUntilIdle();
+    }
+    TestHarness::Report("Submit and run 1000 tasks", TestHarness::ElapsedMs(start) / 20, "ms");
+
+    TaskGroup group;
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < 20; ++round)
+    {
+        group.Start(executor);
+        for (int i = 0; i < 1000; ++i)
+        {
+            group.Submit(TaskPriority::Background, [&sink]() { sink++; });
+        }
+        group.Stop();
+    }
+    TestHarness::Report("Queue 1000 group tasks and stop the group", TestHarness::ElapsedMs(start) / 20, "ms");
+    executor.WaitUntilIdle();
+    CHECK(sink >= 20000);
+
+    TaskLaneStatistics statistics = executor.GetStatistics(TaskPriority::Background);
+    TestHarness::Report("Background wait p99", static_cast<double>(statistics.waitLatency.GetPercentile(99)), "us");
+}
@@ -0,0 +1,98 @@
+#include "TestHarness.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#endif
+
+namespace
+{
+    struct TestCase
+    {
+        const char* name;
+        TestHarness::TestFunction function;
+    };
+
+    std::vector<TestCase>& GetTestCases()
+    {
+        static std::vector<TestCase> testCases;
+        return testCases;
+    }
+
+    int g_failureCount = 0;
+}
+
+namespace TestHarness
+{
+    Registrar::Registrar(const char* name, TestFunction function)
+    {
+        GetTestCases().push_back({ name, function });
+    }
+
+    void ReportFailure(const char* file, int line, const char* expression)
+    {
+        std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+        ++g_failureCount;
+    }
+
+    void Report(const char* name, double value, const char* unit)
+    {
+        std::printf("    %-48s %12.3f %s\n", name, value, unit);
+    }
+
+    uint64_t GetResidentBytes()
+    {
+#if defined(__linux__)
+        unsigned long long totalPages = 0;
+        unsigned long long residentPages = 0;
+        FILE* file = std::fopen("/proc/self/statm", "r");
+        if (!file) return 0;
+        int fields = std::fscanf(file, "%llu %llu", &totalPages, &residentPages);
+        std::fclose(file);
+        return fields == 2 ? residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+        return 0;
+#endif
+    }
+
+    TemporaryDirectory::TemporaryDirectory(const char* name)
+    {
+        path = std::filesystem::temp_directory_path() /
+            ("MultiTabLauncher." + std::string(name) + "." + std::to_string(getpid()));
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+
+    TemporaryDirectory::~TemporaryDirectory()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(path, error);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int failedCases = 0;
+    for (const TestCase& testCase : GetTestCases())
+    {
+        if (filter && !std::strstr(testCase.name, filter)) continue;
+
+        int failuresBefore = g_failureCount;
+        auto start = std::chrono::steady_clock::now();
+        std::printf("%s\n", testCase.name);
+        std::fflush(stdout);
+        testCase.function();
+        bool passed = g_failureCount == failuresBefore;
+        std::printf("  %s (%.1f ms)\n", passed ? "passed" : "FAILED", TestHarness::ElapsedMs(start));
+        failedCases += passed ? 0 : 1;
+    }
+    std::printf("%d of %zu cases failed\n", failedCases, GetTestCases().size());
+    return failedCases == 0 ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+
+/**
+ * @brief A minimal test runner, so the tests build anywhere without dependencies.
+ *
+ * TEST_CASE(Name) { ... } registers a case; CHECK() records a failure and goes on, REQUIRE()
+ * ends the case. A test executable runs all its cases, or those whose name contains its
+ * first argument, and exits with 1 if any failed. Measurements are printed with Report().
+ */
+namespace TestHarness
+{
+    using TestFunction = void (*)();
+
+    struct Registrar
+    {
+        Registrar(const char* name, TestFunction function);
+    };
+
+    void ReportFailure(const char* file, int line, const char* expression);
+    void Report(const char* name, double value, const char* unit);
+
+    // Milliseconds since the given time point
+    inline double ElapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Bytes the process has resident, or 0 where this is not known
+    uint64_t GetResidentBytes();
+
+    // An empty directory of its own per test process, removed afterwards
+    struct TemporaryDirectory
+    {
+        std::filesystem::path path;
+
+        explicit TemporaryDirectory(const char* name);
+        ~TemporaryDirectory();
+
+        TemporaryDirectory(const TemporaryDirectory&) = delete;
+        TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+    };
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static TestHarness::Registrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(expression) \
+    do { if (!(expression)) TestHarness::ReportFailure(__FILE__, __LINE__, #expression); } while (false)
+
+#define REQUIRE(expression) \
+    do { if (!(expression)) { TestHarness::ReportFailure(__FILE__, __LINE__, #expression); return; } } while (false)
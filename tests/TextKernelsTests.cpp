@@ -0,0 +1,245 @@
+#include "TestHarness.h"
+#include "SimdLevel.h"
+#include "TextKernels.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const char* LEVEL_NAMES[] = { "scalar", "SSE2", "AVX2" };
+
+    // The levels this build and processor support, from scalar up
+    std::vector<SimdLevel> GetLevels()
+    {
+        std::vector<SimdLevel> levels;
+        for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 })
+        {
+            LimitSimdLevel(level);
+            if (GetSimdLevel() == level) levels.push_back(level);
+        }
+        LimitSimdLevel(SimdLevel::Avx2);
+        return levels;
+    }
+
+    // Runs operation at every supported level and checks that all give the scalar result
+    template <typename Operation>
+    void CheckAllLevelsAgree(Operation operation)
+    {
+        std::vector<SimdLevel> levels = GetLevels();
+        LimitSimdLevel(SimdLevel::Scalar);
+        auto expected = operation();
+        for (SimdLevel level : levels)
+        {
+            LimitSimdLevel(level);
+            CHECK(operation() == expected);
+        }
+        LimitSimdLevel(SimdLevel::Avx2);
+    }
+
+    template <typename Operation>
+    void ReportEveryLevel(const char* name, int repetitions, Operation operation)
+    {
+        for (SimdLevel level : GetLevels())
+        {
+            LimitSimdLevel(level);
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < repetitions; ++i)
+            {
+                operation();
+            }
+            std::string label = std::string(name) + ", " + LEVEL_NAMES[static_cast<int>(level)];
+            TestHarness::Report(label.c_str(), TestHarness::ElapsedMs(start) / repetitions, "ms");
+        }
+        LimitSimdLevel(SimdLevel::Avx2);
+    }
+
+    // Mostly ASCII with runs of valid multi-byte sequences and some ill-formed bytes
+    std::string MakeMixedUtf8(size_t length, unsigned seed)
+    {
+        static const char* pieces[] = {
+            "\xC3\xA9", "\xED\x95\x9C\xEA\xB8\x80", "\xE4\xB8\xAD", "\xF0\x9F\x98\x80",
+            "\x80", "\xC3", "\xE0\x80", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xFF",
+        };
+        std::mt19937 random(seed);
+        std::string bytes;
+        while (bytes.size() < length)
+        {
+            if (random() % 8 == 0)
+            {
+                bytes += pieces[random() % (sizeof(pieces) / sizeof(pieces[0]))];
+            }
+            else
+            {
+                bytes.append(random() % 40, static_cast<char>('!' + random() % 90));
+            }
+        }
+        return bytes;
+    }
+
+    // Valid UTF-8 only, which must survive a round trip
+    std::string MakeValidUtf8(size_t length, unsigned seed)
+    {
+        static const char* pieces[] = { "\xC3\xA9", "\xED\x95\x9C\xEA\xB8\x80", "\xE4\xB8\xAD", "\xF0\x9F\x98\x80" };
+        std::mt19937 random(seed);
+        std::string bytes;
+        while (bytes.size() < length)
+        {
+            bytes += random() % 4 == 0 ? pieces[random() % 4] : std::string(random() % 40, static_cast<char>(' ' + random() % 95));
+        }
+        return bytes;
+    }
+}
+
+TEST_CASE(DecodeUtf8ReplacesIllFormedSequencesLikeWindows)
+{
+    CHECK(DecodeUtf8("a\xC3\xA9" "b") == L"a\xE9" L"b");
+    CHECK(DecodeUtf8("\xE0\x80") == L"\xFFFD\xFFFD");
+    CHECK(DecodeUtf8("\xE4\xB8") == L"\xFFFD");
+    CHECK(DecodeUtf8("\xED\xA0\x80") == L"\xFFFD\xFFFD\xFFFD");
+    CHECK(DecodeUtf8("\xC0\xAF" "x") == L"\xFFFD\xFFFD" L"x");
+    std::wstring emoji = DecodeUtf8("\xF0\x9F\x98\x80");
+    CHECK(emoji == (sizeof(wchar_t) == 2 ? std::wstring{ wchar_t(0xD83D), wchar_t(0xDE00) } : std::wstring(1, wchar_t(0x1F600))));
+}
+
+TEST_CASE(DecodeUtf8IsTheSameAtEveryLevel)
+{
+    for (unsigned seed = 1; seed <= 20; ++seed)
+    {
+        std::string bytes = MakeMixedUtf8(4000, seed);
+        CheckAllLevelsAgree([&]() { return DecodeUtf8(bytes); });
+    }
+    // Every split of a non-ASCII byte against the block boundaries
+    for (size_t position = 0; position < 80; ++position)
+    {
+        std::string bytes(80, 'a');
+        bytes.replace(position, 1, "\xC3");
+        bytes.insert(position + 1, "\xA9");
+        CheckAllLevelsAgree([&]() { return DecodeUtf8(bytes); });
+    }
+}
+
+TEST_CASE(AsciiPrefixAndWideningAreTheSameAtEveryLevel)
+{
+    for (size_t length = 0; length < 100; ++length)
+    {
+        for (size_t position = 0; position <= length; ++position)
+        {
+            std::string bytes(length, 'x');
+            for (size_t i = 0; i < length; ++i) bytes[i] = static_cast<char>('0' + i % 64);
+            if (position < length) bytes[position] = static_cast<char>(0x80 + position % 128);
+
+            CheckAllLevelsAgree([&]() { return CountAsciiPrefix(bytes); });
+            CheckAllLevelsAgree([&]()
+                {
+                    std::wstring wide(length, L'\0');
+                    WidenAscii(bytes, wide.data());
+                    return wide;
+                });
+        }
+    }
+}
+
+TEST_CASE(FindCharMatchesStdFindAtEveryLevel)
+{
+    std::wstring text;
+    for (int i = 0; i < 150; ++i) text += static_cast<wchar_t>(L'a' + i % 26);
+    for (size_t position = 0; position < text.size(); ++position)
+    {
+        std::wstring copy = text;
+        copy[position] = L'=';
+        for (size_t from : { size_t(0), size_t(1), size_t(7), position })
+        {
+            const wchar_t* first = copy.data() + (std::min)(from, position);
+            const wchar_t* last = copy.data() + copy.size();
+            const wchar_t* expected = std::find(first, last, L'=');
+            for (SimdLevel level : GetLevels())
+            {
+                LimitSimdLevel(level);
+                CHECK(FindChar(first, last, L'=') == expected);
+                CHECK(FindChar(first, last, L'#') == last);
+            }
+        }
+    }
+    LimitSimdLevel(SimdLevel::Avx2);
+
+    // Characters beyond the first byte must not match by their low byte alone
+    std::wstring hangul(40, wchar_t(0xD55C));
+    CHECK(FindChar(hangul.data(), hangul.data() + hangul.size(), wchar_t(0x5C)) == hangul.data() + hangul.size());
+}
+
+TEST_CASE(AppendUtf8RoundTripsAtEveryLevel)
+{
+    for (unsigned seed = 1; seed <= 20; ++seed)
+    {
+        std::string bytes = MakeValidUtf8(4000, seed);
+        std::wstring text = DecodeUtf8(bytes);
+        CheckAllLevelsAgree([&]()
+            {
+                std::string encoded = "prefix";
+                AppendUtf8(text, encoded);
+                return encoded;
+            });
+        std::string encoded;
+        AppendUtf8(text, encoded);
+        CHECK(encoded == bytes);
+    }
+
+    // Unpaired surrogates become U+FFFD, after and before ASCII blocks
+    std::wstring text = std::wstring(20, L'a') + wchar_t(0xD800) + std::wstring(20, L'b') + wchar_t(0xDC00);
+    std::string expected = std::string(20, 'a') + "\xEF\xBF\xBD" + std::string(20, 'b') + "\xEF\xBF\xBD";
+    CheckAllLevelsAgree([&]()
+        {
+            std::string encoded;
+            AppendUtf8(text, encoded);
+            return encoded;
+        });
+    std::string encoded;
+    AppendUtf8(text, encoded);
+    CHECK(encoded == expected);
+}
+
+TEST_CASE(TrimBlanksFollowsIswspace)
+{
+    for (wchar_t ch = 0; ch < 0x3100; ++ch)
+    {
+        CHECK(IsBlank(ch) == (std::iswspace(ch) != 0));
+    }
+    CHECK(TrimBlanks(L" \t Command Prompt \r\n") == L"Command Prompt");
+    CHECK(TrimBlanks(L" \t ").empty());
+}
+
+TEST_CASE(EveryLevelIsTimed)
+{
+    // About the size of the 10,000-tab catalog
+    std::string bytes = MakeValidUtf8(8 << 20, 7);
+    std::string ascii(bytes.size(), 'x');
+    std::transform(bytes.begin(), bytes.end(), ascii.begin(), [](char c) { return static_cast<unsigned char>(c) < 0x80 ? c : '?'; });
+    std::wstring text = DecodeUtf8(ascii);
+    for (size_t i = 60; i < text.size(); i += 61) text[i] = L'\n';
+
+    // Decoding reuses one buffer, so that page faults of a fresh one do not hide the kernels
+    volatile size_t sink = 0;
+    std::wstring decoded;
+    ReportEveryLevel("Decode 8 MB of UTF-8", 5, [&]() { DecodeUtf8(bytes, decoded); });
+    ReportEveryLevel("Decode 8 MB of ASCII", 5, [&]() { DecodeUtf8(ascii, decoded); });
+    ReportEveryLevel("Find line ends in 8M characters", 5, [&]()
+        {
+            const wchar_t* last = text.data() + text.size();
+            for (const wchar_t* line = text.data(); line != last; ++line)
+            {
+                line = FindChar(line, last, L'\n');
+                if (line == last) break;
+                sink = sink + 1;
+            }
+        });
+    std::string encoded;
+    ReportEveryLevel("Encode 8M ASCII characters as UTF-8", 5, [&]()
+        {
+            encoded.clear();
+            AppendUtf8(text, encoded);
+        });
+}
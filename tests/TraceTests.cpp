@@ -0,0 +1,228 @@
+#include "TestHarness.h"
+#include "JsonStream.h"
+#include "Trace.h"
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Members of one trace event; those of its "args" object as "args.<name>"
+    using TraceEvent = std::map<std::string, std::string>;
+
+    // Collects the objects of the "traceEvents" array of a Chrome trace
+    class TraceEventCollector : public JsonHandler
+    {
+    public:
+        std::vector<TraceEvent> events;
+
+        bool OnStartObject() override
+        {
+            ++m_depth;
+            if (m_depth == 2 && m_isInEvents) events.emplace_back();
+            if (m_depth == 3) m_prefix = m_key + ".";
+            return true;
+        }
+
+        bool OnKey(std::string_view key) override
+        {
+            m_key = m_prefix + std::string(key);
+            return true;
+        }
+
+        bool OnEndObject() override
+        {
+            if (m_depth == 3) m_prefix.clear();
+            --m_depth;
+            return true;
+        }
+
+        bool OnStartArray() override
+        {
+            m_isInEvents = m_depth == 1 && m_key == "traceEvents";
+            return true;
+        }
+
+        bool OnEndArray() override
+        {
+            m_isInEvents = false;
+            return true;
+        }
+
+        bool OnString(std::string_view value) override { return Store(value); }
+        bool OnNumber(std::string_view text) override { return Store(text); }
+        bool OnBool(bool value) override { return Store(value ? "true" : "false"); }
+        bool OnNull() override { return Store("null"); }
+
+    private:
+        bool Store(std::string_view value)
+        {
+            if (m_isInEvents && m_depth >= 2) events.back()[m_key] = std::string(value);
+            return true;
+        }
+
+        int m_depth{ 0 };
+        bool m_isInEvents{ false };
+        std::string m_key;
+        std::string m_prefix;
+    };
+
+    // Writes the trace and parses it back; every event of the process so far is included
+    bool ReadTrace(std::vector<TraceEvent>& events)
+    {
+        TestHarness::TemporaryDirectory directory("TraceTests");
+        std::filesystem::path filePath = directory.path / "trace.json";
+        if (!Trace::WriteChromeTrace(filePath)) return false;
+
+        std::ifstream file(filePath, std::ios::binary);
+        JsonReader reader(file);
+        TraceEventCollector collector;
+        if (!reader.Parse(collector)) return false;
+        events = std::move(collector.events);
+        return true;
+    }
+
+    // The events a thread recorded, found by the name it was given, oldest first
+    std::vector<TraceEvent> GetThreadEvents(const std::vector<TraceEvent>& events, const std::string& threadName)
+    {
+        std::string threadId;
+        for (const TraceEvent& event : events)
+        {
+            auto name = event.find("args.name");
+            if (event.at("ph") == "M" && name != event.end() && name->second == threadName) threadId = event.at("tid");
+        }
+        std::vector<TraceEvent> threadEvents;
+        for (const TraceEvent& event : events)
+        {
+            if (!threadId.empty() && event.at("tid") == threadId && event.at("ph") != "M") threadEvents.push_back(event);
+        }
+        return threadEvents;
+    }
+
+    // Records on a thread of its own, so that each case starts with an empty buffer
+    template <typename Function>
+    void RecordOnNewThread(const char* threadName, Function record)
+    {
+        std::thread thread([threadName, &record]()
+            {
+                Trace::SetThreadName(threadName);
+                record();
+            });
+        thread.join();
+    }
+}
+
+TEST_CASE(SpansCountersAndInstantsAreExported)
+{
+    Trace::SetEnabled(true);
+    RecordOnNewThread("Kinds", []()
+        {
+            {
+                TRACE_SCOPE("Scope");
+            }
+            Trace::RecordSpan("Span", 100, 25);
+            TRACE_COUNTER("Counter", -42);
+            TRACE_INSTANT("Instant");
+        });
+    Trace::SetEnabled(false);
+
+    std::vector<TraceEvent> events;
+    REQUIRE(ReadTrace(events));
+    std::vector<TraceEvent> recorded = GetThreadEvents(events, "Kinds");
+    REQUIRE(recorded.size() == 4);
+    CHECK(recorded[0].at("name") == "Scope" && recorded[0].at("ph") == "X");
+    CHECK(recorded[1].at("name") == "Span" && recorded[1].at("ph") == "X");
+    CHECK(recorded[1].at("ts") == "100" && recorded[1].at("dur") == "25");
+    CHECK(recorded[2].at("name") == "Counter" && recorded[2].at("ph") == "C");
+    CHECK(recorded[2].at("args.value") == "-42");
+    CHECK(recorded[3].at("name") == "Instant" && recorded[3].at("ph") == "i");
+    CHECK(recorded[3].at("s") == "t");
+    CHECK(recorded[0].at("pid") == "1");
+}
+
+TEST_CASE(ThreadNamesAreExportedAsMetadata)
+{
+    RecordOnNewThread("Named \"worker\" C:\\x", []() {});
+
+    std::vector<TraceEvent> events;
+    REQUIRE(ReadTrace(events));
+    int found = 0;
+    for (const TraceEvent& event : events)
+    {
+        if (event.at("ph") == "M" && event.at("name") == "thread_name" && event.at("args.name") == "Named \"worker\" C:\\x")
+        {
+            found++;
+        }
+    }
+    CHECK(found == 1);
+}
+
+TEST_CASE(NamesAreEscaped)
+{
+    // Quotes and backslashes are escaped; control characters become spaces
+    Trace::SetEnabled(true);
+    RecordOnNewThread("Escapes", []()
+        {
+            TRACE_INSTANT("quote \" backslash \\ tab\t end");
+        });
+    Trace::SetEnabled(false);
+
+    std::vector<TraceEvent> events;
+    REQUIRE(ReadTrace(events));
+    std::vector<TraceEvent> recorded = GetThreadEvents(events, "Escapes");
+    REQUIRE(recorded.size() == 1);
+    CHECK(recorded[0].at("name") == "quote \" backslash \\ tab  end");
+}
+
+TEST_CASE(TheRingKeepsTheNewestEventsOldestFirst)
+{
+    const int eventCount = 16384 + 1000;
+    Trace::SetEnabled(true);
+    RecordOnNewThread("Ring", []()
+        {
+            for (int i = 0; i < eventCount; ++i) TRACE_COUNTER("Sequence", i);
+        });
+    Trace::SetEnabled(false);
+
+    std::vector<TraceEvent> events;
+    REQUIRE(ReadTrace(events));
+    std::vector<TraceEvent> recorded = GetThreadEvents(events, "Ring");
+    REQUIRE(recorded.size() == 16384);
+    int outOfOrder = 0;
+    for (size_t i = 0; i < recorded.size(); ++i)
+    {
+        if (recorded[i].at("args.value") != std::to_string(eventCount - 16384 + static_cast<int>(i))) outOfOrder++;
+    }
+    CHECK(outOfOrder == 0);
+}
+
+TEST_CASE(NothingIsRecordedWhileDisabled)
+{
+    Trace::SetEnabled(false);
+    RecordOnNewThread("Disabled", []()
+        {
+            {
+                TRACE_SCOPE("Scope");
+            }
+            Trace::RecordSpan("Span", 0, 1);
+            Trace::RecordCounter("Counter", 1);
+            Trace::RecordInstant("Instant");
+        });
+
+    std::vector<TraceEvent> events;
+    REQUIRE(ReadTrace(events));
+    CHECK(GetThreadEvents(events, "Disabled").empty());
+
+    // A span open when tracing is turned on is not recorded either
+    RecordOnNewThread("Late", []()
+        {
+            TRACE_SCOPE("Open");
+            Trace::SetEnabled(true);
+        });
+    Trace::SetEnabled(false);
+    REQUIRE(ReadTrace(events));
+    CHECK(GetThreadEvents(events, "Late").empty());
+}